@@ -0,0 +1,181 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Parsing throughput benchmark.
+
+   A large properties file is generated and parsed by the low level parser
+   with the input provided by various types of streams. The syntax check
+   (sp_check_syntax()) throughput is measured for the memory stream.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sprops/parser.h"
+#include "sprops/props.h"
+
+/* size of the generated input */
+#define IN_SIZE     (8L*1024*1024)
+
+/* number of parsing rounds */
+#define N_ROUNDS    4
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+static long n_elems;
+
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    n_elems++;
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    n_elems++;
+    return SPEC_SUCCESS;
+}
+
+/* Generate input of at least 'size' length into 'cf'. */
+static long gen_input(FILE *cf, long size)
+{
+    long n=0;
+    int i, j;
+
+    for (i=0; n<size; i++)
+    {
+        n += fprintf(cf, "# section %d\nsection sect_%d\n{\n", i, i);
+        n += fprintf(cf, "    name = \"Section number %d\"\n", i);
+        n += fprintf(cf, "    enabled = %s;\n", (i & 1 ? "true" : "false"));
+
+        for (j=0; j<8; j++) {
+            n += fprintf(cf, "    entry_%d {\n", j);
+            n += fprintf(cf, "        key = value_%d_%d  # comment\n", i, j);
+            n += fprintf(cf, "        'quoted key' = 0x%08x\n", i*j);
+            n += fprintf(cf, "        esc = tab\\there\\x20and\\ncont \\\n"
+                "            inued\n");
+            n += fprintf(cf, "    }\n");
+        }
+        n += fprintf(cf, "}\n\n");
+    }
+    return n;
+}
+
+static double now(void)
+{
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+/* Parse 'in' N_ROUNDS times and print the throughput */
+static sp_errc_t bench_parse(const char *desc, SP_FILE *in, long in_len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    double t;
+    int i;
+
+    n_elems = 0;
+    t = now();
+
+    for (i=0; i<N_ROUNDS; i++) {
+        EXEC_RG(sp_parse(in, NULL, cb_prop, cb_scope, NULL, NULL));
+    }
+
+    t = now()-t;
+    printf("%-24s %8.2f MB/s (%ld elements)\n", desc,
+        (t>0 ? (double)in_len*N_ROUNDS/(1024*1024)/t : 0.0),
+        n_elems/N_ROUNDS);
+
+finish:
+    return ret;
+}
+
+/* Check syntax of 'in' N_ROUNDS times and print the throughput */
+static sp_errc_t bench_check(const char *desc, SP_FILE *in, long in_len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    double t;
+    int i;
+
+    t = now();
+
+    for (i=0; i<N_ROUNDS; i++) {
+        EXEC_RG(sp_check_syntax(in, NULL, NULL));
+    }
+
+    t = now()-t;
+    printf("%-24s %8.2f MB/s\n", desc,
+        (t>0 ? (double)in_len*N_ROUNDS/(1024*1024)/t : 0.0));
+
+finish:
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    long in_len;
+    char *buf=NULL;
+    FILE *cf;
+    SP_FILE in;
+    int in_opn=0;
+
+    if (!(cf = tmpfile())) {
+        ret=SPEC_FOPEN_ERR;
+        goto finish;
+    }
+    EXEC_RG(sp_fopen2(&in, cf));
+    in_opn++;
+
+    in_len = gen_input(cf, IN_SIZE);
+    fflush(cf);
+
+    printf("--- Parsing %ld bytes input\n", in_len);
+
+    /* ANSI C stream w/o the library buffering (plain fgetc(3) calls) */
+    EXEC_RG(sp_fsetbuf(&in, 0));
+    EXEC_RG(bench_parse("C stream, unbuffered:", &in, in_len));
+
+    /* ANSI C stream with the read-ahead buffer */
+    EXEC_RG(sp_fsetbuf(&in, 0x1000));
+    EXEC_RG(bench_parse("C stream, 4KB buffer:", &in, in_len));
+
+    EXEC_RG(sp_fsetbuf(&in, 0x10000));
+    EXEC_RG(bench_parse("C stream, 64KB buffer:", &in, in_len));
+
+    /* memory stream */
+    if (!(buf = (char*)malloc(in_len))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    rewind(cf);
+    EXEC_RG(sp_fsetbuf(&in, 0));
+    if (fread(buf, 1, in_len, cf)!=(size_t)in_len) {
+        ret=SPEC_ACCS_ERR;
+        goto finish;
+    }
+
+    sp_close(&in);
+    in_opn--;
+
+    sp_mopen(&in, buf, in_len);
+    EXEC_RG(bench_parse("memory stream:", &in, in_len));
+    EXEC_RG(bench_check("memory stream, check:", &in, in_len));
+
+finish:
+    if (in_opn) sp_close(&in);
+    if (buf) free(buf);
+    if (ret) printf("Error: %d\n", ret);
+    return ret;
+}
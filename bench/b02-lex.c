@@ -0,0 +1,169 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Lexer micro-benchmark.
+
+   Inputs of various shapes (dominated by specific kinds of tokens) are
+   syntax-checked from a memory stream (where the lexer scans runs of chars
+   directly from the stream content) and from a not buffered ANSI C stream
+   (where the content is read char by char). The lexer throughput is printed
+   in bytes per CPU cycle (x86 only) and MB/s.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sprops/props.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# include <x86intrin.h>
+# define HAVE_TSC 1
+#else
+# define HAVE_TSC 0
+#endif
+
+/* size of the generated inputs */
+#define IN_SIZE     (4L*1024*1024)
+
+/* number of lexing rounds */
+#define N_ROUNDS    4
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* Generate input of a shape 'shape' of at least 'size' length into 'buf' */
+static long gen_input(char *buf, long size, int shape)
+{
+    long n=0;
+    int i;
+
+    for (i=0; n<size; i++)
+    {
+        switch (shape)
+        {
+        /* short tokens */
+        case 0:
+            n += sprintf(&buf[n], "a%d=%d;b;c {d=x;}\n", i%10, i%100);
+            break;
+        /* long values */
+        case 1:
+            n += sprintf(&buf[n], "key_%d = Lorem ipsum dolor sit amet, "
+                "consectetur adipiscing elit, sed do eiusmod tempor incididunt "
+                "ut labore et dolore magna aliqua %d\n", i, i);
+            break;
+        /* long comments */
+        case 2:
+            n += sprintf(&buf[n], "# Ut enim ad minim veniam, quis nostrud "
+                "exercitation ullamco laboris nisi ut aliquip ex ea commodo "
+                "consequat %d\nx=%d\n", i, i);
+            break;
+        /* long ids (quoted and not quoted) */
+        case 3:
+            n += sprintf(&buf[n], "section_with_a_long_name_%d "
+                "\"quoted scope name with spaces %d\" {}\n", i, i);
+            break;
+        /* configuration alike input */
+        default:
+            n += sprintf(&buf[n], "# section %d\nsection sect_%d\n{\n"
+                "    name = \"Section number %d\"\n"
+                "    entry {\n"
+                "        key = value_%d  # comment\n"
+                "        esc = tab\\there\\x20and\\ncont \\\n"
+                "            inued\n"
+                "    }\n}\n\n", i, i, i, i);
+            break;
+        }
+    }
+    return n;
+}
+
+static const char *shapes[] = {
+    "short tokens", "long values", "long comments", "long ids", "config"
+};
+
+/* Lex 'in' N_ROUNDS times and print the throughput */
+static sp_errc_t bench_lex(const char *desc, SP_FILE *in, long in_len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    double t, mbs;
+    int i;
+#if HAVE_TSC
+    unsigned long long cyc = __rdtsc();
+#endif
+
+    t = (double)clock()/CLOCKS_PER_SEC;
+
+    for (i=0; i<N_ROUNDS; i++) {
+        EXEC_RG(sp_check_syntax(in, NULL, NULL));
+    }
+
+    t = (double)clock()/CLOCKS_PER_SEC - t;
+    mbs = (t>0 ? (double)in_len*N_ROUNDS/(1024*1024)/t : 0.0);
+#if HAVE_TSC
+    cyc = __rdtsc()-cyc;
+    printf("  %-22s %6.3f bytes/cycle %9.2f MB/s\n", desc,
+        (cyc ? (double)in_len*N_ROUNDS/cyc : 0.0), mbs);
+#else
+    printf("  %-22s %9.2f MB/s\n", desc, mbs);
+#endif
+
+finish:
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    long in_len;
+    char *buf=NULL;
+    FILE *cf=NULL;
+    SP_FILE in;
+    int shape, in_opn=0;
+
+    /* the generated lines are far shorter than the margin */
+    if (!(buf = (char*)malloc(IN_SIZE+0x200))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+
+    for (shape=0; shape < (int)(sizeof(shapes)/sizeof(shapes[0])); shape++)
+    {
+        in_len = gen_input(buf, IN_SIZE, shape);
+        printf("--- Input: %s (%ld bytes)\n", shapes[shape], in_len);
+
+        sp_mopen(&in, buf, in_len);
+        EXEC_RG(bench_lex("memory stream:", &in, in_len));
+
+        if (!(cf = tmpfile())) {
+            ret=SPEC_FOPEN_ERR;
+            goto finish;
+        }
+        EXEC_RG(sp_fopen2(&in, cf));
+        in_opn++;
+
+        if (fwrite(buf, 1, in_len, cf)!=(size_t)in_len) {
+            ret=SPEC_ACCS_ERR;
+            goto finish;
+        }
+        fflush(cf);
+
+        EXEC_RG(bench_lex("C stream, unbuffered:", &in, in_len));
+
+        sp_close(&in);
+        in_opn--;
+    }
+
+finish:
+    if (in_opn) sp_close(&in);
+    if (buf) free(buf);
+    if (ret) printf("Error: %d\n", ret);
+    return ret;
+}
@@ -0,0 +1,120 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Parsing calls overhead benchmark.
+
+   Small inputs (of various nesting depth) are parsed from a memory stream
+   many times by the low level parser, with the parser stacks allocated by
+   alloca(3) (sp_parse()), on the heap for each call (sp_parse_alloc()) and
+   retained by a parser context (sp_parse_ex()). Time per call is printed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sprops/parser.h"
+
+/* number of parsing calls */
+#define N_CALLS     200000L
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    return SPEC_SUCCESS;
+}
+
+static void *h_alloc(void *ctx, size_t size) {
+    return malloc(size);
+}
+static void h_free(void *ctx, void *ptr) {
+    free(ptr);
+}
+
+static const sp_alloc_t heap_alloc = {h_alloc, NULL, h_free, NULL};
+
+/* Generate input with scopes nested up to 'depth' into 'buf' */
+static long gen_input(char *buf, int depth)
+{
+    long n=0;
+    int i;
+
+    for (i=0; i<depth; i++) n += sprintf(&buf[n], "s%d {a=1;", i);
+    for (i=0; i<depth; i++) n += sprintf(&buf[n], "}");
+    n += sprintf(&buf[n], "\nb = 2\nc = 3\n");
+    return n;
+}
+
+static double now(void)
+{
+    return (double)clock()/CLOCKS_PER_SEC;
+}
+
+#define __BENCH(desc, call) { \
+    double t = now(); \
+    for (i=0; i<N_CALLS; i++) { EXEC_RG(call); } \
+    t = now()-t; \
+    printf("  %-20s %8.1f ns/call\n", desc, t*1e9/N_CALLS); \
+}
+
+/* Parse 'in' N_CALLS times by the parsing functions variants */
+static sp_errc_t bench_calls(SP_FILE *in)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_parser_ctx_t ctx;
+    long i;
+
+    EXEC_RG(sp_parser_ctx_init(&ctx, NULL));
+
+    __BENCH("sp_parse():",
+        sp_parse(in, NULL, cb_prop, cb_scope, NULL, NULL));
+    __BENCH("sp_parse_alloc():",
+        sp_parse_alloc(in, NULL, cb_prop, cb_scope, NULL, &heap_alloc, NULL));
+    __BENCH("sp_parse_ex():",
+        sp_parse_ex(&ctx, in, NULL, cb_prop, cb_scope, NULL, NULL));
+
+finish:
+    sp_parser_ctx_free(&ctx);
+    return ret;
+}
+
+int main(void)
+{
+    static const int depths[] = {0, 50, 500};
+
+    sp_errc_t ret=SPEC_SUCCESS;
+    static char buf[0x4000];
+    long in_len;
+    SP_FILE in;
+    int i;
+
+    for (i=0; i<(int)(sizeof(depths)/sizeof(*depths)); i++)
+    {
+        in_len = gen_input(buf, depths[i]);
+        sp_mopen(&in, buf, in_len);
+
+        printf("--- Nesting depth %d (%ld bytes)\n", depths[i], in_len);
+        EXEC_RG(bench_calls(&in));
+    }
+
+finish:
+    if (ret) printf("Error: %d\n", ret);
+    return ret;
+}
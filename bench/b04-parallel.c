@@ -0,0 +1,151 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Parallel parsing benchmark.
+
+   A large input of many top-level scopes is generated in memory and parsed
+   (and indexed) by sp_parse_parallel() (sp_index_build_parallel()) with an
+   increasing number of threads. Since the parallel parsing speeds up the
+   wall clock time only, the elapsed (monotonic) time is measured.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sprops/parser.h"
+#include "sprops/index.h"
+
+/* size of the generated input */
+#define IN_SIZE     (64L*1024*1024)
+
+/* number of parsing rounds */
+#define N_ROUNDS    2
+
+/* max. number of threads */
+#define MAX_THREADS 8
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    (*(long*)arg)++;
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    (*(long*)arg)++;
+    return SPEC_SUCCESS;
+}
+
+/* Generate input of at least 'size' length; the input buffer is returned
+   (NULL on error) with its length written under 'p_len'. */
+static char *gen_input(long size, long *p_len)
+{
+    long n=0;
+    char *buf;
+    int i, j;
+
+    if (!(buf = (char*)malloc(size+0x400))) return NULL;
+
+    for (i=0; n<size; i++)
+    {
+        n += sprintf(&buf[n], "# section %d\nsection sect_%d\n{\n", i, i);
+        n += sprintf(&buf[n], "    name = \"Section number %d\"\n", i);
+
+        for (j=0; j<8; j++) {
+            n += sprintf(&buf[n], "    entry_%d {\n", j);
+            n += sprintf(&buf[n],
+                "        key = value_%d_%d  # comment\n", i, j);
+            n += sprintf(&buf[n], "        'quoted key' = 0x%08x\n", i*j);
+            n += sprintf(&buf[n], "    }\n");
+        }
+        n += sprintf(&buf[n], "}\n\n");
+    }
+    *p_len = n;
+    return buf;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (double)ts.tv_nsec/1e9;
+}
+
+/* Parse (or index if 'index' is set) 'in' with 'n_threads' threads N_ROUNDS
+   times and print the throughput */
+static sp_errc_t bench_parse(SP_FILE *in, long in_len, int n_threads,
+    int index)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_index_t idx;
+    long sinks[MAX_THREADS];
+    void *p_sinks[MAX_THREADS];
+    double t;
+    int i, j;
+
+    t = now();
+    for (i=0; i<N_ROUNDS; i++)
+    {
+        if (index) {
+            EXEC_RG(sp_index_build_parallel(in, NULL, n_threads, &idx, NULL));
+            sp_index_free(&idx);
+        } else {
+            for (j=0; j<n_threads; j++) {
+                sinks[j] = 0;
+                p_sinks[j] = &sinks[j];
+            }
+            EXEC_RG(sp_parse_parallel(in, NULL,
+                cb_prop, cb_scope, NULL, p_sinks, n_threads, NULL));
+        }
+    }
+    t = now()-t;
+
+    printf("%s, %d thread(s): %8.2f MB/s\n", (index ? "index" : "parse"),
+        n_threads, (t>0 ? (double)in_len*N_ROUNDS/(1024*1024)/t : 0.0));
+
+finish:
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    long in_len;
+    char *buf;
+    SP_FILE in;
+    int n_thr, index;
+
+    if (!(buf = gen_input(IN_SIZE, &in_len))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    sp_mopen(&in, buf, in_len);
+
+    printf("--- Parallel parsing %ld bytes input\n", in_len);
+
+    for (index=0; index<2; index++) {
+        for (n_thr=1; n_thr<=MAX_THREADS; n_thr*=2) {
+            EXEC_RG(bench_parse(&in, in_len, n_thr, index));
+        }
+    }
+
+finish:
+    if (buf) free(buf);
+    if (ret) printf("Error: %d\n", ret);
+    return ret;
+}
@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016,2019 Piotr Stolarz
+   Copyright (c) 2016,2019,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -36,7 +36,8 @@ static sp_errc_t store_iter_cb(
     const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     long price=0, stock=0, year=0;
-    char title[48], audir[32];
+    char title[48], audir[32], year_str[16];
+    sp_prop_req_t reqs[3];
     char *audir_nm=NULL;
     sp_loc_t *p_sc=NULL;
 
@@ -77,24 +78,30 @@ static sp_errc_t store_iter_cb(
        location of these scopes have been preserved, we may use them
        to get an item related props with more efficient way (there is no
        need to parse the whole configuration to find a scope of interest).
+       All the item's props are fetched in a single pass over its scope.
      */
-    if (sp_get_prop(in,
+    memset(reqs, 0, sizeof(reqs));
+
+    reqs[0].name = "title";
+    reqs[0].val = title;
+    reqs[0].len = sizeof(title);
+
+    reqs[1].name = audir_nm;
+    reqs[1].val = audir;
+    reqs[1].len = sizeof(audir);
+
+    reqs[2].name = "year";
+    reqs[2].val = year_str;
+    reqs[2].len = sizeof(year_str);
+
+    sp_get_props(in,
         p_sc,               /* parse preserved scope */
-        "title", 0,
         name,               /* iterated scope name as an item id */
-        NULL, title, sizeof(title), NULL)!=SPEC_SUCCESS) *title=0;
-
-    if (sp_get_prop(in,
-        p_sc,
-        audir_nm, 0,
-        name,
-        NULL, audir, sizeof(audir), NULL)!=SPEC_SUCCESS) *audir=0;
+        NULL, reqs, 3);
 
-    sp_get_prop_int(in,
-        p_sc,
-        "year", 0,
-        name,
-        NULL, &year, NULL);
+    if (reqs[0].ret!=SPEC_SUCCESS) *title=0;
+    if (reqs[1].ret!=SPEC_SUCCESS) *audir=0;
+    if (reqs[2].ret==SPEC_SUCCESS) sp_util_parse_int(year_str, &year);
 
     printf(
         "    title: %s\n    %s: %s\n    year: %d\n"
@@ -0,0 +1,445 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Validation-only syntax checker.
+
+   The checker scans the input by a state machine mirroring the lexer
+   (see yylex() in parser.y) and feeds the recognized tokens to a minimal
+   state machine of the grammar. No tokens locations and grammar values are
+   built; the location of the last token beginning is tracked only for the
+   syntax error reporting. The reported syntax errors are the same as the
+   grammar parser's ones.
+ */
+
+#include "config.h"
+#include "io.h"
+#include "parser_int.h"
+#include "scan.h"
+
+/* lexer states */
+typedef enum _chk_lex_t
+{
+    CHL_INIT=0,     /* token not recognized yet */
+    CHL_CMT,        /* comment */
+    CHL_ID,         /* non quoted SP_TKN_ID */
+    CHL_ID_QUOTED,  /* quoted SP_TKN_ID */
+    CHL_VAL_INIT,   /* SP_TKN_VAL not started yet */
+    CHL_VAL         /* SP_TKN_VAL */
+} chk_lex_t;
+
+/* grammar states */
+typedef enum _chk_grm_t
+{
+    CHG_ELM=0,      /* element (or closing bracket) expected */
+    CHG_ID,         /* SP_TKN_ID */
+    CHG_ID2,        /* SP_TKN_ID SP_TKN_ID */
+    CHG_EQ,         /* SP_TKN_ID '=' */
+    CHG_VAL         /* SP_TKN_ID '=' SP_TKN_VAL */
+} chk_grm_t;
+
+/* end of input token */
+#define CHK_TKN_EOF 0
+
+typedef struct _chk_hndl_t
+{
+    struct {
+        chk_lex_t state;
+        int esc;
+        int quot_chr;
+
+        /* if !=0: CR has been read, LF following it is a part of the EOL */
+        int cr;
+
+        /* offset of the next char to read, current line and the line
+           beginning (offset and its column) */
+        long off;
+        int line;
+        long lbeg;
+        int lcol;
+    } lex;
+
+    /* beginning of the last token */
+    struct {
+        long off;
+        int line;
+        int col;
+    } tkn;
+
+    struct {
+        chk_grm_t state;
+
+        /* scope level (0-based) */
+        int lev;
+    } grm;
+
+    /* syntax error; code!=0 if occurred */
+    sp_synerr_t err;
+} chk_hndl_t;
+
+#define __IS_SPACE(c) (sp_cctab[(c) & 0xff] & SP_CC_SPACE)
+#define __IS_NQ_IDC(c) (!(sp_cctab[(c) & 0xff] & (SP_CC_SPACE | SP_CC_RSV)))
+
+/* mark beginning of a token at the current offset */
+#define __TKN_BEG(p) \
+    (p)->tkn.off = (p)->lex.off; \
+    (p)->tkn.line = (p)->lex.line; \
+    (p)->tkn.col = (p)->lex.lcol + (int)((p)->lex.off - (p)->lex.lbeg);
+
+/* Report a syntax error 'code' located at the last token beginning */
+static int chk_err(chk_hndl_t *p_hndl, sp_syncode_t code)
+{
+    p_hndl->err.code = code;
+    p_hndl->err.loc.line = p_hndl->tkn.line;
+    p_hndl->err.loc.col = p_hndl->tkn.col;
+    return -1;
+}
+
+/* Grammar state machine: process a token 'tkn' (SP_TKN_XXX, char token or
+   CHK_TKN_EOF). Return 0 on success, -1 on the syntax error.
+ */
+static int chk_tkn(chk_hndl_t *p_hndl, int tkn)
+{
+    chk_grm_t state = p_hndl->grm.state;
+
+    switch (tkn)
+    {
+    case SP_TKN_ID:
+        if (state==CHG_ELM || state==CHG_VAL) state=CHG_ID;
+        else if (state==CHG_ID) state=CHG_ID2;
+        else goto err;
+        break;
+
+    case SP_TKN_VAL:
+        /* the lexer provides the token after '=' only */
+        state=CHG_VAL;
+        break;
+
+    case '=':
+        if (state==CHG_ID) state=CHG_EQ;
+        else goto err;
+        break;
+
+    case ';':
+#if CONFIG_NO_EMPTY_SCOPE_ALT
+        if (state==CHG_ID || state==CHG_VAL) state=CHG_ELM;
+#else
+        if (state==CHG_ID || state==CHG_ID2 || state==CHG_VAL) state=CHG_ELM;
+#endif
+        else goto err;
+        break;
+
+    case '{':
+#if CONFIG_MAX_SCOPE_LEVEL_DEPTH >= 0
+        /* the lexer's error */
+        if (p_hndl->grm.lev+1 > CONFIG_MAX_SCOPE_LEVEL_DEPTH)
+            return chk_err(p_hndl, SPSYN_LEV_DEPTH);
+#endif
+        if (state==CHG_ID || state==CHG_ID2) {
+            state=CHG_ELM;
+            p_hndl->grm.lev++;
+        } else goto err;
+        break;
+
+    case '}':
+        if ((state==CHG_ELM || state==CHG_VAL) && p_hndl->grm.lev > 0) {
+            state=CHG_ELM;
+            p_hndl->grm.lev--;
+        } else goto err;
+        break;
+
+    default:
+        /* CHK_TKN_EOF; the error is located at the last token */
+        if ((state!=CHG_ELM && state!=CHG_VAL) || p_hndl->grm.lev) goto err;
+        break;
+    }
+
+    p_hndl->grm.state = state;
+    return 0;
+err:
+    return chk_err(p_hndl, SPSYN_GRAMMAR);
+}
+
+/* Scan a block 'b' of 'n' chars of the input. Return number of consumed
+   chars; scanning stops on NULL char (end of the input) or the syntax error.
+ */
+static size_t chk_block(chk_hndl_t *p_hndl, const char *b, size_t n)
+{
+    const sp_scan_mode_t *p_smode;
+    size_t i=0, n_run;
+    int c, eol;
+
+    while (i < n)
+    {
+        /* LF of CR/LF EOL */
+        if (p_hndl->lex.cr) {
+            p_hndl->lex.cr = 0;
+            if (b[i]=='\n') {
+                i++;
+                p_hndl->lex.lbeg = ++p_hndl->lex.off;
+                continue;
+            }
+        }
+
+        switch (p_hndl->lex.state)
+        {
+        case CHL_CMT:
+            p_smode = &sp_scan_cmt;
+            break;
+        case CHL_ID:
+            p_smode = &sp_scan_id;
+            break;
+        case CHL_ID_QUOTED:
+            p_smode = (p_hndl->lex.quot_chr=='"' ? &sp_scan_dq : &sp_scan_sq);
+            break;
+        case CHL_VAL:
+            p_smode = &sp_scan_val;
+            break;
+        default:
+            p_smode = NULL;
+            break;
+        }
+
+        /* runs of chars not requiring the state machine attention (never
+           containing EOLs and escapes) */
+        if (p_smode && (n_run=sp_scan_run(&b[i], n-i, p_smode))>0) {
+            i += n_run;
+            p_hndl->lex.off += (long)n_run;
+            p_hndl->lex.esc = 0;
+            if (i >= n) break;
+        }
+
+        if (!(c = b[i] & 0xff)) break;
+        eol = (c=='\r' || c=='\n');
+
+        switch (p_hndl->lex.state)
+        {
+        case CHL_INIT:
+            if (eol || __IS_SPACE(c)) break;
+            if (c=='#') {
+                p_hndl->lex.state = CHL_CMT;
+                break;
+            }
+
+            __TKN_BEG(p_hndl);
+            if (__IS_NQ_IDC(c)) {
+                if (c=='"' || c=='\'') {
+                    p_hndl->lex.quot_chr = c;
+                    p_hndl->lex.esc = 0;
+                    p_hndl->lex.state = CHL_ID_QUOTED;
+                } else {
+                    p_hndl->lex.esc = (c=='\\');
+                    p_hndl->lex.state = CHL_ID;
+                }
+            } else {
+                if (chk_tkn(p_hndl, c)) return i;
+                if (c=='=') p_hndl->lex.state = CHL_VAL_INIT;
+            }
+            break;
+
+        case CHL_CMT:
+            if (eol) p_hndl->lex.state = CHL_INIT;
+            break;
+
+        case CHL_ID:
+            if (p_hndl->lex.esc) {
+                /* line continuation is not possible for SP_TKN_ID */
+                if (eol) {
+                    chk_err(p_hndl, SPSYN_UNEXP_EOL);
+                    return i;
+                }
+                p_hndl->lex.esc = 0;
+            } else
+            if (c=='\\') {
+                p_hndl->lex.esc = 1;
+            } else
+            if (eol || !__IS_NQ_IDC(c)) {
+                /* the char is processed by the initial state */
+                if (chk_tkn(p_hndl, SP_TKN_ID)) return i;
+                p_hndl->lex.state = CHL_INIT;
+                continue;
+            }
+            break;
+
+        case CHL_ID_QUOTED:
+            if (eol) {
+                /* quoted SP_TKN_ID need to be finished by the quotation mark;
+                   too short token is reported as empty (as the lexer does) */
+                chk_err(p_hndl, (p_hndl->lex.off - p_hndl->tkn.off <= 2 ?
+                    SPSYN_EMPTY_TKN : SPSYN_UNEXP_EOL));
+                return i;
+            } else
+            if (p_hndl->lex.esc) {
+                p_hndl->lex.esc = 0;
+            } else
+            if (c=='\\') {
+                p_hndl->lex.esc = 1;
+            } else
+            if (c==p_hndl->lex.quot_chr) {
+                if (p_hndl->lex.off - p_hndl->tkn.off + 1 <= 2) {
+                    chk_err(p_hndl, SPSYN_EMPTY_TKN);
+                    return i;
+                }
+                if (chk_tkn(p_hndl, SP_TKN_ID)) return i;
+                p_hndl->lex.state = CHL_INIT;
+            }
+            break;
+
+        case CHL_VAL_INIT:
+#if CONFIG_NO_SEMICOL_ENDS_VAL
+            if (eol)
+#else
+            if (eol || c==';')
+#endif
+            {
+                /* empty SP_TKN_VAL */
+                __TKN_BEG(p_hndl);
+                chk_tkn(p_hndl, SP_TKN_VAL);
+                p_hndl->lex.state = CHL_INIT;
+                if (c==';') continue;
+            } else
+#if CONFIG_CUT_VAL_LEADING_SPACES
+            if (!__IS_SPACE(c))
+#endif
+            {
+                __TKN_BEG(p_hndl);
+                p_hndl->lex.esc = (c=='\\');
+                p_hndl->lex.state = CHL_VAL;
+            }
+            break;
+
+        case CHL_VAL:
+            if (p_hndl->lex.esc) {
+                /* escaped char (including EOL for the line continuation) */
+                p_hndl->lex.esc = 0;
+            } else
+            if (c=='\\') {
+                p_hndl->lex.esc = 1;
+            } else
+#if CONFIG_NO_SEMICOL_ENDS_VAL
+            if (eol)
+#else
+            if (eol || c==';')
+#endif
+            {
+                chk_tkn(p_hndl, SP_TKN_VAL);
+                p_hndl->lex.state = CHL_INIT;
+                if (c==';') continue;
+            }
+            break;
+        }
+
+        /* track location of the next char */
+        i++;
+        p_hndl->lex.off++;
+        if (eol) {
+            p_hndl->lex.cr = (c=='\r');
+            p_hndl->lex.line++;
+            p_hndl->lex.lbeg = p_hndl->lex.off;
+            p_hndl->lex.lcol = 1;
+        }
+    }
+    return i;
+}
+
+/* Finish scanning at the end of the input. Return 0 on success, -1 on the
+   syntax error.
+ */
+static int chk_eof(chk_hndl_t *p_hndl)
+{
+    switch (p_hndl->lex.state)
+    {
+    case CHL_ID:
+        if (chk_tkn(p_hndl, SP_TKN_ID)) return -1;
+        break;
+
+    case CHL_ID_QUOTED:
+        /* not finished quoted SP_TKN_ID; too short token is reported as
+           empty (as the lexer does) */
+        return chk_err(p_hndl, (p_hndl->lex.off - p_hndl->tkn.off <= 2 ?
+            SPSYN_EMPTY_TKN : SPSYN_UNEXP_EOF));
+
+    case CHL_VAL_INIT:
+        /* empty SP_TKN_VAL located at the end of the input */
+        __TKN_BEG(p_hndl);
+        chk_tkn(p_hndl, SP_TKN_VAL);
+        break;
+
+    case CHL_VAL:
+        chk_tkn(p_hndl, SP_TKN_VAL);
+        break;
+
+    default:
+        break;
+    }
+    return chk_tkn(p_hndl, CHK_TKN_EOF);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_check(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_loc_t globsc = {0, -1L, 1, 1, -1, -1};
+    chk_hndl_t hndl;
+    const char *b;
+    size_t num, used;
+
+    if (!in) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    /* streams w/o the direct access are checked by the grammar parser */
+    if (!sp_fdirect(in)) {
+        ret = sp_parse(in, p_parsc, NULL, NULL, NULL, p_synerr);
+        goto finish;
+    }
+
+    if (!p_parsc) p_parsc=&globsc;
+    if (sp_fseek(in, p_parsc->beg, SEEK_SET)) {
+        ret=SPEC_ACCS_ERR;
+        goto finish;
+    }
+
+    hndl.lex.state = CHL_INIT;
+    hndl.lex.esc = hndl.lex.quot_chr = hndl.lex.cr = 0;
+    hndl.lex.off = hndl.lex.lbeg = p_parsc->beg;
+    hndl.lex.line = p_parsc->first_line;
+    hndl.lex.lcol = p_parsc->first_column;
+    hndl.tkn.off = p_parsc->beg;
+    hndl.tkn.line = hndl.tkn.col = 1;
+    hndl.grm.state = CHG_ELM;
+    hndl.grm.lev = 0;
+    hndl.err.code = (sp_syncode_t)0;
+
+    while ((b=sp_fpeek(in, &num))!=NULL)
+    {
+        /* the parsing scope end */
+        if (p_parsc->end!=-1L) {
+            if (hndl.lex.off > p_parsc->end) break;
+            if ((long)num > p_parsc->end-hndl.lex.off+1)
+                num = (size_t)(p_parsc->end-hndl.lex.off+1);
+        }
+
+        used = chk_block(&hndl, b, num);
+        sp_fskip(in, used);
+        if (used < num) break;
+    }
+
+    if (hndl.err.code || chk_eof(&hndl)) {
+        ret=SPEC_SYNTAX;
+        if (p_synerr) *p_synerr=hndl.err;
+    }
+
+finish:
+    return ret;
+}
@@ -73,6 +73,75 @@
 # define CONFIG_TRANS_PARSC_MOD PARSC_EXTIND
 #endif
 
+/* Size of the read-ahead buffer (in bytes) allocated for ANSI C streams opened
+   by sp_fopen() and temporary streams of transactions. The buffer allows
+   reading the streams by blocks, and seeking inside the buffered block w/o the
+   C stream access.
+   If 0 - the streams are not buffered by default (the buffering may be still
+   enabled by sp_fsetbuf()).
+ */
+#ifndef CONFIG_FILE_BUF_SIZE
+# define CONFIG_FILE_BUF_SIZE 0x10000
+#endif
+
+/* If the boolean parameter is configured: support memory mapped file streams
+   (sp_fmap()). The support requires POSIX mmap(2) and is configured by default
+   on the platforms providing it.
+ */
+#ifndef CONFIG_FILE_MMAP
+# if defined(__unix__) || defined(__APPLE__)
+#  define CONFIG_FILE_MMAP 1
+# else
+#  define CONFIG_FILE_MMAP 0
+# endif
+#endif
+
+/* If the boolean parameter is configured: the lexer scans runs of chars of
+   ids, values and comments (from memory streams and buffered blocks of other
+   stream types) with SIMD instructions. SSE2 or AVX2 instructions set is used,
+   the latter is selected at runtime if supported by the CPU. If not
+   configured, the runs are scanned with a chars classes table lookup.
+   Configured by default for x86 targets and GCC compatible compilers.
+ */
+#ifndef CONFIG_LEX_SIMD
+# if defined(__GNUC__) && \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#  define CONFIG_LEX_SIMD 1
+# else
+#  define CONFIG_LEX_SIMD 0
+# endif
+#endif
+
+/* Initial size (number of elements) of the grammar parser stacks placed on
+   the parser function's stack frame. The stacks grow (by doubling its size)
+   by alloca(3) or by a parser allocator (see sp_parse_alloc()) if needed.
+   Lower values decrease the stack usage of the parser (which is nested for
+   each followed scope) at the cost of earlier growing for deeper inputs.
+ */
+#ifndef CONFIG_PARSER_INIT_DEPTH
+# define CONFIG_PARSER_INIT_DEPTH 200
+#endif
+
+/* If the boolean parameter is configured: sp_parse_parallel() parses chunks of
+   the input by POSIX threads. Configured by default on the platforms providing
+   them. If not configured, the input is parsed by the calling thread.
+ */
+#ifndef CONFIG_PARSE_PARALLEL
+# if defined(__unix__) || defined(__APPLE__)
+#  define CONFIG_PARSE_PARALLEL 1
+# else
+#  define CONFIG_PARSE_PARALLEL 0
+# endif
+#endif
+
+/* Minimal size (in bytes) of an input chunk parsed by a thread of the parallel
+   parsing (see sp_parse_parallel()). Inputs shorter than two chunks are parsed
+   by the calling thread.
+ */
+#ifndef CONFIG_PARSE_PAR_CHUNK
+# define CONFIG_PARSE_PAR_CHUNK 0x40000
+#endif
+
 /* If a parameter is defined w/o value assigned, it is assumed as configured.
  */
 #define __XEXT1(__prm) (1##__prm)
@@ -106,6 +175,27 @@
 # endif
 #endif
 
+#ifdef CONFIG_FILE_MMAP
+# if (__EXT1(CONFIG_FILE_MMAP) == 1)
+#  undef CONFIG_FILE_MMAP
+#  define CONFIG_FILE_MMAP 1
+# endif
+#endif
+
+#ifdef CONFIG_LEX_SIMD
+# if (__EXT1(CONFIG_LEX_SIMD) == 1)
+#  undef CONFIG_LEX_SIMD
+#  define CONFIG_LEX_SIMD 1
+# endif
+#endif
+
+#ifdef CONFIG_PARSE_PARALLEL
+# if (__EXT1(CONFIG_PARSE_PARALLEL) == 1)
+#  undef CONFIG_PARSE_PARALLEL
+#  define CONFIG_PARSE_PARALLEL 1
+# endif
+#endif
+
 #undef __EXT1
 #undef __XEXT1
 
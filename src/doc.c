@@ -0,0 +1,847 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io.h"
+#include "parser_int.h"
+#include "props_int.h"
+#include "sprops/doc.h"
+#include "sprops/utils.h"
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* arena block size */
+#define DOC_BLK_SZ      0x4000
+
+/* initial size of the pending elements stack */
+#define DOC_INIT_PEND   64
+
+/* arena allocations alignment */
+typedef union _doc_align_t
+{
+    long l;
+    double d;
+    void *p;
+} doc_align_t;
+
+#define __ALIGN(sz) \
+    (((sz)+sizeof(doc_align_t)-1) & ~(sizeof(doc_align_t)-1))
+
+/* body hash table key */
+#define __HKEY(is_scp, th, nh) \
+    ((nh) ^ ((th)*31UL) ^ (unsigned long)(is_scp))
+
+struct _sp_doc_blk_t
+{
+    sp_doc_blk_t *next;
+
+    size_t sz;      /* block data size */
+    size_t used;    /* used part of the block data */
+};
+
+/* arena block data */
+#define BLK_DATA(b) ((char*)(b) + __ALIGN(sizeof(sp_doc_blk_t)))
+
+/* de-escaped string (NULL terminated) */
+typedef struct _doc_str_t
+{
+    const char *ptr;
+    size_t len;
+    unsigned long hash;     /* as calculated by sp_parser_str_hash() */
+} doc_str_t;
+
+struct _sp_doc_elem_t
+{
+    int is_scp;
+
+    /* properties have no type (empty) */
+    doc_str_t type;
+    doc_str_t name;
+
+    /* next sibling of the same kind, type and name; for scopes this is
+       the chain of split scope parts in order of their appearance */
+    sp_doc_elem_t *snext;
+
+    /* body hash table chain of the 1st occurrences of the siblings */
+    sp_doc_elem_t *hnext;
+
+    union {
+        /* property */
+        struct {
+            int val_pres;       /* if !=0: property value is present */
+
+            /* if !=0: the value is not de-escaped yet (raw token content) */
+            int esc;
+
+            const char *val;    /* NULL terminated */
+            size_t len;
+            long tklen;         /* value token length in the input */
+        } prop;
+
+        /* scope */
+        struct {
+            int body_pres;      /* if !=0: scope body is present */
+
+            /* body elements in order of their appearance */
+            sp_doc_elem_t **elems;
+            int n_elems;
+
+            /* body hash table */
+            sp_doc_elem_t **htab;
+            unsigned long hsz;
+        } scp;
+    };
+};
+
+/* Allocate 'sz' bytes on the document arena. Return NULL if no memory. */
+static void *doc_alloc(sp_doc_t *p_doc, size_t sz)
+{
+    sp_doc_blk_t *p_blk = p_doc->blks;
+    void *ptr;
+
+    sz = __ALIGN(sz);
+
+    if (!p_blk || p_blk->sz-p_blk->used < sz)
+    {
+        size_t bsz = (sz > DOC_BLK_SZ/4 ? sz : DOC_BLK_SZ);
+
+        p_blk = (sp_doc_blk_t*)malloc(__ALIGN(sizeof(*p_blk)) + bsz);
+        if (!p_blk) return NULL;
+
+        p_blk->sz = bsz;
+        p_blk->used = 0;
+
+        if (bsz!=DOC_BLK_SZ && p_doc->blks) {
+            /* dedicated block for a large allocation; the current block is
+               retained for further allocations */
+            p_blk->next = p_doc->blks->next;
+            p_doc->blks->next = p_blk;
+        } else {
+            p_blk->next = p_doc->blks;
+            p_doc->blks = p_blk;
+        }
+    }
+
+    ptr = BLK_DATA(p_blk) + p_blk->used;
+    p_blk->used += sz;
+
+    return ptr;
+}
+
+/* element pending for its parent */
+typedef struct _pend_elem_t
+{
+    sp_doc_elem_t *p_elem;
+    long beg;               /* element definition offset */
+} pend_elem_t;
+
+/* sp_doc_load() handle */
+typedef struct _bld_hndl_t
+{
+    sp_doc_t *p_doc;
+
+    /* stack of elements pending for their parent */
+    struct {
+        pend_elem_t *ptr;
+        int n;
+        int sz;
+    } pend;
+} bld_hndl_t;
+
+/* Allocate a new element of a given kind. */
+static sp_errc_t new_elem(sp_doc_t *p_doc, int is_scp, sp_doc_elem_t **pp_elem)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_elem;
+
+    if (!(p_elem=(sp_doc_elem_t*)doc_alloc(p_doc, sizeof(*p_elem)))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+
+    memset(p_elem, 0, sizeof(*p_elem));
+    p_elem->is_scp = is_scp;
+    p_elem->type.ptr = p_elem->name.ptr = "";
+    p_elem->type.hash = p_elem->name.hash = SP_HASH_INIT;
+
+    *pp_elem = p_elem;
+finish:
+    return ret;
+}
+
+/* Push element 'p_elem' defined at offset 'beg' on the pending stack. */
+static sp_errc_t push_pend(bld_hndl_t *p_bhndl, sp_doc_elem_t *p_elem, long beg)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (p_bhndl->pend.n >= p_bhndl->pend.sz)
+    {
+        int sz = (!p_bhndl->pend.sz ? DOC_INIT_PEND : 2*p_bhndl->pend.sz);
+        pend_elem_t *ptr =
+            (pend_elem_t*)realloc(p_bhndl->pend.ptr, sz*sizeof(*ptr));
+
+        if (!ptr) { ret=SPEC_NOMEM; goto finish; }
+
+        p_bhndl->pend.ptr = ptr;
+        p_bhndl->pend.sz = sz;
+    }
+
+    p_bhndl->pend.ptr[p_bhndl->pend.n].p_elem = p_elem;
+    p_bhndl->pend.ptr[p_bhndl->pend.n].beg = beg;
+    p_bhndl->pend.n++;
+
+finish:
+    return ret;
+}
+
+/* Read content of a token under location 'p_tloc' (may be NULL for an empty
+   token) into the arena. The content is NULL terminated.
+
+   A lone backslash ending an escaped token escapes a char following the token
+   in the input (e.g. trimmed trailing space of a value), therefore it's not
+   a part of the token content as de-escaped by the parser and is dropped.
+ */
+static sp_errc_t read_tkn(sp_doc_t *p_doc, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_tloc, char **p_buf, size_t *p_len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    long llen = (p_tloc ? sp_loc_len(&p_tloc->loc) : 0);
+    char *buf;
+
+    if (llen<0) llen=0;
+
+    if (!(buf=(char*)doc_alloc(p_doc, (size_t)llen+1))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+
+    if (llen>0 && (sp_fseek(in, p_tloc->loc.beg, SEEK_SET) ||
+        sp_fread(buf, (size_t)llen, in)!=(size_t)llen))
+    {
+        ret=SPEC_ACCS_ERR;
+        goto finish;
+    }
+
+    if (llen>0 && p_tloc->esc && buf[llen-1]=='\\')
+    {
+        long i;
+
+        /* odd number of trailing backslashes ends with the lone one */
+        for (i=llen-1; i>0 && buf[i-1]=='\\'; i--);
+        if (((llen-i)&1) && sp_fgetc(in)!=EOF) llen--;
+    }
+    buf[llen] = 0;
+
+    *p_buf = buf;
+    *p_len = (size_t)llen;
+finish:
+    return ret;
+}
+
+/* Load de-escaped SP_TKN_ID token under location 'p_tloc' as reported by the
+   parser (may be NULL for an empty token) into 'p_str'.
+ */
+static sp_errc_t load_id(
+    sp_doc_t *p_doc, SP_FILE *in, const sp_parser_tkn_loc_t *p_tloc,
+    doc_str_t *p_str)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    unsigned long hash=SP_HASH_INIT;
+    char *buf;
+    size_t i, len;
+
+    EXEC_RG(read_tkn(p_doc, in, p_tloc, &buf, &len));
+
+    if (len>=2 && (*buf=='"' || *buf=='\'')) {
+        /* strip quotation marks; the closing one is the last char */
+        buf++;
+        len-=2;
+    }
+
+    /* de-escaping doesn't extend the string, so it's done in-place */
+    if (p_tloc && p_tloc->esc)
+        len = sp_parser_str_unesc(buf, len, SP_TKN_ID, buf);
+    buf[len] = 0;
+
+    for (i=0; i<len; i++) SP_HASH_STEP(hash, buf[i]);
+
+    p_str->ptr = buf;
+    p_str->len = len;
+    p_str->hash = hash;
+finish:
+    return ret;
+}
+
+/* Check if de-escaped strings are equal. */
+static int doc_str_equ(const doc_str_t *p_str1, const doc_str_t *p_str2)
+{
+    return (p_str1->hash==p_str2->hash && p_str1->len==p_str2->len &&
+        !memcmp(p_str1->ptr, p_str2->ptr, p_str1->len));
+}
+
+/* Check if de-escaped string 'p_str' is equal to string 'str' with maximum
+   'num' chars ('esc'!=0: the string may contain escaped chars) with the hash
+   and length 'hash', 'hlen' as calculated by sp_parser_str_hash().
+ */
+static int str_equ(const doc_str_t *p_str,
+    const char *str, size_t num, int esc, unsigned long hash, long hlen)
+{
+    if (p_str->hash!=hash || (long)p_str->len!=hlen) return 0;
+
+    return (esc ?
+        sp_parser_str_equ(str, num, 1, SP_TKN_ID, p_str->ptr, p_str->len) :
+        (!p_str->len || !memcmp(p_str->ptr, str, p_str->len)));
+}
+
+/* Pop elements pending for their parent scope 'p_scp' (that is all elements
+   located after 'beg' offset) and set them as the scope's body elements.
+ */
+static sp_errc_t link_body(bld_hndl_t *p_bhndl, sp_doc_elem_t *p_scp, long beg)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_t *p_doc = p_bhndl->p_doc;
+    sp_doc_elem_t **elems, **htab, **pp_h, *p_elem;
+    unsigned long hsz;
+    int i, n, k = p_bhndl->pend.n;
+
+    for (; k>0 && p_bhndl->pend.ptr[k-1].beg > beg; k--);
+    if (!(n = p_bhndl->pend.n-k)) goto finish;
+
+    for (hsz=4; hsz < 2*(unsigned long)n; hsz<<=1);
+
+    elems = (sp_doc_elem_t**)doc_alloc(p_doc, n*sizeof(*elems));
+    htab = (sp_doc_elem_t**)doc_alloc(p_doc, hsz*sizeof(*htab));
+    if (!elems || !htab) { ret=SPEC_NOMEM; goto finish; }
+
+    memset(htab, 0, hsz*sizeof(*htab));
+    for (i=0; i<n; i++) elems[i] = p_bhndl->pend.ptr[k+i].p_elem;
+
+    /* the elements are put on the hash table in the reverse order, so the
+       same named siblings are chained in order of their appearance */
+    for (i=n-1; i>=0; i--)
+    {
+        p_elem = elems[i];
+        pp_h = &htab[__HKEY(p_elem->is_scp,
+            p_elem->type.hash, p_elem->name.hash) & (hsz-1)];
+
+        for (; *pp_h; pp_h=&(*pp_h)->hnext)
+        {
+            if ((*pp_h)->is_scp==p_elem->is_scp &&
+                doc_str_equ(&(*pp_h)->type, &p_elem->type) &&
+                doc_str_equ(&(*pp_h)->name, &p_elem->name)) break;
+        }
+
+        if (*pp_h) {
+            p_elem->snext = *pp_h;
+            p_elem->hnext = (*pp_h)->hnext;
+            (*pp_h)->hnext = NULL;
+        }
+        *pp_h = p_elem;
+    }
+
+    p_scp->scp.elems = elems;
+    p_scp->scp.n_elems = n;
+    p_scp->scp.htab = htab;
+    p_scp->scp.hsz = hsz;
+
+    p_bhndl->pend.n = k;
+finish:
+    return ret;
+}
+
+/* sp_doc_load() parser callback: property */
+static sp_errc_t bld_cb_prop(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t *p_bhndl = (bld_hndl_t*)arg;
+    sp_doc_t *p_doc = p_bhndl->p_doc;
+    sp_doc_elem_t *p_elem;
+
+    EXEC_RG(new_elem(p_doc, 0, &p_elem));
+    EXEC_RG(load_id(p_doc, in, p_lname, &p_elem->name));
+
+    if (p_lval)
+    {
+        char *val;
+
+        p_elem->prop.val_pres = 1;
+        EXEC_RG(read_tkn(p_doc, in, p_lval, &val, &p_elem->prop.len));
+
+        /* de-escaping is postponed until the value is accessed */
+        p_elem->prop.esc = p_lval->esc;
+        p_elem->prop.val = val;
+        p_elem->prop.tklen = (long)p_elem->prop.len;
+    } else {
+        p_elem->prop.val = "";
+    }
+
+    EXEC_RG(push_pend(p_bhndl, p_elem, p_ldef->beg));
+    p_doc->n_props++;
+
+finish:
+    return ret;
+}
+
+/* sp_doc_load() parser callback: scope */
+static sp_errc_t bld_cb_scope(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t *p_bhndl = (bld_hndl_t*)arg;
+    sp_doc_t *p_doc = p_bhndl->p_doc;
+    sp_doc_elem_t *p_elem;
+
+    EXEC_RG(new_elem(p_doc, 1, &p_elem));
+    EXEC_RG(load_id(p_doc, in, p_ltype, &p_elem->type));
+    EXEC_RG(load_id(p_doc, in, p_lname, &p_elem->name));
+
+    p_elem->scp.body_pres = (p_lbody!=NULL);
+
+    /* nested elements have been already reported */
+    EXEC_RG(link_body(p_bhndl, p_elem, p_lbdyenc->beg));
+
+    EXEC_RG(push_pend(p_bhndl, p_elem, p_ldef->beg));
+    p_doc->n_scopes++;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_doc_load(SP_FILE *in, const sp_loc_t *p_parsc, sp_doc_t *p_doc,
+    sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t bhndl;
+
+    memset(&bhndl, 0, sizeof(bhndl));
+
+    if (!in || !p_doc) { ret=SPEC_INV_ARG; goto finish; }
+
+    memset(p_doc, 0, sizeof(*p_doc));
+    bhndl.p_doc = p_doc;
+
+    EXEC_RG(new_elem(p_doc, 1, &p_doc->root));
+    p_doc->root->scp.body_pres = 1;
+
+    EXEC_RG(sp_parse_int(in, p_parsc, bld_cb_prop, bld_cb_scope,
+        &bhndl, SPAR_P_ALL_LEV, p_synerr));
+
+    /* remaining pending elements are the 0-level ones */
+    EXEC_RG(link_body(&bhndl, p_doc->root, -1L));
+
+finish:
+    if (bhndl.pend.ptr) free(bhndl.pend.ptr);
+    if (ret!=SPEC_SUCCESS && p_doc) sp_doc_free(p_doc);
+    return ret;
+}
+
+/* exported; see header for details */
+void sp_doc_free(sp_doc_t *p_doc)
+{
+    sp_doc_blk_t *p_blk, *p_next;
+
+    if (!p_doc) return;
+
+    for (p_blk=p_doc->blks; p_blk; p_blk=p_next) {
+        p_next = p_blk->next;
+        free(p_blk);
+    }
+    memset(p_doc, 0, sizeof(*p_doc));
+}
+
+/* Find the first element of scope 'p_scp' body with given kind, type and name
+   (see str_equ() for the strings specification). Return NULL if not found.
+ */
+static sp_doc_elem_t *find_elem(const sp_doc_elem_t *p_scp, int is_scp,
+    const char *type, size_t typ_len, int typ_esc, unsigned long th, long tl,
+    const char *name, size_t nm_len, int nm_esc, unsigned long nh, long nl)
+{
+    sp_doc_elem_t *p_elem = NULL;
+
+    if (p_scp->scp.htab)
+    {
+        p_elem = p_scp->scp.htab[
+            __HKEY(is_scp, th, nh) & (p_scp->scp.hsz-1)];
+
+        for (; p_elem; p_elem=p_elem->hnext)
+        {
+            if (p_elem->is_scp==is_scp &&
+                str_equ(&p_elem->type, type, typ_len, typ_esc, th, tl) &&
+                str_equ(&p_elem->name, name, nm_len, nm_esc, nh, nl)) break;
+        }
+    }
+    return p_elem;
+}
+
+typedef struct _walk_hndl_t walk_hndl_t;
+
+/* Destination scope part callback. */
+typedef sp_errc_t (*walk_cb_dst_t)(walk_hndl_t *p_whndl, sp_doc_elem_t *p_scp);
+
+/* Path walking handle */
+struct _walk_hndl_t
+{
+    /* destination scope path */
+    const char *path_end;
+    const char *deftp;
+
+    /* processing finish flag */
+    int finish;
+
+    /* last scope spec. */
+    struct {
+        sp_doc_elem_t *scp; /* tracked scope (NULL if not present) */
+        const char *beg;    /* path of the scope content */
+    } lsc;
+
+    /* destination scope callback */
+    walk_cb_dst_t cb_dst;
+
+    /* matched elements tracking index */
+    int eind;
+};
+
+/* Follow path 'beg' starting from the scope 'p_par'. 'p_sind' is the split
+   scope tracking index. The function mirrors the path following semantics of
+   the index (see walk_path() in index.c).
+ */
+static sp_errc_t walk_path(
+    walk_hndl_t *p_whndl, sp_doc_elem_t *p_par, const char *beg, int *p_sind)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_scp;
+    sp_pathseg_t seg;
+
+    if (beg >= p_whndl->path_end) {
+        /* destination scope reached */
+        ret = p_whndl->cb_dst(p_whndl, p_par);
+        goto finish;
+    }
+
+    EXEC_RG(sp_path_seg(beg, p_whndl->path_end, p_whndl->deftp, &seg));
+
+    for (p_scp=find_elem(p_par, 1,
+            seg.type, seg.typ_len, seg.typ_esc, seg.typ_hash, seg.typ_hlen,
+            seg.name, seg.nm_len, seg.nm_esc, seg.nm_hash, seg.nm_hlen);
+        p_scp && !p_whndl->finish; p_scp=p_scp->snext)
+    {
+        /* scope with matching name found */
+
+        if (seg.ind!=SP_IND_ALL)
+            /* the tracking index is updated only if the matched
+               scope was provided with an index specification */
+            *p_sind += 1;
+
+        if (seg.ind==SP_IND_LAST)
+        {
+            /* for last scope spec. simply track the scope */
+            p_whndl->lsc.scp = p_scp;
+            p_whndl->lsc.beg = seg.next;
+        } else
+        if (seg.ind==SP_IND_ALL || *p_sind==seg.ind)
+        {
+            if (p_scp->scp.body_pres)
+            {
+                int sind = -1;
+
+                EXEC_RG(walk_path(p_whndl, p_scp, seg.next,
+                    (seg.ind!=SP_IND_ALL ? &sind : p_sind)));
+            }
+
+            if (seg.ind!=SP_IND_ALL && seg.next>=p_whndl->path_end)
+            {
+                /* the path finishes with a scope addressed by the explicit
+                   index specification; no further path following is needed */
+                p_whndl->finish = 1;
+            }
+        } else
+        if (*p_sind>seg.ind)
+        {
+            /* the destination scope has been already passed by */
+            p_whndl->finish = 1;
+        }
+    }
+
+finish:
+    return ret;
+}
+
+/* Walk the document along the path and call the destination scope callback
+   for each part of the destination scope.
+ */
+static sp_errc_t walk_doc(walk_hndl_t *p_whndl, const sp_doc_t *p_doc,
+    const char *path, const char *deftp, walk_cb_dst_t cb_dst)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_par = p_doc->root;
+    const char *beg;
+    int sind;
+
+    p_whndl->path_end = (!path ? NULL : path+strlen(path));
+    p_whndl->deftp = deftp;
+    p_whndl->finish = 0;
+    p_whndl->cb_dst = cb_dst;
+    p_whndl->eind = -1;
+
+    beg = path;
+    if (beg && *beg=='/') beg++;
+
+    for (;;)
+    {
+        sind = -1;
+        p_whndl->lsc.scp = NULL;
+
+        EXEC_RG(walk_path(p_whndl, p_par, beg, &sind));
+
+        /* last scope spec. detected; follow its content */
+        if (p_whndl->lsc.scp) {
+            p_par = p_whndl->lsc.scp;
+            beg = p_whndl->lsc.beg;
+            p_whndl->finish = 0;
+
+            if (!p_par->scp.body_pres) break;
+        } else
+            break;
+    }
+
+finish:
+    return ret;
+}
+
+/* get_prop() handle */
+typedef struct _getprp_hndl_t
+{
+    walk_hndl_t w;
+
+    /* property desc. */
+    struct {
+        const char *name;
+        size_t nm_len;
+        unsigned long nh;
+        long nl;
+        int ind;
+    } prop;
+
+    /* matched property (NULL if not found) */
+    sp_doc_elem_t *p_elem;
+} getprp_hndl_t;
+
+/* get_prop() destination scope callback */
+static sp_errc_t getprp_cb_dst(walk_hndl_t *p_whndl, sp_doc_elem_t *p_scp)
+{
+    getprp_hndl_t *p_gphndl = (getprp_hndl_t*)p_whndl;
+    sp_doc_elem_t *p_elem;
+
+    for (p_elem=find_elem(p_scp, 0, NULL, 0, 0, SP_HASH_INIT, 0,
+            p_gphndl->prop.name, p_gphndl->prop.nm_len, 0,
+            p_gphndl->prop.nh, p_gphndl->prop.nl);
+        p_elem; p_elem=p_elem->snext)
+    {
+        /* matching element found */
+        p_whndl->eind += 1;
+
+        if (p_gphndl->prop.ind==p_whndl->eind ||
+            p_gphndl->prop.ind==SP_IND_LAST)
+        {
+            p_gphndl->p_elem = p_elem;
+
+            /* done if there is no need to track the last property */
+            if (p_gphndl->prop.ind!=SP_IND_LAST) {
+                p_whndl->finish = 1;
+                break;
+            }
+        }
+    }
+    return SPEC_SUCCESS;
+}
+
+/* Find property with 'name' and de-escape its value (if not already done).
+   The property is written under 'pp_prop'.
+ */
+static sp_errc_t get_prop(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, sp_doc_elem_t **pp_prop)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    getprp_hndl_t gphndl;
+    sp_doc_elem_t *p_prop;
+
+    if (!p_doc || !p_doc->root || !name || (ind<0 && ind!=SP_IND_LAST)) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    memset(&gphndl, 0, sizeof(gphndl));
+
+    gphndl.prop.name = name;
+    gphndl.prop.nm_len = strlen(name);
+    gphndl.prop.ind = ind;
+    sp_parser_str_hash(name, gphndl.prop.nm_len,
+        0, SP_TKN_ID, &gphndl.prop.nh, &gphndl.prop.nl);
+
+    EXEC_RG(walk_doc(&gphndl.w, p_doc, path, deftp, getprp_cb_dst));
+
+    if (!(p_prop=gphndl.p_elem)) {
+        ret=SPEC_NOTFOUND;
+        goto finish;
+    }
+
+    if (p_prop->prop.esc)
+    {
+        char *val = (char*)doc_alloc(p_doc, p_prop->prop.len+1);
+        if (!val) { ret=SPEC_NOMEM; goto finish; }
+
+        p_prop->prop.len = sp_parser_str_unesc(
+            p_prop->prop.val, p_prop->prop.len, SP_TKN_VAL, val);
+        val[p_prop->prop.len] = 0;
+
+        p_prop->prop.val = val;
+        p_prop->prop.esc = 0;
+    }
+
+    *pp_prop = p_prop;
+finish:
+    return ret;
+}
+
+/* Copy value of property 'p_prop' into buffer 'buf' of length 'blen' and trim
+   it as sp_get_prop_int() does. Return the trimmed value or NULL if the value
+   is not present, empty or too long.
+ */
+static char *trim_val(const sp_doc_elem_t *p_prop, char *buf, size_t blen)
+{
+    char *strv = buf;
+
+    if (!p_prop->prop.val_pres || (size_t)p_prop->prop.tklen >= blen)
+        return NULL;
+
+    strcpy(buf, p_prop->prop.val);
+    return (sp_util_strtrim(&strv, 1) ? strv : NULL);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_doc_get_str(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, const char **p_val, size_t *p_len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_prop;
+
+    if (!p_val) { ret=SPEC_INV_ARG; goto finish; }
+
+    EXEC_RG(get_prop(p_doc, name, ind, path, deftp, &p_prop));
+
+    *p_val = p_prop->prop.val;
+    if (p_len) *p_len = p_prop->prop.len;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_doc_get_int(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, long *p_val)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_prop;
+
+    char val[80];
+    char *strv;
+
+    EXEC_RG(get_prop(p_doc, name, ind, path, deftp, &p_prop));
+
+    if (!(strv=trim_val(p_prop, val, sizeof(val)))) {
+        ret=SPEC_VAL_ERR;
+        goto finish;
+    }
+
+    if (p_val) ret=sp_util_parse_int(strv, p_val);
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_doc_get_float(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, double *p_val)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_prop;
+
+    char val[80];
+    char *strv;
+
+    EXEC_RG(get_prop(p_doc, name, ind, path, deftp, &p_prop));
+
+    if (!(strv=trim_val(p_prop, val, sizeof(val)))) {
+        ret=SPEC_VAL_ERR;
+        goto finish;
+    }
+
+    if (p_val) ret=sp_util_parse_float(strv, p_val);
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_doc_get_enum(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, const sp_enumval_t *p_evals,
+    int igncase, int *p_val)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_doc_elem_t *p_prop;
+    const sp_enumval_t *p_eval;
+    const char *strv;
+    size_t i, len;
+
+    if (!p_evals) { ret=SPEC_INV_ARG; goto finish; }
+
+    EXEC_RG(get_prop(p_doc, name, ind, path, deftp, &p_prop));
+
+    /* trim the value (as sp_util_strtrim() does) w/o copying it */
+    for (strv=p_prop->prop.val; isspace((int)*strv); strv++);
+    for (len=strlen(strv); len && isspace((int)strv[len-1]); len--);
+
+    if (!p_prop->prop.val_pres || !len) {
+        ret=SPEC_VAL_ERR;
+        goto finish;
+    }
+
+    for (p_eval=p_evals; p_eval->name; p_eval++)
+    {
+        if (strlen(p_eval->name)!=len) continue;
+
+        if (igncase) {
+            for (i=0; i<len && tolower((int)p_eval->name[i])==
+                tolower((int)strv[i]); i++);
+        } else {
+            for (i=0; i<len && p_eval->name[i]==strv[i]; i++);
+        }
+        if (i>=len) break;
+    }
+
+    if (!p_eval->name) {
+        ret=SPEC_VAL_ERR;
+        goto finish;
+    }
+
+    if (p_val) *p_val=p_eval->val;
+
+finish:
+    return ret;
+}
@@ -0,0 +1,107 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Document object model of a parsed input.
+
+   For read-mostly configurations the input may be loaded once (by a single
+   parsing pass) into a tree of scopes and properties kept in memory and
+   queried afterwards w/o any access to the input. Contrary to the index (see
+   index.h) the document doesn't refer to the loaded input, therefore the input
+   may be closed or modified after loading.
+
+   Names and types of the loaded elements are de-escaped on load. Property
+   values are de-escaped lazily on their first access and cached by the
+   document. Parts of split scopes are chained together, so the queries combine
+   them as the parsing based API does.
+
+   NOTE: Since the lazy de-escaping modifies the document, concurrent queries
+   on the same document need to be synchronized by the caller.
+ */
+
+#ifndef __SP_DOC_H__
+#define __SP_DOC_H__
+
+#include "sprops/props.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* document element (internal use) */
+typedef struct _sp_doc_elem_t sp_doc_elem_t;
+
+/* document memory arena block (internal use) */
+typedef struct _sp_doc_blk_t sp_doc_blk_t;
+
+/* document */
+typedef struct _sp_doc_t
+{
+    /* number of loaded properties and scopes */
+    int n_props;
+    int n_scopes;
+
+    /* root element (loaded parsing scope) (internal use) */
+    sp_doc_elem_t *root;
+
+    /* memory arena blocks; the document elements are allocated on the arena
+       and freed at once by sp_doc_free() (internal use) */
+    sp_doc_blk_t *blks;
+} sp_doc_t;
+
+/* Load document 'p_doc' from an input 'in' with a parsing scope 'p_parsc'
+   (if NULL: the entire input). In case of the syntax error (SPEC_SYNTAX)
+   'p_synerr' is filled with the error related info.
+
+   The document shall be freed by sp_doc_free() after successful load. In case
+   of failure no resources are acquired.
+ */
+sp_errc_t sp_doc_load(SP_FILE *in, const sp_loc_t *p_parsc, sp_doc_t *p_doc,
+    sp_synerr_t *p_synerr);
+
+/* Free document resources acquired by sp_doc_load().
+ */
+void sp_doc_free(sp_doc_t *p_doc);
+
+/* sp_get_prop() analogous working on the document 'p_doc'. Pointer to the
+   property value (NULL terminated, owned by the document) is written under
+   'p_val', its length under 'p_len' (may be NULL). Property w/o a value is
+   provided as an empty string.
+
+   NOTE: The value may contain NULL chars if such chars were escaped in the
+   input. The value stays valid until the document is freed.
+ */
+sp_errc_t sp_doc_get_str(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, const char **p_val, size_t *p_len);
+
+/* sp_get_prop_int() analogous working on the document 'p_doc'.
+ */
+sp_errc_t sp_doc_get_int(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, long *p_val);
+
+/* sp_get_prop_float() analogous working on the document 'p_doc'.
+ */
+sp_errc_t sp_doc_get_float(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, double *p_val);
+
+/* sp_get_prop_enum() analogous working on the document 'p_doc'. Since the
+   property value is already provided by the document there is no need for
+   a working buffer to store the enum names.
+ */
+sp_errc_t sp_doc_get_enum(sp_doc_t *p_doc, const char *name, int ind,
+    const char *path, const char *deftp, const sp_enumval_t *p_evals,
+    int igncase, int *p_val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __SP_DOC_H__ */
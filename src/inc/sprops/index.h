@@ -0,0 +1,160 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Structural index of a parsed input.
+
+   Read access API functions (sp_get_prop(), sp_get_scope_info(), sp_iterate())
+   parse the input on each call. For inputs queried many times the index may be
+   built once (by a single parsing pass) and used afterwards to answer the
+   queries w/o re-parsing. The stream is accessed only to compare matching
+   candidates and to de-escape the finally provided tokens.
+
+   NOTE: The index keeps stream locations only. Therefore it stays valid as long
+   as the indexed input is not modified.
+ */
+
+#ifndef __SP_INDEX_H__
+#define __SP_INDEX_H__
+
+#include "sprops/props.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* index node kinds */
+#define SP_IDXN_ROOT    0   /* root node (indexed parsing scope) */
+#define SP_IDXN_PROP    1   /* property */
+#define SP_IDXN_SCOPE   2   /* scope */
+
+/* index node
+
+   NOTE: Node numbers are indexes in the index nodes table. Not existing node
+   is denoted by -1.
+ */
+typedef struct _sp_index_node_t
+{
+    int kind;               /* node kind (SP_IDXN_XXX) */
+
+    int parent;             /* parent (containing scope) node */
+    int child;              /* first child node (scopes only) */
+    int next;               /* next sibling node */
+
+    /* next sibling node of the same kind, name and type (hash chain of
+       siblings in order of their appearance in the parent) */
+    int snext;
+
+    int pos;                /* position of the node in the parent */
+
+    /* index of the node among its siblings of the same kind, name and type;
+       for scopes this is the split-scope part index in the parent */
+    int ind;
+
+    int n_child;            /* number of children (scopes only) */
+    int n_scope;            /* number of children scopes (scopes only) */
+
+    /* hashes and lengths of de-escaped name and type tokens;
+       properties have no type (empty) */
+    unsigned long name_hash;
+    unsigned long type_hash;
+    long name_len;
+    long type_len;
+
+    sp_loc_t lname;         /* name token location */
+    sp_loc_t ldef;          /* definition location */
+
+    union {
+        /* SP_IDXN_PROP */
+        struct {
+            int val_pres;       /* if !=0: property value is present */
+            sp_loc_t lval;      /* property value location */
+        } prop;
+
+        /* SP_IDXN_SCOPE, SP_IDXN_ROOT */
+        struct {
+            int type_pres;      /* if !=0: scope type is present */
+            int body_pres;      /* if !=0: scope body is present */
+            sp_loc_t ltype;     /* scope type location */
+            sp_loc_t lbody;     /* scope body location */
+            sp_loc_t lbdyenc;   /* scope body with enclosing brackets */
+        } scope;
+    };
+
+    /* hash table chain (internal use) */
+    int hnext;
+} sp_index_node_t;
+
+/* structural index */
+typedef struct _sp_index_t
+{
+    /* nodes table; the root node is always the first one */
+    sp_index_node_t *nodes;
+    int n_nodes;
+
+    /* hash table heads (internal use) */
+    int *htab;
+    unsigned long hsz;
+
+    /* nodes table allocated size (internal use) */
+    int n_alloc;
+} sp_index_t;
+
+/* Build structural index 'p_idx' of an input 'in' with a parsing scope
+   'p_parsc' (if NULL: the entire input). In case of the syntax error
+   (SPEC_SYNTAX) 'p_synerr' is filled with the error related info.
+
+   The index is allocated on the heap and shall be freed by sp_index_free()
+   after successful build. In case of failure no resources are acquired.
+ */
+sp_errc_t sp_index_build(SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_index_t *p_idx, sp_synerr_t *p_synerr);
+
+/* sp_index_build() analogous building the index by 'n_threads' parsing
+   threads (if <=0: the number of online CPUs). Chunks of 0-level elements
+   of the input are indexed concurrently and merged into the resulting index,
+   which is the same as built by sp_index_build().
+
+   NOTE: The parallel parsing conditions apply (see sp_parse_parallel()),
+   otherwise the index is built by the calling thread.
+ */
+sp_errc_t sp_index_build_parallel(SP_FILE *in, const sp_loc_t *p_parsc,
+    int n_threads, sp_index_t *p_idx, sp_synerr_t *p_synerr);
+
+/* Free index resources acquired by sp_index_build().
+ */
+void sp_index_free(sp_index_t *p_idx);
+
+/* sp_iterate() analogous working on the index 'p_idx' of the input 'in'.
+ */
+sp_errc_t sp_iterate_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *path, const char *deftp, sp_cb_prop_t cb_prop,
+    sp_cb_scope_t cb_scope, void *arg, char *buf1, size_t b1len, char *buf2,
+    size_t b2len);
+
+/* sp_get_prop() analogous working on the index 'p_idx' of the input 'in'.
+ */
+sp_errc_t sp_get_prop_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *name, int ind, const char *path, const char *deftp, char *val,
+    size_t len, sp_prop_info_ex_t *p_info);
+
+/* sp_get_scope_info() analogous working on the index 'p_idx' of the input
+   'in'.
+ */
+sp_errc_t sp_get_scope_info_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *type, const char *name, int ind, const char *path,
+    const char *deftp, sp_scope_info_ex_t *p_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __SP_INDEX_H__ */
@@ -61,6 +61,109 @@ sp_errc_t sp_parse(
     SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
     sp_parser_cb_scope_t cb_scope, void *arg, sp_synerr_t *p_synerr);
 
+/* sp_parse() analogous with the grammar parser stacks allocated by 'alloc'
+   (if NULL: as for sp_parse()). Initial stacks of CONFIG_PARSER_INIT_DEPTH
+   elements are placed on the caller's stack; the allocator is used while the
+   stacks need to grow for deeper inputs, and the allocated memory is freed
+   before the function returns. If the allocation fails SPEC_NOMEM is returned.
+
+   By default (as for sp_parse()) the stacks grow on the caller's stack by
+   alloca(3). Using an allocator (e.g. arena, see sp_arena_init()) allows
+   parsing deeply nested inputs by threads with small stacks. The library API
+   parses a stream with an allocator if the stream is set with a parser
+   context (see sp_fsetpctx()).
+ */
+sp_errc_t sp_parse_alloc(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, const sp_alloc_t *alloc,
+    sp_synerr_t *p_synerr);
+
+/* Parser context (see sp_parse_ex()); all fields are internal use.
+ */
+typedef struct _sp_parser_ctx_t
+{
+    const sp_alloc_t *alloc;    /* parser stacks allocator */
+
+    void *stk;      /* retained parser stacks block; NULL if none */
+    long stk_n;     /* capacity of the retained stacks (number of elements) */
+
+    int busy;       /* if !=0 the context is in use by a parsing */
+} sp_parser_ctx_t;
+
+/* Initialize parser context 'p_ctx' with the parser stacks allocator 'alloc'
+   (if NULL: malloc(3) family routines). The context shall be freed by
+   sp_parser_ctx_free().
+ */
+sp_errc_t sp_parser_ctx_init(sp_parser_ctx_t *p_ctx, const sp_alloc_t *alloc);
+
+/* Free resources (the retained parser stacks) of the parser context 'p_ctx'.
+ */
+void sp_parser_ctx_free(sp_parser_ctx_t *p_ctx);
+
+/* sp_parse() analogous working with a parser context 'p_ctx'. The context
+   retains the parser stacks grown during the parsing, so subsequent parsings
+   with the context don't need to grow (reallocate) the stacks up to the
+   largest nesting depth encountered so far.
+
+   The context is intended to be created once per thread and used by all the
+   thread's parsings. Nested parsings (e.g. called from the parser callbacks)
+   with the context, while it is in use by an outer parsing, allocate their own
+   stacks by the context allocator (or alloca(3) if the allocator is not set).
+
+   NOTE: The context is not thread safe, therefore it must not be used by
+   concurrent parsings.
+ */
+sp_errc_t sp_parse_ex(sp_parser_ctx_t *p_ctx,
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, sp_synerr_t *p_synerr);
+
+/* Set parser context 'p_ctx' (NULL to unset) for the stream 'f'. The context
+   is used by the library API parsing the stream (sp_iterate(), sp_get_prop(),
+   sp_add_prop(), sp_edit_apply() etc.), including parsings of scope bodies
+   while following a scope path. The context is not set for newly opened
+   streams, in which case the API parses as by sp_parse(). Raw parser routines
+   (sp_parse(), sp_parse_alloc()) don't use the context set for the stream.
+
+   NOTE: Copies of the stream handle share the context, which must not be
+   used by concurrent parsings (see sp_parse_ex()). The context needs to be
+   unset or remain valid while the stream is in use.
+ */
+sp_errc_t sp_fsetpctx(SP_FILE *f, sp_parser_ctx_t *p_ctx);
+
+/* sp_parse() analogous parsing the input by 'n_threads' threads (if <=0: the
+   number of online CPUs). The input is pre-scanned and split into chunks of
+   0-level elements, which are parsed concurrently.
+
+   If 'sinks' is NULL, the parsed elements are reported to the callbacks (with
+   'arg') by the calling thread in order of their appearance, as sp_parse()
+   does. Otherwise 'sinks' points to a table of 'n_threads' per-thread
+   callbacks arguments (sinks) and the elements are reported directly by the
+   parsing threads: thread i calls the callbacks with 'sinks[i]' ('arg' is not
+   used). In this mode the callbacks are called concurrently and the order
+   of reported elements is preserved within a chunk only. The input handle
+   passed to the callbacks is a thread's copy of 'in' w/o the parser context
+   set for the stream (see sp_fsetpctx()).
+
+   In case of the syntax error, the error is reported as by sp_parse() (the
+   first error in the input). Elements following the error may be reported
+   in the sinks mode. SPEC_CB_FINISH returned by a callback finishes the whole
+   parsing.
+
+   NOTE 1: The input is parsed in parallel if it is a memory based stream
+   (SP_FILE_MEM, SP_FILE_MMAP, SP_FILE_MEM_DYN) of at least two chunks of
+   CONFIG_PARSE_PAR_CHUNK size and the parallel parsing is configured
+   (CONFIG_PARSE_PARALLEL). Otherwise the input is parsed by the calling
+   thread (in the sinks mode with 'sinks[0]').
+   NOTE 2: In the in order mode the parsed elements locations are recorded by
+   the parsing threads until reported, therefore the mode is suitable for
+   light callbacks. Heavy processing of the elements shall be performed in
+   the sinks mode.
+ */
+sp_errc_t sp_parse_parallel(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, void *const *sinks,
+    int n_threads, sp_synerr_t *p_synerr);
+
 /* Copy a token of type 'tkn' from location 'p_loc' into buffer 'p_buf' with
    length as set in 'buf_len'. If there is enough space the copied string is
    NULL terminated. If 'p_tklen' is not NULL it will be provided with token's
@@ -69,6 +172,21 @@ sp_errc_t sp_parse(
 sp_errc_t sp_parser_tkn_cpy(SP_FILE *in, sp_parser_token_t tkn,
     const sp_loc_t *p_loc, char *buf, size_t buf_len, long *p_tklen);
 
+/* Get a view of a token of type 'tkn' from location 'p_loc' directly in the
+   stream content, w/o copying it. The view is available for tokens w/o
+   backslash escaped chars (therefore not needing de-escaping) located in
+   memory based streams (SP_FILE_MEM, SP_FILE_MMAP, SP_FILE_MEM_DYN). In such
+   case pointer to the token's content is returned with the content length
+   written under 'p_len'. Otherwise NULL is returned and the token needs to be
+   copied by sp_parser_tkn_cpy().
+
+   NOTE 1: The view is not NULL terminated. Quotation marks of quoted SP_TKN_ID
+   are not part of the view.
+   NOTE 2: The view is valid as long as the stream is not closed or written.
+ */
+const char *sp_parser_tkn_view(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, size_t *p_len);
+
 /* Compare a token of type 'tkn' from location 'p_loc' with string 'str'.
    'num' specifies maximum number of 'str' chars to compare. If stresc!=0
    then 'str' may contain backslash escaped chars.
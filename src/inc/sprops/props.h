@@ -115,8 +115,81 @@ typedef struct _sp_tkn_info_t
     sp_loc_t loc;
 } sp_tkn_info_t;
 
-#define SP_FILE_C   0   /* ANSI C stream */
-#define SP_FILE_MEM 1   /* memory buffer */
+#define SP_FILE_C       0   /* ANSI C stream */
+#define SP_FILE_MEM     1   /* memory buffer */
+#define SP_FILE_MMAP    2   /* memory mapped file */
+#define SP_FILE_CUSTOM  3   /* custom stream (user provided operations) */
+#define SP_FILE_MEM_DYN 4   /* growable (dynamically allocated) memory buffer */
+
+/* Memory allocator. 'ctx' is the allocator context passed to its routines.
+ */
+typedef struct _sp_alloc_t
+{
+    /* malloc(3) analogous */
+    void *(*alloc)(void *ctx, size_t size);
+
+    /* realloc(3) analogous; may be NULL (allocation, copy and free of the
+       previous block is performed instead) */
+    void *(*realloc)(void *ctx, void *ptr, size_t size);
+
+    /* free(3) analogous */
+    void (*free)(void *ctx, void *ptr);
+
+    void *ctx;
+} sp_alloc_t;
+
+/* Arena allocator working on a caller provided buffer (see sp_arena_init()).
+ */
+typedef struct _sp_arena_t
+{
+    /* allocator routines working on the arena; to be passed to the API */
+    sp_alloc_t alloc;
+
+    /* internal use */
+    char *b;        /* arena buffer */
+    size_t sz;      /* buffer size */
+    size_t used;    /* used part of the buffer */
+    size_t last;    /* offset of the last allocated block; (size_t)-1: none */
+} sp_arena_t;
+
+/* read-ahead buffer of ANSI C and custom streams (private) */
+struct _sp_fbuf_t;
+
+/* Custom stream operations (see sp_fopen_custom()). 'ctx' is the stream context
+   as provided to sp_fopen_custom().
+ */
+typedef struct _sp_fops_t
+{
+    /* Read up to 'num' chars from the current stream position to 'buf'.
+       Return number of read chars (0 at the stream end) or -1 on error.
+     */
+    long (*read)(void *ctx, char *buf, size_t num);
+
+    /* Write 'num' chars from 'buf' at the current stream position. Return
+       number of written chars or -1 on error. May be NULL for read-only
+       streams.
+     */
+    long (*write)(void *ctx, const char *buf, size_t num);
+
+    /* fseek(3) analogous */
+    int (*seek)(void *ctx, long off, int origin);
+
+    /* ftell(3) analogous */
+    long (*tell)(void *ctx);
+
+    /* Optional (may be NULL) direct access to the stream content. Return
+       pointer to the stream content at offset 'off' and write number of chars
+       available under the pointer to 'p_num'. NULL is returned if the offset
+       is beyond the stream end. If provided, the stream content is read
+       directly w/o copying it to the read-ahead buffer.
+     */
+    const char *(*ptr)(void *ctx, long off, size_t *p_num);
+
+    /* Optional (may be NULL) stream close; called by sp_close(). Return 0 on
+       success.
+     */
+    int (*close)(void *ctx);
+} sp_fops_t;
 
 /* stream */
 typedef struct _SP_FILE
@@ -125,15 +198,36 @@ typedef struct _SP_FILE
 
     union {
         /* SP_FILE_C */
-        FILE *f;
+        struct {
+            FILE *f;
+            struct _sp_fbuf_t *fb;  /* read-ahead buffer; NULL if not used */
+        };
 
-        /* SP_FILE_MEM */
+        /* SP_FILE_MEM, SP_FILE_MMAP, SP_FILE_MEM_DYN */
         struct {
             char *b;    /* stream buffer */
             size_t num; /* number of chars in the buffer */
             size_t i;   /* current index in the buffer (stream position) */
+
+            /* SP_FILE_MEM_DYN: allocated buffer size,
+               SP_FILE_MMAP: writable mapping size (0 if read-only) */
+            size_t sz;
+
+            /* SP_FILE_MEM_DYN only */
+            const sp_alloc_t *alloc;    /* allocator; NULL for default */
         } m;
+
+        /* SP_FILE_CUSTOM */
+        struct {
+            const sp_fops_t *ops;   /* stream operations */
+            void *ctx;              /* stream context */
+            struct _sp_fbuf_t *fb;  /* read-ahead buffer */
+        } cs;
     };
+
+    /* parser context used while parsing the stream by the library API; NULL
+       if not set (see sp_fsetpctx()) */
+    struct _sp_parser_ctx_t *pctx;
 } SP_FILE;
 
 #define SP_MODE_READ        "rb"
@@ -159,6 +253,20 @@ sp_errc_t sp_fopen(SP_FILE *f, const char *filename, const char *mode);
  */
 sp_errc_t sp_fopen2(SP_FILE *f, FILE *cf);
 
+/* Set read-ahead buffer of size 'size' for an ANSI C stream 'f' (opened by
+   sp_fopen() or sp_fopen2()). If 'size' is 0 the buffering is disabled. The
+   buffer is allocated on the heap and freed by sp_close(). By default streams
+   opened by sp_fopen() are buffered with a buffer of size configured by
+   CONFIG_FILE_BUF_SIZE, if the stream is seekable. Streams passed by
+   sp_fopen2() are not buffered by default.
+   The function may be also used to change size of the read-ahead buffer of a
+   custom stream, which is always buffered ('size' must not be 0).
+
+   NOTE: The buffered stream keeps its own stream position, therefore the
+   underlying C stream shall not be accessed directly while buffered.
+ */
+sp_errc_t sp_fsetbuf(SP_FILE *f, size_t size);
+
 /* Open SP_FILE memory stream handle with a buffer 'buf' and available number
    of chars 'num'. Always success if valid arguments are passed. Since the
    routine doesn't acquire any resources the handle need not to be closed by
@@ -174,6 +282,83 @@ sp_errc_t sp_fopen2(SP_FILE *f, FILE *cf);
  */
 sp_errc_t sp_mopen(SP_FILE *f, char *buf, size_t num);
 
+/* Open SP_FILE growable memory stream handle with initially allocated buffer
+   of 'size' chars (may be 0). The buffer is allocated by 'alloc' allocator
+   (if NULL: malloc(3) family routines) and grows geometrically while written
+   beyond its size. The handle shall be closed by sp_close() which frees the
+   buffer, or the buffer may be detached by sp_mdetach().
+
+   NOTE 1: While reading, the stream is constrained by the written content
+   length or a NULL termination char in the buffer (which first occurs).
+   NOTE 2: Since the buffer may be reallocated while written, copies of the
+   handle shall not be used after the stream has been written.
+ */
+sp_errc_t sp_mopen_dyn(SP_FILE *f, size_t size, const sp_alloc_t *alloc);
+
+/* Detach the buffer of a growable memory stream 'f' (opened by sp_mopen_dyn()).
+   The buffer is returned under 'p_buf' and the length of its content under
+   'p_len' (may be NULL). The content is NULL terminated. The buffer shall be
+   freed by the stream allocator. After the call the stream handle is closed.
+ */
+sp_errc_t sp_mdetach(SP_FILE *f, char **p_buf, size_t *p_len);
+
+/* Initialize arena allocator 'p_arena' working on a buffer 'buf' of 'size'
+   bytes. The arena allocator ('p_arena->alloc') allocates memory blocks
+   sequentially from the buffer. Freeing (and reallocating in place) is
+   effective for the last allocated block only, the remaining blocks are
+   released at once by sp_arena_reset(). Allocations exceeding the buffer
+   fail, therefore the allocator doesn't acquire any resources.
+
+   The arena may be used as the allocator of growable memory streams,
+   in-memory transactions and the grammar parser stacks (see sp_parse_alloc()).
+   Reset of the arena between independent parsings or transactions provides
+   steady state of its usage w/o any heap allocations.
+ */
+sp_errc_t sp_arena_init(sp_arena_t *p_arena, void *buf, size_t size);
+
+/* Release all blocks allocated by the arena allocator 'p_arena'. The blocks
+   shall not be used after the call.
+ */
+void sp_arena_reset(sp_arena_t *p_arena);
+
+/* Map a file with 'filename' into memory (read-only) and populate SP_FILE
+   handle pointed by 'f' to access the mapped file as a memory stream. The handle
+   shall be closed by sp_close() which unmaps the file. In case of error
+   SPEC_FOPEN_ERR is returned and 'errno' may be checked against the problem
+   root cause.
+
+   NOTE 1: The stream position is kept by the handle, therefore copies of the
+   handle (e.g. used by different threads) share the mapping but may be used
+   independently. Only one of the copies shall be closed, after the others
+   stopped to use the mapping.
+   NOTE 2: Since the mapping is read-only, any write to the stream fails (see
+   sp_fmap_rw()).
+   NOTE 3: Available on platforms supporting POSIX mmap(2) (CONFIG_FILE_MMAP),
+   otherwise the function fails with 'errno' set to ENOSYS.
+ */
+sp_errc_t sp_fmap(SP_FILE *f, const char *filename);
+
+/* sp_fmap() counterpart mapping the file with read/write access. Writes to the
+   stream modify the mapped file content in place (in particular by in-place
+   property update, see SP_F_INPLACE), however they can't change the file size,
+   therefore writing beyond the mapped file end fails.
+ */
+sp_errc_t sp_fmap_rw(SP_FILE *f, const char *filename);
+
+/* Open SP_FILE custom stream handle with stream operations 'ops' and a stream
+   context 'ctx'. The handle shall be closed by sp_close().
+
+   The stream is accessed by blocks of chars read by 'read' operation into the
+   read-ahead buffer (CONFIG_FILE_BUF_SIZE or 0x1000 if the configured size is
+   0), or directly via 'ptr' operation, if provided. Written content is passed
+   to 'write' operation. The stream must be seekable.
+
+   NOTE: As for ANSI C stream, the stream position is kept by the buffer shared
+   by all copies of the handle, therefore the copies shall not be used
+   concurrently.
+ */
+sp_errc_t sp_fopen_custom(SP_FILE *f, const sp_fops_t *ops, void *ctx);
+
 /* Close opened SP_FILE handle.
    If SP_FILE was opened as an ANSI C stream (by sp_fopen() or sp_fopen2()),
    this function merely calls fclose(3) to close it. If fclose(3) fails
@@ -182,13 +367,21 @@ sp_errc_t sp_mopen(SP_FILE *f, char *buf, size_t num);
    In case of memory stream, the function removes a references to the memory
    buffer in the handle being closed, therefore the handle must not be used
    anymore. Note, since sp_mopen() doesn't acquire any resources, sp_close()
-   need not to be called for memory stream SP_FILE. 
+   need not to be called for memory stream SP_FILE. Memory mapped file is
+   unmapped by the function, growable memory stream buffer is freed. For
+   custom stream its 'close' operation is called (if provided); SPEC_ACCS_ERR
+   is returned in case of the operation failure.
  */
 sp_errc_t sp_close(SP_FILE *f);
 
 /* Check syntax of a properties set read from an input 'in' with a given parsing
    scope 'p_parsc'. In case of the syntax error (SPEC_SYNTAX) 'p_synerr' is
    filled with the error related info.
+
+   NOTE: Inputs with the direct access (memory streams and buffered ANSI C
+   streams) are validated by a dedicated scanner, w/o the grammar parser
+   overhead. The reported syntax errors are the same as reported by the
+   parser.
  */
 sp_errc_t sp_check_syntax(
     SP_FILE *in, const sp_loc_t *p_parsc, sp_synerr_t *p_synerr);
@@ -246,9 +439,10 @@ typedef sp_errc_t (*sp_cb_scope_t)(void *arg, SP_FILE *in, const char *type,
    For split scopes there is possible to provide specific split-scope index
    (0-based) where the iteration shall occur, by appending "@n" to the scope
    name in the NAME token. "@*" names overall (combined) scope and is assumed
-   if no @-addressing is provided in NAME. "@$" denotes last split-scope index
-   (usage of this construct shall be avoided due to additional overhead needed
-   for tracking the scope in question).
+   if no @-addressing is provided in NAME. "@$" denotes last split-scope index.
+   Since the last split-scope is not known until the end of its enclosing
+   scope, only location of the last candidate's body is tracked while parsing
+   and the body is parsed again afterwards (once per "@$" on the path).
 
    NOTE: Both TYPE and NAME may contain escape characters. Primary usage of them
    is escaping ':', '/'  and '@' in the 'path' string to avoid ambiguity with
@@ -264,6 +458,107 @@ sp_errc_t sp_iterate(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
     const char *deftp, sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope,
     void *arg, char *buf1, size_t b1len, char *buf2, size_t b2len);
 
+/* compiled path segment (scope spec. on a given path level) */
+typedef struct _sp_path_seg_t
+{
+    /* de-escaped scope type and name (NULL terminated) w/o the index spec.
+       Zero length type denotes untyped scope. */
+    const char *type;
+    size_t typ_len;
+    const char *name;
+    size_t nm_len;
+
+    /* hashes of the type and name as calculated for scope type and name tokens
+       by the index (see sp_index_node_t) */
+    unsigned long typ_hash;
+    unsigned long nm_hash;
+
+    int ind;        /* split-scope index spec. (SP_IND_ALL if absent) */
+
+    /* internal use */
+    int typ_esc;
+    int nm_esc;
+} sp_path_seg_t;
+
+/* compiled path */
+typedef struct _sp_path_t
+{
+    sp_path_seg_t *segs;
+    int n_segs;
+
+    /* segments strings (internal use) */
+    char *buf;
+} sp_path_t;
+
+/* Compile 'path' with the default scope type 'deftp' (as specified for
+   sp_iterate()) into 'p_path'. The compiled path is split into segments with
+   de-escaped scope types and names, ready to use by the _p variants of the
+   path addressing functions, which don't need to parse the path on each
+   nesting level as their string path counterparts do. The compiled path
+   doesn't refer to 'path' and 'deftp' strings and shall be freed by
+   sp_path_free().
+
+   SPEC_INV_PATH is returned if the path is malformed, SPEC_NOMEM on
+   allocation failure.
+ */
+sp_errc_t sp_path_compile(
+    const char *path, const char *deftp, sp_path_t *p_path);
+
+/* Free compiled path resources.
+ */
+void sp_path_free(sp_path_t *p_path);
+
+/* sp_iterate() with compiled path 'path' (NULL: the global scope).
+ */
+sp_errc_t sp_iterate_p(SP_FILE *in, const sp_loc_t *p_parsc,
+    const sp_path_t *path, sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope,
+    void *arg, char *buf1, size_t b1len, char *buf2, size_t b2len);
+
+/* Streaming reader callbacks (see sp_read_stream()). 'lev' is the scope level
+   of a reported element (0 for the global scope elements).
+
+   Property callback provides name and value (NULL for a property w/o a value)
+   of a read property.
+   Scope enter callback provides type (NULL for untyped scope) and name of
+   a read scope. Elements of the scope body are reported afterwards, followed
+   by the scope leave callback.
+
+   Return codes are interpreted as for sp_cb_prop_t.
+ */
+typedef sp_errc_t (*sp_strm_cb_prop_t)(
+    void *arg, const char *name, const char *val, int lev);
+typedef sp_errc_t (*sp_strm_cb_enter_t)(
+    void *arg, const char *type, const char *name, int lev);
+typedef sp_errc_t (*sp_strm_cb_leave_t)(void *arg, int lev);
+
+/* Read elements of the whole input 'in' in a single pass and report them
+   (in order of their definitions) to the callbacks 'cb_prop', 'cb_enter',
+   'cb_leave' (each of them may be NULL). Read strings are de-escaped and
+   written under buffers 'buf1' (property name, scope type) of 'b1len' and
+   'buf2' (property value, scope name) of 'b2len'. In case of the syntax error
+   (SPEC_SYNTAX) 'p_synerr' (may be NULL) is filled with the error related
+   info.
+
+   Contrary to the other API, 'in' is never sought, therefore it may be
+   a non-seekable stream (e.g. stdin or a pipe opened by sp_fopen2(), or
+   a custom stream reading a decompressed input) as long as it is read from
+   its current position. The input is read into a caller provided window
+   buffer 'win' of 'win_len' size (at least 2, otherwise SPEC_INV_ARG is
+   returned), which is the only input content kept by the reader. Content
+   preceding the last reported element is dropped from the window, therefore
+   the window must fit each element definition (property or scope header) with
+   spaces and comments surrounding it, up to the next token. Otherwise
+   SPEC_SIZE is returned.
+
+   NOTE: 'in' must not be buffered (see sp_fsetbuf()) if it is non-seekable.
+   Custom streams are buffered, therefore their 'seek' operation must support
+   seeking to the current stream position at least.
+ */
+sp_errc_t sp_read_stream(SP_FILE *in, char *win, size_t win_len,
+    sp_strm_cb_prop_t cb_prop, sp_strm_cb_enter_t cb_enter,
+    sp_strm_cb_leave_t cb_leave, void *arg, char *buf1, size_t b1len,
+    char *buf2, size_t b2len, sp_synerr_t *p_synerr);
+
 typedef struct _sp_prop_info_ex_t
 {
     sp_tkn_info_t tkname;       /* property name token info */
@@ -322,6 +617,49 @@ sp_errc_t sp_get_prop(SP_FILE *in, const sp_loc_t *p_parsc, const char *name,
     int ind, const char *path, const char *deftp, char *val, size_t len,
     sp_prop_info_ex_t *p_info);
 
+/* sp_get_prop() with compiled path 'path' (NULL: the global scope).
+ */
+sp_errc_t sp_get_prop_p(SP_FILE *in, const sp_loc_t *p_parsc, const char *name,
+    int ind, const sp_path_t *path, char *val, size_t len,
+    sp_prop_info_ex_t *p_info);
+
+/* property request for sp_get_props() */
+typedef struct _sp_prop_req_t
+{
+    const char *name;           /* property name */
+    int ind;                    /* property index (as for sp_get_prop()) */
+
+    char *val;                  /* property value buffer */
+    size_t len;                 /* value buffer length */
+
+    sp_prop_info_ex_t *p_info;  /* property extra info; may be NULL */
+
+    /* request status: SPEC_SUCCESS - property found, SPEC_NOTFOUND - not
+       found */
+    sp_errc_t ret;
+
+    /* internal use */
+    int eind;
+    size_t nm_len;
+    unsigned long nm_hash;
+} sp_prop_req_t;
+
+/* Find many properties of a single scope specified by 'path' and 'deftp'. The
+   function is sp_get_prop() analogous for a table of 'n_reqs' property requests
+   'reqs', but fetches all the properties in a single pass over the destination
+   scope (finished as soon as all the requests are satisfied). Status of each
+   request is written to its 'ret' member. If any of the requested properties
+   is not found, SPEC_NOTFOUND error is returned (nonetheless the found
+   properties are provided).
+ */
+sp_errc_t sp_get_props(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
+    const char *deftp, sp_prop_req_t *reqs, int n_reqs);
+
+/* sp_get_props() with compiled path 'path' (NULL: the global scope).
+ */
+sp_errc_t sp_get_props_p(SP_FILE *in, const sp_loc_t *p_parsc,
+    const sp_path_t *path, sp_prop_req_t *reqs, int n_reqs);
+
 /* Find integer property with 'name' and write its value under 'p_val'. In case
    of string format problem SPEC_VAL_ERR error is returned.
 
@@ -512,6 +850,24 @@ sp_errc_t sp_get_scope_info(
  */
 #define SP_F_NOSEMC     0x00004000UL
 
+/* Set a property value in place, that is by overwriting the value location in
+   the input w/o copying the rest of the input to the output (not used in this
+   case and may be NULL). The input must be writable: a memory stream, a file
+   opened with read/write access or a file mapped by sp_fmap_rw().
+
+   The update is possible if the tokenized value is of the same length as the
+   replaced one, or is shorter and may be padded with trailing spaces (if
+   configured with CONFIG_TRIM_VAL_TRAILING_SPACES). A removed value is
+   replaced by spaces. If the value doesn't fit (for any of the set
+   properties) or the property has no value location to overwrite, the input
+   is not modified and SPEC_SIZE is returned, so the caller may fall back to
+   the regular update. Since a property can't be added in place, absent
+   property is reported by SPEC_NOTFOUND (as for SP_F_NOADD).
+
+   The flag has effect for sp_set_prop() and sp_set_prop_p() only.
+ */
+#define SP_F_INPLACE    0x00008000UL
+
 /* Add (insert) a property of 'name' with value 'val' (may be NULL for a prop
    w/o a value) in location 'n_elem' (number of elements - scopes/props, before
    the inserted property) in a scope addressed by 'p_parsc', 'path' and 'deftp'.
@@ -597,6 +953,8 @@ sp_errc_t sp_rm_scope(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
    NOTE 3: The function returns SPEC_NOTFOUND if the destination scope is not
    found OR the property being set is absent in the scope and is not possible
    (or allowed) to be added.
+   NOTE 4: If SP_F_INPLACE is specified in 'flags', the value is updated in
+   place in the input 'in' and 'out' is ignored (see the flag description).
 
    See also sp_add_prop() notes.
  */
@@ -604,6 +962,12 @@ sp_errc_t sp_set_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
     const char *name, const char *val, int ind, const char *path,
     const char *deftp, unsigned long flags);
 
+/* sp_set_prop() with compiled path 'path' (NULL: the global scope).
+ */
+sp_errc_t sp_set_prop_p(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *name, const char *val, int ind, const sp_path_t *path,
+    unsigned long flags);
+
 /* Move (rename) to 'new_name' a property with 'name' and index 'ind' in a scope
    addressed by 'p_parsc', 'path' and 'deftp'.
 
@@ -629,6 +993,223 @@ sp_errc_t sp_mv_scope(
     const char *name, const char *new_type, const char *new_name, int ind,
     const char *path, const char *deftp, unsigned long flags);
 
+/*
+ * Batch editing
+ */
+
+/* batch edit operations */
+#define SP_EDIT_ADD_PROP    1   /* sp_add_prop() */
+#define SP_EDIT_ADD_SCOPE   2   /* sp_add_scope() */
+#define SP_EDIT_RM_PROP     3   /* sp_rm_prop() */
+#define SP_EDIT_RM_SCOPE    4   /* sp_rm_scope() */
+#define SP_EDIT_SET_PROP    5   /* sp_set_prop() */
+#define SP_EDIT_MV_PROP     6   /* sp_mv_prop() */
+#define SP_EDIT_MV_SCOPE    7   /* sp_mv_scope() */
+
+/* batch edit spec.; the fields meaning is the same as for the corresponding
+   arguments of the edit operation function
+
+   NOTE: The strings are referenced (not copied) by the spec., therefore they
+   must be valid until the batch is applied.
+ */
+typedef struct _sp_edit_t
+{
+    int op;                 /* edit operation (SP_EDIT_XXX) */
+
+    const char *type;       /* element type (scopes only) */
+    const char *name;       /* element name */
+    const char *val;        /* property value */
+    const char *new_type;   /* new scope type (moves only) */
+    const char *new_name;   /* new element name (moves only) */
+
+    /* element index; for additions: the position ('n_elem') */
+    int ind;
+
+    const char *path;       /* destination scope path */
+    const char *deftp;      /* default scope type */
+
+    unsigned long flags;    /* edit flags */
+} sp_edit_t;
+
+/* batch of edits */
+typedef struct _sp_edit_batch_t
+{
+    sp_edit_t *edits;
+    int n_edits;
+
+    /* edits table allocated size (internal use) */
+    int n_alloc;
+} sp_edit_batch_t;
+
+/* Initialize an empty batch of edits 'p_batch'. The batch edits table is
+   allocated on the heap while adding edits and shall be freed by
+   sp_edit_batch_free().
+ */
+void sp_edit_batch_init(sp_edit_batch_t *p_batch);
+
+/* Free batch resources. The batch is left empty and may be reused.
+ */
+void sp_edit_batch_free(sp_edit_batch_t *p_batch);
+
+/* Append sp_add_prop() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_add_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *val, int n_elem, const char *path, const char *deftp,
+    unsigned long flags);
+
+/* Append sp_add_scope() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_add_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, int n_elem, const char *path, const char *deftp,
+    unsigned long flags);
+
+/* Append sp_rm_prop() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_rm_prop(sp_edit_batch_t *p_batch, const char *name,
+    int ind, const char *path, const char *deftp, unsigned long flags);
+
+/* Append sp_rm_scope() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_rm_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, int ind, const char *path, const char *deftp,
+    unsigned long flags);
+
+/* Append sp_set_prop() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_set_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *val, int ind, const char *path, const char *deftp,
+    unsigned long flags);
+
+/* Append sp_mv_prop() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_mv_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *new_name, int ind, const char *path, const char *deftp,
+    unsigned long flags);
+
+/* Append sp_mv_scope() edit to the batch 'p_batch'.
+ */
+sp_errc_t sp_edit_mv_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, const char *new_type, const char *new_name, int ind,
+    const char *path, const char *deftp, unsigned long flags);
+
+/* Apply all edits of the batch 'p_batch' to the input 'in' with a parsing
+   scope 'p_parsc' and write the result to 'out'. The input is parsed once for
+   all the edits (including scopes on the edits paths, which are followed
+   by each edit separately during the parsing) and the output is written in
+   a single pass, contrary to applying the edits one by one, where each edit
+   parses its input and copies it to the output.
+
+   All the edits refer to the original input; that is paths, indexes and
+   positions of the edits are not affected by other edits of the batch.
+   Elements added in the same location are placed in the order of their edits
+   in the batch. The edits must not modify the same input ranges (e.g. setting
+   a property and removing its containing scope); SPEC_INV_ARG is returned in
+   such case.
+
+   In case of failure nothing is written to the output and 'p_err_edit' (if not
+   NULL) is written with index of the failed edit (-1 if the failure is not
+   related with any particular edit). As for sp_rm_prop(), a removal whose
+   destination scope is not found results with SPEC_NOTFOUND, but the output
+   is written with the remaining edits.
+ */
+sp_errc_t sp_edit_apply(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_batch_t *p_batch, int *p_err_edit);
+
+/* Apply all edits of the batch 'p_batch' to the scope of the input 'in'
+   specified by the parsing scope 'p_parsc' (e.g. a scope body as provided by
+   sp_get_scope_info()) and write the entire modified input to 'out'.
+
+   Contrary to sp_edit_apply() with a parsing scope, which writes only the
+   modified scope, the input preceding and following the scope is copied to
+   the output by blocks (w/o parsing), therefore the cost of the rewrite is
+   proportional to the size of the scope rather than the whole input. The
+   indentation white spaces preceding the scope on its first line are treated
+   as a part of the rewritten scope, so the scope is modified in the same way
+   as by a transaction with the parsing scope.
+
+   NOTE: The scope definition is not known to the rewrite, therefore elements
+   added to a scope body may be indented differently than if the edits were
+   applied to the entire input, e.g. an element added at the beginning of a
+   body is not indented in relation to the scope's opening bracket.
+
+   The edits paths are relative to the parsing scope, whose 'end' may be -1
+   for a scope spanning up to the input end. Edits failures are reported as
+   for sp_edit_apply(), except the output may be partially written in case of
+   failure.
+ */
+sp_errc_t sp_rewrite_scope(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_batch_t *p_batch, int *p_err_edit);
+
+/*
+ * Edit deltas
+ */
+
+/* Edit delta. The edit output differs from its input by a single splice:
+   'rm_len' chars of the input at offset 'off' are replaced by 'ins_len' chars
+   at the same offset of the output. Text locations (line/column) of the first
+   char following the splice are provided for the input and the output.
+ */
+typedef struct _sp_edit_delta_t
+{
+    long off;       /* splice offset */
+    long rm_len;    /* number of removed input chars */
+    long ins_len;   /* number of inserted output chars */
+
+    /* first char following the splice in the input */
+    int in_line;
+    int in_col;
+
+    /* first char following the splice in the output */
+    int out_line;
+    int out_col;
+} sp_edit_delta_t;
+
+/* Apply single edit 'p_edit' (see sp_edit_t) to the input 'in' with a parsing
+   scope 'p_parsc' and write the result to 'out'. The function works as the
+   edit operation function, and additionally writes the edit delta under
+   'p_delta' (may be NULL). If the edit performs several modifications (e.g.
+   removal of SP_IND_ALL properties) the delta splice covers all of them.
+   The delta of not modified input has 'rm_len' and 'ins_len' equal to 0.
+
+   NOTE: The delta offsets are the same for the input and the output, that is
+   the output stream shall be written from the same offset as the parsing
+   scope starts on the input (e.g. the entire input written to an empty
+   output stream).
+ */
+sp_errc_t sp_edit(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_t *p_edit, sp_edit_delta_t *p_delta);
+
+/* Rebase an array of 'n' locations 'p_locs' of an edit input to the edit
+   output, as described by the edit delta 'p_delta'. Locations before the
+   splice are not changed, locations after it are shifted, and locations
+   enclosing the splice (e.g. scope body containing an edited property) are
+   extended by the splice length difference. Empty locations at the splice
+   offset are left before the inserted chars.
+
+   Locations overlapping the removed input range can't be rebased and are
+   invalidated: set to zeros with 'end' set to -1 (empty location). The number
+   of invalidated locations is returned.
+ */
+int sp_loc_rebase(sp_loc_t *p_locs, int n, const sp_edit_delta_t *p_delta);
+
+/* sp_loc_rebase() analogous rebasing locations of an array of 'n' properties
+   extra info 'p_infos'. The info is invalidated (and counted in the returned
+   value) if any of its locations is invalidated.
+
+   NOTE: The properties indexes and number of elements preceding them are not
+   rebased.
+ */
+int sp_prop_info_rebase(
+    sp_prop_info_ex_t *p_infos, int n, const sp_edit_delta_t *p_delta);
+
+/* sp_prop_info_rebase() analogous for scopes extra info. Additionally, the
+   scope body location is invalidated if the splice is placed inside the body
+   enclosing brackets but outside the body itself (e.g. a property added at
+   the end of the scope), since the body bounds may have changed.
+ */
+int sp_scope_info_rebase(
+    sp_scope_info_ex_t *p_infos, int n, const sp_edit_delta_t *p_delta);
+
 #ifdef __cplusplus
 }
 #endif
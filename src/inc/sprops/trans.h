@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016,2019 Piotr Stolarz
+   Copyright (c) 2016,2019,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -93,6 +93,18 @@ typedef struct _sp_trans_t
 sp_errc_t sp_init_tr(sp_trans_t *p_trans, SP_FILE *in,
     const sp_loc_t *p_parsc, const sp_trans_ths_t *p_ths);
 
+/* Initialize handle and start an in-memory transaction.
+
+   The function works as sp_init_tr() with the temporary streams being
+   growable memory streams (see sp_mopen_dyn()) owned by the transaction and
+   allocated by 'alloc' (if NULL: malloc(3) family routines). The streams are
+   reused by subsequent modifications, therefore their buffers are allocated
+   up to the size of the largest modification output. The final result is
+   written to the committed output by a single write.
+ */
+sp_errc_t sp_init_mem_tr(sp_trans_t *p_trans, SP_FILE *in,
+    const sp_loc_t *p_parsc, const sp_alloc_t *alloc);
+
 /* Commit the transaction to a specified output.
 
    The resulting output will be written to 'out'. If 'out' is NULL the function
@@ -0,0 +1,93 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Streaming writer.
+
+   A configuration may be generated from scratch by a sequence of calls
+   beginning scopes, writing properties and ending scopes, in order of the
+   elements definitions. Contrary to the element addition API (sp_add_prop(),
+   sp_add_scope()) the output is written directly, w/o re-parsing previously
+   written content, therefore the generation takes time linear to the number
+   of written elements. The writer keeps a constant state independent of the
+   scopes nesting depth.
+
+   The elements are formatted as by the addition API with the SP_F_XXX
+   formatting flags, each element in a separate line.
+ */
+
+#ifndef __SP_WRITER_H__
+#define __SP_WRITER_H__
+
+#include "sprops/props.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* writer */
+typedef struct _sp_writer_t
+{
+    SP_FILE *out;       /* output */
+
+    int lev;            /* current scope level (0: global scope) */
+
+    /* internal use */
+    unsigned long ind;  /* indentation (SP_F_SPIND() flags) */
+    sp_eol_t eol;       /* EOL type */
+    int empty;          /* if !=0: no elements in the current scope yet */
+    int pend;           /* pending header of the current scope
+                           (0: none, 1: untyped, 2: typed scope) */
+    unsigned long pend_flags;   /* flags of the pending scope */
+    int xeol;           /* if !=0: the last element put an extra EOL */
+} sp_writer_t;
+
+/* Initialize writer 'p_wr' writing to the output 'out'. Scope bodies are
+   indented as specified by SP_F_SPIND() or SP_F_TBIND 'ind_flags'. 'eol'
+   specifies EOL type of the written lines (EOL_PLAT: the platform's EOL).
+ */
+sp_errc_t sp_writer_init(
+    sp_writer_t *p_wr, SP_FILE *out, unsigned long ind_flags, sp_eol_t eol);
+
+/* Write property with 'name' and 'val' (NULL or "" for a property w/o
+   a value). The property is written in the current scope.
+
+   Flags (SP_F_XXX) specify formatting of the property: SP_F_NVSRSP,
+   SP_F_NOSEMC, SP_F_EXTEOL, SP_F_EOLBFR. Other flags are ignored.
+ */
+sp_errc_t sp_writer_prop(sp_writer_t *p_wr,
+    const char *name, const char *val, unsigned long flags);
+
+/* Begin scope with 'type' (NULL or "" for untyped scope) and 'name' in the
+   current scope. Elements written afterwards are placed in the scope body
+   until the scope is ended by sp_writer_end_scope(). SPEC_SIZE is returned
+   if the scope exceeds the configured scopes nesting depth
+   (CONFIG_MAX_SCOPE_LEVEL_DEPTH).
+
+   Flags (SP_F_XXX) specify formatting of the scope: SP_F_SPLBRA, SP_F_EMPCPT
+   (applied if the scope body is empty), SP_F_EOLBFR. Other flags are ignored.
+ */
+sp_errc_t sp_writer_begin_scope(sp_writer_t *p_wr,
+    const char *type, const char *name, unsigned long flags);
+
+/* End the current scope. SP_F_EXTEOL of 'flags' puts an extra EOL after the
+   scope, other flags are ignored. SPEC_INV_ARG is returned if there is no
+   scope to end (the global scope is the current one).
+
+   NOTE: All begun scopes need to be ended to finish the output.
+ */
+sp_errc_t sp_writer_end_scope(sp_writer_t *p_wr, unsigned long flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __SP_WRITER_H__ */
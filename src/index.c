@@ -0,0 +1,979 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "io.h"
+#include "parser_int.h"
+#include "props_int.h"
+#include "sprops/index.h"
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* initial size of the nodes table */
+#define IDX_INIT_NODES  64
+
+/* hash table key */
+#define __HKEY(par, kind, nh, th) \
+    (((unsigned long)(par)*2654435761UL) ^ (nh) ^ ((th)*31UL) ^ \
+    (unsigned long)(kind))
+
+/* sp_index_build() handle */
+typedef struct _bld_hndl_t
+{
+    sp_index_t *p_idx;
+
+    /* stack of nodes pending for their parent */
+    struct {
+        int *ptr;
+        int n;
+        int sz;
+    } pend;
+} bld_hndl_t;
+
+/* Add a new node to the index and write its number under 'p_n'. */
+static sp_errc_t add_node(sp_index_t *p_idx, int kind, int *p_n)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_index_node_t *p_node;
+
+    if (p_idx->n_nodes >= p_idx->n_alloc)
+    {
+        int n_alloc = (!p_idx->n_alloc ? IDX_INIT_NODES : 2*p_idx->n_alloc);
+        sp_index_node_t *nodes = (sp_index_node_t*)realloc(
+            p_idx->nodes, n_alloc*sizeof(*nodes));
+
+        if (!nodes) { ret=SPEC_NOMEM; goto finish; }
+
+        p_idx->nodes = nodes;
+        p_idx->n_alloc = n_alloc;
+    }
+
+    *p_n = p_idx->n_nodes++;
+    p_node = &p_idx->nodes[*p_n];
+
+    memset(p_node, 0, sizeof(*p_node));
+    p_node->kind = kind;
+    p_node->parent = p_node->child = p_node->next = -1;
+    p_node->snext = p_node->hnext = -1;
+    p_node->name_hash = p_node->type_hash = SP_HASH_INIT;
+
+finish:
+    return ret;
+}
+
+/* Push node 'n' on the pending stack. */
+static sp_errc_t push_pend(bld_hndl_t *p_bhndl, int n)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (p_bhndl->pend.n >= p_bhndl->pend.sz)
+    {
+        int sz = (!p_bhndl->pend.sz ? IDX_INIT_NODES : 2*p_bhndl->pend.sz);
+        int *ptr = (int*)realloc(p_bhndl->pend.ptr, sz*sizeof(*ptr));
+
+        if (!ptr) { ret=SPEC_NOMEM; goto finish; }
+
+        p_bhndl->pend.ptr = ptr;
+        p_bhndl->pend.sz = sz;
+    }
+    p_bhndl->pend.ptr[p_bhndl->pend.n++] = n;
+
+finish:
+    return ret;
+}
+
+/* Pop nodes pending for their parent scope 'par' (that is all nodes located
+   after 'beg' offset) and link them as the scope's children.
+
+   NOTE: Since the parser reports elements in order of their appearance in the
+   stream, the popped nodes are prepended to the children list to retain that
+   order.
+ */
+static void link_children(bld_hndl_t *p_bhndl, int par, long beg)
+{
+    sp_index_node_t *nodes = p_bhndl->p_idx->nodes;
+
+    while (p_bhndl->pend.n > 0)
+    {
+        int n = p_bhndl->pend.ptr[p_bhndl->pend.n-1];
+        if (nodes[n].ldef.beg <= beg) break;
+
+        p_bhndl->pend.n--;
+
+        nodes[n].parent = par;
+        nodes[n].next = nodes[par].child;
+        nodes[par].child = n;
+        nodes[par].n_child++;
+        if (nodes[n].kind==SP_IDXN_SCOPE) nodes[par].n_scope++;
+    }
+}
+
+/* sp_index_build() parser callback: property */
+static sp_errc_t bld_cb_prop(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t *p_bhndl = (bld_hndl_t*)arg;
+    sp_index_node_t *p_node;
+    int n;
+
+    EXEC_RG(add_node(p_bhndl->p_idx, SP_IDXN_PROP, &n));
+    p_node = &p_bhndl->p_idx->nodes[n];
+
+    EXEC_RG(sp_parser_tkn_hash(in, SP_TKN_ID,
+        &p_lname->loc, &p_node->name_hash, &p_node->name_len));
+
+    p_node->lname = p_lname->loc;
+    if (p_lval) {
+        p_node->prop.val_pres = 1;
+        p_node->prop.lval = p_lval->loc;
+    }
+    p_node->ldef = *p_ldef;
+
+    EXEC_RG(push_pend(p_bhndl, n));
+
+finish:
+    return ret;
+}
+
+/* sp_index_build() parser callback: scope */
+static sp_errc_t bld_cb_scope(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t *p_bhndl = (bld_hndl_t*)arg;
+    sp_index_node_t *p_node;
+    int n;
+
+    EXEC_RG(add_node(p_bhndl->p_idx, SP_IDXN_SCOPE, &n));
+    p_node = &p_bhndl->p_idx->nodes[n];
+
+    EXEC_RG(sp_parser_tkn_hash(in, SP_TKN_ID,
+        &p_lname->loc, &p_node->name_hash, &p_node->name_len));
+    EXEC_RG(sp_parser_tkn_hash(in, SP_TKN_ID,
+        (p_ltype ? &p_ltype->loc : NULL), &p_node->type_hash,
+        &p_node->type_len));
+
+    p_node->lname = p_lname->loc;
+    if (p_ltype) {
+        p_node->scope.type_pres = 1;
+        p_node->scope.ltype = p_ltype->loc;
+    }
+    if (p_lbody) {
+        p_node->scope.body_pres = 1;
+        p_node->scope.lbody = *p_lbody;
+    }
+    p_node->scope.lbdyenc = *p_lbdyenc;
+    p_node->ldef = *p_ldef;
+
+    /* nested elements have been already reported */
+    link_children(p_bhndl, n, p_lbdyenc->beg);
+
+    EXEC_RG(push_pend(p_bhndl, n));
+
+finish:
+    return ret;
+}
+
+/* Find the first child node of 'par' with given kind, name and type hashes.
+   Return -1 if not found.
+ */
+static int find_node(const sp_index_t *p_idx, int par, int kind,
+    unsigned long nh, long nl, unsigned long th, long tl)
+{
+    int n = p_idx->htab[__HKEY(par, kind, nh, th) & (p_idx->hsz-1)];
+
+    for (; n>=0; n=p_idx->nodes[n].hnext)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[n];
+
+        if (p_node->parent==par && p_node->kind==kind &&
+            p_node->name_hash==nh && p_node->name_len==nl &&
+            p_node->type_hash==th && p_node->type_len==tl) break;
+    }
+    return n;
+}
+
+/* Finalize the index build process by numbering the nodes positions and
+   creating the hash table.
+ */
+static sp_errc_t finalize_index(sp_index_t *p_idx)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    int n, c, pos, *tails=NULL;
+    unsigned long hsz;
+
+    for (n=0; n < p_idx->n_nodes; n++) {
+        for (c=p_idx->nodes[n].child, pos=0; c>=0; c=p_idx->nodes[c].next)
+            p_idx->nodes[c].pos = pos++;
+    }
+
+    for (hsz=IDX_INIT_NODES; hsz < (unsigned long)p_idx->n_nodes; hsz<<=1);
+
+    p_idx->htab = (int*)malloc(hsz*sizeof(*p_idx->htab));
+    tails = (int*)malloc(p_idx->n_nodes*sizeof(*tails));
+    if (!p_idx->htab || !tails) { ret=SPEC_NOMEM; goto finish; }
+
+    p_idx->hsz = hsz;
+    memset(p_idx->htab, 0xff, hsz*sizeof(*p_idx->htab));
+
+    /* nodes numbering retains the order of appearance of the siblings,
+       therefore the same-named siblings chains are created in that order */
+    for (n=1; n < p_idx->n_nodes; n++)
+    {
+        sp_index_node_t *p_node = &p_idx->nodes[n];
+        int h = find_node(p_idx, p_node->parent, p_node->kind,
+            p_node->name_hash, p_node->name_len,
+            p_node->type_hash, p_node->type_len);
+
+        if (h<0) {
+            /* 1st occurrence in the parent; put on the hash table */
+            int *p_head = &p_idx->htab[__HKEY(p_node->parent, p_node->kind,
+                p_node->name_hash, p_node->type_hash) & (hsz-1)];
+
+            p_node->hnext = *p_head;
+            *p_head = n;
+            tails[n] = n;
+        } else {
+            p_node->ind = p_idx->nodes[tails[h]].ind+1;
+            p_idx->nodes[tails[h]].snext = n;
+            tails[h] = n;
+        }
+    }
+
+finish:
+    if (tails) free(tails);
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_index_build(SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_index_t *p_idx, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t bhndl;
+    int root;
+
+    if (!in || !p_idx) { ret=SPEC_INV_ARG; goto finish; }
+
+    memset(p_idx, 0, sizeof(*p_idx));
+    memset(&bhndl, 0, sizeof(bhndl));
+    bhndl.p_idx = p_idx;
+
+    EXEC_RG(add_node(p_idx, SP_IDXN_ROOT, &root));
+    if (p_parsc) {
+        p_idx->nodes[root].scope.body_pres = 1;
+        p_idx->nodes[root].scope.lbody = *p_parsc;
+    }
+
+    EXEC_RG(sp_parse_int(in, p_parsc, bld_cb_prop, bld_cb_scope,
+        &bhndl, SPAR_P_ALL_LEV, p_synerr));
+
+    /* remaining pending nodes are the 0-level ones */
+    link_children(&bhndl, root, -1L);
+
+    EXEC_RG(finalize_index(p_idx));
+
+finish:
+    if (bhndl.pend.ptr) free(bhndl.pend.ptr);
+    if (ret!=SPEC_SUCCESS && p_idx) sp_index_free(p_idx);
+    return ret;
+}
+
+/* index part built from a chunk of the input (sp_index_build_parallel()) */
+typedef struct _idx_part_t
+{
+    sp_index_t idx;
+
+    /* the part's 0-level nodes are left pending */
+    bld_hndl_t bhndl;
+} idx_part_t;
+
+/* Free index part 'p_part' */
+static void free_part(idx_part_t *p_part)
+{
+    if (p_part->idx.nodes) free(p_part->idx.nodes);
+    if (p_part->bhndl.pend.ptr) free(p_part->bhndl.pend.ptr);
+    free(p_part);
+}
+
+/* sp_index_build_parallel() chunk job: build index part of the chunk */
+static sp_errc_t bld_cb_chunk(void *arg, SP_FILE *in, int thread,
+    const sp_loc_t *p_chunk, void **p_res, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    idx_part_t *p_part;
+
+    if (!(p_part=(idx_part_t*)calloc(1, sizeof(*p_part)))) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    p_part->bhndl.p_idx = &p_part->idx;
+    *p_res = p_part;
+
+    ret = sp_parse_int(in, p_chunk, bld_cb_prop, bld_cb_scope,
+        &p_part->bhndl, SPAR_P_ALL_LEV, p_synerr);
+finish:
+    return ret;
+}
+
+/* sp_index_build_parallel() chunks collection: append index part 'res' to
+   the built index */
+static sp_errc_t bld_cb_collect(void *arg, void *res, int discard)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t *p_bhndl = (bld_hndl_t*)arg;
+    sp_index_t *p_idx = p_bhndl->p_idx;
+    idx_part_t *p_part = (idx_part_t*)res;
+    int i, base = p_idx->n_nodes, n = p_part->idx.n_nodes;
+
+    if (discard) goto finish;
+
+    /* a chunk may yield no nodes (and no nodes array) */
+    if (n)
+    {
+        if (base+n > p_idx->n_alloc)
+        {
+            int n_alloc = 2*p_idx->n_alloc;
+            sp_index_node_t *nodes;
+
+            if (n_alloc < base+n) n_alloc = base+n;
+            nodes = (sp_index_node_t*)realloc(
+                p_idx->nodes, n_alloc*sizeof(*nodes));
+            if (!nodes) { ret=SPEC_NOMEM; goto finish; }
+
+            p_idx->nodes = nodes;
+            p_idx->n_alloc = n_alloc;
+        }
+
+        /* nodes are renumbered by the part's base */
+        memcpy(&p_idx->nodes[base], p_part->idx.nodes,
+            n*sizeof(*p_idx->nodes));
+        p_idx->n_nodes += n;
+
+        for (i=base; i < p_idx->n_nodes; i++) {
+            sp_index_node_t *p_node = &p_idx->nodes[i];
+
+            if (p_node->parent>=0) p_node->parent += base;
+            if (p_node->child>=0) p_node->child += base;
+            if (p_node->next>=0) p_node->next += base;
+        }
+    }
+
+    /* the part's 0-level nodes are pending for the root */
+    for (i=0; i < p_part->bhndl.pend.n; i++)
+        EXEC_RG(push_pend(p_bhndl, base+p_part->bhndl.pend.ptr[i]));
+
+finish:
+    free_part(p_part);
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_index_build_parallel(SP_FILE *in, const sp_loc_t *p_parsc,
+    int n_threads, sp_index_t *p_idx, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    bld_hndl_t bhndl;
+    int root;
+
+    memset(&bhndl, 0, sizeof(bhndl));
+
+    if (!in || !p_idx) { ret=SPEC_INV_ARG; goto finish; }
+
+    n_threads = sp_parse_chunks_nthr(in, p_parsc, n_threads);
+    if (n_threads <= 1) {
+        /* not worth (or not possible) to build in parallel */
+        ret = sp_index_build(in, p_parsc, p_idx, p_synerr);
+        goto finish;
+    }
+
+    memset(p_idx, 0, sizeof(*p_idx));
+    bhndl.p_idx = p_idx;
+
+    EXEC_RG(add_node(p_idx, SP_IDXN_ROOT, &root));
+    if (p_parsc) {
+        p_idx->nodes[root].scope.body_pres = 1;
+        p_idx->nodes[root].scope.lbody = *p_parsc;
+    }
+
+    EXEC_RG(sp_parse_chunks(in, p_parsc, n_threads, bld_cb_chunk,
+        bld_cb_collect, &bhndl, p_synerr));
+
+    link_children(&bhndl, root, -1L);
+
+    EXEC_RG(finalize_index(p_idx));
+
+finish:
+    if (bhndl.pend.ptr) free(bhndl.pend.ptr);
+    if (ret!=SPEC_SUCCESS && p_idx) sp_index_free(p_idx);
+    return ret;
+}
+
+/* exported; see header for details */
+void sp_index_free(sp_index_t *p_idx)
+{
+    if (!p_idx) return;
+
+    if (p_idx->nodes) free(p_idx->nodes);
+    if (p_idx->htab) free(p_idx->htab);
+    memset(p_idx, 0, sizeof(*p_idx));
+}
+
+typedef struct _walk_hndl_t walk_hndl_t;
+
+/* Destination scope part callback. 'par' is a node of the destination
+   scope part.
+ */
+typedef sp_errc_t (*walk_cb_dst_t)(walk_hndl_t *p_whndl, int par);
+
+/* Path walking handle; common for all index queries. */
+struct _walk_hndl_t
+{
+    SP_FILE *in;
+    const sp_index_t *p_idx;
+
+    /* destination scope path */
+    const char *path_end;
+    const char *deftp;
+
+    /* processing finish flag */
+    int finish;
+
+    /* last scope spec. */
+    struct {
+        int node;           /* tracked scope (-1 if not present) */
+        const char *beg;    /* path of the scope content */
+    } lsc;
+
+    /* destination scope callback */
+    walk_cb_dst_t cb_dst;
+
+    /* element position number tracking index */
+    int neind;
+
+    /* matched elements tracking index */
+    int eind;
+};
+
+/* Check if a token under location 'p_loc' is equal to string 'str' of length
+   'len'. The result is written under 'p_equ'.
+ */
+#define CHK_TKN_EQU(in, loc, str, len, esc, p_equ) \
+    EXEC_RG(sp_parser_tkn_cmp((in), SP_TKN_ID, (loc), (str), (len), (esc), \
+        (p_equ)))
+
+/* Follow path 'beg' starting from the scope node 'par'. 'p_sind' is the split
+   scope tracking index. The function mirrors the path following semantics of
+   the parsing based API (see follow_scope_path() in props.c).
+ */
+static sp_errc_t walk_path(
+    walk_hndl_t *p_whndl, int par, const char *beg, int *p_sind)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const sp_index_t *p_idx = p_whndl->p_idx;
+    sp_pathseg_t seg;
+    int n, equ;
+
+    if (beg >= p_whndl->path_end) {
+        /* destination scope reached */
+        ret = p_whndl->cb_dst(p_whndl, par);
+        goto finish;
+    }
+
+    /* path segment is examined against the scopes only */
+    if (!p_idx->nodes[par].n_scope) goto finish;
+
+    EXEC_RG(sp_path_seg(beg, p_whndl->path_end, p_whndl->deftp, &seg));
+
+    for (n=find_node(p_idx, par, SP_IDXN_SCOPE,
+            seg.nm_hash, seg.nm_hlen, seg.typ_hash, seg.typ_hlen);
+        n>=0 && !p_whndl->finish; n=p_idx->nodes[n].snext)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[n];
+
+        CHK_TKN_EQU(p_whndl->in, (p_node->scope.type_pres ?
+            &p_node->scope.ltype : NULL), seg.type, seg.typ_len,
+            seg.typ_esc, &equ);
+        if (!equ) continue;
+        CHK_TKN_EQU(p_whndl->in, &p_node->lname, seg.name, seg.nm_len,
+            seg.nm_esc, &equ);
+        if (!equ) continue;
+
+        /* scope with matching name found */
+
+        if (seg.ind!=SP_IND_ALL)
+            /* the tracking index is updated only if the matched
+               scope was provided with an index specification */
+            *p_sind += 1;
+
+        if (seg.ind==SP_IND_LAST)
+        {
+            /* for last scope spec. simply track the scope */
+            p_whndl->lsc.node = n;
+            p_whndl->lsc.beg = seg.next;
+        } else
+        if (seg.ind==SP_IND_ALL || *p_sind==seg.ind)
+        {
+            if (p_node->scope.body_pres)
+            {
+                int sind = -1;
+
+                EXEC_RG(walk_path(p_whndl, n, seg.next,
+                    (seg.ind!=SP_IND_ALL ? &sind : p_sind)));
+            }
+
+            if (seg.ind!=SP_IND_ALL && seg.next>=p_whndl->path_end)
+            {
+                /* the path finishes with a scope addressed by the explicit
+                   index specification; no further path following is needed */
+                p_whndl->finish = 1;
+            }
+        } else
+        if (*p_sind>seg.ind)
+        {
+            /* the destination scope has been already passed by */
+            p_whndl->finish = 1;
+        }
+    }
+
+finish:
+    return ret;
+}
+
+/* Walk the index along the path and call the destination scope callback for
+   each part of the destination scope.
+ */
+static sp_errc_t walk_index(walk_hndl_t *p_whndl, SP_FILE *in,
+    const sp_index_t *p_idx, const char *path, const char *deftp,
+    walk_cb_dst_t cb_dst)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const char *beg;
+    int par=0, sind;
+
+    p_whndl->in = in;
+    p_whndl->p_idx = p_idx;
+    p_whndl->path_end = (!path ? NULL : path+strlen(path));
+    p_whndl->deftp = deftp;
+    p_whndl->finish = 0;
+    p_whndl->cb_dst = cb_dst;
+    p_whndl->neind = 0;
+    p_whndl->eind = -1;
+
+    beg = path;
+    if (beg && *beg=='/') beg++;
+
+    for (;;)
+    {
+        sind = -1;
+        p_whndl->lsc.node = -1;
+
+        EXEC_RG(walk_path(p_whndl, par, beg, &sind));
+
+        /* last scope spec. detected; follow its content
+
+           NOTE: As for the parsing based API, the tracked scope is followed
+           even if the walk has been finished by an index spec. on the
+           preceding path levels.
+         */
+        if (p_whndl->lsc.node>=0) {
+            par = p_whndl->lsc.node;
+            beg = p_whndl->lsc.beg;
+            p_whndl->finish = 0;
+
+            if (!p_idx->nodes[par].scope.body_pres) break;
+        } else
+            break;
+    }
+
+finish:
+    return ret;
+}
+
+/* sp_iterate_idx() handle */
+typedef struct _iter_hndl_t
+{
+    walk_hndl_t w;
+
+    struct {
+        void *arg;
+        sp_cb_prop_t prop;
+        sp_cb_scope_t scope;
+    } cb;
+
+    struct {
+        char *ptr;
+        size_t sz;
+    } buf1;
+
+    struct {
+        char *ptr;
+        size_t sz;
+    } buf2;
+} iter_hndl_t;
+
+/* sp_iterate_idx() destination scope callback */
+static sp_errc_t iter_cb_dst(walk_hndl_t *p_whndl, int par)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    iter_hndl_t *p_ihndl = (iter_hndl_t*)p_whndl;
+    const sp_index_node_t *nodes = p_whndl->p_idx->nodes;
+    SP_FILE *in = p_whndl->in;
+    int n;
+
+    for (n=nodes[par].child; n>=0 && !p_whndl->finish; n=nodes[n].next)
+    {
+        const sp_index_node_t *p_node = &nodes[n];
+
+        if (p_node->kind==SP_IDXN_PROP && p_ihndl->cb.prop)
+        {
+            sp_tkn_info_t tkname, tkval;
+            const sp_loc_t *p_lval =
+                (p_node->prop.val_pres ? &p_node->prop.lval : NULL);
+
+            EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID, &p_node->lname,
+                p_ihndl->buf1.ptr, p_ihndl->buf1.sz, &tkname.len));
+            EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_VAL, p_lval,
+                p_ihndl->buf2.ptr, p_ihndl->buf2.sz, &tkval.len));
+
+            tkname.loc = p_node->lname;
+            if (p_lval) tkval.loc = *p_lval;
+
+            ret = p_ihndl->cb.prop(p_ihndl->cb.arg, in, p_ihndl->buf1.ptr,
+                &tkname, p_ihndl->buf2.ptr, (p_lval ? &tkval : NULL),
+                &p_node->ldef);
+        } else
+        if (p_node->kind==SP_IDXN_SCOPE && p_ihndl->cb.scope)
+        {
+            sp_tkn_info_t tktype, tkname;
+            const sp_loc_t *p_ltype =
+                (p_node->scope.type_pres ? &p_node->scope.ltype : NULL);
+
+            EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID, p_ltype,
+                p_ihndl->buf1.ptr, p_ihndl->buf1.sz, &tktype.len));
+            EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID, &p_node->lname,
+                p_ihndl->buf2.ptr, p_ihndl->buf2.sz, &tkname.len));
+
+            if (p_ltype) tktype.loc = *p_ltype;
+            tkname.loc = p_node->lname;
+
+            ret = p_ihndl->cb.scope(p_ihndl->cb.arg, in,
+                p_ihndl->buf1.ptr, (p_ltype ? &tktype : NULL),
+                p_ihndl->buf2.ptr, &tkname,
+                (p_node->scope.body_pres ? &p_node->scope.lbody : NULL),
+                &p_node->scope.lbdyenc, &p_node->ldef);
+        }
+
+        /* check user callback return code */
+        if (ret==SPEC_CB_FINISH) {
+            p_whndl->finish=1;
+            ret=SPEC_SUCCESS;
+        } else if ((int)ret<0) {
+            ret=SPEC_CB_RET_ERR;
+        }
+        if (ret!=SPEC_SUCCESS) goto finish;
+    }
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_iterate_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *path, const char *deftp, sp_cb_prop_t cb_prop,
+    sp_cb_scope_t cb_scope, void *arg, char *buf1, size_t b1len, char *buf2,
+    size_t b2len)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    iter_hndl_t ihndl;
+
+    if (!in || !p_idx || !p_idx->n_nodes || (!cb_prop && !cb_scope)) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    memset(&ihndl, 0, sizeof(ihndl));
+
+    ihndl.cb.arg = arg;
+    ihndl.cb.prop = cb_prop;
+    ihndl.cb.scope = cb_scope;
+
+    if (b1len) {
+        ihndl.buf1.ptr = buf1;
+        ihndl.buf1.sz = b1len-1;
+        ihndl.buf1.ptr[ihndl.buf1.sz] = 0;
+    }
+    if (b2len) {
+        ihndl.buf2.ptr = buf2;
+        ihndl.buf2.sz = b2len-1;
+        ihndl.buf2.ptr[ihndl.buf2.sz] = 0;
+    }
+
+    ret = walk_index(&ihndl.w, in, p_idx, path, deftp, iter_cb_dst);
+
+finish:
+    return ret;
+}
+
+/* sp_get_prop_idx() handle */
+typedef struct _getprp_hndl_t
+{
+    walk_hndl_t w;
+
+    /* property desc. */
+    struct {
+        const char *name;
+        size_t nm_len;
+        unsigned long nh;
+        long nl;
+        int ind;
+    } prop;
+
+    /* matched property node (-1 if not found) */
+    int node;
+
+    /* extra info of the matched property */
+    sp_prop_info_ex_t *p_info;
+} getprp_hndl_t;
+
+/* sp_get_prop_idx() destination scope callback */
+static sp_errc_t getprp_cb_dst(walk_hndl_t *p_whndl, int par)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    getprp_hndl_t *p_gphndl = (getprp_hndl_t*)p_whndl;
+    const sp_index_t *p_idx = p_whndl->p_idx;
+    int n, equ;
+
+    for (n=find_node(p_idx, par, SP_IDXN_PROP,
+            p_gphndl->prop.nh, p_gphndl->prop.nl, SP_HASH_INIT, 0);
+        n>=0; n=p_idx->nodes[n].snext)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[n];
+
+        CHK_TKN_EQU(p_whndl->in, &p_node->lname,
+            p_gphndl->prop.name, p_gphndl->prop.nm_len, 0, &equ);
+        if (!equ) continue;
+
+        /* matching element found */
+        p_whndl->eind += 1;
+
+        if (p_gphndl->prop.ind==p_whndl->eind ||
+            p_gphndl->prop.ind==SP_IND_LAST)
+        {
+            p_gphndl->node = n;
+            p_gphndl->p_info->ind = p_whndl->eind;
+            p_gphndl->p_info->n_elem = p_whndl->neind + p_node->pos;
+
+            /* done if there is no need to track the last property */
+            if (p_gphndl->prop.ind!=SP_IND_LAST) {
+                p_whndl->finish = 1;
+                break;
+            }
+        }
+    }
+    p_whndl->neind += p_idx->nodes[par].n_child;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_get_prop_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *name, int ind, const char *path, const char *deftp, char *val,
+    size_t len, sp_prop_info_ex_t *p_info)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    getprp_hndl_t gphndl;
+    sp_prop_info_ex_t info;
+
+    memset(&info, 0, sizeof(info));
+
+    if (!in || !p_idx || !p_idx->n_nodes || !len || !name ||
+        (ind<0 && ind!=SP_IND_LAST))
+    {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    memset(&gphndl, 0, sizeof(gphndl));
+
+    gphndl.prop.name = name;
+    gphndl.prop.nm_len = strlen(name);
+    gphndl.prop.ind = ind;
+    sp_parser_str_hash(name, gphndl.prop.nm_len,
+        0, SP_TKN_ID, &gphndl.prop.nh, &gphndl.prop.nl);
+    gphndl.node = -1;
+    gphndl.p_info = &info;
+
+    val[len-1] = 0;
+
+    EXEC_RG(walk_index(&gphndl.w, in, p_idx, path, deftp, getprp_cb_dst));
+
+    if (gphndl.node>=0)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[gphndl.node];
+
+        info.tkname.len = gphndl.prop.nm_len;
+        info.tkname.loc = p_node->lname;
+
+        if (p_node->prop.val_pres) {
+            info.val_pres = 1;
+            info.tkval.loc = p_node->prop.lval;
+        }
+        info.ldef = p_node->ldef;
+
+        /* the stream is accessed to de-escape the final value only */
+        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_VAL,
+            (info.val_pres ? &info.tkval.loc : NULL), val, len-1,
+            &info.tkval.len));
+    } else
+        ret=SPEC_NOTFOUND;
+
+finish:
+    if (p_info) *p_info=info;
+    return ret;
+}
+
+/* sp_get_scope_info_idx() handle */
+typedef struct _getscp_hndl_t
+{
+    walk_hndl_t w;
+
+    /* scope desc. */
+    struct {
+        const char *type;
+        size_t typ_len;
+        unsigned long th;
+        long tl;
+        const char *name;
+        size_t nm_len;
+        unsigned long nh;
+        long nl;
+        int ind;
+    } scp;
+
+    /* matched scope node (-1 if not found) */
+    int node;
+
+    /* extra info of the matched scope */
+    sp_scope_info_ex_t *p_info;
+} getscp_hndl_t;
+
+/* sp_get_scope_info_idx() destination scope callback */
+static sp_errc_t getscp_cb_dst(walk_hndl_t *p_whndl, int par)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    getscp_hndl_t *p_gshndl = (getscp_hndl_t*)p_whndl;
+    const sp_index_t *p_idx = p_whndl->p_idx;
+    int n, equ;
+
+    for (n=find_node(p_idx, par, SP_IDXN_SCOPE,
+            p_gshndl->scp.nh, p_gshndl->scp.nl,
+            p_gshndl->scp.th, p_gshndl->scp.tl);
+        n>=0; n=p_idx->nodes[n].snext)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[n];
+
+        CHK_TKN_EQU(p_whndl->in, (p_node->scope.type_pres ?
+            &p_node->scope.ltype : NULL), p_gshndl->scp.type,
+            p_gshndl->scp.typ_len, 0, &equ);
+        if (!equ) continue;
+        CHK_TKN_EQU(p_whndl->in, &p_node->lname,
+            p_gshndl->scp.name, p_gshndl->scp.nm_len, 0, &equ);
+        if (!equ) continue;
+
+        /* matching element found */
+        p_whndl->eind += 1;
+
+        if (p_gshndl->scp.ind==p_whndl->eind ||
+            p_gshndl->scp.ind==SP_IND_LAST)
+        {
+            p_gshndl->node = n;
+            p_gshndl->p_info->ind = p_whndl->eind;
+            p_gshndl->p_info->n_elem = p_whndl->neind + p_node->pos;
+
+            /* done if there is no need to track the last scope */
+            if (p_gshndl->scp.ind!=SP_IND_LAST) {
+                p_whndl->finish = 1;
+                break;
+            }
+        }
+    }
+    p_whndl->neind += p_idx->nodes[par].n_child;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_get_scope_info_idx(SP_FILE *in, const sp_index_t *p_idx,
+    const char *type, const char *name, int ind, const char *path,
+    const char *deftp, sp_scope_info_ex_t *p_info)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    getscp_hndl_t gshndl;
+
+    if (!in || !p_idx || !p_idx->n_nodes || !name ||
+        (ind<0 && ind!=SP_IND_LAST) || !p_info)
+    {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    memset(&gshndl, 0, sizeof(gshndl));
+    memset(p_info, 0, sizeof(*p_info));
+
+    gshndl.scp.type = type;
+    gshndl.scp.typ_len = (type ? strlen(type) : 0);
+    sp_parser_str_hash(type, gshndl.scp.typ_len,
+        0, SP_TKN_ID, &gshndl.scp.th, &gshndl.scp.tl);
+    gshndl.scp.name = name;
+    gshndl.scp.nm_len = strlen(name);
+    sp_parser_str_hash(name, gshndl.scp.nm_len,
+        0, SP_TKN_ID, &gshndl.scp.nh, &gshndl.scp.nl);
+    gshndl.scp.ind = ind;
+    gshndl.node = -1;
+    gshndl.p_info = p_info;
+
+    EXEC_RG(walk_index(&gshndl.w, in, p_idx, path, deftp, getscp_cb_dst));
+
+    if (gshndl.node>=0)
+    {
+        const sp_index_node_t *p_node = &p_idx->nodes[gshndl.node];
+
+        if (p_node->scope.type_pres) {
+            p_info->type_pres = 1;
+            p_info->tktype.len = gshndl.scp.typ_len;
+            p_info->tktype.loc = p_node->scope.ltype;
+        }
+
+        p_info->tkname.len = gshndl.scp.nm_len;
+        p_info->tkname.loc = p_node->lname;
+
+        if (p_node->scope.body_pres) {
+            p_info->body_pres = 1;
+            p_info->lbody = p_node->scope.lbody;
+        }
+
+        p_info->lbdyenc = p_node->scope.lbdyenc;
+        p_info->ldef = p_node->ldef;
+    } else
+        ret=SPEC_NOTFOUND;
+
+finish:
+    return ret;
+}
@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016,2019 Piotr Stolarz
+   Copyright (c) 2016,2019,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -11,16 +11,207 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
 #include "io.h"
 
+#if CONFIG_FILE_MMAP
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+#endif
+
+/* read-ahead buffer size of custom stream if not configured */
+#define CUSTOM_BUF_SIZE 0x1000
+
+/* minimal allocated buffer size of growable memory stream */
+#define MEM_DYN_MIN_SIZE 0x100
+
+/* memory stream types */
+#define IS_MEM(f) ((f)->typ==SP_FILE_MEM || (f)->typ==SP_FILE_MMAP || \
+    (f)->typ==SP_FILE_MEM_DYN)
+
+/* Read-ahead buffer of ANSI C and custom streams.
+
+   The buffer header is shared by all copies of SP_FILE handle (as the C stream
+   is), therefore the stream position is kept there. The buffered block is
+   identified by the stream offset, so it stays valid independently of the
+   underlying stream position.
+ */
+struct _sp_fbuf_t
+{
+    long pos;       /* stream position */
+    long off;       /* stream offset of the buffered block */
+    long end;       /* end (exclusive) of the buffered block */
+    size_t sz;      /* buffer size */
+
+    /* if !=0: the underlying stream position is the same as 'pos' */
+    int fpos_ok;
+
+    /* if !=0: the last underlying stream access was writing; reading after
+       writing requires the stream to be positioned (ANSI C) */
+    int wr;
+
+    /* buffered block content; points to 'b' or directly to the stream
+       content (custom stream with 'ptr' operation) */
+    const char *w;
+
+    char b[1];      /* buffer (of 'sz' size) */
+};
+
+/* read-ahead buffer of a stream (NULL if not buffered) */
+#define FBUF(f) ((f)->typ==SP_FILE_C ? (f)->fb : \
+    ((f)->typ==SP_FILE_CUSTOM ? (f)->cs.fb : NULL))
+
+/* Underlying (not buffered) stream access routines. */
+
+static int raw_seek(SP_FILE *f, long off, int origin)
+{
+    return (f->typ==SP_FILE_C ? fseek(f->f, off, origin) :
+        f->cs.ops->seek(f->cs.ctx, off, origin));
+}
+
+static long raw_tell(SP_FILE *f)
+{
+    return (f->typ==SP_FILE_C ? ftell(f->f) : f->cs.ops->tell(f->cs.ctx));
+}
+
+static size_t raw_read(SP_FILE *f, char *buf, size_t num)
+{
+    long n;
+
+    if (f->typ==SP_FILE_C) return fread(buf, 1, num, f->f);
+
+    n = f->cs.ops->read(f->cs.ctx, buf, num);
+    return (n>0 ? (size_t)n : 0);
+}
+
+static size_t raw_write(SP_FILE *f, const char *buf, size_t num)
+{
+    long n;
+
+    if (f->typ==SP_FILE_C) return fwrite(buf, 1, num, f->f);
+
+    if (!f->cs.ops->write) return 0;
+    n = f->cs.ops->write(f->cs.ctx, buf, num);
+    return (n>0 ? (size_t)n : 0);
+}
+
+/* Refill the read-ahead buffer starting from the current stream position.
+   Return number of read chars.
+ */
+static size_t fb_refill(SP_FILE *f)
+{
+    size_t n=0;
+    struct _sp_fbuf_t *fb = FBUF(f);
+
+    fb->off = fb->end = fb->pos;
+
+    if (f->typ==SP_FILE_CUSTOM && f->cs.ops->ptr)
+    {
+        /* direct access; the underlying stream position is not used */
+        const char *w = f->cs.ops->ptr(f->cs.ctx, fb->pos, &n);
+        if (!w) n=0;
+        else fb->w = w;
+    } else {
+        if (!fb->fpos_ok || fb->wr) {
+            if (raw_seek(f, fb->pos, SEEK_SET)) goto finish;
+            fb->fpos_ok = 1;
+            fb->wr = 0;
+        }
+        fb->w = fb->b;
+        n = raw_read(f, fb->b, fb->sz);
+    }
+
+    fb->end += (long)n;
+    if (n) fb->fpos_ok = 0;
+
+finish:
+    return n;
+}
+
+/* Prepare buffered stream for writing. */
+static int fb_prep_write(SP_FILE *f)
+{
+    struct _sp_fbuf_t *fb = FBUF(f);
+
+    /* written content invalidates the buffered block */
+    fb->off = fb->end = 0;
+
+    if (!fb->fpos_ok) {
+        if (raw_seek(f, fb->pos, SEEK_SET)) return EOF;
+        fb->fpos_ok = 1;
+    }
+    return 0;
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_fsetbuf(SP_FILE *f, size_t size)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    struct _sp_fbuf_t *fb=NULL, **p_fb;
+    long pos;
+
+    if (!f || (f->typ==SP_FILE_C && !f->f) ||
+        (f->typ==SP_FILE_CUSTOM && (!f->cs.ops || !size)) ||
+        (f->typ!=SP_FILE_C && f->typ!=SP_FILE_CUSTOM))
+    {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+    p_fb = (f->typ==SP_FILE_C ? &f->fb : &f->cs.fb);
+
+    if (size)
+    {
+        /* the buffering is not possible for not seekable streams */
+        if ((pos = sp_ftell(f))==-1L) { ret=SPEC_ACCS_ERR; goto finish; }
+
+        fb = (struct _sp_fbuf_t*)malloc(sizeof(*fb)+size-1);
+        if (!fb) { ret=SPEC_NOMEM; goto finish; }
+
+        fb->pos = pos;
+        fb->off = fb->end = 0;
+        fb->sz = size;
+        fb->fpos_ok = 0;
+        fb->wr = 0;
+        fb->w = fb->b;
+    }
+
+    if (*p_fb) {
+        /* set the underlying stream position as the buffered one */
+        if ((!(*p_fb)->fpos_ok || (*p_fb)->wr) &&
+            raw_seek(f, (*p_fb)->pos, SEEK_SET))
+        {
+            if (fb) free(fb);
+            ret=SPEC_ACCS_ERR;
+            goto finish;
+        }
+        free(*p_fb);
+    }
+    *p_fb = fb;
+
+finish:
+    return ret;
+}
+
 /* exported; see props.h header for details */
 sp_errc_t sp_fopen(SP_FILE *f, const char *filename, const char *mode)
 {
     if (!f || !filename || !mode) return SPEC_INV_ARG;
 
     f->typ = SP_FILE_C;
+    f->pctx = NULL;
+    f->fb = NULL;
     f->f = fopen(filename, mode);
-    return (f->f ? SPEC_SUCCESS : SPEC_FOPEN_ERR);
+    if (!f->f) return SPEC_FOPEN_ERR;
+
+    /* buffering is optional; proceed in case of failure */
+    if (CONFIG_FILE_BUF_SIZE>0) sp_fsetbuf(f, CONFIG_FILE_BUF_SIZE);
+
+    return SPEC_SUCCESS;
 }
 
 /* exported; see props.h header for details */
@@ -28,8 +219,13 @@ sp_errc_t sp_fopen2(SP_FILE *f, FILE *cf)
 {
     if (!f || !cf) return SPEC_INV_ARG;
 
+    /* the stream may be accessed by the caller directly,
+       therefore it is not buffered by default */
     f->typ = SP_FILE_C;
+    f->pctx = NULL;
+    f->fb = NULL;
     f->f = cf;
+
     return SPEC_SUCCESS;
 }
 
@@ -39,12 +235,272 @@ sp_errc_t sp_mopen(SP_FILE *f, char *buf, size_t num)
     if (!f || (!buf && num>0)) return SPEC_INV_ARG;
 
     f->typ = SP_FILE_MEM;
+    f->pctx = NULL;
     f->m.b = buf;
     f->m.num = num;
     f->m.i = 0;
     return SPEC_SUCCESS;
 }
 
+/* Growable memory stream buffer allocation routines. */
+
+static void *md_alloc(SP_FILE *f, size_t size)
+{
+    return (f->m.alloc ?
+        f->m.alloc->alloc(f->m.alloc->ctx, size) : malloc(size));
+}
+
+static void md_free(SP_FILE *f, void *ptr)
+{
+    if (!ptr) return;
+
+    if (f->m.alloc) f->m.alloc->free(f->m.alloc->ctx, ptr);
+    else free(ptr);
+}
+
+/* Grow the buffer to at least 'size' chars. Return 0 on success. */
+static int md_grow(SP_FILE *f, size_t size)
+{
+    char *b;
+    size_t sz = (f->m.sz ? f->m.sz : MEM_DYN_MIN_SIZE);
+
+    while (sz < size) {
+        if (sz > (size_t)-1/2) { sz = size; break; }
+        sz *= 2;
+    }
+
+    if (!f->m.alloc) {
+        b = (char*)realloc(f->m.b, sz);
+    } else
+    if (f->m.alloc->realloc) {
+        b = (char*)f->m.alloc->realloc(f->m.alloc->ctx, f->m.b, sz);
+    } else {
+        if ((b = (char*)md_alloc(f, sz))!=NULL && f->m.b) {
+            memcpy(b, f->m.b, f->m.num);
+            md_free(f, f->m.b);
+        }
+    }
+    if (!b) return -1;
+
+    f->m.b = b;
+    f->m.sz = sz;
+    return 0;
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_mopen_dyn(SP_FILE *f, size_t size, const sp_alloc_t *alloc)
+{
+    if (!f || (alloc && (!alloc->alloc || !alloc->free))) return SPEC_INV_ARG;
+
+    f->typ = SP_FILE_MEM_DYN;
+    f->pctx = NULL;
+    f->m.b = NULL;
+    f->m.num = 0;
+    f->m.i = 0;
+    f->m.sz = 0;
+    f->m.alloc = alloc;
+
+    if (size && md_grow(f, size)) return SPEC_NOMEM;
+    return SPEC_SUCCESS;
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_mdetach(SP_FILE *f, char **p_buf, size_t *p_len)
+{
+    if (!f || f->typ!=SP_FILE_MEM_DYN || !p_buf) return SPEC_INV_ARG;
+
+    /* NULL termination */
+    if (f->m.num >= f->m.sz && md_grow(f, f->m.num+1)) return SPEC_NOMEM;
+    f->m.b[f->m.num] = 0;
+
+    *p_buf = f->m.b;
+    if (p_len) *p_len = f->m.num;
+
+    f->m.b = NULL;
+    f->m.num = 0;
+    f->m.i = 0;
+    f->m.sz = 0;
+    return SPEC_SUCCESS;
+}
+
+/* Arena allocator routines.
+
+   Each arena block is preceded by a header with the block size, allowing
+   reallocation of the blocks.
+ */
+
+/* arena allocations alignment */
+typedef union _arena_align_t
+{
+    long l;
+    double d;
+    void *p;
+} arena_align_t;
+
+#define __ARENA_ALIGN(sz) \
+    (((sz)+sizeof(arena_align_t)-1) & ~(sizeof(arena_align_t)-1))
+
+#define ARENA_HDR_SZ __ARENA_ALIGN(sizeof(size_t))
+#define ARENA_NO_LAST ((size_t)-1)
+
+static void *arena_alloc(void *ctx, size_t size)
+{
+    sp_arena_t *p_arena = (sp_arena_t*)ctx;
+    size_t off = p_arena->used;
+    size_t sz = __ARENA_ALIGN(size);
+
+    if (sz < size || p_arena->sz-off < ARENA_HDR_SZ ||
+        p_arena->sz-off-ARENA_HDR_SZ < sz) return NULL;
+
+    *(size_t*)&p_arena->b[off] = size;
+    p_arena->last = off;
+    p_arena->used = off+ARENA_HDR_SZ+sz;
+    return &p_arena->b[off+ARENA_HDR_SZ];
+}
+
+static void arena_free(void *ctx, void *ptr)
+{
+    sp_arena_t *p_arena = (sp_arena_t*)ctx;
+
+    if (ptr && p_arena->last!=ARENA_NO_LAST &&
+        (char*)ptr==&p_arena->b[p_arena->last+ARENA_HDR_SZ])
+    {
+        p_arena->used = p_arena->last;
+        p_arena->last = ARENA_NO_LAST;
+    }
+}
+
+static void *arena_realloc(void *ctx, void *ptr, size_t size)
+{
+    sp_arena_t *p_arena = (sp_arena_t*)ctx;
+    size_t off, old_sz, sz = __ARENA_ALIGN(size);
+    void *b;
+
+    if (!ptr) return arena_alloc(ctx, size);
+
+    off = (size_t)((char*)ptr-p_arena->b)-ARENA_HDR_SZ;
+    old_sz = *(size_t*)&p_arena->b[off];
+
+    if (off==p_arena->last)
+    {
+        /* last block is resized in place */
+        if (sz < size || p_arena->sz-off-ARENA_HDR_SZ < sz) return NULL;
+
+        *(size_t*)&p_arena->b[off] = size;
+        p_arena->used = off+ARENA_HDR_SZ+sz;
+        return ptr;
+    }
+
+    if ((b = arena_alloc(ctx, size))!=NULL)
+        memcpy(b, ptr, (old_sz < size ? old_sz : size));
+    return b;
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_arena_init(sp_arena_t *p_arena, void *buf, size_t size)
+{
+    size_t adj;
+
+    if (!p_arena || (!buf && size)) return SPEC_INV_ARG;
+
+    /* align the buffer start */
+    adj = __ARENA_ALIGN((size_t)buf)-(size_t)buf;
+    if (adj > size) adj = size;
+
+    p_arena->alloc.alloc = arena_alloc;
+    p_arena->alloc.realloc = arena_realloc;
+    p_arena->alloc.free = arena_free;
+    p_arena->alloc.ctx = p_arena;
+
+    p_arena->b = (char*)buf+adj;
+    p_arena->sz = size-adj;
+    sp_arena_reset(p_arena);
+    return SPEC_SUCCESS;
+}
+
+/* exported; see props.h header for details */
+void sp_arena_reset(sp_arena_t *p_arena)
+{
+    if (!p_arena) return;
+
+    p_arena->used = 0;
+    p_arena->last = ARENA_NO_LAST;
+}
+
+/* Map a file with 'filename' into memory; read/write if 'rw' is set.
+   Support funct. for sp_fmap(), sp_fmap_rw().
+ */
+static sp_errc_t fmap(SP_FILE *f, const char *filename, int rw)
+{
+#if CONFIG_FILE_MMAP
+    sp_errc_t ret=SPEC_SUCCESS;
+    struct stat st;
+    void *b=NULL;
+    int fd;
+
+    if (!f || !filename) return SPEC_INV_ARG;
+
+    if ((fd = open(filename, (rw ? O_RDWR : O_RDONLY)))<0)
+        return SPEC_FOPEN_ERR;
+
+    if (fstat(fd, &st)) { ret=SPEC_FOPEN_ERR; goto finish; }
+
+    /* empty file can't be mapped */
+    if (st.st_size>0) {
+        b = mmap(NULL, (size_t)st.st_size,
+            (rw ? PROT_READ|PROT_WRITE : PROT_READ), MAP_SHARED, fd, 0);
+        if (b==MAP_FAILED) { ret=SPEC_FOPEN_ERR; goto finish; }
+    }
+
+    f->typ = SP_FILE_MMAP;
+    f->pctx = NULL;
+    f->m.b = (char*)b;
+    f->m.num = (size_t)st.st_size;
+    f->m.i = 0;
+    /* writable mapping is marked by its size */
+    f->m.sz = (rw ? f->m.num : 0);
+
+finish:
+    /* the mapping remains valid after the file is closed */
+    close(fd);
+    return ret;
+#else
+    if (!f || !filename) return SPEC_INV_ARG;
+
+    errno = ENOSYS;
+    return SPEC_FOPEN_ERR;
+#endif
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_fmap(SP_FILE *f, const char *filename)
+{
+    return fmap(f, filename, 0);
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_fmap_rw(SP_FILE *f, const char *filename)
+{
+    return fmap(f, filename, 1);
+}
+
+/* exported; see props.h header for details */
+sp_errc_t sp_fopen_custom(SP_FILE *f, const sp_fops_t *ops, void *ctx)
+{
+    if (!f || !ops || !ops->read || !ops->seek || !ops->tell)
+        return SPEC_INV_ARG;
+
+    f->typ = SP_FILE_CUSTOM;
+    f->pctx = NULL;
+    f->cs.ops = ops;
+    f->cs.ctx = ctx;
+    f->cs.fb = NULL;
+
+    /* the buffer is not used for directly accessed content */
+    return sp_fsetbuf(f, (ops->ptr ? 1 :
+        (CONFIG_FILE_BUF_SIZE>0 ? CONFIG_FILE_BUF_SIZE : CUSTOM_BUF_SIZE)));
+}
+
 /* exported; see props.h header for details */
 sp_errc_t sp_close(SP_FILE *f)
 {
@@ -52,13 +508,40 @@ sp_errc_t sp_close(SP_FILE *f)
        return SPEC_INV_ARG;
 
     if (f->typ==SP_FILE_C) {
+        if (f->fb) {
+            free(f->fb);
+            f->fb = NULL;
+        }
         if (f->f) {
             if (fclose(f->f)) {
                 return SPEC_ACCS_ERR;
             }
             f->f = NULL;
         }
+    } else
+    if (f->typ==SP_FILE_CUSTOM) {
+        if (f->cs.fb) {
+            free(f->cs.fb);
+            f->cs.fb = NULL;
+        }
+        if (f->cs.ops) {
+            if (f->cs.ops->close && f->cs.ops->close(f->cs.ctx)) {
+                return SPEC_ACCS_ERR;
+            }
+            f->cs.ops = NULL;
+        }
     } else {
+        if (f->typ==SP_FILE_MEM_DYN) {
+            md_free(f, f->m.b);
+            f->m.sz = 0;
+        }
+#if CONFIG_FILE_MMAP
+        if (f->typ==SP_FILE_MMAP && f->m.b) {
+            if (munmap(f->m.b, f->m.num)) {
+                return SPEC_ACCS_ERR;
+            }
+        }
+#endif
         f->m.b = NULL;
         f->m.num = 0;
         f->m.i = 0;
@@ -72,14 +555,9 @@ sp_errc_t sp_close(SP_FILE *f)
 int sp_fgetc(SP_FILE *f)
 {
     int c;
+    struct _sp_fbuf_t *fb;
 
-    if (f->typ==SP_FILE_C) {
-        c = fgetc(f->f);
-        if (!c) {
-            ungetc(c, f->f);
-            c = EOF;
-        }
-    } else {
+    if (IS_MEM(f)) {
         if (f->m.i < f->m.num) {
             c = f->m.b[f->m.i] & 0xff;
             if (!c) c = EOF;
@@ -87,43 +565,192 @@ int sp_fgetc(SP_FILE *f)
         } else {
             c = EOF;
         }
+    } else
+    if ((fb = FBUF(f))!=NULL) {
+        if ((fb->pos < fb->off || fb->pos >= fb->end) && !fb_refill(f)) {
+            c = EOF;
+        } else {
+            c = fb->w[fb->pos - fb->off] & 0xff;
+            if (!c) c = EOF;
+            else fb->pos++;
+        }
+    } else {
+        c = fgetc(f->f);
+        if (!c) {
+            ungetc(c, f->f);
+            c = EOF;
+        }
     }
     return c;
 }
 
-/* fputc(3) analogous */
-int sp_fputc(int c, SP_FILE *f)
+/* exported; see header for details */
+const char *sp_fpeek(SP_FILE *f, size_t *p_num)
 {
-    if (f->typ==SP_FILE_C) {
-        return fputc(c, f->f);
-    } else {
+    const char *ret=NULL;
+    struct _sp_fbuf_t *fb;
+
+    if (IS_MEM(f)) {
         if (f->m.i < f->m.num) {
-            return ((f->m.b[f->m.i++]=(char)c) & 0xff);
-        } else {
-            return EOF;
+            ret = &f->m.b[f->m.i];
+            *p_num = f->m.num - f->m.i;
+        }
+    } else
+    if ((fb = FBUF(f))!=NULL) {
+        if ((fb->pos >= fb->off && fb->pos < fb->end) || fb_refill(f)) {
+            ret = &fb->w[fb->pos - fb->off];
+            *p_num = (size_t)(fb->end - fb->pos);
         }
     }
+    return ret;
+}
+
+/* exported; see header for details */
+int sp_fdirect(SP_FILE *f)
+{
+    return (IS_MEM(f) || FBUF(f)!=NULL);
+}
+
+/* exported; see header for details */
+void sp_fskip(SP_FILE *f, size_t num)
+{
+    struct _sp_fbuf_t *fb;
+
+    if (IS_MEM(f)) {
+        f->m.i += num;
+    } else
+    if ((fb = FBUF(f))!=NULL) {
+        fb->pos += (long)num;
+    }
+}
+
+/* exported; see header for details */
+const char *sp_fview(SP_FILE *f, long off, size_t *p_num)
+{
+    const char *ret=NULL;
+
+    if (IS_MEM(f) && off >= 0 && (size_t)off < f->m.num) {
+        ret = &f->m.b[off];
+        *p_num = f->m.num - (size_t)off;
+    }
+    return ret;
+}
+
+/* fputc(3) analogous */
+int sp_fputc(int c, SP_FILE *f)
+{
+    char ch = (char)c;
+
+    if (f->typ==SP_FILE_C && !f->fb) return fputc(c, f->f);
+    return (sp_fwrite(&ch, 1, f)==1 ? (c & 0xff) : EOF);
 }
 
 /* fputs(3) analogous */
 int sp_fputs(const char *str, SP_FILE *f)
 {
-    if (f->typ==SP_FILE_C) {
-        return fputs(str, f->f);
+    size_t len;
+
+    if (f->typ==SP_FILE_C && !f->fb) return fputs(str, f->f);
+
+    len = strlen(str);
+    return (sp_fwrite(str, len, f)==len ? 0 : EOF);
+}
+
+/* fread(3) analogous */
+size_t sp_fread(char *buf, size_t num, SP_FILE *f)
+{
+    size_t n=0, k;
+    const char *nul;
+    struct _sp_fbuf_t *fb;
+
+    if (IS_MEM(f))
+    {
+        if (f->m.i < f->m.num) {
+            n = f->m.num - f->m.i;
+            if (n > num) n = num;
+
+            if ((nul = (const char*)memchr(&f->m.b[f->m.i], 0, n))!=NULL)
+                n = (size_t)(nul - &f->m.b[f->m.i]);
+
+            memcpy(buf, &f->m.b[f->m.i], n);
+            f->m.i += n;
+        }
+    } else
+    if ((fb = FBUF(f))!=NULL)
+    {
+        while (n < num)
+        {
+            if ((fb->pos < fb->off || fb->pos >= fb->end) && !fb_refill(f))
+                break;
+
+            k = (size_t)(fb->end - fb->pos);
+            if (k > num-n) k = num-n;
+
+            nul = (const char*)memchr(&fb->w[fb->pos - fb->off], 0, k);
+            if (nul) k = (size_t)(nul - &fb->w[fb->pos - fb->off]);
+
+            memcpy(&buf[n], &fb->w[fb->pos - fb->off], k);
+            fb->pos += (long)k;
+            n += k;
+
+            if (nul) break;
+        }
     } else {
-        size_t i = f->m.num-f->m.i;
-        for (; *str && i; i--, str++)
-            f->m.b[f->m.i++] = *str;
-        return (*str ? EOF : 0);
+        int c;
+        for (; n < num && (c=sp_fgetc(f))!=EOF; n++) buf[n]=(char)c;
     }
+    return n;
+}
+
+/* fwrite(3) analogous */
+size_t sp_fwrite(const char *buf, size_t num, SP_FILE *f)
+{
+    size_t n=0;
+    struct _sp_fbuf_t *fb;
+
+    /* memory mapped stream is writable if mapped by sp_fmap_rw() only;
+       as for a memory buffer, its size can't be changed */
+    if (f->typ==SP_FILE_MEM || (f->typ==SP_FILE_MMAP && f->m.sz)) {
+        n = (f->m.i < f->m.num ? f->m.num - f->m.i : 0);
+        if (n > num) n = num;
+
+        if (n) {
+            memcpy(&f->m.b[f->m.i], buf, n);
+            f->m.i += n;
+        }
+    } else
+    if (f->typ==SP_FILE_MEM_DYN) {
+        if (!num || num > (size_t)-1 - f->m.i ||
+            (f->m.i+num > f->m.sz && md_grow(f, f->m.i+num))) return 0;
+
+        memcpy(&f->m.b[f->m.i], buf, num);
+        f->m.i += num;
+        if (f->m.i > f->m.num) f->m.num = f->m.i;
+        n = num;
+    } else
+    if (f->typ==SP_FILE_MMAP) {
+        /* read-only mapping (sp_fmap()) */
+    } else
+    if ((fb = FBUF(f))!=NULL) {
+        if (!fb_prep_write(f)) {
+            n = raw_write(f, buf, num);
+            fb->pos += (long)n;
+            fb->wr = 1;
+        }
+        if (n < num) fb->fpos_ok = 0;
+    } else {
+        n = fwrite(buf, 1, num, f->f);
+    }
+    return n;
 }
 
 /* fseek(3) analogous */
 int sp_fseek(SP_FILE *f, long int offset, int origin)
 {
-    if (f->typ==SP_FILE_C) {
-        return fseek(f->f, offset, origin);
-    } else {
+    struct _sp_fbuf_t *fb;
+
+    if (IS_MEM(f))
+    {
         switch (origin)
         {
         case SEEK_CUR:
@@ -144,11 +771,47 @@ int sp_fseek(SP_FILE *f, long int offset, int origin)
             errno = EINVAL;
             return -1;
         }
+    } else
+    if ((fb = FBUF(f))!=NULL)
+    {
+        switch (origin)
+        {
+        case SEEK_CUR:
+            offset += fb->pos;
+            /* fall-through */
+
+        case SEEK_SET:
+            if (offset < 0) break;
+
+            /* seeking doesn't touch the underlying stream */
+            if (offset!=fb->pos) {
+                fb->pos = offset;
+                fb->fpos_ok = 0;
+            }
+            return 0;
+
+        case SEEK_END:
+            fb->fpos_ok = 0;
+            if (raw_seek(f, offset, origin) ||
+                (offset = raw_tell(f))==-1L) return -1;
+
+            fb->pos = offset;
+            fb->fpos_ok = 1;
+            fb->wr = 0;
+            return 0;
+        }
+        errno = EINVAL;
+        return -1;
     }
+    return fseek(f->f, offset, origin);
 }
 
 /* ftell(3) analogous */
 long int sp_ftell(SP_FILE *f)
 {
-    return (f->typ==SP_FILE_C ? ftell(f->f) : (long int)f->m.i);
+    struct _sp_fbuf_t *fb;
+
+    if (IS_MEM(f)) return (long int)f->m.i;
+    if ((fb = FBUF(f))!=NULL) return fb->pos;
+    return raw_tell(f);
 }
@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016,2019 Piotr Stolarz
+   Copyright (c) 2016,2019,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -16,6 +16,7 @@
  */
 
 #ifndef __SP_IO_H__
+#define __SP_IO_H__
 
 #include "sprops/props.h"
 
@@ -28,10 +29,43 @@ int sp_fputc(int c, SP_FILE *f);
 /* fputs(3) analogous */
 int sp_fputs(const char *str, SP_FILE *f);
 
+/* fread(3) analogous; reads up to 'num' chars to 'buf'
+   NOTE: As for sp_fgetc(), NULL termination char stops reading (EOF).
+ */
+size_t sp_fread(char *buf, size_t num, SP_FILE *f);
+
+/* fwrite(3) analogous; writes 'num' chars from 'buf' */
+size_t sp_fwrite(const char *buf, size_t num, SP_FILE *f);
+
 /* fseek(3) analogous */
 int sp_fseek(SP_FILE *f, long int offset, int origin);
 
 /* ftell(3) analogous */
 long int sp_ftell(SP_FILE *f);
 
+/* Get direct read access to the stream content at the current stream
+   position. Return pointer to the content and number of chars accessible by
+   it under 'p_num'. NULL is returned if the direct access is not possible
+   (not buffered ANSI C stream) or there is no more chars to read.
+
+   NOTE: Contrary to sp_fgetc() and sp_fread() the accessible content is not
+   limited by the NULL termination char.
+ */
+const char *sp_fpeek(SP_FILE *f, size_t *p_num);
+
+/* Check if the stream supports the direct read access (see sp_fpeek()) */
+int sp_fdirect(SP_FILE *f);
+
+/* Advance the stream position by 'num' chars accessed by sp_fpeek() */
+void sp_fskip(SP_FILE *f, size_t num);
+
+/* Get direct read access to the stream content at offset 'off', independently
+   of the stream position. Return pointer to the content and number of chars
+   accessible by it under 'p_num'. Contrary to sp_fpeek() the content stays
+   accessible as long as the stream is not closed or written, therefore NULL
+   is returned for streams other than memory based ones or if the offset is
+   beyond the stream end.
+ */
+const char *sp_fview(SP_FILE *f, long off, size_t *p_num);
+
 #endif  /* __SP_IO_H__ */
@@ -0,0 +1,799 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "io.h"
+#include "parser_int.h"
+#include "scan.h"
+
+#if CONFIG_PARSE_PARALLEL
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* number of chunks per parsing thread; more chunks than threads balance
+   the threads load for chunks of various parsing cost */
+#define CHUNKS_PER_THREAD   4
+
+/* maximum number of parsing threads */
+#define MAX_THREADS         64
+
+/* chunk states */
+#define CHS_PEND    0       /* not processed yet */
+#define CHS_RUN     1       /* processed by a thread */
+#define CHS_DONE    2       /* processed */
+
+typedef struct _chunk_t
+{
+    sp_loc_t loc;           /* chunk location */
+    int state;              /* chunk state (CHS_XXX) */
+
+    /* chunk job result */
+    sp_errc_t ret;
+    sp_synerr_t synerr;
+    void *res;
+} chunk_t;
+
+/* sp_parse_chunks() handle */
+typedef struct _chunks_hndl_t
+{
+    sp_parser_cb_chunk_t cb_chunk;
+    void *arg;
+
+    /* chunks table: 'n_chunks' chunks are published by the pre-scan,
+       'n_max' is the table size */
+    chunk_t *chunks;
+    int n_chunks;
+    int n_max;
+
+    int next;       /* next chunk to process */
+    int stop;       /* chunks starting from this one are not processed */
+    int scan_done;  /* if !=0: all chunks have been published */
+
+#if CONFIG_PARSE_PARALLEL
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+#endif
+} chunks_hndl_t;
+
+/* parsing thread */
+typedef struct _worker_t
+{
+    chunks_hndl_t *p_chndl;
+    SP_FILE in;     /* thread's copy of the input handle */
+    int thread;     /* thread number */
+#if CONFIG_PARSE_PARALLEL
+    pthread_t tid;
+#endif
+} worker_t;
+
+#if CONFIG_PARSE_PARALLEL
+# define __LOCK(h)      pthread_mutex_lock(&(h)->mtx)
+# define __UNLOCK(h)    pthread_mutex_unlock(&(h)->mtx)
+# define __WAIT(h)      pthread_cond_wait(&(h)->cond, &(h)->mtx)
+# define __SIGNAL(h)    pthread_cond_broadcast(&(h)->cond)
+#else
+# define __LOCK(h)
+# define __UNLOCK(h)
+# define __WAIT(h)
+# define __SIGNAL(h)
+#endif
+
+/* Chunks processing loop of a parsing thread */
+static void *worker(void *arg)
+{
+    worker_t *p_w = (worker_t*)arg;
+    chunks_hndl_t *p_chndl = p_w->p_chndl;
+    chunk_t *p_ch;
+    sp_errc_t ret;
+    int i;
+
+    for (;;)
+    {
+        __LOCK(p_chndl);
+        while (p_chndl->next >= p_chndl->n_chunks &&
+            p_chndl->next < p_chndl->stop && !p_chndl->scan_done)
+        {
+            __WAIT(p_chndl);
+        }
+        if (p_chndl->next >= p_chndl->n_chunks ||
+            p_chndl->next >= p_chndl->stop)
+        {
+            __UNLOCK(p_chndl);
+            break;
+        }
+        i = p_chndl->next++;
+        p_ch = &p_chndl->chunks[i];
+        p_ch->state = CHS_RUN;
+        __UNLOCK(p_chndl);
+
+        ret = p_chndl->cb_chunk(p_chndl->arg, &p_w->in, p_w->thread,
+            &p_ch->loc, &p_ch->res, &p_ch->synerr);
+
+        __LOCK(p_chndl);
+        p_ch->ret = ret;
+        p_ch->state = CHS_DONE;
+        /* chunks following a failed (or finished) one are not processed */
+        if (ret!=SPEC_SUCCESS && i+1 < p_chndl->stop) p_chndl->stop = i+1;
+        __SIGNAL(p_chndl);
+        __UNLOCK(p_chndl);
+    }
+    return NULL;
+}
+
+/* Publish a chunk located at 'beg'..'end' with the text position of its
+   beginning 'line', 'col'. Return 0 if no more chunks need to be published.
+ */
+static int publish(
+    chunks_hndl_t *p_chndl, long beg, long end, int line, int col)
+{
+    chunk_t *p_ch;
+    int cont;
+
+    __LOCK(p_chndl);
+    p_ch = &p_chndl->chunks[p_chndl->n_chunks];
+    p_ch->loc.beg = beg;
+    p_ch->loc.end = end;
+    p_ch->loc.first_line = line;
+    p_ch->loc.first_column = col;
+    p_ch->loc.last_line = p_ch->loc.last_column = -1;
+    p_ch->state = CHS_PEND;
+    p_ch->ret = SPEC_SUCCESS;
+    p_ch->res = NULL;
+    p_chndl->n_chunks++;
+
+    cont = (p_chndl->n_chunks < p_chndl->n_max-1 &&
+        p_chndl->n_chunks < p_chndl->stop);
+    __SIGNAL(p_chndl);
+    __UNLOCK(p_chndl);
+
+    return cont;
+}
+
+/* is_nq_idc() of the lexer (EOL excluded by the caller) */
+#define __IS_NQ_IDC(c) (!(sp_cctab[(c) & 0xff] & (SP_CC_SPACE | SP_CC_RSV)))
+
+/* Pre-scan content 'b' of 'n' chars of the parsing scope 'p_parsc' and split
+   it into chunks of at least 'tgt' chars. The chunks are published as soon as
+   found, so they may be parsed while the scan proceeds.
+
+   The scan is a reduced lexer's state machine tracking the scope level only.
+   Chunks are split at 0-level elements boundaries, that is after a closing
+   bracket or a semicolon on the 0-level, or after an end of line finishing
+   a 0-level property value. The boundary is confirmed by the first char of
+   the following token, since a semicolon finishing a property may follow the
+   value after the end of line. In case of a lexical error (or unbalanced
+   brackets) the scan stops splitting; the error is reported by the parser of
+   the last chunk.
+ */
+static void prescan(chunks_hndl_t *p_chndl, const char *b, long n,
+    const sp_loc_t *p_parsc, long tgt)
+{
+    /* pre-scan states */
+    enum { PS_INIT=0, PS_CMT, PS_ID, PS_ID_QUOTED, PS_VAL } state = PS_INIT;
+
+    long i=0, cbeg=0, bnd=-1;
+    int line = p_parsc->first_line, col = p_parsc->first_column;
+    int cline = line, ccol = col, bline=0, bcol=0;
+    int lev=0, esc=0, eol, quot_chr=0;
+    const sp_scan_mode_t *p_smode;
+    size_t n_run;
+    char c;
+
+    while (i < n)
+    {
+        switch (state)
+        {
+        case PS_CMT:
+            p_smode = &sp_scan_cmt;
+            break;
+        case PS_ID:
+            p_smode = &sp_scan_id;
+            break;
+        case PS_ID_QUOTED:
+            p_smode = (quot_chr=='"' ? &sp_scan_dq : &sp_scan_sq);
+            break;
+        case PS_VAL:
+            p_smode = &sp_scan_val;
+            break;
+        default:
+            p_smode = NULL;
+            break;
+        }
+
+        /* runs of chars not requiring the state machine attention
+           (never containing EOLs) */
+        if (p_smode && (n_run=sp_scan_run(&b[i], n-i, p_smode))>0) {
+            i += (long)n_run;
+            col += (int)n_run;
+            esc = 0;
+            if (i >= n) break;
+        }
+
+        if (!(c=b[i])) break;
+
+        /* EOL conversion */
+        eol = (c=='\r' || c=='\n');
+        if (c=='\r' && i+1 < n && b[i+1]=='\n') i++;
+
+        switch (state)
+        {
+        case PS_INIT:
+            if (eol || (sp_cctab[c & 0xff] & SP_CC_SPACE)) break;
+            if (c=='#') {
+                state = PS_CMT;
+                break;
+            }
+
+            /* a token starts; confirm pending boundary */
+            if (bnd>=0)
+            {
+                if (c!=';' && bnd-cbeg >= tgt) {
+                    int cont = publish(p_chndl, p_parsc->beg+cbeg,
+                        p_parsc->beg+bnd-1, cline, ccol);
+
+                    cbeg = bnd;
+                    cline = bline;
+                    ccol = bcol;
+                    if (!cont) goto finish;
+                }
+                bnd = -1;
+            }
+
+            if (__IS_NQ_IDC(c)) {
+                if (c=='"' || c=='\'') {
+                    quot_chr = c;
+                    esc = 0;
+                    state = PS_ID_QUOTED;
+                } else {
+                    esc = (c=='\\');
+                    state = PS_ID;
+                }
+            } else
+            if (c=='{') {
+                lev++;
+            } else
+            if (c=='}') {
+                /* unbalanced brackets; stop splitting */
+                if (--lev < 0) goto finish;
+                if (!lev) { bnd=i+1; bline=line; bcol=col+1; }
+            } else
+            if (c==';') {
+                if (!lev) { bnd=i+1; bline=line; bcol=col+1; }
+            } else
+            if (c=='=') {
+                esc = 0;
+                state = PS_VAL;
+            }
+            break;
+
+        case PS_CMT:
+            if (eol) state = PS_INIT;
+            break;
+
+        case PS_ID:
+            if (eol) {
+                /* lexical error: line continuation is not possible */
+                if (esc) goto finish;
+                state = PS_INIT;
+            } else
+            if (esc) {
+                esc = 0;
+            } else
+            if (c=='\\') {
+                esc = 1;
+            } else
+            if (!__IS_NQ_IDC(c)) {
+                /* the char is processed by the initial state */
+                state = PS_INIT;
+                continue;
+            }
+            break;
+
+        case PS_ID_QUOTED:
+            /* lexical error: not finished quoted id */
+            if (eol) goto finish;
+
+            if (esc) esc = 0;
+            else if (c=='\\') esc = 1;
+            else if (c==quot_chr) state = PS_INIT;
+            break;
+
+        case PS_VAL:
+            if (esc) {
+                /* escaped char (including EOL for the line continuation) */
+                esc = 0;
+            } else
+            if (c=='\\') {
+                esc = 1;
+            } else
+            if (eol) {
+                state = PS_INIT;
+                if (!lev) { bnd=i+1; bline=line+1; bcol=1; }
+            }
+#if !CONFIG_NO_SEMICOL_ENDS_VAL
+            else
+            if (c==';') {
+                /* the semicolon is processed by the initial state */
+                state = PS_INIT;
+                continue;
+            }
+#endif
+            break;
+        }
+
+        /* track location of the next char */
+        if (eol) {
+            line++;
+            col = 1;
+        } else {
+            col++;
+        }
+        i++;
+    }
+
+finish:
+    /* the last chunk up to the end of the parsing scope */
+    publish(p_chndl, p_parsc->beg+cbeg, p_parsc->end, cline, ccol);
+    return;
+}
+
+#undef __IS_NQ_IDC
+
+/* Get content of the parsing scope 'p_parsc' (the scope is updated with
+   the default values if NULL is passed). Return NULL if not accessible.
+ */
+static const char *parsc_content(
+    SP_FILE *in, const sp_loc_t **pp_parsc, sp_loc_t *p_globsc, long *p_n)
+{
+    const char *b;
+    size_t num;
+
+    if (!*pp_parsc) {
+        p_globsc->beg = 0;
+        p_globsc->end = -1;
+        p_globsc->first_line = p_globsc->first_column = 1;
+        p_globsc->last_line = p_globsc->last_column = -1;
+        *pp_parsc = p_globsc;
+    }
+
+    if (!(b=sp_fview(in, (*pp_parsc)->beg, &num))) return NULL;
+
+    *p_n = (long)num;
+    if ((*pp_parsc)->end!=-1L && (*pp_parsc)->end-(*pp_parsc)->beg+1 < *p_n)
+        *p_n = (*pp_parsc)->end-(*pp_parsc)->beg+1;
+    return b;
+}
+
+/* exported; see header for details */
+int sp_parse_chunks_nthr(SP_FILE *in, const sp_loc_t *p_parsc, int n_threads)
+{
+#if CONFIG_PARSE_PARALLEL
+    sp_loc_t globsc;
+    long n;
+
+    if (!in || !parsc_content(in, &p_parsc, &globsc, &n)) return 1;
+
+    if (n_threads <= 0) {
+        long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = (n_cpus > 0 ? (int)n_cpus : 1);
+    }
+    if (n_threads > MAX_THREADS) n_threads = MAX_THREADS;
+
+    /* each thread shall get at least one chunk of minimal size */
+    if ((long)n_threads > n/CONFIG_PARSE_PAR_CHUNK)
+        n_threads = (int)(n/CONFIG_PARSE_PAR_CHUNK);
+    return (n_threads > 1 ? n_threads : 1);
+#else
+    return 1;
+#endif
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_chunks(SP_FILE *in, const sp_loc_t *p_parsc,
+    int n_threads, sp_parser_cb_chunk_t cb_chunk,
+    sp_parser_cb_collect_t cb_collect, void *arg, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS, cret;
+    chunks_hndl_t chndl;
+    worker_t *workers=NULL;
+    int i, done, n_workers=0;
+#if CONFIG_PARSE_PARALLEL
+    int sync_init=0;
+#endif
+    sp_loc_t globsc;
+    const char *b;
+    long n, tgt;
+
+    memset(&chndl, 0, sizeof(chndl));
+
+    if (!in || !cb_chunk || n_threads <= 0) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    chndl.cb_chunk = cb_chunk;
+    chndl.arg = arg;
+
+    if (!(b=parsc_content(in, &p_parsc, &globsc, &n))) {
+        /* the content is not accessible; single chunk */
+        n = 0;
+        n_threads = 1;
+    }
+
+    tgt = n/((long)n_threads*CHUNKS_PER_THREAD);
+    if (tgt < CONFIG_PARSE_PAR_CHUNK) tgt = CONFIG_PARSE_PAR_CHUNK;
+
+    /* each chunk (except the last one) is at least 'tgt' long */
+    chndl.n_max = (int)(n/tgt)+2;
+    chndl.stop = chndl.n_max;
+    chndl.chunks = (chunk_t*)malloc(chndl.n_max*sizeof(*chndl.chunks));
+    workers = (worker_t*)malloc(n_threads*sizeof(*workers));
+    if (!chndl.chunks || !workers) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+
+#if CONFIG_PARSE_PARALLEL
+    if (pthread_mutex_init(&chndl.mtx, NULL)) {
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    if (pthread_cond_init(&chndl.cond, NULL)) {
+        pthread_mutex_destroy(&chndl.mtx);
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    sync_init++;
+#endif
+
+    for (i=0; i<n_threads; i++) {
+        workers[i].p_chndl = &chndl;
+        workers[i].in = *in;
+        /* the parser context must not be shared by the threads */
+        workers[i].in.pctx = NULL;
+        workers[i].thread = i;
+    }
+
+    if (n_threads > 1)
+    {
+#if CONFIG_PARSE_PARALLEL
+        /* failure of a thread creation is not fatal; the chunks are parsed
+           by the created ones (or by the calling thread, if none) */
+        for (; n_workers<n_threads; n_workers++) {
+            if (pthread_create(&workers[n_workers].tid, NULL,
+                worker, &workers[n_workers])) break;
+        }
+#endif
+        prescan(&chndl, b, n, p_parsc, tgt);
+    } else {
+        publish(&chndl, p_parsc->beg, p_parsc->end,
+            p_parsc->first_line, p_parsc->first_column);
+    }
+
+    __LOCK(&chndl);
+    chndl.scan_done = 1;
+    __SIGNAL(&chndl);
+    __UNLOCK(&chndl);
+
+    if (!n_workers) worker(&workers[0]);
+
+    /* collect processed chunks in order */
+    for (i=0; i<chndl.n_chunks; i++)
+    {
+        chunk_t *p_ch = &chndl.chunks[i];
+
+        __LOCK(&chndl);
+        while (i < chndl.stop && p_ch->state!=CHS_DONE) __WAIT(&chndl);
+        done = (p_ch->state==CHS_DONE);
+        __UNLOCK(&chndl);
+
+        if (!done) break;
+
+        cret = p_ch->ret;
+        if (cb_collect && (cret==SPEC_SUCCESS || p_ch->res))
+        {
+            /* results recorded by a failed chunk are collected too, since
+               elements preceding the failure are reported by sp_parse() */
+            sp_errc_t colret = cb_collect(arg, p_ch->res, 0);
+
+            p_ch->res = NULL;
+            if (colret!=SPEC_SUCCESS) cret = colret;
+        }
+
+        if (cret!=SPEC_SUCCESS)
+        {
+            if (cret!=SPEC_CB_FINISH) {
+                ret = cret;
+                if (ret==SPEC_SYNTAX && p_ch->ret==SPEC_SYNTAX && p_synerr)
+                    *p_synerr = p_ch->synerr;
+            }
+
+            /* stop processing of the following chunks */
+            __LOCK(&chndl);
+            if (i+1 < chndl.stop) chndl.stop = i+1;
+            __SIGNAL(&chndl);
+            __UNLOCK(&chndl);
+            break;
+        }
+    }
+
+finish:
+#if CONFIG_PARSE_PARALLEL
+    for (i=0; i<n_workers; i++) pthread_join(workers[i].tid, NULL);
+    if (sync_init) {
+        pthread_cond_destroy(&chndl.cond);
+        pthread_mutex_destroy(&chndl.mtx);
+    }
+#endif
+    if (chndl.chunks) {
+        /* discard results of not collected chunks */
+        for (i=0; i<chndl.n_chunks; i++) {
+            if (chndl.chunks[i].res && cb_collect)
+                cb_collect(arg, chndl.chunks[i].res, 1);
+        }
+        free(chndl.chunks);
+    }
+    if (workers) free(workers);
+    return ret;
+}
+
+#undef __SIGNAL
+#undef __WAIT
+#undef __UNLOCK
+#undef __LOCK
+
+/* recorded parser callback event */
+typedef struct _par_evt_t
+{
+    int scope;          /* 0: property, 1: scope */
+    unsigned pres;      /* presence mask of the optional locations */
+
+    /* a property value is recorded under 'ltype' */
+    sp_loc_t ltype;
+    sp_loc_t lname;
+
+    sp_loc_t lbody;
+    sp_loc_t lbdyenc;
+    sp_loc_t ldef;
+} par_evt_t;
+
+/* presence mask bits */
+#define __EVT_TYPE  0x01U
+#define __EVT_BODY  0x02U
+
+/* recorded events of a chunk */
+typedef struct _par_rec_t
+{
+    par_evt_t *evts;
+    int n_evts;
+    int sz;
+} par_rec_t;
+
+/* sp_parse_parallel() handle */
+typedef struct _par_hndl_t
+{
+    SP_FILE *in;
+
+    sp_parser_cb_prop_t cb_prop;
+    sp_parser_cb_scope_t cb_scope;
+    void *arg;
+
+    void *const *sinks;     /* per-thread sinks; NULL: in order delivery */
+} par_hndl_t;
+
+/* Add event to the recorded events 'p_rec' */
+static par_evt_t *add_evt(par_rec_t *p_rec)
+{
+    if (p_rec->n_evts >= p_rec->sz)
+    {
+        int sz = (!p_rec->sz ? 64 : 2*p_rec->sz);
+        par_evt_t *evts =
+            (par_evt_t*)realloc(p_rec->evts, sz*sizeof(*evts));
+
+        if (!evts) return NULL;
+
+        p_rec->evts = evts;
+        p_rec->sz = sz;
+    }
+    return &p_rec->evts[p_rec->n_evts++];
+}
+
+/* Recording parser callback: property */
+static sp_errc_t rec_cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    par_evt_t *p_evt = add_evt((par_rec_t*)arg);
+
+    if (!p_evt) return SPEC_NOMEM;
+
+    p_evt->scope = 0;
+    p_evt->pres = 0;
+    p_evt->lname = *p_lname;
+    if (p_lval) {
+        p_evt->pres |= __EVT_TYPE;
+        p_evt->ltype = *p_lval;
+    }
+    p_evt->ldef = *p_ldef;
+    return SPEC_SUCCESS;
+}
+
+/* Recording parser callback: scope */
+static sp_errc_t rec_cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    par_evt_t *p_evt = add_evt((par_rec_t*)arg);
+
+    if (!p_evt) return SPEC_NOMEM;
+
+    p_evt->scope = 1;
+    p_evt->pres = 0;
+    if (p_ltype) {
+        p_evt->pres |= __EVT_TYPE;
+        p_evt->ltype = *p_ltype;
+    }
+    p_evt->lname = *p_lname;
+    if (p_lbody) {
+        p_evt->pres |= __EVT_BODY;
+        p_evt->lbody = *p_lbody;
+    }
+    p_evt->lbdyenc = *p_lbdyenc;
+    p_evt->ldef = *p_ldef;
+    return SPEC_SUCCESS;
+}
+
+/* per-thread sink of a chunk parsing */
+typedef struct _sink_t
+{
+    const par_hndl_t *p_phndl;
+    void *arg;          /* thread's sink argument */
+    int finish;         /* if !=0: finish requested by a callback */
+} sink_t;
+
+/* Sink parser callback: property */
+static sp_errc_t sink_cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    sink_t *p_sink = (sink_t*)arg;
+    sp_errc_t ret = p_sink->p_phndl->cb_prop(
+        p_sink->arg, in, p_lname, p_lval, p_ldef);
+
+    if (ret==SPEC_CB_FINISH) p_sink->finish = 1;
+    return ret;
+}
+
+/* Sink parser callback: scope */
+static sp_errc_t sink_cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sink_t *p_sink = (sink_t*)arg;
+    sp_errc_t ret = p_sink->p_phndl->cb_scope(
+        p_sink->arg, in, p_ltype, p_lname, p_lbody, p_lbdyenc, p_ldef);
+
+    if (ret==SPEC_CB_FINISH) p_sink->finish = 1;
+    return ret;
+}
+
+/* sp_parse_parallel() chunk job */
+static sp_errc_t par_cb_chunk(void *arg, SP_FILE *in, int thread,
+    const sp_loc_t *p_chunk, void **p_res, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    par_hndl_t *p_phndl = (par_hndl_t*)arg;
+    par_rec_t *p_rec;
+
+    if (p_phndl->sinks)
+    {
+        /* elements are reported directly to the thread's sink */
+        sink_t sink;
+
+        sink.p_phndl = p_phndl;
+        sink.arg = p_phndl->sinks[thread];
+        sink.finish = 0;
+
+        ret = sp_parse(in, p_chunk,
+            (p_phndl->cb_prop ? sink_cb_prop : NULL),
+            (p_phndl->cb_scope ? sink_cb_scope : NULL), &sink, p_synerr);
+
+        /* finish the whole parsing */
+        if (ret==SPEC_SUCCESS && sink.finish) ret=SPEC_CB_FINISH;
+    } else {
+        if (!(p_rec=(par_rec_t*)calloc(1, sizeof(*p_rec)))) {
+            ret=SPEC_NOMEM;
+            goto finish;
+        }
+        *p_res = p_rec;
+
+        ret = sp_parse(in, p_chunk, (p_phndl->cb_prop ? rec_cb_prop : NULL),
+            (p_phndl->cb_scope ? rec_cb_scope : NULL), p_rec, p_synerr);
+    }
+finish:
+    return ret;
+}
+
+/* sp_parse_parallel() chunk results collection; recorded events are
+   reported in order of their appearance */
+static sp_errc_t par_cb_collect(void *arg, void *res, int discard)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    par_hndl_t *p_phndl = (par_hndl_t*)arg;
+    par_rec_t *p_rec = (par_rec_t*)res;
+    int i;
+
+    for (i=0; !discard && i < p_rec->n_evts; i++)
+    {
+        const par_evt_t *p_evt = &p_rec->evts[i];
+
+        if (!p_evt->scope) {
+            ret = p_phndl->cb_prop(p_phndl->arg, p_phndl->in,
+                &p_evt->lname,
+                (p_evt->pres & __EVT_TYPE ? &p_evt->ltype : NULL),
+                &p_evt->ldef);
+        } else {
+            ret = p_phndl->cb_scope(p_phndl->arg, p_phndl->in,
+                (p_evt->pres & __EVT_TYPE ? &p_evt->ltype : NULL),
+                &p_evt->lname,
+                (p_evt->pres & __EVT_BODY ? &p_evt->lbody : NULL),
+                &p_evt->lbdyenc, &p_evt->ldef);
+        }
+        if (ret!=SPEC_SUCCESS) break;
+    }
+
+    if (p_rec->evts) free(p_rec->evts);
+    free(p_rec);
+    return ret;
+}
+
+#undef __EVT_BODY
+#undef __EVT_TYPE
+
+/* exported; see header for details */
+sp_errc_t sp_parse_parallel(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, void *const *sinks,
+    int n_threads, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    par_hndl_t phndl;
+    int n_thr;
+
+    if (!in || (sinks && n_threads <= 0)) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    n_thr = sp_parse_chunks_nthr(in, p_parsc, n_threads);
+    if (n_thr <= 1) {
+        /* not worth (or not possible) to parse in parallel */
+        ret = sp_parse(in, p_parsc, cb_prop, cb_scope,
+            (sinks ? sinks[0] : arg), p_synerr);
+        goto finish;
+    }
+
+    phndl.in = in;
+    phndl.cb_prop = cb_prop;
+    phndl.cb_scope = cb_scope;
+    phndl.arg = arg;
+    phndl.sinks = sinks;
+
+    ret = sp_parse_chunks(in, p_parsc, n_thr, par_cb_chunk,
+        (sinks ? NULL : par_cb_collect), &phndl, p_synerr);
+finish:
+    return ret;
+}
@@ -67,24 +67,25 @@
 #line 14 "parser.y"
 
 #include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "config.h"
 #include "io.h"
-#include "sprops/parser.h"
+#include "parser_int.h"
+#include "scan.h"
 
 #define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
 
 /* EOL char code (platform independent) */
 #define EOL (EOF-1)
-#define is_space(c) (isspace(c) || (c)==EOL)
+#define is_space(c) ((c)==EOL || (sp_cctab[(c) & 0xff] & SP_CC_SPACE))
 
 /* NOTE: semicolon char is reserved even though CONFIG_NO_SEMICOL_ENDS_VAL
    is configured, due to the property w/o a value and scope w/o a body
-   alternative grammar rules. */
-#define RESERVED_CHRS   "={};#"
-
-#define is_nq_idc(c) (!is_space(c) && !strchr(RESERVED_CHRS, (c)))
+   alternative grammar rules (see SP_CC_RSV chars class). */
+#define is_nq_idc(c) \
+    ((c)!=EOL && !(sp_cctab[(c) & 0xff] & (SP_CC_SPACE | SP_CC_RSV)))
 
 #define unc_clean(unc) ((unc)->inbuf=0)
 #define unc_getc(unc, def) ((unc)->inbuf ? (unc)->buf[--((unc)->inbuf)] : (def))
@@ -99,6 +100,19 @@ typedef struct _lexval_t {
     long beg;
     long end;   /* inclusive */
     int scope_lev;
+
+    /* tokens only: if !=0 the token contains backslash escaped chars */
+    int esc;
+
+    /* SP_TKN_ID only: hash and length of the token content (w/o quotation
+       marks) calculated during scanning; valid for non escaped tokens */
+    unsigned long hash;
+    long hlen;
+
+    /* path following mode: reporting flag of the enclosing scope body and
+       the entered scope level state (scope body enter mid-rule actions) */
+    int rep;
+    sp_parser_lev_t lev;
 } lexval_t;
 
 #define YYSTYPE lexval_t
@@ -118,6 +132,9 @@ typedef struct _sp_parser_hndl_t
     /* parsed input */
     SP_FILE *in;
 
+    /* parsing flags (SPAR_P_XXX) */
+    unsigned flags;
+
     struct {
         /* next char to read */
         int line;
@@ -127,6 +144,9 @@ typedef struct _sp_parser_hndl_t
         /* last input offset to parse; -1: end */
         long end;
 
+        /* if !=0: the input is directly accessible (see lex_run()) */
+        int direct;
+
         /* currently scope level (0-based) */
         int scope_lev;
 
@@ -144,6 +164,18 @@ typedef struct _sp_parser_hndl_t
         /* parser callbacks */
         sp_parser_cb_prop_t prop;
         sp_parser_cb_scope_t scope;
+
+        /* internal parser callbacks; used instead of the above if set */
+        sp_parser_cb_prop_int_t prop_int;
+        sp_parser_cb_scope_int_t scope_int;
+
+        /* path following mode callbacks (NULL if not used) */
+        sp_parser_cb_enter_t enter;
+        sp_parser_cb_leave_t leave;
+
+        /* path following mode: if !=0 elements of the currently
+           parsed scope body are reported */
+        int rep;
     } cb;
 
     struct {
@@ -151,10 +183,94 @@ typedef struct _sp_parser_hndl_t
         /* syntax error (SPEC_SYNTAX) detailed code and location */
         sp_synerr_t syn;
     } err;
+
+    struct {
+        /* grammar parser stacks allocator; NULL: the stacks are allocated
+           by alloca(3) (malloc(3) if not used) */
+        const sp_alloc_t *alloc;
+
+        /* if !=0 the stacks are allocated on the heap (by the allocator or
+           malloc(3)) */
+        int heap;
+
+        /* heap allocated parser stacks block (NULL if not allocated) and its
+           capacity (number of elements) */
+        char *blk;
+        long n;
+
+        /* parser context owning the stacks block (NULL if none); the block is
+           retained by the context after the parsing */
+        sp_parser_ctx_t *ctx;
+    } stk;
 } sp_parser_hndl_t;
 
+/* Initial size (number of elements) of the grammar parser stacks. The initial
+   stacks are placed on the parser function's stack frame. */
+#define YYINITDEPTH CONFIG_PARSER_INIT_DEPTH
+
+#if defined(YYSTACK_USE_ALLOCA) && YYSTACK_USE_ALLOCA
+# define __STK_USE_ALLOCA 1
+# ifdef __GNUC__
+#  define __STK_ALLOCA(sz) __builtin_alloca(sz)
+# elif defined(_MSC_VER)
+#  include <malloc.h>
+#  define __STK_ALLOCA(sz) _alloca(sz)
+# else
+#  include <alloca.h>
+#  define __STK_ALLOCA(sz) alloca(sz)
+# endif
+#else
+# define __STK_USE_ALLOCA 0
+# define __STK_ALLOCA(sz) NULL
+#endif
+
+/* parser stacks growing state */
+typedef struct _stk_grow_t
+{
+    long n;         /* new stacks size (number of elements) */
+    size_t sz;      /* size of the stacks block */
+    int heap;       /* if !=0 the block is heap allocated */
+
+    /* offsets of the stacks in the block */
+    size_t ss_off, vs_off, ls_off;
+
+    char *b;        /* the stacks block */
+} stk_grow_t;
+
+static int stk_grow_init(const sp_parser_hndl_t *p_hndl, stk_grow_t *p_sg,
+    long n, long max, size_t ss_esz, size_t vs_esz, size_t ls_esz);
+static char *stk_alloc(const sp_parser_hndl_t *p_hndl, size_t sz);
+static void stk_set(sp_parser_hndl_t *p_hndl, char *blk, long n);
+
+/* Grammar parser stacks growing (bison's yyoverflow() hook). The stacks are
+   relocated to a single block of doubled size allocated by the parser stacks
+   allocator, or by alloca(3) in the parser function's stack frame if the
+   allocator is not set. A larger stacks block retained by the parser context
+   is reused w/o allocation. If the stacks may not grow the parser fails with
+   the memory exhaustion. */
+#define yyoverflow(msg, p_ss, ss_sz, p_vs, vs_sz, p_ls, ls_sz, p_stsz) { \
+    stk_grow_t sg; \
+    if (stk_grow_init(p_hndl, &sg, *(p_stsz), YYMAXDEPTH, \
+        sizeof(**(p_ss)), sizeof(**(p_vs)), sizeof(**(p_ls)))) \
+    { \
+        if (!sg.b) sg.b = (sg.heap ? stk_alloc(p_hndl, sg.sz) : \
+            (char*)__STK_ALLOCA(sg.sz)); \
+        if (sg.b) { \
+            memcpy(sg.b+sg.ss_off, *(p_ss), (ss_sz)); \
+            memcpy(sg.b+sg.vs_off, *(p_vs), (vs_sz)); \
+            memcpy(sg.b+sg.ls_off, *(p_ls), (ls_sz)); \
+            *(p_ss) = (void*)(sg.b+sg.ss_off); \
+            *(p_vs) = (void*)(sg.b+sg.vs_off); \
+            *(p_ls) = (void*)(sg.b+sg.ls_off); \
+            *(p_stsz) = sg.n; \
+            if (sg.heap) stk_set(p_hndl, sg.b, sg.n); \
+        } \
+    } \
+    if (!sg.b) YYNOMEM; \
+}
 
-#line 158 "parser.c"
+
+#line 274 "parser.c"
 
 
 
@@ -231,7 +347,7 @@ struct YYLTYPE
 int yyparse (sp_parser_hndl_t *p_hndl);
 
 /* "%code provides" blocks.  */
-#line 105 "parser.y"
+#line 221 "parser.y"
 
 static int yylex(YYSTYPE*, YYLTYPE*, sp_parser_hndl_t*);
 static void yyerror(YYLTYPE*, sp_parser_hndl_t*, char const*);
@@ -247,12 +363,33 @@ static void set_loc(
     p_loc->last_column = p_lloc->last_column;
 }
 
+static void set_tkn_loc(sp_parser_tkn_loc_t *p_tloc,
+    const YYSTYPE *p_lval, const YYLTYPE *p_lloc)
+{
+    set_loc(&p_tloc->loc, p_lval, p_lloc);
+    p_tloc->esc = p_lval->esc;
+    p_tloc->hash = p_lval->hash;
+    p_tloc->hlen = p_lval->hlen;
+}
+
+/* Location of token 'p_tloc' (may be NULL) as passed to public callbacks */
+static const sp_loc_t *tkn_loc(const sp_parser_tkn_loc_t *p_tloc)
+{
+    return (p_tloc ? &p_tloc->loc : NULL);
+}
+
 /* temporary macros indented for use in actions
  */
+#define __IS_CB_PROP() (p_hndl->cb.prop || p_hndl->cb.prop_int)
+#define __IS_CB_SCOPE() (p_hndl->cb.scope || p_hndl->cb.scope_int)
+
 #define __CALL_CB_PROP(nm, val, def) { \
     long pos = sp_ftell(p_hndl->in); \
-    sp_errc_t res = p_hndl->cb.prop( \
-        p_hndl->cb.arg, p_hndl->in, (nm), (val), (def)); \
+    sp_errc_t res = (p_hndl->cb.prop_int ? \
+        p_hndl->cb.prop_int( \
+            p_hndl->cb.arg, p_hndl->in, (nm), (val), (def)) : \
+        p_hndl->cb.prop( \
+            p_hndl->cb.arg, p_hndl->in, &(nm)->loc, tkn_loc(val), (def))); \
     if (res==SPEC_SUCCESS && \
         (pos==-1L || sp_fseek(p_hndl->in, pos, SEEK_SET))) res=SPEC_ACCS_ERR; \
     if ((int)res>0) { p_hndl->err.code=res; YYABORT; } \
@@ -261,19 +398,66 @@ static void set_loc(
 
 #define __CALL_CB_SCOPE(typ, nm, bdy, bdyenc, def) { \
     long pos = sp_ftell(p_hndl->in); \
-    sp_errc_t res = p_hndl->cb.scope( \
-        p_hndl->cb.arg, p_hndl->in, (typ), (nm), (bdy), (bdyenc), (def)); \
+    sp_errc_t res = (p_hndl->cb.scope_int ? \
+        p_hndl->cb.scope_int(p_hndl->cb.arg, p_hndl->in, \
+            (typ), (nm), (bdy), (bdyenc), (def)) : \
+        p_hndl->cb.scope(p_hndl->cb.arg, p_hndl->in, \
+            tkn_loc(typ), &(nm)->loc, (bdy), (bdyenc), (def))); \
     if (res==SPEC_SUCCESS && \
         (pos==-1L || sp_fseek(p_hndl->in, pos, SEEK_SET))) res=SPEC_ACCS_ERR; \
     if ((int)res>0) { p_hndl->err.code=res; YYABORT; } \
     else if ((int)res<0) { YYACCEPT; } \
 }
 
+#define __CALL_CB_ENTER(typ, nm, plev) { \
+    long pos = sp_ftell(p_hndl->in); \
+    sp_errc_t res = p_hndl->cb.enter( \
+        p_hndl->cb.arg, p_hndl->in, (typ), (nm), (plev)); \
+    if (res==SPEC_SUCCESS && \
+        (pos==-1L || sp_fseek(p_hndl->in, pos, SEEK_SET))) res=SPEC_ACCS_ERR; \
+    if ((int)res>0) { p_hndl->err.code=res; YYABORT; } \
+    else if ((int)res<0) { YYACCEPT; } \
+}
+
+#define __CALL_CB_LEAVE(nm, plev) { \
+    long pos = sp_ftell(p_hndl->in); \
+    sp_errc_t res = p_hndl->cb.leave( \
+        p_hndl->cb.arg, p_hndl->in, (nm), (plev)); \
+    if (res==SPEC_SUCCESS && \
+        (pos==-1L || sp_fseek(p_hndl->in, pos, SEEK_SET))) res=SPEC_ACCS_ERR; \
+    if ((int)res>0) { p_hndl->err.code=res; YYABORT; } \
+    else if ((int)res<0) { YYACCEPT; } \
+}
+
+/* callbacks are called for 0-level elements only, unless configured otherwise;
+   in the path following mode for elements of descended scopes */
+#define __IS_CB_LEV(lev) (p_hndl->cb.enter ? p_hndl->cb.rep : \
+    (!(lev) || (p_hndl->flags & SPAR_P_ALL_LEV)))
+
+/* Scope body enter (to be used in a mid-rule action with its value 'lv'):
+   save the reporting flag of the enclosing body and set it for the entered
+   one */
+#define __SCOPE_ENTER(lv, typ, nm) { \
+    (lv).rep = p_hndl->cb.rep; \
+    (lv).lev.desc = 0; \
+    if (p_hndl->cb.enter && p_hndl->cb.rep) \
+        __CALL_CB_ENTER((typ), (nm), &(lv).lev); \
+    p_hndl->cb.rep = (lv).lev.desc; \
+}
+
+/* Scope body leave counterpart of __SCOPE_ENTER() */
+#define __SCOPE_LEAVE(lv, nm) { \
+    p_hndl->cb.rep = (lv).rep; \
+    if ((lv).lev.desc && p_hndl->cb.leave) __CALL_CB_LEAVE((nm), &(lv).lev); \
+}
+
 #define __IS_EMPTY(loc) ((loc).beg>(loc).end)
 #define __PREP_LOC_PTR(loc) (__IS_EMPTY(loc) ? (sp_loc_t*)NULL : &(loc))
+#define __PREP_TKN_PTR(tloc) \
+    (__IS_EMPTY((tloc).loc) ? (sp_parser_tkn_loc_t*)NULL : &(tloc))
 
 
-#line 277 "parser.c"
+#line 461 "parser.c"
 
 
 /* Symbol kind.  */
@@ -292,7 +476,9 @@ enum yysymbol_kind_t
   YYSYMBOL_YYACCEPT = 9,                   /* $accept  */
   YYSYMBOL_input = 10,                     /* input  */
   YYSYMBOL_scoped_props = 11,              /* scoped_props  */
-  YYSYMBOL_prop_scope = 12                 /* prop_scope  */
+  YYSYMBOL_prop_scope = 12,                /* prop_scope  */
+  YYSYMBOL_13_1 = 13,                      /* @1  */
+  YYSYMBOL_14_2 = 14                       /* @2  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -623,16 +809,16 @@ union yyalloc
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  9
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   14
+#define YYLAST   15
 
 /* YYNTOKENS -- Number of terminals.  */
 #define YYNTOKENS  9
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  4
+#define YYNNTS  6
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  11
+#define YYNRULES  13
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  19
+#define YYNSTATES  21
 
 /* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   259
@@ -681,8 +867,8 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   158,   158,   164,   168,   169,   181,   209,   224,   238,
-     263,   293
+       0,   342,   342,   348,   352,   353,   365,   394,   410,   426,
+     425,   462,   461,   504
 };
 #endif
 
@@ -700,7 +886,7 @@ static const char *const yytname[] =
 {
   "\"end of file\"", "error", "\"invalid token\"", "SP_TKN_ID",
   "SP_TKN_VAL", "'='", "';'", "'{'", "'}'", "$accept", "input",
-  "scoped_props", "prop_scope", YY_NULLPTR
+  "scoped_props", "prop_scope", "@1", "@2", YY_NULLPTR
 };
 
 static const char *
@@ -724,8 +910,9 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-       5,    -3,     9,     5,    -8,     0,     6,    -8,     5,    -8,
-      -8,    -8,     5,     7,     3,     4,    -8,    -8,    -8
+      -2,    -3,     9,    -2,    -8,    -1,     6,    -8,    -8,    -8,
+      -8,    -8,    -8,     5,    -2,    -2,    -8,     4,     7,    -8,
+      -8
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -733,20 +920,21 @@ static const yytype_int8 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       2,     0,     0,     3,     4,     0,     0,     8,     2,     1,
-       5,    11,     2,     6,     0,     0,     7,     9,    10
+       2,     0,     0,     3,     4,     0,     0,     8,     9,     1,
+       5,    13,    11,     6,     2,     2,     7,     0,     0,    10,
+      12
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-      -8,    -7,    -8,    11
+      -8,    -7,    -8,    10,    -8,    -8
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-       0,     2,     3,     4
+       0,     2,     3,     4,    14,    15
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -754,14 +942,14 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int8 yytable[] =
 {
-       5,    14,     6,     7,     8,    15,    11,    12,     1,     9,
-      13,    17,    18,    16,    10
+       5,     1,     6,     7,     8,    11,    12,    17,    18,     9,
+      13,    16,    19,    10,     0,    20
 };
 
 static const yytype_int8 yycheck[] =
 {
-       3,     8,     5,     6,     7,    12,     6,     7,     3,     0,
-       4,     8,     8,     6,     3
+       3,     3,     5,     6,     7,     6,     7,    14,    15,     0,
+       4,     6,     8,     3,    -1,     8
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -769,21 +957,22 @@ static const yytype_int8 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     3,    10,    11,    12,     3,     5,     6,     7,     0,
-      12,     6,     7,     4,    10,    10,     6,     8,     8
+      12,     6,     7,     4,    13,    14,     6,    10,    10,     8,
+       8
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,     9,    10,    10,    11,    11,    12,    12,    12,    12,
-      12,    12
+       0,     9,    10,    10,    11,    11,    12,    12,    12,    13,
+      12,    14,    12,    12
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     0,     1,     1,     2,     3,     4,     2,     4,
-       5,     3
+       0,     2,     0,     1,     1,     2,     3,     4,     2,     0,
+       5,     0,     6,     3
 };
 
 
@@ -1370,35 +1559,35 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* input: %empty  */
-#line 158 "parser.y"
+#line 342 "parser.y"
     {
         /* set to empty scope */
         yyval.end = 0;
         yyval.beg = yyval.end+1;
         yyval.scope_lev = 0;
     }
-#line 1381 "parser.c"
+#line 1570 "parser.c"
     break;
 
   case 5: /* scoped_props: scoped_props prop_scope  */
-#line 170 "parser.y"
+#line 354 "parser.y"
     {
         yyval.beg = yyvsp[-1].beg;
         yyval.end = yyvsp[0].end;
         yyval.scope_lev = yyvsp[-1].scope_lev;
     }
-#line 1391 "parser.c"
+#line 1580 "parser.c"
     break;
 
   case 6: /* prop_scope: SP_TKN_ID '=' SP_TKN_VAL  */
-#line 182 "parser.y"
+#line 366 "parser.y"
     {
-        sp_loc_t lval;
-        set_loc(&lval, &yyvsp[0], &(yylsp[0]));
+        sp_parser_tkn_loc_t lval;
+        set_tkn_loc(&lval, &yyvsp[0], &(yylsp[0]));
 
         yyval.beg = yyvsp[-2].beg;
         yyval.scope_lev = yyvsp[-2].scope_lev;
-        if (__IS_EMPTY(lval)) {
+        if (__IS_EMPTY(lval.loc)) {
             yyval.end = yyvsp[-1].end;
             (yyloc).last_line = (yylsp[-1]).last_line;
             (yyloc).last_column = (yylsp[-1]).last_column;
@@ -1408,122 +1597,158 @@ yyreduce:
             (yyloc).last_column = (yylsp[0]).last_column;
         }
 
-        if (p_hndl->cb.prop && !yyval.scope_lev) {
-            sp_loc_t lname, ldef;
-            set_loc(&lname, &yyvsp[-2], &(yylsp[-2]));
+        if (__IS_CB_PROP() && __IS_CB_LEV(yyval.scope_lev)) {
+            sp_parser_tkn_loc_t lname;
+            sp_loc_t ldef;
+            set_tkn_loc(&lname, &yyvsp[-2], &(yylsp[-2]));
             set_loc(&ldef, &yyval, &(yyloc));
-            __CALL_CB_PROP(&lname, __PREP_LOC_PTR(lval), &ldef);
+            __CALL_CB_PROP(&lname, __PREP_TKN_PTR(lval), &ldef);
         }
     }
-#line 1419 "parser.c"
+#line 1609 "parser.c"
     break;
 
   case 7: /* prop_scope: SP_TKN_ID '=' SP_TKN_VAL ';'  */
-#line 210 "parser.y"
+#line 395 "parser.y"
     {
         yyval.beg = yyvsp[-3].beg;
         yyval.end = yyvsp[0].end;
         yyval.scope_lev = yyvsp[-3].scope_lev;
 
-        if (p_hndl->cb.prop && !yyval.scope_lev) {
-            sp_loc_t lname, lval, ldef;
-            set_loc(&lname, &yyvsp[-3], &(yylsp[-3]));
-            set_loc(&lval, &yyvsp[-1], &(yylsp[-1]));
+        if (__IS_CB_PROP() && __IS_CB_LEV(yyval.scope_lev)) {
+            sp_parser_tkn_loc_t lname, lval;
+            sp_loc_t ldef;
+            set_tkn_loc(&lname, &yyvsp[-3], &(yylsp[-3]));
+            set_tkn_loc(&lval, &yyvsp[-1], &(yylsp[-1]));
             set_loc(&ldef, &yyval, &(yyloc));
-            __CALL_CB_PROP(&lname, __PREP_LOC_PTR(lval), &ldef);
+            __CALL_CB_PROP(&lname, __PREP_TKN_PTR(lval), &ldef);
         }
     }
-#line 1437 "parser.c"
+#line 1628 "parser.c"
     break;
 
   case 8: /* prop_scope: SP_TKN_ID ';'  */
-#line 225 "parser.y"
+#line 411 "parser.y"
     {
         yyval.beg = yyvsp[-1].beg;
         yyval.end = yyvsp[0].end;
         yyval.scope_lev = yyvsp[-1].scope_lev;
 
-        if (p_hndl->cb.prop && !yyval.scope_lev) {
-            sp_loc_t lname, ldef;
-            set_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
+        if (__IS_CB_PROP() && __IS_CB_LEV(yyval.scope_lev)) {
+            sp_parser_tkn_loc_t lname;
+            sp_loc_t ldef;
+            set_tkn_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
             set_loc(&ldef, &yyval, &(yyloc));
-            __CALL_CB_PROP(&lname, (sp_loc_t*)NULL, &ldef);
+            __CALL_CB_PROP(&lname, (sp_parser_tkn_loc_t*)NULL, &ldef);
         }
     }
-#line 1454 "parser.c"
+#line 1646 "parser.c"
     break;
 
-  case 9: /* prop_scope: SP_TKN_ID '{' input '}'  */
-#line 239 "parser.y"
+  case 9: /* @1: %empty  */
+#line 426 "parser.y"
     {
-        yyval.beg = yyvsp[-3].beg;
+        sp_parser_tkn_loc_t lname;
+        set_tkn_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
+        __SCOPE_ENTER(yyval, (sp_parser_tkn_loc_t*)NULL, &lname);
+    }
+#line 1656 "parser.c"
+    break;
+
+  case 10: /* prop_scope: SP_TKN_ID '{' @1 input '}'  */
+#line 432 "parser.y"
+    {
+        sp_parser_tkn_loc_t lname;
+
+        yyval.beg = yyvsp[-4].beg;
         yyval.end = yyvsp[0].end;
-        yyval.scope_lev = yyvsp[-3].scope_lev;
+        yyval.scope_lev = yyvsp[-4].scope_lev;
+
+        set_tkn_loc(&lname, &yyvsp[-4], &(yylsp[-4]));
+        __SCOPE_LEAVE(yyvsp[-2], &lname);
 
-        if (p_hndl->cb.scope && !yyval.scope_lev)
+        if (__IS_CB_SCOPE() && __IS_CB_LEV(yyval.scope_lev))
         {
-            sp_loc_t lname, lbody, lbdyenc, ldef;
+            sp_loc_t lbody, lbdyenc, ldef;
 
-            set_loc(&lname, &yyvsp[-3], &(yylsp[-3]));
             set_loc(&lbody, &yyvsp[-1], &(yylsp[-1]));
-            lbdyenc.beg = yyvsp[-2].beg;
+            lbdyenc.beg = yyvsp[-3].beg;
             lbdyenc.end = yyvsp[0].end;
-            lbdyenc.first_line = (yylsp[-2]).first_line;
-            lbdyenc.first_column = (yylsp[-2]).first_column;
+            lbdyenc.first_line = (yylsp[-3]).first_line;
+            lbdyenc.first_column = (yylsp[-3]).first_column;
             lbdyenc.last_line = (yylsp[0]).last_line;
             lbdyenc.last_column = (yylsp[0]).last_column;
             set_loc(&ldef, &yyval, &(yyloc));
 
             __CALL_CB_SCOPE(
-                (sp_loc_t*)NULL, &lname, __PREP_LOC_PTR(lbody), &lbdyenc, &ldef);
+                (sp_parser_tkn_loc_t*)NULL, &lname, __PREP_LOC_PTR(lbody),
+                &lbdyenc, &ldef);
         }
     }
-#line 1482 "parser.c"
+#line 1689 "parser.c"
     break;
 
-  case 10: /* prop_scope: SP_TKN_ID SP_TKN_ID '{' input '}'  */
-#line 264 "parser.y"
+  case 11: /* @2: %empty  */
+#line 462 "parser.y"
     {
-        yyval.beg = yyvsp[-4].beg;
+        sp_parser_tkn_loc_t ltype, lname;
+        set_tkn_loc(&ltype, &yyvsp[-2], &(yylsp[-2]));
+        set_tkn_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
+        __SCOPE_ENTER(yyval, &ltype, &lname);
+    }
+#line 1700 "parser.c"
+    break;
+
+  case 12: /* prop_scope: SP_TKN_ID SP_TKN_ID '{' @2 input '}'  */
+#line 469 "parser.y"
+    {
+        sp_parser_tkn_loc_t lname;
+
+        yyval.beg = yyvsp[-5].beg;
         yyval.end = yyvsp[0].end;
-        yyval.scope_lev = yyvsp[-4].scope_lev;
+        yyval.scope_lev = yyvsp[-5].scope_lev;
 
-        if (p_hndl->cb.scope && !yyval.scope_lev)
+        set_tkn_loc(&lname, &yyvsp[-4], &(yylsp[-4]));
+        __SCOPE_LEAVE(yyvsp[-2], &lname);
+
+        if (__IS_CB_SCOPE() && __IS_CB_LEV(yyval.scope_lev))
         {
-            sp_loc_t ltype, lname, lbody, lbdyenc, ldef;
+            sp_parser_tkn_loc_t ltype;
+            sp_loc_t lbody, lbdyenc, ldef;
 
-            set_loc(&ltype, &yyvsp[-4], &(yylsp[-4]));
-            set_loc(&lname, &yyvsp[-3], &(yylsp[-3]));
+            set_tkn_loc(&ltype, &yyvsp[-5], &(yylsp[-5]));
             set_loc(&lbody, &yyvsp[-1], &(yylsp[-1]));
-            lbdyenc.beg = yyvsp[-2].beg;
+            lbdyenc.beg = yyvsp[-3].beg;
             lbdyenc.end = yyvsp[0].end;
-            lbdyenc.first_line = (yylsp[-2]).first_line;
-            lbdyenc.first_column = (yylsp[-2]).first_column;
+            lbdyenc.first_line = (yylsp[-3]).first_line;
+            lbdyenc.first_column = (yylsp[-3]).first_column;
             lbdyenc.last_line = (yylsp[0]).last_line;
             lbdyenc.last_column = (yylsp[0]).last_column;
             set_loc(&ldef, &yyval, &(yyloc));
 
             __CALL_CB_SCOPE(
-                &ltype, &lname, __PREP_LOC_PTR(lbody), &lbdyenc, &ldef);
+                &ltype, &lname, __PREP_LOC_PTR(lbody), &lbdyenc,
+                &ldef);
         }
     }
-#line 1511 "parser.c"
+#line 1735 "parser.c"
     break;
 
-  case 11: /* prop_scope: SP_TKN_ID SP_TKN_ID ';'  */
-#line 294 "parser.y"
+  case 13: /* prop_scope: SP_TKN_ID SP_TKN_ID ';'  */
+#line 505 "parser.y"
     {
 #if !CONFIG_NO_EMPTY_SCOPE_ALT
         yyval.beg = yyvsp[-2].beg;
         yyval.end = yyvsp[0].end;
         yyval.scope_lev = yyvsp[-2].scope_lev;
 
-        if (p_hndl->cb.scope && !yyval.scope_lev)
+        if (__IS_CB_SCOPE() && __IS_CB_LEV(yyval.scope_lev))
         {
-            sp_loc_t ltype, lname, lbdyenc, ldef;
+            sp_parser_tkn_loc_t ltype, lname;
+            sp_loc_t lbdyenc, ldef;
 
-            set_loc(&ltype, &yyvsp[-2], &(yylsp[-2]));
-            set_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
+            set_tkn_loc(&ltype, &yyvsp[-2], &(yylsp[-2]));
+            set_tkn_loc(&lname, &yyvsp[-1], &(yylsp[-1]));
             set_loc(&lbdyenc, &yyvsp[0], &(yylsp[0]));
             set_loc(&ldef, &yyval, &(yyloc));
 
@@ -1539,11 +1764,11 @@ yyreduce:
         YYERROR;
 #endif
     }
-#line 1543 "parser.c"
+#line 1768 "parser.c"
     break;
 
 
-#line 1547 "parser.c"
+#line 1772 "parser.c"
 
       default: break;
     }
@@ -1741,13 +1966,21 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 323 "parser.y"
+#line 535 "parser.y"
 
 
+#undef __PREP_TKN_PTR
 #undef __PREP_LOC_PTR
 #undef __IS_EMPTY
+#undef __SCOPE_LEAVE
+#undef __SCOPE_ENTER
+#undef __IS_CB_LEV
+#undef __CALL_CB_LEAVE
+#undef __CALL_CB_ENTER
 #undef __CALL_CB_SCOPE
 #undef __CALL_CB_PROP
+#undef __IS_CB_SCOPE
+#undef __IS_CB_PROP
 
 /* Get character from the input (lexer) */
 static int lex_getc(sp_parser_hndl_t *p_hndl)
@@ -1775,6 +2008,34 @@ static int lex_getc(sp_parser_hndl_t *p_hndl)
     return c;
 }
 
+/* Lexer's fast path: get a run of chars not requiring the lexer's state
+   machine attention, directly from the stream content (if accessible). Chars
+   are scanned in a mode 'p_mode' up to the end of parsing. Return pointer
+   to the run and its length under 'p_num' (0 if no run is available).
+
+   NOTE: The run is not consumed by the function.
+ */
+static const char *lex_run(
+    sp_parser_hndl_t *p_hndl, const sp_scan_mode_t *p_mode, size_t *p_num)
+{
+    const char *buf = NULL;
+    long n_end;
+
+    *p_num = 0;
+
+    /* chars from the unget cache need to be read first */
+    if (!p_hndl->lex.unc.inbuf && (buf=sp_fpeek(p_hndl->in, p_num))!=NULL)
+    {
+        if (p_hndl->lex.end!=-1L) {
+            n_end = p_hndl->lex.end - p_hndl->lex.off + 1;
+            if (n_end <= 0) *p_num = 0;
+            else if ((long)*p_num > n_end) *p_num = (size_t)n_end;
+        }
+        *p_num = sp_scan_run(buf, *p_num, p_mode);
+    }
+    return buf;
+}
+
 /* Lexical scanner (lexer)
  */
 static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
@@ -1800,10 +2061,17 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
     } lex_state_t;
 
     long last_off;
-    int token=0, endloop=0, c, last_col, last_ln, escaped=0, quot_chr;
+    int token=0, endloop=0, c, last_col, last_ln, escaped=0, quot_chr=0;
+    const sp_scan_mode_t *p_smode;
+    const char *run;
+    size_t n_run, n_tail;
     lex_state_t state =
         (p_hndl->lex.ctx==LCTX_GLOBAL ? LXST_INIT : LXST_VAL_INIT);
 
+    p_lval->esc = 0;
+    p_lval->hash = SP_HASH_INIT;
+    p_lval->hlen = 0;
+
 #define __CHAR_TOKEN(t) \
     p_lloc->first_column = p_lloc->last_column = p_hndl->lex.col; \
     p_lloc->first_line = p_lloc->last_line = p_hndl->lex.line; \
@@ -1831,10 +2099,73 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
 
 #define __USE_ESC() \
     int esc = escaped; \
-    escaped = (!esc && c=='\\' ? 1 : 0);
+    escaped = (!esc && c=='\\' ? 1 : 0); \
+    if (escaped) p_lval->esc = 1;
 
-    while (!endloop && (c=lex_getc(p_hndl))!=EOF)
+/* SP_TKN_ID token content hashing */
+#define __HASH_CHR(c) \
+    SP_HASH_STEP(p_lval->hash, (c)); \
+    p_lval->hlen++;
+
+    while (!endloop)
     {
+        if (!p_hndl->lex.direct) {
+            p_smode = NULL;
+        } else
+        switch (state)
+        {
+        case LXST_COMMENT:
+            p_smode = &sp_scan_cmt;
+            break;
+        case LXST_ID:
+            p_smode = &sp_scan_id;
+            break;
+        case LXST_ID_QUOTED:
+            p_smode = (quot_chr=='"' ? &sp_scan_dq : &sp_scan_sq);
+            break;
+        case LXST_VAL:
+            p_smode = &sp_scan_val;
+            break;
+        default:
+            p_smode = NULL;
+            break;
+        }
+
+        if (p_smode && (run=lex_run(p_hndl, p_smode, &n_run))!=NULL && n_run)
+        {
+            /* consume the run of chars; for the token states the chars are
+               not escaped and update the token's tail (as the state machine
+               would do for them) */
+            if (state!=LXST_COMMENT)
+            {
+                escaped = 0;
+                n_tail = n_run;
+                if (state!=LXST_VAL) {
+                    const char *r;
+                    for (r=run; r<run+n_run; r++) { __HASH_CHR(*r); }
+                }
+#if CONFIG_TRIM_VAL_TRAILING_SPACES
+                if (state==LXST_VAL) {
+                    while (n_tail &&
+                        (sp_cctab[run[n_tail-1] & 0xff] & SP_CC_SPACE))
+                    {
+                        n_tail--;
+                    }
+                }
+#endif
+                if (n_tail) {
+                    last_off = p_hndl->lex.off + (long)n_tail-1;
+                    last_col = p_hndl->lex.col + (int)n_tail-1;
+                    last_ln = p_hndl->lex.line;
+                }
+            }
+            p_hndl->lex.off += (long)n_run;
+            p_hndl->lex.col += (int)n_run;
+            sp_fskip(p_hndl->in, n_run);
+        }
+
+        if ((c=lex_getc(p_hndl))==EOF) break;
+
         switch (state)
         {
         case LXST_INIT:
@@ -1851,6 +2182,7 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
                     quot_chr = c;
                     state = LXST_ID_QUOTED;
                 } else {
+                    __HASH_CHR(c);
                     state = LXST_ID;
                 }
             } else {
@@ -1880,6 +2212,7 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
                     token = YYERRCODE;
                 } else {
                     __MCHAR_UPDATE_TAIL();
+                    __HASH_CHR(c);
                 }
             }
             break;
@@ -1900,6 +2233,8 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
                 if (c==quot_chr && !esc) {
                     __MCHAR_TOKEN_END();
                     endloop=1;
+                } else {
+                    __HASH_CHR(c);
                 }
             }
             break;
@@ -1983,16 +2318,20 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
         } else
         if (token==SP_TKN_ID || token==SP_TKN_VAL) {
             /* EOF finishes SP_TKN_ID/SP_TKN_VAL tokens, except quoted
-               SP_TKN_ID which need to be finished by the quotation mark */
+               SP_TKN_ID which need to be finished by the quotation mark
+               (the token's end is set for the empty token check below) */
+            __MCHAR_TOKEN_END();
             if (state==LXST_ID_QUOTED) {
                 p_hndl->err.syn.code = SPSYN_UNEXP_EOF;
                 token = YYERRCODE;
-            } else {
-                __MCHAR_TOKEN_END();
             }
         }
     }
 
+    /* the hash is not available for escaped tokens (de-escaping is not
+       performed during scanning) */
+    if (token!=SP_TKN_ID || p_lval->esc) p_lval->hlen = -1;
+
     /* scope level update */
     p_lval->scope_lev = p_hndl->lex.scope_lev;
     if (token=='{') {
@@ -2032,6 +2371,7 @@ static int yylex(YYSTYPE *p_lval, YYLTYPE *p_lloc, sp_parser_hndl_t *p_hndl)
 
     return token;
 
+#undef __HASH_CHR
 #undef __USE_ESC
 #undef __MCHAR_TOKEN_END
 #undef __MCHAR_UPDATE_TAIL
@@ -2068,11 +2408,13 @@ static sp_errc_t sp_parser_hndl_init(sp_parser_hndl_t *p_hndl,
     }
 
     p_hndl->in = in;
+    p_hndl->flags = 0;
 
     p_hndl->lex.line = p_parsc->first_line;
     p_hndl->lex.col = p_parsc->first_column;
     p_hndl->lex.off = p_parsc->beg;
     p_hndl->lex.end = p_parsc->end;
+    p_hndl->lex.direct = sp_fdirect(in);
     p_hndl->lex.scope_lev = 0;
     p_hndl->lex.ctx = LCTX_GLOBAL;
     unc_clean(&p_hndl->lex.unc);
@@ -2080,12 +2422,23 @@ static sp_errc_t sp_parser_hndl_init(sp_parser_hndl_t *p_hndl,
     p_hndl->cb.arg = arg;
     p_hndl->cb.prop = cb_prop;
     p_hndl->cb.scope = cb_scope;
+    p_hndl->cb.prop_int = NULL;
+    p_hndl->cb.scope_int = NULL;
+    p_hndl->cb.enter = NULL;
+    p_hndl->cb.leave = NULL;
+    p_hndl->cb.rep = 1;
 
     p_hndl->err.code = SPEC_SUCCESS;
     p_hndl->err.syn.code = SPSYN_GRAMMAR;   /* default syntax error code */
     p_hndl->err.syn.loc.line = 0;
     p_hndl->err.syn.loc.col = 0;
 
+    p_hndl->stk.alloc = NULL;
+    p_hndl->stk.heap = !__STK_USE_ALLOCA;
+    p_hndl->stk.blk = NULL;
+    p_hndl->stk.n = 0;
+    p_hndl->stk.ctx = NULL;
+
 finish:
     return ret;
 }
@@ -2095,32 +2448,244 @@ sp_errc_t sp_parse(
     SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
     sp_parser_cb_scope_t cb_scope, void *arg, sp_synerr_t *p_synerr)
 {
-    sp_errc_t ret=SPEC_SUCCESS;
-    sp_parser_hndl_t hndl;
+    return sp_parse_alloc(in, p_parsc, cb_prop, cb_scope, arg, NULL, p_synerr);
+}
 
-    EXEC_RG(sp_parser_hndl_init(&hndl, in, p_parsc, cb_prop, cb_scope, arg));
+/* parser stacks block alignment */
+typedef union _stk_align_t
+{
+    long l;
+    double d;
+    void *p;
+} stk_align_t;
+
+#define __STK_ALIGN(sz) \
+    (((sz)+sizeof(stk_align_t)-1) & ~(sizeof(stk_align_t)-1))
+
+/* Prepare growing of the parser stacks of 'n' elements (up to 'max') with
+   elements sizes 'ss_esz', 'vs_esz', 'ls_esz'. Return 0 if the stacks may not
+   be grown. If the currently set heap stacks block is large enough, it is
+   provided for reuse in 'p_sg->b'.
+ */
+static int stk_grow_init(const sp_parser_hndl_t *p_hndl, stk_grow_t *p_sg,
+    long n, long max, size_t ss_esz, size_t vs_esz, size_t ls_esz)
+{
+    p_sg->b = NULL;
+    p_sg->heap = p_hndl->stk.heap;
 
-    switch (yyparse(&hndl))
+    if (n >= max) return 0;
+    p_sg->n = (n > max/2 ? max : n*2);
+
+    /* the stacks are currently placed on the parser function's stack frame
+       if the set block is larger */
+    if (p_hndl->stk.n >= p_sg->n) {
+        p_sg->n = p_hndl->stk.n;
+        p_sg->b = p_hndl->stk.blk;
+    }
+
+    /* the values stack first for its most restrictive alignment */
+    p_sg->vs_off = 0;
+    p_sg->ls_off = __STK_ALIGN(p_sg->vs_off + (size_t)p_sg->n*vs_esz);
+    p_sg->ss_off = __STK_ALIGN(p_sg->ls_off + (size_t)p_sg->n*ls_esz);
+    p_sg->sz = p_sg->ss_off + (size_t)p_sg->n*ss_esz;
+    return 1;
+}
+
+/* Allocate heap parser stacks block of 'sz' bytes */
+static char *stk_alloc(const sp_parser_hndl_t *p_hndl, size_t sz)
+{
+    const sp_alloc_t *alloc = p_hndl->stk.alloc;
+    return (char*)(alloc ? alloc->alloc(alloc->ctx, sz) : malloc(sz));
+}
+
+/* Set heap parser stacks block 'blk' of 'n' elements capacity; the previous
+   block is freed */
+static void stk_set(sp_parser_hndl_t *p_hndl, char *blk, long n)
+{
+    const sp_alloc_t *alloc = p_hndl->stk.alloc;
+
+    if (p_hndl->stk.blk && p_hndl->stk.blk!=blk) {
+        if (alloc) alloc->free(alloc->ctx, p_hndl->stk.blk);
+        else free(p_hndl->stk.blk);
+    }
+    p_hndl->stk.blk = blk;
+    p_hndl->stk.n = (blk ? n : 0);
+}
+
+/* Run the parser for initialized handle 'p_hndl' */
+static sp_errc_t run_parser(sp_parser_hndl_t *p_hndl, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret;
+    int res = yyparse(p_hndl);
+
+    if (p_hndl->stk.ctx) {
+        /* the stacks block is retained by the context */
+        p_hndl->stk.ctx->stk = p_hndl->stk.blk;
+        p_hndl->stk.ctx->stk_n = p_hndl->stk.n;
+        p_hndl->stk.ctx->busy = 0;
+    } else {
+        stk_set(p_hndl, NULL, 0);
+    }
+
+    switch (res)
     {
     case 0:
-        ret = hndl.err.code = SPEC_SUCCESS;
+        ret = p_hndl->err.code = SPEC_SUCCESS;
         break;
     default:
     case 1:
-        if (hndl.err.code==SPEC_SUCCESS) {
+        if (p_hndl->err.code==SPEC_SUCCESS) {
             /* probably will not happen */
-            ret = hndl.err.code = SPEC_SYNTAX;
+            ret = p_hndl->err.code = SPEC_SYNTAX;
         } else {
-            ret = hndl.err.code;
+            ret = p_hndl->err.code;
         }
         break;
     case 2:
-        ret = hndl.err.code = SPEC_NOMEM;
+        ret = p_hndl->err.code = SPEC_NOMEM;
         break;
     }
 
+    if (ret==SPEC_SYNTAX && p_synerr) *p_synerr=p_hndl->err.syn;
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_alloc(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, const sp_alloc_t *alloc,
+    sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_parser_hndl_t hndl;
+
+    if (alloc && (!alloc->alloc || !alloc->free)) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    EXEC_RG(sp_parser_hndl_init(&hndl, in, p_parsc, cb_prop, cb_scope, arg));
+    if (alloc) {
+        hndl.stk.alloc = alloc;
+        hndl.stk.heap = 1;
+    }
+
+    ret = run_parser(&hndl, p_synerr);
+finish:
+    return ret;
+}
+
+/* Set parser context 'p_ctx' for the parsing handle 'p_hndl' */
+static void hndl_set_ctx(sp_parser_hndl_t *p_hndl, sp_parser_ctx_t *p_ctx)
+{
+    p_hndl->stk.alloc = p_ctx->alloc;
+
+    if (!p_ctx->busy) {
+        /* the context's stacks are used (and retained) by the parsing */
+        p_ctx->busy = 1;
+        p_hndl->stk.heap = 1;
+        p_hndl->stk.blk = (char*)p_ctx->stk;
+        p_hndl->stk.n = p_ctx->stk_n;
+        p_hndl->stk.ctx = p_ctx;
+    } else
+    if (p_ctx->alloc) {
+        /* nested parsing with the busy context; own stacks are used */
+        p_hndl->stk.heap = 1;
+    }
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parser_ctx_init(sp_parser_ctx_t *p_ctx, const sp_alloc_t *alloc)
+{
+    if (!p_ctx || (alloc && (!alloc->alloc || !alloc->free)))
+        return SPEC_INV_ARG;
+
+    p_ctx->alloc = alloc;
+    p_ctx->stk = NULL;
+    p_ctx->stk_n = 0;
+    p_ctx->busy = 0;
+    return SPEC_SUCCESS;
+}
+
+/* exported; see header for details */
+void sp_parser_ctx_free(sp_parser_ctx_t *p_ctx)
+{
+    if (!p_ctx || !p_ctx->stk) return;
+
+    if (p_ctx->alloc) p_ctx->alloc->free(p_ctx->alloc->ctx, p_ctx->stk);
+    else free(p_ctx->stk);
+
+    p_ctx->stk = NULL;
+    p_ctx->stk_n = 0;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_ex(sp_parser_ctx_t *p_ctx,
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_parser_cb_prop_t cb_prop,
+    sp_parser_cb_scope_t cb_scope, void *arg, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_parser_hndl_t hndl;
+
+    if (!p_ctx) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    EXEC_RG(sp_parser_hndl_init(&hndl, in, p_parsc, cb_prop, cb_scope, arg));
+    hndl_set_ctx(&hndl, p_ctx);
+
+    ret = run_parser(&hndl, p_synerr);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_fsetpctx(SP_FILE *f, sp_parser_ctx_t *p_ctx)
+{
+    if (!f) return SPEC_INV_ARG;
+
+    f->pctx = p_ctx;
+    return SPEC_SUCCESS;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_int(SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_parser_cb_prop_int_t cb_prop, sp_parser_cb_scope_int_t cb_scope,
+    void *arg, unsigned pflags, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_parser_hndl_t hndl;
+
+    EXEC_RG(sp_parser_hndl_init(&hndl, in, p_parsc, NULL, NULL, arg));
+    hndl.cb.prop_int = cb_prop;
+    hndl.cb.scope_int = cb_scope;
+    hndl.flags = pflags;
+
+    ret = run_parser(&hndl, p_synerr);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parse_path(sp_parser_ctx_t *p_ctx,
+    SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_parser_cb_prop_int_t cb_prop, sp_parser_cb_scope_int_t cb_scope,
+    sp_parser_cb_enter_t cb_enter, sp_parser_cb_leave_t cb_leave, void *arg,
+    sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_parser_hndl_t hndl;
+
+    EXEC_RG(sp_parser_hndl_init(&hndl, in, p_parsc, NULL, NULL, arg));
+    hndl.cb.prop_int = cb_prop;
+    hndl.cb.scope_int = cb_scope;
+    hndl.cb.enter = cb_enter;
+    hndl.cb.leave = cb_leave;
+    if (p_ctx) hndl_set_ctx(&hndl, p_ctx);
+
+    ret = run_parser(&hndl, p_synerr);
 finish:
-    if (ret==SPEC_SYNTAX && p_synerr) *p_synerr=hndl.err.syn;
     return ret;
 }
 
@@ -2324,14 +2889,52 @@ reread:
     return c;
 }
 
-/* exported; see header for details */
-sp_errc_t sp_parser_tkn_cpy(SP_FILE *in, sp_parser_token_t tkn,
-    const sp_loc_t *p_loc, char *buf, size_t buf_len, long *p_tklen)
+/* Get view of a token (see sp_parser_tkn_view()). 'esc' specifies whether
+   the token contains escaped chars (if <0: not known, the token is scanned).
+ */
+static const char *tkn_view(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, int esc, size_t *p_len)
+{
+    const char *tkn_b;
+    size_t n;
+    long llen=sp_loc_len(p_loc);
+
+    if (llen<=0) {
+        *p_len = 0;
+        return "";
+    }
+
+    if (esc>0 || !(tkn_b=sp_fview(in, p_loc->beg, &n)) || n<(size_t)llen)
+        return NULL;
+    n = (size_t)llen;
+
+    /* NULL char is treated as EOF by the stream reading routines, so such
+       token is not viewed to let sp_parser_tkn_cpy() handle it as usual */
+    if (esc<0 && (memchr(tkn_b, '\\', n) || memchr(tkn_b, 0, n)))
+        return NULL;
+
+    if (tkn==SP_TKN_ID && (*tkn_b=='"' || *tkn_b=='\''))
+    {
+        /* strip quotation marks; the closing one must be the last char */
+        if (n<2 || tkn_b[n-1]!=*tkn_b || memchr(tkn_b+1, *tkn_b, n-2))
+            return NULL;
+        tkn_b++;
+        n -= 2;
+    }
+
+    *p_len = n;
+    return tkn_b;
+}
+
+/* Copy a token. 'esc' as for tkn_view(). */
+static sp_errc_t tkn_cpy(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, int esc, char *buf, size_t buf_len, long *p_tklen)
 {
     sp_errc_t ret=SPEC_ACCS_ERR;
     int c=0;
-    size_t i=0;
+    size_t i=0, n;
     hndl_eschr_t eh_tkn;
+    const char *tkn_b;
     long llen=sp_loc_len(p_loc);
 
     if (p_tklen) *p_tklen=0;
@@ -2340,6 +2943,19 @@ sp_errc_t sp_parser_tkn_cpy(SP_FILE *in, sp_parser_token_t tkn,
         goto finish;
     }
 
+    /* tokens not needing de-escaping are copied directly from the stream
+       content (if accessible) */
+    if ((tkn_b=tkn_view(in, tkn, p_loc, esc, &n))!=NULL)
+    {
+        if (p_tklen) *p_tklen=(long)n;
+        i = (n<buf_len ? n : buf_len);
+        memcpy(buf, tkn_b, i);
+        buf_len -= i;
+
+        ret=SPEC_SUCCESS;
+        goto finish;
+    }
+
     if (sp_fseek(in, p_loc->beg, SEEK_SET)) goto finish;
 
     init_hndl_eschr_stream(&eh_tkn, in, tkn);
@@ -2366,6 +2982,29 @@ finish:
     return ret;
 }
 
+/* exported; see header for details */
+sp_errc_t sp_parser_tkn_cpy(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, char *buf, size_t buf_len, long *p_tklen)
+{
+    return tkn_cpy(in, tkn, p_loc, -1, buf, buf_len, p_tklen);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parser_tkn_cpy_int(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_parser_tkn_loc_t *p_tloc, char *buf, size_t buf_len,
+    long *p_tklen)
+{
+    return tkn_cpy(in, tkn, (p_tloc ? &p_tloc->loc : NULL),
+        (p_tloc ? p_tloc->esc : 0), buf, buf_len, p_tklen);
+}
+
+/* exported; see header for details */
+const char *sp_parser_tkn_view(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, size_t *p_len)
+{
+    return tkn_view(in, tkn, p_loc, -1, p_len);
+}
+
 /* exported; see header for details */
 sp_errc_t sp_parser_tkn_cmp(SP_FILE *in, sp_parser_token_t tkn,
     const sp_loc_t *p_loc, const char *str, size_t num, int stresc, int *p_equ)
@@ -2420,6 +3059,128 @@ finish:
 #undef __CHK_STREAM
 }
 
+/* exported; see header for details */
+sp_errc_t sp_parser_tkn_cmp_int(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_parser_tkn_loc_t *p_tloc, const char *str, size_t num,
+    int stresc, unsigned long hash, long hlen, int *p_equ)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const sp_loc_t *p_loc = (p_tloc ? &p_tloc->loc : NULL);
+    const char *tkn_b;
+    size_t n;
+
+    if (p_tloc && tkn==SP_TKN_ID && hlen>=0 && p_tloc->hlen>=0)
+    {
+        if (p_tloc->hlen!=hlen || p_tloc->hash!=hash) {
+            if (p_equ) *p_equ=0;
+            goto finish;
+        }
+
+        /* hashes match; not escaped string may be compared directly
+           with the token's view */
+        if (!stresc && (tkn_b=tkn_view(in, tkn, p_loc, 0, &n))!=NULL) {
+            if (p_equ) *p_equ=(n==(size_t)hlen && !memcmp(tkn_b, str, n));
+            goto finish;
+        }
+    }
+
+    ret = sp_parser_tkn_cmp(in, tkn, p_loc, str, num, stresc, p_equ);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parser_tkn_hash(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, unsigned long *p_hash, long *p_len)
+{
+    sp_errc_t ret=SPEC_ACCS_ERR;
+    int c=0;
+    hndl_eschr_t eh_tkn;
+    unsigned long hash=SP_HASH_INIT;
+    long len=0, llen=sp_loc_len(p_loc);
+
+    if (!llen) {
+        ret=SPEC_SUCCESS;
+        goto finish;
+    }
+
+    if (sp_fseek(in, p_loc->beg, SEEK_SET)) goto finish;
+
+    init_hndl_eschr_stream(&eh_tkn, in, tkn);
+
+    while (eh_tkn.n_rdc<(size_t)llen)
+    {
+        if ((c=esc_getc(&eh_tkn))==EOF || eh_tkn.n_rdc>(size_t)llen)
+            break;
+
+        if (eh_tkn.quot_chr>=0 && c==eh_tkn.quot_chr && !eh_tkn.escaped) {
+            eh_tkn.quot_chr = -1;
+        } else {
+            SP_HASH_STEP(hash, c);
+            len++;
+        }
+    }
+    if (c!=EOF || eh_tkn.n_rdc>=(size_t)llen) ret=SPEC_SUCCESS;
+
+finish:
+    if (ret==SPEC_SUCCESS) {
+        if (p_hash) *p_hash=hash;
+        if (p_len) *p_len=len;
+    }
+    return ret;
+}
+
+/* exported; see header for details */
+void sp_parser_str_hash(const char *str, size_t num, int stresc,
+    sp_parser_token_t tkn, unsigned long *p_hash, long *p_len)
+{
+    int c;
+    hndl_eschr_t eh_str;
+    unsigned long hash=SP_HASH_INIT;
+    long len=0;
+
+    init_hndl_eschr_string(&eh_str, str, num, tkn);
+
+    while ((c=(stresc ? esc_getc(&eh_str) : noesc_getc(&eh_str)))!=EOF) {
+        SP_HASH_STEP(hash, c);
+        len++;
+    }
+
+    if (p_hash) *p_hash=hash;
+    if (p_len) *p_len=len;
+}
+
+/* exported; see header for details */
+int sp_parser_str_equ(const char *str, size_t num, int stresc,
+    sp_parser_token_t tkn, const char *buf, size_t len)
+{
+    int c;
+    size_t i=0;
+    hndl_eschr_t eh_str;
+
+    init_hndl_eschr_string(&eh_str, str, num, tkn);
+
+    while ((c=(stresc ? esc_getc(&eh_str) : noesc_getc(&eh_str)))!=EOF) {
+        if (i>=len || c!=((int)buf[i] & 0xff)) return 0;
+        i++;
+    }
+    return (i==len);
+}
+
+/* exported; see header for details */
+size_t sp_parser_str_unesc(
+    const char *str, size_t num, sp_parser_token_t tkn, char *buf)
+{
+    int c;
+    size_t len=0;
+    hndl_eschr_t eh_str;
+
+    init_hndl_eschr_string(&eh_str, str, num, tkn);
+
+    while ((c=esc_getc(&eh_str))!=EOF) buf[len++]=(char)c;
+    return len;
+}
+
 /* exported; see header for details */
 sp_errc_t sp_parser_tokenize_str(
     SP_FILE *out, sp_parser_token_t tkn, const char *str, unsigned cv_flags)
@@ -0,0 +1,219 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Content of this header is not a part of the library API interface.
+   It rather defines internal use (private) extensions of the low level parser
+   interface. Public part of this interface is defined in the parser.h header.
+ */
+
+#ifndef __SP_PARSER_INT_H__
+#define __SP_PARSER_INT_H__
+
+#include "sprops/parser.h"
+
+/* Tokens hashing (32-bit FNV-1a) of de-escaped tokens content */
+#define SP_HASH_INIT        2166136261UL
+#define SP_HASH_STEP(h, c) \
+    ((h) = (((h) ^ ((unsigned long)(c) & 0xff)) * 16777619UL) & 0xffffffffUL)
+
+/* Token location as reported by the parser to the internal parser callbacks
+   (see sp_parser_cb_prop_int_t), along with the lexer's info about the token.
+ */
+typedef struct _sp_parser_tkn_loc_t
+{
+    sp_loc_t loc;
+
+    /* if !=0: the token contains backslash escaped chars */
+    int esc;
+
+    /* SP_TKN_ID only: hash and length of the token content as calculated by
+       sp_parser_tkn_hash(), provided by the lexer w/o a need to read the token
+       again; 'hlen'<0 if not available (escaped token or other token type) */
+    unsigned long hash;
+    long hlen;
+} sp_parser_tkn_loc_t;
+
+/* Internal counterparts of sp_parser_cb_prop_t and sp_parser_cb_scope_t.
+   Locations of tokens (scope types and names, property names and values) are
+   provided along with the lexer's info about them.
+ */
+typedef sp_errc_t (*sp_parser_cb_prop_int_t)(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef);
+
+typedef sp_errc_t (*sp_parser_cb_scope_int_t)(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc,
+    const sp_loc_t *p_ldef);
+
+/* sp_parse_int() flags */
+
+/* Call parser callbacks for elements on all scope levels (not only
+   the 0-level ones). Elements are reported in order of their grammar
+   reductions, that is nested elements of a scope are reported before
+   the scope itself.
+ */
+#define SPAR_P_ALL_LEV      0x01U
+
+/* sp_parse() analogous with the internal parser callbacks and additional
+   flags 'pflags' (SPAR_P_XXX) tuning the parsing process.
+ */
+sp_errc_t sp_parse_int(SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_parser_cb_prop_int_t cb_prop, sp_parser_cb_scope_int_t cb_scope,
+    void *arg, unsigned pflags, sp_synerr_t *p_synerr);
+
+/* Validation-only syntax check of an input 'in' with a parsing scope
+   'p_parsc' (see sp_check_syntax()). The input is scanned by a minimal state
+   machine mirroring the lexer and the grammar, w/o the grammar parser
+   overhead. Streams w/o the direct access (see sp_fdirect()) are checked by
+   the grammar parser.
+ */
+sp_errc_t sp_parse_check(
+    SP_FILE *in, const sp_loc_t *p_parsc, sp_synerr_t *p_synerr);
+
+/* Chunk job callback of sp_parse_chunks(). The callback processes (parses)
+   a chunk of the input located at 'p_chunk' by a parsing thread number
+   'thread'. 'in' is the thread's copy of the input handle. The chunk's result
+   may be passed under 'p_res' to the chunks collection callback. In case of
+   the syntax error 'p_synerr' shall be filled with the error related info.
+   Return codes are interpreted as for the parser callbacks.
+ */
+typedef sp_errc_t (*sp_parser_cb_chunk_t)(void *arg, SP_FILE *in, int thread,
+    const sp_loc_t *p_chunk, void **p_res, sp_synerr_t *p_synerr);
+
+/* Chunks collection callback of sp_parse_chunks(). Called by the calling
+   thread for results 'res' of successfully processed chunks in order of the
+   chunks in the input, and for results (if provided) of the first failed
+   chunk before its error is returned. If 'discard'!=0 the result shall be
+   discarded only (freed), since the processing has been stopped. Return
+   codes are interpreted as for the parser callbacks.
+ */
+typedef sp_errc_t (*sp_parser_cb_collect_t)(void *arg, void *res, int discard);
+
+/* Get number of threads worth to be used by sp_parse_chunks() for parsing an
+   input 'in' with a parsing scope 'p_parsc' by 'n_threads' threads (<=0: the
+   number of online CPUs). 1 is returned if the input may not be parsed in
+   parallel (not a memory based stream, the parallel parsing is not configured
+   or the input is too short).
+ */
+int sp_parse_chunks_nthr(SP_FILE *in, const sp_loc_t *p_parsc, int n_threads);
+
+/* Split an input 'in' with a parsing scope 'p_parsc' into chunks of 0-level
+   elements and process them by 'cb_chunk' called by 'n_threads' parsing
+   threads (see sp_parse_chunks_nthr()). The chunks results are collected by
+   'cb_collect' (may be NULL). The processing stops on the first failed chunk
+   (in order of the chunks in the input), whose error is returned. 'arg' is
+   passed untouched to the callbacks.
+ */
+sp_errc_t sp_parse_chunks(SP_FILE *in, const sp_loc_t *p_parsc,
+    int n_threads, sp_parser_cb_chunk_t cb_chunk,
+    sp_parser_cb_collect_t cb_collect, void *arg, sp_synerr_t *p_synerr);
+
+/* Scope level state kept by the parser on its stack for a scope whose body
+   is being parsed in the path following mode (see sp_parse_path()).
+ */
+typedef struct _sp_parser_lev_t
+{
+    /* if !=0: the scope body is descended, that is elements of the body are
+       reported to the parser callbacks; set by the enter callback */
+    int desc;
+
+    /* enclosing scope state saved by the enter callback and restored by the
+       leave one; the content is not interpreted by the parser */
+    const char *path;
+    int sind;
+    int ind;
+} sp_parser_lev_t;
+
+/* Scope body enter callback. Called after an opening bracket of a scope
+   with a body, if the scope itself is a subject of reporting. The callback
+   decides whether to descend into the scope body by setting 'p_lev->desc'.
+   Return codes are interpreted as for the scope callback.
+ */
+typedef sp_errc_t (*sp_parser_cb_enter_t)(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    sp_parser_lev_t *p_lev);
+
+/* Scope body leave callback. Called for descended scopes after their closing
+   bracket, just before the scope callback for the scope.
+ */
+typedef sp_errc_t (*sp_parser_cb_leave_t)(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_lev_t *p_lev);
+
+/* sp_parse() analogous with the internal parser callbacks working in the path
+   following mode. Apart of 0-level elements, the parser reports also elements
+   of scopes descended by the 'cb_enter' callback (recursively) during the
+   single parsing pass. Nested elements are reported before their enclosing
+   scope. There is no need to re-parse bodies of followed scopes. 'p_synerr'
+   (may be NULL) is filled as for sp_parse().
+
+   The parsing is performed with a parser context 'p_ctx' as by sp_parse_ex()
+   (if NULL: as by sp_parse()). W/o 'cb_enter' and 'cb_leave' callbacks the
+   function reports 0-level elements only, as sp_parse() does.
+ */
+sp_errc_t sp_parse_path(sp_parser_ctx_t *p_ctx,
+    SP_FILE *in, const sp_loc_t *p_parsc,
+    sp_parser_cb_prop_int_t cb_prop, sp_parser_cb_scope_int_t cb_scope,
+    sp_parser_cb_enter_t cb_enter, sp_parser_cb_leave_t cb_leave, void *arg,
+    sp_synerr_t *p_synerr);
+
+/* sp_parser_tkn_cpy() analogous for token location 'p_tloc' as reported by
+   the internal parser callbacks (may be NULL as for the public counterpart).
+   Contrary to the public counterpart there is no need to scan the token for
+   escaped chars since the info is provided by the lexer.
+ */
+sp_errc_t sp_parser_tkn_cpy_int(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_parser_tkn_loc_t *p_tloc, char *buf, size_t buf_len,
+    long *p_tklen);
+
+/* sp_parser_tkn_cmp() analogous for token location 'p_tloc' as reported by
+   the internal parser callbacks (may be NULL as for the public counterpart).
+   'hash' and 'hlen' specify the compared string's hash and length as
+   calculated by sp_parser_str_hash() ('hlen'<0 if not provided). If both the
+   token and the string hashes are available, tokens not matching the string
+   are rejected w/o reading the stream.
+ */
+sp_errc_t sp_parser_tkn_cmp_int(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_parser_tkn_loc_t *p_tloc, const char *str, size_t num,
+    int stresc, unsigned long hash, long hlen, int *p_equ);
+
+/* Calculate hash of a de-escaped token of type 'tkn' from location 'p_loc'.
+   The hash is written under 'p_hash', the de-escaped token's length under
+   'p_len'.
+ */
+sp_errc_t sp_parser_tkn_hash(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, unsigned long *p_hash, long *p_len);
+
+/* sp_parser_tkn_hash() counterpart for a string 'str' with maximum 'num'
+   chars. If 'stresc'!=0 the string may contain backslash escaped chars.
+   For equal strings and tokens (as for sp_parser_tkn_cmp()) the calculated
+   hashes and lengths are the same.
+ */
+void sp_parser_str_hash(const char *str, size_t num, int stresc,
+    sp_parser_token_t tkn, unsigned long *p_hash, long *p_len);
+
+/* Check if string 'str' with maximum 'num' chars (if 'stresc'!=0 the string
+   may contain backslash escaped chars) is equal to de-escaped content of
+   a token of type 'tkn' provided in buffer 'buf' of length 'len'. Return !=0
+   if equal.
+ */
+int sp_parser_str_equ(const char *str, size_t num, int stresc,
+    sp_parser_token_t tkn, const char *buf, size_t len);
+
+/* De-escape string 'str' with maximum 'num' chars as for a token of type
+   'tkn'. The result (not NULL terminated) is written to 'buf' which must be
+   at least of the string length. Return length of the de-escaped string.
+ */
+size_t sp_parser_str_unesc(
+    const char *str, size_t num, sp_parser_token_t tkn, char *buf);
+
+#endif  /* __SP_PARSER_INT_H__ */
@@ -11,11 +11,13 @@
  */
 
 #include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "config.h"
 #include "io.h"
-#include "sprops/parser.h"
+#include "parser_int.h"
+#include "props_int.h"
 #include "sprops/utils.h"
 
 /* path separators markers */
@@ -31,11 +33,14 @@
 #define CHK_FSEEK(c) if ((c)!=0) { ret=SPEC_ACCS_ERR; goto finish; }
 #define CHK_FERR(c) if ((c)==EOF) { ret=SPEC_ACCS_ERR; goto finish; }
 
+/* location of a token reported by the parser callbacks (may be NULL) */
+#define TKN_LOC(p_tloc) ((p_tloc) ? &(p_tloc)->loc : (const sp_loc_t*)NULL)
+
 /* to be used inside parser callbacks only */
-#define CMPLOC_RG(in, tkn, loc, str, len, esc) { \
+#define CMPLOC_RG(in, tkn, tloc, str, len, esc, hash, hlen) { \
     int equ=0; \
-    ret = (sp_errc_t)sp_parser_tkn_cmp( \
-        (in), (tkn), (loc), (str), (len), (esc), &equ); \
+    ret = (sp_errc_t)sp_parser_tkn_cmp_int( \
+        (in), (tkn), (tloc), (str), (len), (esc), (hash), (hlen), &equ); \
     if (ret!=SPEC_SUCCESS) goto finish; \
     if (!equ) goto finish; \
 }
@@ -44,8 +49,7 @@
 sp_errc_t sp_check_syntax(
     SP_FILE *in, const sp_loc_t *p_parsc, sp_synerr_t *p_synerr)
 {
-    return (!in ? SPEC_INV_ARG :
-        sp_parse(in, p_parsc, NULL, NULL, NULL, p_synerr));
+    return sp_parse_check(in, p_parsc, p_synerr);
 }
 
 /* Search for the first/last non-escaped occurrence of char 'c' in string 'str'
@@ -75,11 +79,18 @@ static const char *strchr_nesc(const char *str, size_t len, int c, int last)
     return ret;
 }
 
+/* Path being followed.
+
+   NOTE: For compiled paths 'beg' and 'end' are not pointers to the path
+   string but to the compiled path's strings buffer, with the offset equal to
+   the segment index (see path_seg()).
+ */
 typedef struct _path_t
 {
     const char *beg;        /* start pointer */
     const char *end;        /* end pointer (exclusive) */
     const char *deftp;      /* default scope type */
+    const sp_path_t *cp;    /* compiled path; NULL: string path */
 } path_t;
 
 typedef struct _lastsc_t
@@ -111,18 +122,30 @@ typedef struct _base_hndl_t
     /* destination scope path (not propagated) */
     path_t path;
 
+    /* scope whose body has been just followed by the parser in the path
+       following mode (see follow_cb_enter(), follow_cb_leave()) */
+    struct {
+        long nm_beg;        /* scope name offset; -1: not set */
+        const char *path;   /* path position inside the followed scope */
+        int ind;            /* scope index from the path */
+    } fsc;
+
     /* parser callbacks (const) */
     struct {
-        sp_parser_cb_prop_t prop;
-        sp_parser_cb_scope_t scope;
+        sp_parser_cb_prop_int_t prop;
+        sp_parser_cb_scope_int_t scope;
     } parser_cb;
+
+    /* parser context of the parsed stream (const); NULL if not set */
+    sp_parser_ctx_t *pctx;
 } base_hndl_t;
 
-/* Initialize base_hndl_t struct.
+/* Initialize base_hndl_t struct for parsing the input 'in'.
  */
-static void init_base_hndl(base_hndl_t *p_b, int *p_finish,
+static void init_base_hndl(base_hndl_t *p_b, SP_FILE *in, int *p_finish,
     lastsc_t *p_lsc, int *p_sind, const char *path, const char *deftp,
-    sp_parser_cb_prop_t parser_cb_prop, sp_parser_cb_scope_t parser_cb_scope)
+    const sp_path_t *cpath, sp_parser_cb_prop_int_t parser_cb_prop,
+    sp_parser_cb_scope_int_t parser_cb_scope)
 {
     p_b->p_finish = p_finish;
     *p_finish = 0;
@@ -133,13 +156,24 @@ static void init_base_hndl(base_hndl_t *p_b, int *p_finish,
     p_b->p_sind = p_sind;
     *p_sind = -1;
 
-    p_b->path.beg = path;
-    p_b->path.end = (!path ? NULL : p_b->path.beg+strlen(path));
-    if (p_b->path.beg && *p_b->path.beg==C_SEP_SCP) p_b->path.beg++;
-    p_b->path.deftp = deftp;
+    if (cpath) {
+        p_b->path.beg = cpath->buf;
+        p_b->path.end = cpath->buf + cpath->n_segs;
+        p_b->path.deftp = NULL;
+    } else {
+        p_b->path.beg = path;
+        p_b->path.end = (!path ? NULL : p_b->path.beg+strlen(path));
+        if (p_b->path.beg && *p_b->path.beg==C_SEP_SCP) p_b->path.beg++;
+        p_b->path.deftp = deftp;
+    }
+    p_b->path.cp = cpath;
+
+    p_b->fsc.nm_beg = -1;
 
     p_b->parser_cb.prop = parser_cb_prop;
     p_b->parser_cb.scope = parser_cb_scope;
+
+    p_b->pctx = (in ? in->pctx : NULL);
 }
 
 /* sp_iterate() handle
@@ -223,24 +257,12 @@ finish:
     return ret;
 }
 
-/* Follow requested path up to the destination scope.
-
-   The function accepts a clone of the enclosing scope handle pointed by
-   'ph_nst' which is then updated (actually its base part pointed by 'ph_nstb'),
-   to represent the nesting scope. The nesting scope is followed if its
-   characteristic meets scope criteria provided in the path).
- */
-static sp_errc_t follow_scope_path(
-    SP_FILE *in, base_hndl_t *ph_nstb, void *ph_nst, const sp_loc_t *p_ltype,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lbody, const sp_loc_t *p_ldef)
+/* exported; see header for details */
+sp_errc_t sp_path_seg(
+    const char *beg, const char *end, const char *deftp, sp_pathseg_t *p_seg)
 {
     sp_errc_t ret=SPEC_SUCCESS;
-
-    int ind, *p_sind=ph_nstb->p_sind;
-    size_t typ_len=0, nm_len=0, ind_len;
-    const char *type=NULL, *name=NULL;
-    const path_t *p_path = &ph_nstb->path;
-    const char *beg=p_path->beg, *end=p_path->end;
+    size_t ind_len;
     const char *typ=strchr_nesc(beg, end-beg, C_SEP_TYP, 0);
     const char *scp=strchr_nesc(beg, end-beg, C_SEP_SCP, 0);
 
@@ -250,27 +272,207 @@ static sp_errc_t follow_scope_path(
     if (typ)
     {
         /* type and name specified */
-        type = beg;
-        typ_len = typ-beg;
-        name = typ+1;
-        nm_len = end-name;
+        p_seg->type = beg;
+        p_seg->typ_len = typ-beg;
+        p_seg->typ_esc = 1;
+        p_seg->name = typ+1;
+        p_seg->nm_len = end-p_seg->name;
+        p_seg->nm_esc = 1;
     } else
     {
         /* scope with default type */
-        type = p_path->deftp;
-        typ_len = (type ? strlen(type) : 0);
-        name = beg;
-        nm_len = end-beg;
+        p_seg->type = deftp;
+        p_seg->typ_len = (deftp ? strlen(deftp) : 0);
+        p_seg->typ_esc = 0;
+        p_seg->name = beg;
+        p_seg->nm_len = end-beg;
+        p_seg->nm_esc = 1;
+    }
+    p_seg->next = (!*end ? end : end+1);
+
+    if (!p_seg->nm_len) { ret=SPEC_INV_PATH; goto finish; }
+
+    EXEC_RG(get_ind_from_name(
+        p_seg->name, p_seg->nm_len, &p_seg->ind, &ind_len));
+    if (!(p_seg->nm_len-=ind_len)) { ret=SPEC_INV_PATH; goto finish; }
+
+    /* if not specified, SP_IND_ALL is assumed */
+    if (!ind_len) p_seg->ind=SP_IND_ALL;
+
+    sp_parser_str_hash(p_seg->type, p_seg->typ_len, p_seg->typ_esc,
+        SP_TKN_ID, &p_seg->typ_hash, &p_seg->typ_hlen);
+    sp_parser_str_hash(p_seg->name, p_seg->nm_len, p_seg->nm_esc,
+        SP_TKN_ID, &p_seg->nm_hash, &p_seg->nm_hlen);
+
+finish:
+    return ret;
+}
+
+/* Get the segment of path 'p_path' at its current position. */
+static sp_errc_t path_seg(const path_t *p_path, sp_pathseg_t *p_seg)
+{
+    const sp_path_seg_t *p_cs;
+
+    if (!p_path->cp)
+        return sp_path_seg(p_path->beg, p_path->end, p_path->deftp, p_seg);
+
+    p_cs = &p_path->cp->segs[p_path->beg - p_path->cp->buf];
+
+    p_seg->type = p_cs->type;
+    p_seg->typ_len = p_cs->typ_len;
+    p_seg->typ_esc = p_cs->typ_esc;
+    p_seg->name = p_cs->name;
+    p_seg->nm_len = p_cs->nm_len;
+    p_seg->nm_esc = p_cs->nm_esc;
+    p_seg->ind = p_cs->ind;
+    p_seg->next = p_path->beg+1;
+
+    /* escaped strings of compiled segments contain NULL chars, which are
+       never matched by hashed tokens; hashes are not used for them */
+    p_seg->typ_hash = p_cs->typ_hash;
+    p_seg->typ_hlen = (p_cs->typ_esc ? -1L : (long)p_cs->typ_len);
+    p_seg->nm_hash = p_cs->nm_hash;
+    p_seg->nm_hlen = (p_cs->nm_esc ? -1L : (long)p_cs->nm_len);
+
+    return SPEC_SUCCESS;
+}
+
+/* De-escape string 'str' of length 'len' into 'buf' (NULL terminated) as
+   a compiled path segment string. If the de-escaped string contains NULL
+   char (not possible to be compared as not escaped), the string is copied
+   as is. Return pointer past the written string.
+ */
+static char *path_seg_str(const char *str, size_t len, int esc,
+    char *buf, const char **p_str, size_t *p_len, int *p_esc,
+    unsigned long *p_hash)
+{
+    long hlen;
+    size_t n = (esc ? sp_parser_str_unesc(str, len, SP_TKN_ID, buf) : 0);
+
+    if (!esc || memchr(buf, 0, n)) {
+        if (len) memcpy(buf, str, len);
+        n = len;
+    } else
+        esc = 0;
+
+    buf[n] = 0;
+    *p_str = buf;
+    *p_len = n;
+    *p_esc = esc;
+    sp_parser_str_hash(buf, n, esc, SP_TKN_ID, p_hash, &hlen);
+
+    return buf+n+1;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_path_compile(
+    const char *path, const char *deftp, sp_path_t *p_path)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_pathseg_t seg;
+    path_t pth;
+    size_t sz=0;
+    char *buf;
+    int i;
+
+    if (!p_path) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+    memset(p_path, 0, sizeof(*p_path));
+
+    pth.beg = path;
+    pth.end = (!path ? NULL : path+strlen(path));
+    if (pth.beg && *pth.beg==C_SEP_SCP) pth.beg++;
+    pth.deftp = deftp;
+    pth.cp = NULL;
+
+    /* count segments and their strings size (the size is not lower than
+       2 chars per segment, as required for path positions) */
+    for (; pth.beg < pth.end; pth.beg=seg.next) {
+        EXEC_RG(sp_path_seg(pth.beg, pth.end, pth.deftp, &seg));
+        sz += seg.typ_len + seg.nm_len + 2;
+        p_path->n_segs++;
+    }
+    if (!p_path->n_segs) goto finish;
+
+    if (!(p_path->segs = (sp_path_seg_t*)malloc(
+        p_path->n_segs*sizeof(sp_path_seg_t) + sz + 1)))
+    {
+        p_path->n_segs = 0;
+        ret=SPEC_NOMEM;
+        goto finish;
+    }
+    buf = p_path->buf = (char*)&p_path->segs[p_path->n_segs];
+
+    pth.beg = path + (*path==C_SEP_SCP ? 1 : 0);
+    for (i=0; i < p_path->n_segs; i++, pth.beg=seg.next)
+    {
+        sp_path_seg_t *p_cs = &p_path->segs[i];
+
+        sp_path_seg(pth.beg, pth.end, pth.deftp, &seg);
+
+        buf = path_seg_str(seg.type, seg.typ_len, seg.typ_esc, buf,
+            &p_cs->type, &p_cs->typ_len, &p_cs->typ_esc, &p_cs->typ_hash);
+        buf = path_seg_str(seg.name, seg.nm_len, seg.nm_esc, buf,
+            &p_cs->name, &p_cs->nm_len, &p_cs->nm_esc, &p_cs->nm_hash);
+        p_cs->ind = seg.ind;
     }
 
-    if (!nm_len) { ret=SPEC_INV_PATH; goto finish; }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void sp_path_free(sp_path_t *p_path)
+{
+    if (!p_path) return;
+
+    if (p_path->segs) free(p_path->segs);
+    memset(p_path, 0, sizeof(*p_path));
+}
+
+/* Follow requested path up to the destination scope.
+
+   The function accepts a clone of the enclosing scope handle pointed by
+   'ph_nst' which is then updated (actually its base part pointed by 'ph_nstb'),
+   to represent the nesting scope. The nesting scope is followed if its
+   characteristic meets scope criteria provided in the path).
+ */
+static sp_errc_t follow_scope_path(
+    SP_FILE *in, base_hndl_t *ph_nstb, void *ph_nst,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    int ind, *p_sind=ph_nstb->p_sind;
+    sp_pathseg_t seg;
+    const path_t *p_path = &ph_nstb->path;
+
+    if (ph_nstb->fsc.nm_beg==p_lname->loc.beg)
+    {
+        /* the scope body has been already followed by the parser (path
+           following mode); the tracking index is already updated */
+        ph_nstb->fsc.nm_beg = -1;
+        ph_nstb->path.beg = ph_nstb->fsc.path;
+
+        if (ph_nstb->fsc.ind!=SP_IND_ALL &&
+            ph_nstb->path.beg>=ph_nstb->path.end)
+        {
+            /* see below */
+            *ph_nstb->p_finish = 1;
+        }
+        goto finish;
+    }
 
-    EXEC_RG(get_ind_from_name(name, nm_len, &ind, &ind_len));
-    if (!(nm_len-=ind_len)) { ret=SPEC_INV_PATH; goto finish; }
-    if (!ind_len) ind=SP_IND_ALL;  /* if not specified, SP_IND_ALL is assumed */
+    EXEC_RG(path_seg(p_path, &seg));
+    ind = seg.ind;
 
-    CMPLOC_RG(in, SP_TKN_ID, p_ltype, type, typ_len, (p_path->deftp!=type));
-    CMPLOC_RG(in, SP_TKN_ID, p_lname, name, nm_len, 1);
+    CMPLOC_RG(in, SP_TKN_ID, p_ltype,
+        seg.type, seg.typ_len, seg.typ_esc, seg.typ_hash, seg.typ_hlen);
+    CMPLOC_RG(in, SP_TKN_ID, p_lname,
+        seg.name, seg.nm_len, seg.nm_esc, seg.nm_hash, seg.nm_hlen);
 
     /* scope with matching name found */
 
@@ -283,7 +485,7 @@ static sp_errc_t follow_scope_path(
     {
         /* for last scope spec. simply track the scope */
         ph_nstb->p_lsc->present = 1;
-        ph_nstb->p_lsc->beg = (!*end ? end : end+1);
+        ph_nstb->p_lsc->beg = seg.next;
         if (p_lbody) {
             ph_nstb->p_lsc->lbody = *p_lbody;
         } else {
@@ -295,7 +497,7 @@ static sp_errc_t follow_scope_path(
     if (ind==SP_IND_ALL || *p_sind==ind)
     {
         /* follow the path for matching index */
-        ph_nstb->path.beg = (!*end ? end : end+1);
+        ph_nstb->path.beg = seg.next;
 
         if (p_lbody)
         {
@@ -310,8 +512,9 @@ static sp_errc_t follow_scope_path(
                (before the scope callback call, which in turn calls
                follow_scope_path()).
              */
-            EXEC_RG(sp_parse(in, p_lbody, ph_nstb->parser_cb.prop,
-                ph_nstb->parser_cb.scope, ph_nst, NULL));
+            EXEC_RG(sp_parse_path(ph_nstb->pctx, in, p_lbody,
+                ph_nstb->parser_cb.prop, ph_nstb->parser_cb.scope, NULL, NULL,
+                ph_nst, NULL));
         }
 
         if (ind!=SP_IND_ALL && ph_nstb->path.beg>=ph_nstb->path.end)
@@ -333,6 +536,87 @@ finish:
     return ret;
 }
 
+/* Path following mode (sp_parse_path()) scope body enter callback.
+
+   The callback decides to descend into the scope body on the same conditions
+   as follow_scope_path() does for re-parsing it. In this case the handle
+   passed by 'arg' is updated to represent the entered scope and its previous
+   state is saved under 'p_lev'. Not descended scopes (including last scope
+   specs.) are handled by follow_scope_path() as usual.
+ */
+static sp_errc_t follow_cb_enter(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    sp_parser_lev_t *p_lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_hndl_t *p_b=(base_hndl_t*)arg;
+    sp_pathseg_t seg;
+
+    /* scopes inside the destination scope are not followed */
+    if (p_b->path.beg >= p_b->path.end) goto finish;
+
+    EXEC_RG(path_seg(&p_b->path, &seg));
+
+    if (seg.ind!=SP_IND_ALL &&
+        (seg.ind==SP_IND_LAST || *p_b->p_sind+1!=seg.ind)) goto finish;
+
+    CMPLOC_RG(in, SP_TKN_ID, p_ltype,
+        seg.type, seg.typ_len, seg.typ_esc, seg.typ_hash, seg.typ_hlen);
+    CMPLOC_RG(in, SP_TKN_ID, p_lname,
+        seg.name, seg.nm_len, seg.nm_esc, seg.nm_hash, seg.nm_hlen);
+
+    /* scope with matching name and index found; descend into its body */
+    p_lev->desc = 1;
+    p_lev->path = p_b->path.beg;
+    p_lev->ind = seg.ind;
+
+    if (seg.ind!=SP_IND_ALL) {
+        /* start tracking in the followed scope */
+        p_lev->sind = seg.ind;
+        *p_b->p_sind = -1;
+    }
+    p_b->path.beg = seg.next;
+
+finish:
+    return ret;
+}
+
+static sp_errc_t parse_lsc(SP_FILE *in, base_hndl_t *p_b, void *hndl);
+
+/* Path following mode (sp_parse_path()) scope body leave callback.
+
+   If the left scope has been addressed by an explicit index, the last scope
+   spec. tracked inside it is resolved immediately, since no other part of the
+   scope may provide further candidates. The processing finishes afterwards.
+ */
+static sp_errc_t follow_cb_leave(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_lev_t *p_lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_hndl_t *p_b=(base_hndl_t*)arg;
+
+    if (p_lev->ind!=SP_IND_ALL && p_b->p_lsc->present)
+    {
+        EXEC_RG(parse_lsc(in, p_b, arg));
+
+        *p_b->p_finish = 1;
+        ret = SPEC_CB_FINISH;
+        goto finish;
+    }
+
+    /* pass the followed scope to follow_scope_path() */
+    p_b->fsc.nm_beg = p_lname->loc.beg;
+    p_b->fsc.path = p_b->path.beg;
+    p_b->fsc.ind = p_lev->ind;
+
+    /* restore the enclosing scope state */
+    p_b->path.beg = p_lev->path;
+    if (p_lev->ind!=SP_IND_ALL) *p_b->p_sind = p_lev->sind;
+
+finish:
+    return ret;
+}
+
 /* Call follow_scope_path() for cloned nested scope handle 'hndl' and check
    the finish flag afterward. To be used inside scope parser callbacks only.
  */
@@ -351,7 +635,8 @@ finish:
 
 /* sp_iterate() parser callback: property */
 static sp_errc_t iter_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     iter_hndl_t *p_ihndl = (iter_hndl_t*)arg;
@@ -361,13 +646,13 @@ static sp_errc_t iter_cb_prop(void *arg, SP_FILE *in,
     {
         sp_tkn_info_t tkname, tkval;
 
-        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID,
+        EXEC_RG(sp_parser_tkn_cpy_int(in, SP_TKN_ID,
             p_lname, p_ihndl->buf1.ptr, p_ihndl->buf1.sz, &tkname.len));
-        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_VAL,
+        EXEC_RG(sp_parser_tkn_cpy_int(in, SP_TKN_VAL,
             p_lval, p_ihndl->buf2.ptr, p_ihndl->buf2.sz, &tkval.len));
 
-        tkname.loc = *p_lname;
-        if (p_lval) tkval.loc = *p_lval;
+        tkname.loc = p_lname->loc;
+        if (p_lval) tkval.loc = p_lval->loc;
 
         ret = p_ihndl->cb.prop(p_ihndl->cb.arg, in, p_ihndl->buf1.ptr,
             &tkname, p_ihndl->buf2.ptr, (p_lval ? &tkval : NULL), p_ldef);
@@ -380,8 +665,8 @@ finish:
 
 /* sp_iterate() parser callback: scope */
 static sp_errc_t iter_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     iter_hndl_t *p_ihndl=(iter_hndl_t*)arg;
@@ -394,13 +679,13 @@ static sp_errc_t iter_cb_scope(void *arg, SP_FILE *in,
     {
         sp_tkn_info_t tktype, tkname;
 
-        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID,
+        EXEC_RG(sp_parser_tkn_cpy_int(in, SP_TKN_ID,
             p_ltype, p_ihndl->buf1.ptr, p_ihndl->buf1.sz, &tktype.len));
-        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_ID,
+        EXEC_RG(sp_parser_tkn_cpy_int(in, SP_TKN_ID,
             p_lname, p_ihndl->buf2.ptr, p_ihndl->buf2.sz, &tkname.len));
 
-        if (p_ltype) tktype.loc = *p_ltype;
-        tkname.loc = *p_lname;
+        if (p_ltype) tktype.loc = p_ltype->loc;
+        tkname.loc = p_lname->loc;
 
         ret = p_ihndl->cb.scope(p_ihndl->cb.arg, in,
             p_ihndl->buf1.ptr, (p_ltype ? &tktype : NULL),
@@ -414,45 +699,62 @@ finish:
 
 #undef __CHK_USER_CB_RET
 
-/* Start parsing basing on the input 'in' with 'p_parsc' parsing scope. If
-   the destination scope has not been reached due to the last scope addressing
-   usage, start the re-parsing process until the destination will be finally
-   reached.
+/* If the destination scope has not been reached due to the last scope
+   addressing usage, descend into the body of the tracked last scope. The
+   function is called at the end of the scope enclosing the last scope
+   candidates, that is at the end of parsing or while leaving a scope
+   addressed by an explicit index (see follow_cb_leave()).
+
+   Only the location of the last candidate's body is tracked while parsing
+   (see follow_scope_path()), therefore the body is parsed again, once per
+   last scope spec. on the path.
  */
-static sp_errc_t parse_with_lsc_handling(
-    SP_FILE *in, const sp_loc_t *p_parsc, base_hndl_t *p_b, void *hndl)
+static sp_errc_t parse_lsc(SP_FILE *in, base_hndl_t *p_b, void *hndl)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     sp_loc_t lsc_bdy;
-    const sp_loc_t *p_psc=p_parsc;
 
-    for (;;)
+    while (p_b->p_lsc->present && !*p_b->p_finish)
     {
-        EXEC_RG(sp_parse(
-            in, p_psc, p_b->parser_cb.prop, p_b->parser_cb.scope, hndl, NULL));
-
-        if (p_b->p_lsc->present && !*p_b->p_finish)
-        {
-            /* last scope spec. detected; need to re-parse the last scope */
+        /* last scope spec. detected; need to re-parse the last scope */
 
-            if (!p_b->p_lsc->lbody.first_column) {
-                /* empty scope; skip further processing */
-                break;
-            }
+        if (!p_b->p_lsc->lbody.first_column) {
+            /* empty scope; skip further processing */
+            break;
+        }
 
-            p_b->path.beg = p_b->p_lsc->beg;
-            lsc_bdy = p_b->p_lsc->lbody;
-            memset(p_b->p_lsc, 0, sizeof(*p_b->p_lsc));
-            *p_b->p_sind = -1;
+        p_b->path.beg = p_b->p_lsc->beg;
+        lsc_bdy = p_b->p_lsc->lbody;
+        memset(p_b->p_lsc, 0, sizeof(*p_b->p_lsc));
+        *p_b->p_sind = -1;
+        p_b->fsc.nm_beg = -1;
 
-            p_psc = &lsc_bdy;
-        } else break;
+        EXEC_RG(sp_parse_path(p_b->pctx, in, &lsc_bdy, p_b->parser_cb.prop,
+            p_b->parser_cb.scope, follow_cb_enter, follow_cb_leave, hndl,
+            NULL));
     }
 
 finish:
     return ret;
 }
 
+/* Start parsing basing on the input 'in' with 'p_parsc' parsing scope. If
+   the destination scope has not been reached due to the last scope addressing
+   usage, descend into the last scope (see parse_lsc()).
+ */
+static sp_errc_t parse_with_lsc_handling(
+    SP_FILE *in, const sp_loc_t *p_parsc, base_hndl_t *p_b, void *hndl)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    EXEC_RG(sp_parse_path(p_b->pctx, in, p_parsc, p_b->parser_cb.prop,
+        p_b->parser_cb.scope, follow_cb_enter, follow_cb_leave, hndl, NULL));
+    ret = parse_lsc(in, p_b, hndl);
+
+finish:
+    return ret;
+}
+
 #define __BASE_DEFS \
     /* processing finish flag */ \
     int f_finish; \
@@ -461,10 +763,13 @@ finish:
     /* split scope tracking index */ \
     int sind;
 
-/* exported; see header for details */
-sp_errc_t sp_iterate(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
-    const char *deftp, sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope,
-    void *arg, char *buf1, size_t b1len, char *buf2, size_t b2len)
+/* Iterate elements under string path 'path' and 'deftp' or compiled path
+   'cpath' (if not NULL); support funct. for sp_iterate(), sp_iterate_p().
+ */
+static sp_errc_t iterate(SP_FILE *in, const sp_loc_t *p_parsc,
+    const char *path, const char *deftp, const sp_path_t *cpath,
+    sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope, void *arg, char *buf1,
+    size_t b1len, char *buf2, size_t b2len)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     iter_hndl_t ihndl;
@@ -478,8 +783,8 @@ sp_errc_t sp_iterate(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
 
     memset(&ihndl, 0, sizeof(ihndl));
 
-    init_base_hndl(&ihndl.b,
-        &f_finish, &lsc, &sind, path, deftp, iter_cb_prop, iter_cb_scope);
+    init_base_hndl(&ihndl.b, in, &f_finish, &lsc, &sind,
+        path, deftp, cpath, iter_cb_prop, iter_cb_scope);
 
     ihndl.cb.arg = arg;
     ihndl.cb.prop = cb_prop;
@@ -502,10 +807,32 @@ finish:
     return ret;
 }
 
+/* exported; see header for details */
+sp_errc_t sp_iterate(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
+    const char *deftp, sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope,
+    void *arg, char *buf1, size_t b1len, char *buf2, size_t b2len)
+{
+    return iterate(in, p_parsc, path, deftp, NULL,
+        cb_prop, cb_scope, arg, buf1, b1len, buf2, b2len);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_iterate_p(SP_FILE *in, const sp_loc_t *p_parsc,
+    const sp_path_t *path, sp_cb_prop_t cb_prop, sp_cb_scope_t cb_scope,
+    void *arg, char *buf1, size_t b1len, char *buf2, size_t b2len)
+{
+    return iterate(in, p_parsc, NULL, NULL, path,
+        cb_prop, cb_scope, arg, buf1, b1len, buf2, b2len);
+}
+
 typedef struct _prop_dsc_t
 {
     const char *name;
     int ind;
+
+    /* name length and hash (see sp_parser_str_hash()) */
+    size_t nm_len;
+    unsigned long nm_hash;
 } prop_dsc_t;
 
 typedef struct _scope_dsc_t
@@ -513,9 +840,52 @@ typedef struct _scope_dsc_t
     const char *type;
     const char *name;
     int ind;
+
+    /* type and name lengths and hashes (see sp_parser_str_hash()) */
+    size_t typ_len;
+    unsigned long typ_hash;
+    size_t nm_len;
+    unsigned long nm_hash;
 } scope_dsc_t;
 
-/* sp_get_prop() handle
+/* Initialize property desc. 'p_dsc' */
+static void init_prop_dsc(prop_dsc_t *p_dsc, const char *name, int ind)
+{
+    p_dsc->name = name;
+    p_dsc->ind = ind;
+
+    p_dsc->nm_len = strlen(name);
+    sp_parser_str_hash(
+        name, p_dsc->nm_len, 0, SP_TKN_ID, &p_dsc->nm_hash, NULL);
+}
+
+/* Initialize scope desc. 'p_dsc' */
+static void init_scope_dsc(
+    scope_dsc_t *p_dsc, const char *type, const char *name, int ind)
+{
+    p_dsc->type = type;
+    p_dsc->name = name;
+    p_dsc->ind = ind;
+
+    p_dsc->typ_len = (type ? strlen(type) : 0);
+    sp_parser_str_hash(
+        type, p_dsc->typ_len, 0, SP_TKN_ID, &p_dsc->typ_hash, NULL);
+    p_dsc->nm_len = strlen(name);
+    sp_parser_str_hash(
+        name, p_dsc->nm_len, 0, SP_TKN_ID, &p_dsc->nm_hash, NULL);
+}
+
+/* Compare a token with the property/scope desc. name or type (to be used
+   inside parser callbacks only) */
+#define CMPLOC_NM_RG(in, loc, dsc) \
+    CMPLOC_RG((in), SP_TKN_ID, (loc), \
+        (dsc).name, (dsc).nm_len, 0, (dsc).nm_hash, (long)(dsc).nm_len)
+
+#define CMPLOC_TYP_RG(in, loc, dsc) \
+    CMPLOC_RG((in), SP_TKN_ID, (loc), \
+        (dsc).type, (dsc).typ_len, 0, (dsc).typ_hash, (long)(dsc).typ_len)
+
+/* sp_get_props() handle
 
    NOTE: This struct is copied during upward-downward process of following
    the destination scope path.
@@ -524,79 +894,94 @@ typedef struct _getprp_hndl_t
 {
     base_hndl_t b;
 
-    /* property desc. (const) */
-    prop_dsc_t prop;
+    /* property requests (shared) */
+    sp_prop_req_t *reqs;
+    int n_reqs;
 
-    /* matched props tracking index (shared) */
-    int *p_eind;
+    /* number of pending requests; processing is finished if zeroed (shared) */
+    int *p_n_pend;
 
     /* element position number tracking index (shared) */
     int *p_neind;
-
-    /* property value buffer (const) */
-    struct {
-        char *ptr;
-        size_t sz;
-    } val;
-
-    /* extra info will be written under this address (shared) */
-    sp_prop_info_ex_t *p_info;
 } getprp_hndl_t;
 
-/* sp_get_prop() parser callback: property */
+/* sp_get_props() parser callback: property */
 static sp_errc_t getprp_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     getprp_hndl_t *p_gphndl = (getprp_hndl_t*)arg;
+    int i;
 
     /* ignore props until the destination scope */
     if (p_gphndl->b.path.beg >= p_gphndl->b.path.end)
     {
-        size_t nm_len = strlen(p_gphndl->prop.name);
-
         *p_gphndl->p_neind += 1;
 
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_gphndl->prop.name, nm_len, 0);
-        EXEC_RG(sp_parser_tkn_cpy(in, SP_TKN_VAL, p_lval,
-            p_gphndl->val.ptr, p_gphndl->val.sz, &p_gphndl->p_info->tkval.len));
+        for (i=0; i<p_gphndl->n_reqs; i++)
+        {
+            sp_prop_req_t *p_req = &p_gphndl->reqs[i];
+            sp_prop_info_ex_t *p_info = p_req->p_info;
+            int equ=0;
 
-        /* matching element found */
-        *p_gphndl->p_eind += 1;
+            /* skip already satisfied requests */
+            if (p_req->ret==SPEC_SUCCESS && p_req->ind!=SP_IND_LAST)
+                continue;
 
-        if (p_gphndl->prop.ind==*p_gphndl->p_eind ||
-            p_gphndl->prop.ind==SP_IND_LAST)
-        {
-            p_gphndl->p_info->tkname.len = nm_len;
-            p_gphndl->p_info->tkname.loc = *p_lname;
+            EXEC_RG(sp_parser_tkn_cmp_int(in, SP_TKN_ID, p_lname, p_req->name,
+                p_req->nm_len, 0, p_req->nm_hash, (long)p_req->nm_len, &equ));
+            if (!equ) continue;
 
-            if (p_lval) {
-                p_gphndl->p_info->val_pres = 1;
-                p_gphndl->p_info->tkval.loc = *p_lval;
-            } else {
-                p_gphndl->p_info->val_pres = 0;
-            }
+            /* matching element found */
+            p_req->eind += 1;
 
-            p_gphndl->p_info->ldef = *p_ldef;
+            if (p_req->ind!=p_req->eind && p_req->ind!=SP_IND_LAST)
+                continue;
 
-            p_gphndl->p_info->ind = *p_gphndl->p_eind;
-            p_gphndl->p_info->n_elem = *p_gphndl->p_neind-1;
+            EXEC_RG(sp_parser_tkn_cpy_int(in, SP_TKN_VAL, p_lval, p_req->val,
+                p_req->len-1, (p_info ? &p_info->tkval.len : NULL)));
 
-            /* done if there is no need to track the last property */
-            if (p_gphndl->prop.ind!=SP_IND_LAST) {
-                ret = SPEC_CB_FINISH;
-                *p_gphndl->b.p_finish = 1;
+            if (p_info)
+            {
+                p_info->tkname.len = p_req->nm_len;
+                p_info->tkname.loc = p_lname->loc;
+
+                if (p_lval) {
+                    p_info->val_pres = 1;
+                    p_info->tkval.loc = p_lval->loc;
+                } else {
+                    p_info->val_pres = 0;
+                }
+
+                p_info->ldef = *p_ldef;
+
+                p_info->ind = p_req->eind;
+                p_info->n_elem = *p_gphndl->p_neind-1;
+            }
+
+            if (p_req->ret!=SPEC_SUCCESS) {
+                p_req->ret = SPEC_SUCCESS;
+
+                /* there is a need to track the last property till the end */
+                if (p_req->ind!=SP_IND_LAST) *p_gphndl->p_n_pend -= 1;
             }
         }
+
+        /* done if all requests are satisfied */
+        if (!*p_gphndl->p_n_pend) {
+            ret = SPEC_CB_FINISH;
+            *p_gphndl->b.p_finish = 1;
+        }
     }
 finish:
     return ret;
 }
 
-/* sp_get_prop() parser callback: scope */
+/* sp_get_props() parser callback: scope */
 static sp_errc_t getprp_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     getprp_hndl_t *p_gphndl=(getprp_hndl_t*)arg;
@@ -618,71 +1003,159 @@ static sp_errc_t getprp_cb_scope(void *arg, SP_FILE *in,
     /* element position number tracking index */ \
     int neind = 0;
 
-/* exported; see header for details */
-sp_errc_t sp_get_prop(SP_FILE *in, const sp_loc_t *p_parsc, const char *name,
-    int ind, const char *path, const char *deftp, char *val, size_t len,
-    sp_prop_info_ex_t *p_info)
+/* Find many properties under string path 'path' and 'deftp' or compiled path
+   'cpath' (if not NULL); support funct. for sp_get_props(), sp_get_props_p().
+ */
+static sp_errc_t get_props(SP_FILE *in, const sp_loc_t *p_parsc,
+    const char *path, const char *deftp, const sp_path_t *cpath,
+    sp_prop_req_t *reqs, int n_reqs)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     getprp_hndl_t gphndl;
+    int i, n_pend=0, last=0;
 
     __BASE_DEFS
-    __EIND_DEF
     __NEIND_DEF
 
-    sp_prop_info_ex_t info;
-
-    if (!in || !len || !name || (ind<0 && ind!=SP_IND_LAST))
-    {
+    if (!in || (n_reqs>0 && !reqs) || n_reqs<0) {
         ret=SPEC_INV_ARG;
         goto finish;
     }
 
-    memset(&gphndl, 0, sizeof(gphndl));
-    memset(&info, 0, sizeof(info));
+    for (i=0; i<n_reqs; i++)
+    {
+        sp_prop_req_t *p_req = &reqs[i];
 
-    init_base_hndl(&gphndl.b,
-        &f_finish, &lsc, &sind, path, deftp, getprp_cb_prop, getprp_cb_scope);
+        if (!p_req->name || !p_req->val || !p_req->len ||
+            (p_req->ind<0 && p_req->ind!=SP_IND_LAST))
+        {
+            ret=SPEC_INV_ARG;
+            goto finish;
+        }
 
-    gphndl.prop.name = name;
-    gphndl.prop.ind = ind;
-    gphndl.p_eind = &eind;
-    gphndl.p_neind = &neind;
+        p_req->ret = SPEC_NOTFOUND;
+        p_req->eind = -1;
+        p_req->nm_len = strlen(p_req->name);
+        sp_parser_str_hash(p_req->name,
+            p_req->nm_len, 0, SP_TKN_ID, &p_req->nm_hash, NULL);
+        p_req->val[p_req->len-1] = 0;
+        if (p_req->p_info) memset(p_req->p_info, 0, sizeof(*p_req->p_info));
+
+        if (p_req->ind!=SP_IND_LAST) n_pend++;
+        else last=1;
+    }
+
+    if (!n_reqs) goto finish;
+
+    /* requests for the last property are never finished before
+       the destination scope end */
+    n_pend += last;
+
+    memset(&gphndl, 0, sizeof(gphndl));
 
-    gphndl.val.ptr = val;
-    gphndl.val.sz = len-1;
-    gphndl.val.ptr[gphndl.val.sz] = 0;
+    init_base_hndl(&gphndl.b, in, &f_finish, &lsc, &sind,
+        path, deftp, cpath, getprp_cb_prop, getprp_cb_scope);
 
-    gphndl.p_info = &info;
+    gphndl.reqs = reqs;
+    gphndl.n_reqs = n_reqs;
+    gphndl.p_n_pend = &n_pend;
+    gphndl.p_neind = &neind;
 
     EXEC_RG(parse_with_lsc_handling(in, p_parsc, &gphndl.b, &gphndl));
 
-    if (!info.ldef.first_column) ret=SPEC_NOTFOUND;
+    for (i=0; i<n_reqs; i++) {
+        if (reqs[i].ret!=SPEC_SUCCESS) {
+            ret=SPEC_NOTFOUND;
+            break;
+        }
+    }
 
 finish:
-    if (p_info) *p_info=info;
     return ret;
+}
 
+/* exported; see header for details */
+sp_errc_t sp_get_props(SP_FILE *in, const sp_loc_t *p_parsc, const char *path,
+    const char *deftp, sp_prop_req_t *reqs, int n_reqs)
+{
+    return get_props(in, p_parsc, path, deftp, NULL, reqs, n_reqs);
 }
 
 /* exported; see header for details */
-sp_errc_t sp_get_prop_int(SP_FILE *in, const sp_loc_t *p_parsc,
-    const char *name, int ind, const char *path, const char *deftp, long *p_val,
-    sp_prop_info_ex_t *p_info)
+sp_errc_t sp_get_props_p(SP_FILE *in, const sp_loc_t *p_parsc,
+    const sp_path_t *path, sp_prop_req_t *reqs, int n_reqs)
+{
+    return get_props(in, p_parsc, NULL, NULL, path, reqs, n_reqs);
+}
+
+/* Find property under string path 'path' and 'deftp' or compiled path 'cpath'
+   (if not NULL); support funct. for sp_get_prop(), sp_get_prop_p().
+ */
+static sp_errc_t get_prop(SP_FILE *in, const sp_loc_t *p_parsc,
+    const char *name, int ind, const char *path, const char *deftp,
+    const sp_path_t *cpath, char *val, size_t len, sp_prop_info_ex_t *p_info)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     sp_prop_info_ex_t info;
+    sp_prop_req_t req;
 
-    char val[80];
-    char *strv = &val[0];
-
-    EXEC_RG(sp_get_prop(
-        in, p_parsc, name, ind, path, deftp, val, sizeof(val), &info));
+    memset(&info, 0, sizeof(info));
 
-    if (!info.val_pres || info.tkval.len>=sizeof(val) ||
-        !sp_util_strtrim(&strv, 1))
+    if (!in || !len || !name || (ind<0 && ind!=SP_IND_LAST))
     {
-        ret=SPEC_VAL_ERR;
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    req.name = name;
+    req.ind = ind;
+    req.val = val;
+    req.len = len;
+    req.p_info = &info;
+
+    ret = get_props(in, p_parsc, path, deftp, cpath, &req, 1);
+
+finish:
+    if (p_info) *p_info=info;
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_get_prop(SP_FILE *in, const sp_loc_t *p_parsc, const char *name,
+    int ind, const char *path, const char *deftp, char *val, size_t len,
+    sp_prop_info_ex_t *p_info)
+{
+    return get_prop(
+        in, p_parsc, name, ind, path, deftp, NULL, val, len, p_info);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_get_prop_p(SP_FILE *in, const sp_loc_t *p_parsc, const char *name,
+    int ind, const sp_path_t *path, char *val, size_t len,
+    sp_prop_info_ex_t *p_info)
+{
+    return get_prop(
+        in, p_parsc, name, ind, NULL, NULL, path, val, len, p_info);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_get_prop_int(SP_FILE *in, const sp_loc_t *p_parsc,
+    const char *name, int ind, const char *path, const char *deftp, long *p_val,
+    sp_prop_info_ex_t *p_info)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_prop_info_ex_t info;
+
+    char val[80];
+    char *strv = &val[0];
+
+    EXEC_RG(sp_get_prop(
+        in, p_parsc, name, ind, path, deftp, val, sizeof(val), &info));
+
+    if (!info.val_pres || info.tkval.len>=sizeof(val) ||
+        !sp_util_strtrim(&strv, 1))
+    {
+        ret=SPEC_VAL_ERR;
         goto finish;
     }
 
@@ -780,7 +1253,8 @@ typedef struct _getscp_hndl_t
 
 /* sp_get_scope_info() parser callback: property */
 static sp_errc_t getscp_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     getscp_hndl_t *p_gshndl=(getscp_hndl_t*)arg;
 
@@ -792,8 +1266,8 @@ static sp_errc_t getscp_cb_prop(void *arg, SP_FILE *in,
 
 /* sp_get_scope_info() parser callback: scope */
 static sp_errc_t getscp_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     getscp_hndl_t *p_gshndl=(getscp_hndl_t*)arg;
@@ -803,13 +1277,10 @@ static sp_errc_t getscp_cb_scope(void *arg, SP_FILE *in,
         CALL_FOLLOW_SCOPE_PATH(gshndl);
     } else
     {
-        size_t typ_len = (p_gshndl->scp.type ? strlen(p_gshndl->scp.type) : 0);
-        size_t nm_len = strlen(p_gshndl->scp.name);
-
         *p_gshndl->p_neind += 1;
 
-        CMPLOC_RG(in, SP_TKN_ID, p_ltype, p_gshndl->scp.type, typ_len, 0);
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_gshndl->scp.name, nm_len, 0);
+        CMPLOC_TYP_RG(in, p_ltype, p_gshndl->scp);
+        CMPLOC_NM_RG(in, p_lname, p_gshndl->scp);
 
         /* matching element found */
         *p_gshndl->p_eind += 1;
@@ -819,14 +1290,14 @@ static sp_errc_t getscp_cb_scope(void *arg, SP_FILE *in,
         {
             if (p_ltype) {
                 p_gshndl->p_info->type_pres = 1;
-                p_gshndl->p_info->tktype.len = typ_len;
-                p_gshndl->p_info->tktype.loc = *p_ltype;
+                p_gshndl->p_info->tktype.len = p_gshndl->scp.typ_len;
+                p_gshndl->p_info->tktype.loc = p_ltype->loc;
             } else {
                 p_gshndl->p_info->type_pres = 0;
             }
 
-            p_gshndl->p_info->tkname.len = nm_len;
-            p_gshndl->p_info->tkname.loc = *p_lname;
+            p_gshndl->p_info->tkname.len = p_gshndl->scp.nm_len;
+            p_gshndl->p_info->tkname.loc = p_lname->loc;
 
             if (p_lbody) {
                 p_gshndl->p_info->body_pres = 1;
@@ -873,12 +1344,10 @@ sp_errc_t sp_get_scope_info(
     memset(&gshndl, 0, sizeof(gshndl));
     memset(p_info, 0, sizeof(*p_info));
 
-    init_base_hndl(&gshndl.b,
-        &f_finish, &lsc, &sind, path, deftp, getscp_cb_prop, getscp_cb_scope);
+    init_base_hndl(&gshndl.b, in, &f_finish, &lsc, &sind,
+        path, deftp, NULL, getscp_cb_prop, getscp_cb_scope);
 
-    gshndl.scp.type = type;
-    gshndl.scp.name = name;
-    gshndl.scp.ind = ind;
+    init_scope_dsc(&gshndl.scp, type, name, ind);
     gshndl.p_eind = &eind;
     gshndl.p_neind = &neind;
     gshndl.p_info = p_info;
@@ -892,6 +1361,38 @@ finish:
 
 }
 
+/* Input splice recorded by an update in the batch mode (see sp_edit_apply()).
+ */
+typedef struct _splice_t
+{
+    /* replaced input range (end exclusive) */
+    long beg;
+    long end;
+
+    /* recording edit index and the splice sequence number */
+    int edit;
+    int seq;
+
+    /* replacement text location in the edit output */
+    long txt_off;
+    long txt_len;
+} splice_t;
+
+/* Splices recorder.
+ */
+typedef struct _splices_t
+{
+    splice_t *tab;
+    int n;
+    int n_alloc;
+
+    /* end of the processed input range */
+    long in_end;
+
+    /* index of the edit whose update-handles are being initialized */
+    int edit;
+} splices_t;
+
 /* Base struct for update-handles.
  */
 typedef struct _base_updt_hndl_t
@@ -911,12 +1412,27 @@ typedef struct _base_updt_hndl_t
 
     /* type of EOL detected */
     sp_eol_t eol_typ;
+
+    /* Splices recorder (batch mode); NULL if not used. In the batch mode the
+       input is not copied to the output (which receives replacement texts
+       only), but recorded as splices of the input. */
+    splices_t *p_rec;
+
+    struct {
+        /* recording edit index */
+        int edit;
+        /* end of the last copied input range */
+        long end;
+        /* output offset of not recorded replacement text */
+        long txt;
+    } rec;
 } base_updt_hndl_t;
 
 /* Initialize base_updt_hndl_t struct.
  */
-static sp_errc_t init_base_updt_hndl(base_updt_hndl_t *p_bu,
-    SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc, unsigned long flags)
+static sp_errc_t init_base_updt_hndl(base_updt_hndl_t *p_bu, SP_FILE *in,
+    SP_FILE *out, const sp_loc_t *p_parsc, unsigned long flags,
+    splices_t *p_rec)
 {
     sp_errc_t ret=SPEC_SUCCESS;
 
@@ -926,6 +1442,11 @@ static sp_errc_t init_base_updt_hndl(base_updt_hndl_t *p_bu,
     p_bu->p_parsc = p_parsc;
     p_bu->flags = flags;
 
+    p_bu->p_rec = p_rec;
+    p_bu->rec.edit = (p_rec ? p_rec->edit : 0);
+    p_bu->rec.end = p_bu->in_off;
+    p_bu->rec.txt = (p_rec ? sp_ftell(out) : 0);
+
     p_bu->eol_typ = SP_F_GET_USEEOL(p_bu->flags);
     if (p_bu->eol_typ==(sp_eol_t)-1)
         ret = sp_util_detect_eol(in, &p_bu->eol_typ);
@@ -933,17 +1454,81 @@ static sp_errc_t init_base_updt_hndl(base_updt_hndl_t *p_bu,
     return ret;
 }
 
+/* Record the input range from the end of the last copied range up to 'end'
+   offset (exclusive) as replaced by the text written to the output since the
+   last recorded splice. Nothing is recorded if the range and the text are both
+   empty.
+ */
+static sp_errc_t rec_splice(base_updt_hndl_t *p_bu, long end)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    splices_t *p_rec = p_bu->p_rec;
+    long txt = sp_ftell(p_bu->out);
+
+    if (txt==-1L) { ret=SPEC_ACCS_ERR; goto finish; }
+    if (end < p_bu->rec.end) end = p_bu->rec.end;
+
+    if (end > p_bu->rec.end || txt > p_bu->rec.txt)
+    {
+        splice_t *p_spl;
+
+        if (p_rec->n >= p_rec->n_alloc)
+        {
+            int n_alloc = (p_rec->n_alloc ? 2*p_rec->n_alloc : 16);
+
+            p_spl = (splice_t*)realloc(p_rec->tab, n_alloc*sizeof(*p_spl));
+            if (!p_spl) { ret=SPEC_NOMEM; goto finish; }
+
+            p_rec->tab = p_spl;
+            p_rec->n_alloc = n_alloc;
+        }
+
+        p_spl = &p_rec->tab[p_rec->n];
+        p_spl->beg = p_bu->rec.end;
+        p_spl->end = end;
+        p_spl->edit = p_bu->rec.edit;
+        p_spl->seq = p_rec->n++;
+        p_spl->txt_off = p_bu->rec.txt;
+        p_spl->txt_len = txt-p_bu->rec.txt;
+    }
+    p_bu->rec.txt = txt;
+
+finish:
+    return ret;
+}
+
+/* Finish update in the batch mode by recording the not recorded part of the
+   update. No-op if not in the batch mode.
+ */
+static sp_errc_t rec_flush(base_updt_hndl_t *p_bu)
+{
+    return (p_bu->p_rec ? rec_splice(p_bu, p_bu->in_off) : SPEC_SUCCESS);
+}
+
 /* Copies input bytes (from the offset staring the not processed range) to
    the output up to 'end' offset (exclusive). In case of success (and there
    is something to copy) the input offset is set at 'end'.
+
+   In the batch mode the copied range is not written to the output but
+   recorded as untouched by the update.
  */
 static sp_errc_t __cpy_to_out(base_updt_hndl_t *p_bu, long end)
 {
-    sp_errc_t ret;
+    sp_errc_t ret=SPEC_SUCCESS;
     long n=0;
 
-    ret = sp_util_cpy_to_out(p_bu->in, p_bu->out, p_bu->in_off, end, &n);
-    if (ret==SPEC_SUCCESS && n>0) p_bu->in_off = p_bu->in_off+n;
+    if (p_bu->p_rec)
+    {
+        if (end==EOF || end > p_bu->p_rec->in_end) end = p_bu->p_rec->in_end;
+
+        if (end > p_bu->in_off) {
+            ret = rec_splice(p_bu, p_bu->in_off);
+            if (ret==SPEC_SUCCESS) p_bu->rec.end = p_bu->in_off = end;
+        }
+    } else {
+        ret = sp_util_cpy_to_out(p_bu->in, p_bu->out, p_bu->in_off, end, &n);
+        if (ret==SPEC_SUCCESS && n>0) p_bu->in_off = p_bu->in_off+n;
+    }
     return ret;
 }
 
@@ -1147,7 +1732,8 @@ static sp_errc_t track_add_elem(add_hndl_t *p_ahndl, const sp_loc_t *p_ldef)
 
 /* add_elem() parser callback: property */
 static sp_errc_t add_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     add_hndl_t *p_ahndl=(add_hndl_t*)arg;
@@ -1160,8 +1746,8 @@ static sp_errc_t add_cb_prop(void *arg, SP_FILE *in,
 
 /* add_elem() parser callback: scope */
 static sp_errc_t add_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     add_hndl_t *p_ahndl=(add_hndl_t*)arg;
@@ -1178,7 +1764,7 @@ static sp_errc_t add_cb_scope(void *arg, SP_FILE *in,
         {
             /* track the last scope and write under 'p_frst_sc'
                if the scope finishes the path */
-            p_ahndl->p_frst_sc->lname = *p_lname;
+            p_ahndl->p_frst_sc->lname = p_lname->loc;
             p_ahndl->p_frst_sc->lbdyenc = *p_lbdyenc;
             p_ahndl->p_frst_sc->ldef = *p_ldef;
         } else
@@ -1186,7 +1772,7 @@ static sp_errc_t add_cb_scope(void *arg, SP_FILE *in,
             !p_ahndl->p_frst_sc->ldef.first_column)
         {
             /* mark first matching, non-global scope */
-            p_ahndl->p_frst_sc->lname = *p_lname;
+            p_ahndl->p_frst_sc->lname = p_lname->loc;
             p_ahndl->p_frst_sc->lbdyenc = *p_lbdyenc;
             p_ahndl->p_frst_sc->ldef = *p_ldef;
         }
@@ -1269,32 +1855,49 @@ finish:
     return ret;
 }
 
-#define __BASEUPD_DEF \
-    /* base class for the update part */ \
-    base_updt_hndl_t bu;
+/* add_elem() context; the handle along with its shared objects
 
-/* Add prop/scope element.
+   NOTE: The handle refers to the objects of the context, therefore the context
+   must not be moved after its initialization.
  */
-static sp_errc_t add_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
-    const char *prop_nm, const char *prop_val, const char *sc_typ,
-    const char *sc_nm, int n_elem, const char *path, const char *deftp,
-    unsigned long flags)
+typedef struct _add_ctx_t
 {
-    sp_errc_t ret=SPEC_SUCCESS;
     add_hndl_t ahndl;
 
-    long lstcpy_n;
-    int chk_end_eol=0, traileol;
+    /* processing finish flag */
+    int f_finish;
+    /* last scope spec. */
+    lastsc_t lsc;
+    /* split scope tracking index */
+    int sind;
+    /* element position number tracking index */
+    int neind;
 
-    __BASE_DEFS
-    __BASEUPD_DEF
-    __NEIND_DEF
+    /* base class for the update part */
+    base_updt_hndl_t bu;
 
     /* first scope matching the path */
     addh_frst_sc_t frst_sc;
     /* ldef of an element associated with the requested position */
     sp_loc_t ldef_elem;
 
+    /* added element (const) */
+    const char *prop_nm;
+    const char *prop_val;
+    const char *sc_typ;
+    const char *sc_nm;
+} add_ctx_t;
+
+/* Initialize add_elem() context.
+ */
+static sp_errc_t add_init(add_ctx_t *p_ctx, SP_FILE *in, SP_FILE *out,
+    const sp_loc_t *p_parsc, const char *prop_nm, const char *prop_val,
+    const char *sc_typ, const char *sc_nm, int n_elem, const char *path,
+    const char *deftp, const sp_path_t *cpath, unsigned long flags,
+    splices_t *p_rec)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
     if (!in || !out ||
         (!prop_nm && !sc_nm) ||
         (n_elem<0 && n_elem!=SP_ELM_LAST))
@@ -1303,97 +1906,124 @@ static sp_errc_t add_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
         goto finish;
     }
 
-    memset(&ahndl, 0, sizeof(ahndl));
-    memset(&frst_sc, 0, sizeof(frst_sc));
-    memset(&ldef_elem, 0, sizeof(ldef_elem));
+    memset(p_ctx, 0, sizeof(*p_ctx));
+
+    init_base_hndl(&p_ctx->ahndl.b, in, &p_ctx->f_finish, &p_ctx->lsc,
+        &p_ctx->sind, path, deftp, cpath, add_cb_prop, add_cb_scope);
+
+    EXEC_RG(init_base_updt_hndl(&p_ctx->bu, in, out, p_parsc, flags, p_rec));
+    p_ctx->ahndl.p_bu = &p_ctx->bu;
+
+    p_ctx->ahndl.n_elem = n_elem;
+    p_ctx->ahndl.p_neind = &p_ctx->neind;
+    p_ctx->ahndl.p_frst_sc = &p_ctx->frst_sc;
+    p_ctx->ahndl.p_ldef_elem = &p_ctx->ldef_elem;
+
+    p_ctx->prop_nm = prop_nm;
+    p_ctx->prop_val = prop_val;
+    p_ctx->sc_typ = sc_typ;
+    p_ctx->sc_nm = sc_nm;
+
+finish:
+    return ret;
+}
+
+/* Finish element addition after the input has been parsed.
+ */
+static sp_errc_t add_fin(add_ctx_t *p_ctx)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_updt_hndl_t *p_bu = &p_ctx->bu;
 
-    init_base_hndl(&ahndl.b,
-        &f_finish, &lsc, &sind, path, deftp, add_cb_prop, add_cb_scope);
+    const sp_loc_t *p_parsc = p_bu->p_parsc;
+    unsigned long flags = p_bu->flags;
+    int n_elem = p_ctx->ahndl.n_elem;
 
-    EXEC_RG(init_base_updt_hndl(&bu, in, out, p_parsc, flags));
-    ahndl.p_bu = &bu;
+    const char *prop_nm = p_ctx->prop_nm, *prop_val = p_ctx->prop_val;
+    const char *sc_typ = p_ctx->sc_typ, *sc_nm = p_ctx->sc_nm;
 
-    ahndl.n_elem = n_elem;
-    ahndl.p_neind = &neind;
-    ahndl.p_frst_sc = &frst_sc;
-    ahndl.p_ldef_elem = &ldef_elem;
+    const addh_frst_sc_t *p_frst_sc = &p_ctx->frst_sc;
+    const sp_loc_t *p_ldef_elem = &p_ctx->ldef_elem;
 
-    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ahndl.b, &ahndl));
+    long lstcpy_n;
+    int chk_end_eol=0, traileol;
 
-    if ((ahndl.b.path.beg < ahndl.b.path.end) && !frst_sc.ldef.first_column)
+    if ((p_ctx->ahndl.b.path.beg < p_ctx->ahndl.b.path.end) &&
+        !p_frst_sc->ldef.first_column)
     {
         /* destination scope was not found in the specified path */
         ret=SPEC_NOTFOUND;
         goto finish;
     }
 
-    if ((n_elem && n_elem!=SP_ELM_LAST) && !ldef_elem.first_column)
+    if ((n_elem && n_elem!=SP_ELM_LAST) && !p_ldef_elem->first_column)
     {
         /* requested position not found */
         ret=SPEC_NOTFOUND;
         goto finish;
     }
 
-    if (n_elem && (n_elem!=SP_ELM_LAST || ldef_elem.first_column))
+    if (n_elem && (n_elem!=SP_ELM_LAST || p_ldef_elem->first_column))
     {
         /* add after n-th elem
          */
-        EXEC_RG(__cpy_to_out(&bu, ldef_elem.end+1));
+        EXEC_RG(__cpy_to_out(p_bu, p_ldef_elem->end+1));
 
         if (flags & SP_F_EOLBFR)
         {
             long skip_n, skip_n2;
             int eol_n, eol_n2;
 
-            EXEC_RG(put_eol(&bu));
-            EXEC_RG(put_eol_ind(&bu, &ldef_elem, 0));
+            EXEC_RG(put_eol(p_bu));
+            EXEC_RG(put_eol_ind(p_bu, p_ldef_elem, 0));
 
-            EXEC_RG(skip_sp_to_eol(&bu, bu.in_off, &skip_n, &eol_n));
+            EXEC_RG(skip_sp_to_eol(p_bu, p_bu->in_off, &skip_n, &eol_n));
             if (eol_n) {
-                EXEC_RG(
-                    skip_sp_to_eol(&bu, bu.in_off+skip_n, &skip_n2, &eol_n2));
-                bu.in_off += (!eol_n2 ? skip_n-eol_n : skip_n+skip_n2-eol_n2);
+                EXEC_RG(skip_sp_to_eol(
+                    p_bu, p_bu->in_off+skip_n, &skip_n2, &eol_n2));
+                p_bu->in_off +=
+                    (!eol_n2 ? skip_n-eol_n : skip_n+skip_n2-eol_n2);
             }
         } else {
-            EXEC_RG(put_eol_ind(&bu, &ldef_elem, IND_F_TRIMSP));
+            EXEC_RG(put_eol_ind(p_bu, p_ldef_elem, IND_F_TRIMSP));
         }
 
         EXEC_RG(put_elem(
-            &bu, prop_nm, prop_val, sc_typ, sc_nm, &ldef_elem, 0, &traileol));
+            p_bu, prop_nm, prop_val, sc_typ, sc_nm, p_ldef_elem, 0, &traileol));
 
         if (traileol || (flags & SP_F_EXTEOL)) {
             EXEC_RG(put_eol_ind(
-                &bu, &ldef_elem, IND_F_CUTGAP|IND_F_CHKEOL|IND_F_EXTEOL));
+                p_bu, p_ldef_elem, IND_F_CUTGAP|IND_F_CHKEOL|IND_F_EXTEOL));
         } else {
             chk_end_eol=1;
         }
     } else {
-        if (frst_sc.ldef.first_column)
+        if (p_frst_sc->ldef.first_column)
         {
             /* add at the scope beginning
              */
-            long bdyenc_sz = sp_loc_len(&frst_sc.lbdyenc);
+            long bdyenc_sz = sp_loc_len(&p_frst_sc->lbdyenc);
 
             if (bdyenc_sz==1)
             {
 #if !CONFIG_NO_EMPTY_SCOPE_ALT
                 /* body as ; */
-                EXEC_RG(__cpy_to_out(&bu, frst_sc.lbdyenc.beg));
-                if (frst_sc.lbdyenc.beg-frst_sc.lname.end <= 1) {
+                EXEC_RG(__cpy_to_out(p_bu, p_frst_sc->lbdyenc.beg));
+                if (p_frst_sc->lbdyenc.beg-p_frst_sc->lname.end <= 1) {
                     /* put extra space before the opening bracket */
-                    CHK_FERR(sp_fputc(' ', out));
+                    CHK_FERR(sp_fputc(' ', p_bu->out));
                 }
-                CHK_FERR(sp_fputc('{', out));
+                CHK_FERR(sp_fputc('{', p_bu->out));
 
-                bu.in_off = frst_sc.ldef.end+1;
+                p_bu->in_off = p_frst_sc->ldef.end+1;
                 EXEC_RG(put_eol_ind(
-                    &bu, &frst_sc.ldef, IND_F_TRIMSP|IND_F_SCBDY));
+                    p_bu, &p_frst_sc->ldef, IND_F_TRIMSP|IND_F_SCBDY));
 
-                EXEC_RG(put_elem(&bu, prop_nm, prop_val,
-                    sc_typ, sc_nm, &frst_sc.ldef, IND_F_SCBDY, &traileol));
+                EXEC_RG(put_elem(p_bu, prop_nm, prop_val,
+                    sc_typ, sc_nm, &p_frst_sc->ldef, IND_F_SCBDY, &traileol));
 
-                EXEC_RG(put_eol_ind(&bu, &frst_sc.ldef, IND_F_EXTEOL));
-                CHK_FERR(sp_fputc('}', out));
+                EXEC_RG(put_eol_ind(p_bu, &p_frst_sc->ldef, IND_F_EXTEOL));
+                CHK_FERR(sp_fputc('}', p_bu->out));
 #else
                 /* should never happen */
                 ret=SPEC_SYNTAX;
@@ -1403,45 +2033,67 @@ static sp_errc_t add_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
             if (bdyenc_sz>=2)
             {
                 /* body as {} or { ... } */
-                EXEC_RG(__cpy_to_out(&bu, frst_sc.lbdyenc.beg+1));
+                EXEC_RG(__cpy_to_out(p_bu, p_frst_sc->lbdyenc.beg+1));
                 EXEC_RG(put_eol_ind(
-                    &bu, &frst_sc.ldef, IND_F_TRIMSP|IND_F_SCBDY));
+                    p_bu, &p_frst_sc->ldef, IND_F_TRIMSP|IND_F_SCBDY));
 
-                EXEC_RG(put_elem(&bu, prop_nm, prop_val,
-                    sc_typ, sc_nm, &frst_sc.ldef, IND_F_SCBDY, &traileol));
+                EXEC_RG(put_elem(p_bu, prop_nm, prop_val,
+                    sc_typ, sc_nm, &p_frst_sc->ldef, IND_F_SCBDY, &traileol));
 
                 if (bdyenc_sz==2) {
-                    EXEC_RG(put_eol_ind(&bu, &frst_sc.ldef, IND_F_EXTEOL));
+                    EXEC_RG(put_eol_ind(p_bu, &p_frst_sc->ldef, IND_F_EXTEOL));
                 } else
                 if (traileol || (flags & SP_F_EXTEOL)) {
-                    EXEC_RG(put_eol_ind(&bu,
-                        &frst_sc.ldef, IND_F_CUTGAP|IND_F_CHKEOL|IND_F_EXTEOL));
+                    EXEC_RG(put_eol_ind(p_bu, &p_frst_sc->ldef,
+                        IND_F_CUTGAP|IND_F_CHKEOL|IND_F_EXTEOL));
                 }
             }
         } else
         {
             /* add at the stream beginning
              */
-            const sp_loc_t *p_ind_ldef = (bu.p_parsc ? bu.p_parsc : NULL);
+            const sp_loc_t *p_ind_ldef = (p_parsc ? p_parsc : NULL);
 
-            EXEC_RG(put_elem(&bu, prop_nm, prop_val,
+            EXEC_RG(put_elem(p_bu, prop_nm, prop_val,
                 sc_typ, sc_nm, p_ind_ldef, 0, &traileol));
 
-            EXEC_RG(put_eol_ind(&bu, p_ind_ldef, IND_F_EXTEOL));
+            EXEC_RG(put_eol_ind(p_bu, p_ind_ldef, IND_F_EXTEOL));
         }
     }
 
     /* copy untouched last part of the input */
-    lstcpy_n = bu.in_off;
-    EXEC_RG(__cpy_to_out(&bu, (p_parsc ? p_parsc->end+1 : EOF)));
-    lstcpy_n = bu.in_off-lstcpy_n;
+    lstcpy_n = p_bu->in_off;
+    EXEC_RG(__cpy_to_out(p_bu, (p_parsc ? p_parsc->end+1 : EOF)));
+    lstcpy_n = p_bu->in_off-lstcpy_n;
 
     if (chk_end_eol && !lstcpy_n && !p_parsc && !(flags & SP_F_NLSTEOL))
     {
         /* ensure EOL if updated elem ends the input */
-        EXEC_RG(put_eol(&bu));
+        EXEC_RG(put_eol(p_bu));
     }
 
+    EXEC_RG(rec_flush(p_bu));
+
+finish:
+    return ret;
+}
+
+/* Add prop/scope element.
+ */
+static sp_errc_t add_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *prop_nm, const char *prop_val, const char *sc_typ,
+    const char *sc_nm, int n_elem, const char *path, const char *deftp,
+    const sp_path_t *cpath, unsigned long flags, splices_t *p_rec)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    add_ctx_t ctx;
+
+    EXEC_RG(add_init(&ctx, in, out, p_parsc, prop_nm, prop_val,
+        sc_typ, sc_nm, n_elem, path, deftp, cpath, flags, p_rec));
+
+    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ctx.ahndl.b, &ctx.ahndl));
+    ret = add_fin(&ctx);
+
 finish:
     return ret;
 }
@@ -1451,8 +2103,8 @@ sp_errc_t sp_add_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
     const char *name, const char *val, int n_elem, const char *path,
     const char *deftp, unsigned long flags)
 {
-    return add_elem(
-        in, out, p_parsc, name, val, NULL, NULL, n_elem, path, deftp, flags);
+    return add_elem(in, out, p_parsc,
+        name, val, NULL, NULL, n_elem, path, deftp, NULL, flags, NULL);
 }
 
 /* exported; see header for details */
@@ -1460,8 +2112,8 @@ sp_errc_t sp_add_scope(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
     const char *type, const char *name, int n_elem, const char *path,
     const char *deftp, unsigned long flags)
 {
-    return add_elem(
-        in, out, p_parsc, NULL, NULL, type, name, n_elem, path, deftp, flags);
+    return add_elem(in, out, p_parsc,
+        NULL, NULL, type, name, n_elem, path, deftp, NULL, flags, NULL);
 }
 
 typedef enum _fndstat_t
@@ -1585,7 +2237,8 @@ finish:
 
 /* rm_elem() parser callback: property */
 static sp_errc_t rm_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     rm_hndl_t *p_rhndl = (rm_hndl_t*)arg;
@@ -1593,10 +2246,8 @@ static sp_errc_t rm_cb_prop(void *arg, SP_FILE *in,
     /* ignore props until the destination scope */
     if ((p_rhndl->b.path.beg >= p_rhndl->b.path.end) && !p_rhndl->e.is_scp)
     {
-        size_t nm_len = strlen(p_rhndl->e.prop.name);
-
         if (*p_rhndl->p_fndstat==ELM_NOT_FND) *p_rhndl->p_fndstat=ELM_DEST_FND;
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_rhndl->e.prop.name, nm_len, 0);
+        CMPLOC_NM_RG(in, p_lname, p_rhndl->e.prop);
 
         /* matching element found */
         ret = rm_ldef(p_rhndl, p_rhndl->e.prop.ind, p_ldef);
@@ -1607,8 +2258,8 @@ finish:
 
 /* rm_elem() parser callback: scope */
 static sp_errc_t rm_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     rm_hndl_t *p_rhndl = (rm_hndl_t*)arg;
@@ -1619,12 +2270,9 @@ static sp_errc_t rm_cb_scope(void *arg, SP_FILE *in,
     } else
     if (p_rhndl->e.is_scp)
     {
-        size_t typ_len = (p_rhndl->e.scp.type ? strlen(p_rhndl->e.scp.type) : 0);
-        size_t nm_len = strlen(p_rhndl->e.scp.name);
-
         if (*p_rhndl->p_fndstat==ELM_NOT_FND) *p_rhndl->p_fndstat=ELM_DEST_FND;
-        CMPLOC_RG(in, SP_TKN_ID, p_ltype, p_rhndl->e.scp.type, typ_len, 0);
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_rhndl->e.scp.name, nm_len, 0);
+        CMPLOC_TYP_RG(in, p_ltype, p_rhndl->e.scp);
+        CMPLOC_NM_RG(in, p_lname, p_rhndl->e.scp);
 
         /* matching element found */
         ret = rm_ldef(p_rhndl, p_rhndl->e.scp.ind, p_ldef);
@@ -1633,26 +2281,42 @@ finish:
     return ret;
 }
 
-#define __RM_MOD_DEFS \
-    __EIND_DEF \
-    /* found status */ \
-    fndstat_t fndstat = ELM_NOT_FND;
+/* rm_elem() context; the handle along with its shared objects
 
-/* Remove prop/scope element.
+   NOTE: The handle refers to the objects of the context, therefore the context
+   must not be moved after its initialization.
  */
-static sp_errc_t rm_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
-    const char *prop_nm, const char *sc_typ, const char *sc_nm, int ind,
-    const char *path, const char *deftp, unsigned long flags)
+typedef struct _rm_ctx_t
 {
-    sp_errc_t ret=SPEC_SUCCESS;
     rm_hndl_t rhndl;
 
-    __BASE_DEFS
-    __BASEUPD_DEF
-    __RM_MOD_DEFS
+    /* processing finish flag */
+    int f_finish;
+    /* last scope spec. */
+    lastsc_t lsc;
+    /* split scope tracking index */
+    int sind;
+    /* matched elements tracking index */
+    int eind;
+    /* found status */
+    fndstat_t fndstat;
+
+    /* base class for the update part */
+    base_updt_hndl_t bu;
 
     /* last element def. */
     sp_loc_t lst_ldef;
+} rm_ctx_t;
+
+/* Initialize rm_elem() context.
+ */
+static sp_errc_t rm_init(rm_ctx_t *p_ctx, SP_FILE *in, SP_FILE *out,
+    const sp_loc_t *p_parsc, const char *prop_nm, const char *sc_typ,
+    const char *sc_nm, int ind, const char *path, const char *deftp,
+    unsigned long flags, splices_t *p_rec)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    rm_hndl_t *p_rhndl = &p_ctx->rhndl;
 
     if (!in || !out ||
         (!prop_nm && !sc_nm) ||
@@ -1662,41 +2326,49 @@ static sp_errc_t rm_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
         goto finish;
     }
 
-    memset(&rhndl, 0, sizeof(rhndl));
-    memset(&lst_ldef, 0, sizeof(lst_ldef));
+    memset(p_ctx, 0, sizeof(*p_ctx));
+    p_ctx->eind = -1;
+    p_ctx->fndstat = ELM_NOT_FND;
 
-    init_base_hndl(&rhndl.b,
-        &f_finish, &lsc, &sind, path, deftp, rm_cb_prop, rm_cb_scope);
+    init_base_hndl(&p_rhndl->b, in, &p_ctx->f_finish, &p_ctx->lsc,
+        &p_ctx->sind, path, deftp, NULL, rm_cb_prop, rm_cb_scope);
 
-    EXEC_RG(init_base_updt_hndl(&bu, in, out, p_parsc, flags));
-    rhndl.p_bu = &bu;
+    EXEC_RG(init_base_updt_hndl(&p_ctx->bu, in, out, p_parsc, flags, p_rec));
+    p_rhndl->p_bu = &p_ctx->bu;
 
     if (prop_nm) {
-        rhndl.e.is_scp = 0;
-        rhndl.e.prop.name = prop_nm;
-        rhndl.e.prop.ind = ind;
+        p_rhndl->e.is_scp = 0;
+        init_prop_dsc(&p_rhndl->e.prop, prop_nm, ind);
     } else {
-        rhndl.e.is_scp = 1;
-        rhndl.e.scp.type = sc_typ;
-        rhndl.e.scp.name = sc_nm;
-        rhndl.e.scp.ind = ind;
+        p_rhndl->e.is_scp = 1;
+        init_scope_dsc(&p_rhndl->e.scp, sc_typ, sc_nm, ind);
     }
 
-    rhndl.p_eind = &eind;
-    rhndl.p_fndstat = &fndstat;
-    rhndl.p_lst_ldef = &lst_ldef;
+    p_rhndl->p_eind = &p_ctx->eind;
+    p_rhndl->p_fndstat = &p_ctx->fndstat;
+    p_rhndl->p_lst_ldef = &p_ctx->lst_ldef;
+
+finish:
+    return ret;
+}
 
-    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &rhndl.b, &rhndl));
+/* Finish element removal after the input has been parsed.
+ */
+static sp_errc_t rm_fin(rm_ctx_t *p_ctx)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_updt_hndl_t *p_bu = &p_ctx->bu;
 
     /* process the last element if required */
-    if (lst_ldef.first_column) {
-        EXEC_RG(cpy_rm_ldef(&bu, &lst_ldef));
+    if (p_ctx->lst_ldef.first_column) {
+        EXEC_RG(cpy_rm_ldef(p_bu, &p_ctx->lst_ldef));
     }
 
     /* copy untouched last part of the input */
-    EXEC_RG(__cpy_to_out(&bu, (p_parsc ? p_parsc->end+1 : EOF)));
+    EXEC_RG(__cpy_to_out(p_bu, (p_bu->p_parsc ? p_bu->p_parsc->end+1 : EOF)));
+    EXEC_RG(rec_flush(p_bu));
 
-    if (fndstat==ELM_NOT_FND) {
+    if (p_ctx->fndstat==ELM_NOT_FND) {
         /* destination scope was not found (nonetheless the output is copied) */
         ret=SPEC_NOTFOUND;
     }
@@ -1705,6 +2377,25 @@ finish:
     return ret;
 }
 
+/* Remove prop/scope element.
+ */
+static sp_errc_t rm_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *prop_nm, const char *sc_typ, const char *sc_nm, int ind,
+    const char *path, const char *deftp, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    rm_ctx_t ctx;
+
+    EXEC_RG(rm_init(&ctx, in, out, p_parsc,
+        prop_nm, sc_typ, sc_nm, ind, path, deftp, flags, NULL));
+
+    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ctx.rhndl.b, &ctx.rhndl));
+    ret = rm_fin(&ctx);
+
+finish:
+    return ret;
+}
+
 /* exported; see header for details */
 sp_errc_t sp_rm_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
     const char *name, int ind, const char *path, const char *deftp,
@@ -1914,7 +2605,8 @@ finish:
 
 /* Element modification parser callback: property */
 static sp_errc_t mod_cb_prop(void *arg, SP_FILE *in,
-    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     mod_hndl_t *p_mhndl = (mod_hndl_t*)arg;
@@ -1922,10 +2614,8 @@ static sp_errc_t mod_cb_prop(void *arg, SP_FILE *in,
     /* ignore props until the destination scope */
     if ((p_mhndl->b.path.beg >= p_mhndl->b.path.end) && !p_mhndl->e.is_scp)
     {
-        size_t nm_len = strlen(p_mhndl->e.prop.name);
-
         if (*p_mhndl->p_fndstat==ELM_NOT_FND) *p_mhndl->p_fndstat=ELM_DEST_FND;
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_mhndl->e.prop.name, nm_len, 0);
+        CMPLOC_NM_RG(in, p_lname, p_mhndl->e.prop);
 
         /* matching element found */
         *p_mhndl->p_fndstat = ELM_FND;
@@ -1934,7 +2624,7 @@ static sp_errc_t mod_cb_prop(void *arg, SP_FILE *in,
         if (p_mhndl->e.prop.ind == *p_mhndl->p_eind)
         {
             EXEC_RG(cpy_mod_prop(
-                p_mhndl->p_bu, p_lname, p_lval, p_ldef,
+                p_mhndl->p_bu, &p_lname->loc, TKN_LOC(p_lval), p_ldef,
                 p_mhndl->mod.prop.name, p_mhndl->mod.prop.val,
                 p_mhndl->mod.prop.flags));
 
@@ -1945,15 +2635,15 @@ static sp_errc_t mod_cb_prop(void *arg, SP_FILE *in,
         if (p_mhndl->e.prop.ind == SP_IND_ALL)
         {
             EXEC_RG(cpy_mod_prop(
-                p_mhndl->p_bu, p_lname, p_lval, p_ldef,
+                p_mhndl->p_bu, &p_lname->loc, TKN_LOC(p_lval), p_ldef,
                 p_mhndl->mod.prop.name, p_mhndl->mod.prop.val,
                 p_mhndl->mod.prop.flags));
         } else
         if (p_mhndl->e.prop.ind == SP_IND_LAST)
         {
-            p_mhndl->p_lst->prop.lname = *p_lname;
+            p_mhndl->p_lst->prop.lname = p_lname->loc;
             if (p_lval) {
-                p_mhndl->p_lst->prop.lval = *p_lval;
+                p_mhndl->p_lst->prop.lval = p_lval->loc;
             } else {
                 /* prop w/o a value */
                 memset(&p_mhndl->p_lst->prop.lval, 0, sizeof(sp_loc_t));
@@ -1967,8 +2657,8 @@ finish:
 
 /* Element modification parser callback: scope */
 static sp_errc_t mod_cb_scope(void *arg, SP_FILE *in,
-    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
-    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
 {
     sp_errc_t ret=SPEC_SUCCESS;
     mod_hndl_t *p_mhndl = (mod_hndl_t*)arg;
@@ -1978,12 +2668,9 @@ static sp_errc_t mod_cb_scope(void *arg, SP_FILE *in,
         CALL_FOLLOW_SCOPE_PATH(mhndl);
     } else
     if (p_mhndl->e.is_scp)  {
-        size_t typ_len = (p_mhndl->e.scp.type ? strlen(p_mhndl->e.scp.type) : 0);
-        size_t nm_len = strlen(p_mhndl->e.scp.name);
-
         if (*p_mhndl->p_fndstat==ELM_NOT_FND) *p_mhndl->p_fndstat=ELM_DEST_FND;
-        CMPLOC_RG(in, SP_TKN_ID, p_ltype, p_mhndl->e.scp.type, typ_len, 0);
-        CMPLOC_RG(in, SP_TKN_ID, p_lname, p_mhndl->e.scp.name, nm_len, 0);
+        CMPLOC_TYP_RG(in, p_ltype, p_mhndl->e.scp);
+        CMPLOC_NM_RG(in, p_lname, p_mhndl->e.scp);
 
         /* matching element found */
         *p_mhndl->p_fndstat = ELM_FND;
@@ -1992,7 +2679,7 @@ static sp_errc_t mod_cb_scope(void *arg, SP_FILE *in,
         if (p_mhndl->e.scp.ind == *p_mhndl->p_eind)
         {
             EXEC_RG(cpy_mod_scope(
-                p_mhndl->p_bu, p_ltype, p_lname, p_lbdyenc,
+                p_mhndl->p_bu, TKN_LOC(p_ltype), &p_lname->loc, p_lbdyenc,
                 p_mhndl->mod.scp.type, p_mhndl->mod.scp.name,
                 p_mhndl->mod.scp.flags));
 
@@ -2003,19 +2690,19 @@ static sp_errc_t mod_cb_scope(void *arg, SP_FILE *in,
         if (p_mhndl->e.scp.ind == SP_IND_ALL)
         {
             EXEC_RG(cpy_mod_scope(
-                p_mhndl->p_bu, p_ltype, p_lname, p_lbdyenc,
+                p_mhndl->p_bu, TKN_LOC(p_ltype), &p_lname->loc, p_lbdyenc,
                 p_mhndl->mod.scp.type, p_mhndl->mod.scp.name,
                 p_mhndl->mod.scp.flags));
         } else
         if (p_mhndl->e.scp.ind == SP_IND_LAST)
         {
             if (p_ltype) {
-                p_mhndl->p_lst->scp.ltype = *p_ltype;
+                p_mhndl->p_lst->scp.ltype = p_ltype->loc;
             } else {
                 /* scope w/o a type */
                 memset(&p_mhndl->p_lst->scp.ltype, 0, sizeof(sp_loc_t));
             }
-            p_mhndl->p_lst->scp.lname = *p_lname;
+            p_mhndl->p_lst->scp.lname = p_lname->loc;
             p_mhndl->p_lst->scp.lbdyenc = *p_lbdyenc;
         }
     }
@@ -2023,178 +2710,1418 @@ finish:
     return ret;
 }
 
-/* Property modification; support funct. for sp_set_prop() and sp_mv_prop().
+/* Element modification context; the handle along with its shared objects
+
+   NOTE: The handle refers to the objects of the context, therefore the context
+   must not be moved after its initialization.
  */
-static sp_errc_t mod_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
-    const char *name, const char *new_name, const char *new_val, int ind,
-    const char *path, const char *deftp, unsigned mod_flags, unsigned long flags)
+typedef struct _mod_ctx_t
 {
-    sp_errc_t ret=SPEC_SUCCESS;
     mod_hndl_t mhndl;
 
-    __BASE_DEFS
-    __BASEUPD_DEF
-    __RM_MOD_DEFS
+    /* processing finish flag */
+    int f_finish;
+    /* last scope spec. */
+    lastsc_t lsc;
+    /* split scope tracking index */
+    int sind;
+    /* matched elements tracking index */
+    int eind;
+    /* found status */
+    fndstat_t fndstat;
+
+    /* base class for the update part */
+    base_updt_hndl_t bu;
 
     /* last element spec. */
     mod_lst_t lst;
 
+    /* destination scope path (const) */
+    const char *path;
+    const char *deftp;
+    const sp_path_t *cpath;
+} mod_ctx_t;
+
+/* Initialize element modification context. 'is_scp' specifies the modified
+   element kind.
+ */
+static sp_errc_t mod_init(mod_ctx_t *p_ctx, SP_FILE *in, SP_FILE *out,
+    const sp_loc_t *p_parsc, int is_scp, const char *type, const char *name,
+    const char *new_type, const char *new_name, const char *new_val, int ind,
+    const char *path, const char *deftp, const sp_path_t *cpath,
+    unsigned mod_flags, unsigned long flags, splices_t *p_rec)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    mod_hndl_t *p_mhndl = &p_ctx->mhndl;
+
     if (!in || !out || !name ||
-        ((mod_flags & MOD_F_PROP_NAME) && !new_name) ||
+        (!is_scp && (mod_flags & MOD_F_PROP_NAME) && !new_name) ||
+        (is_scp && !new_name) ||
         (ind<0 && ind!=SP_IND_LAST && ind!=SP_IND_ALL))
     {
         ret=SPEC_INV_ARG;
         goto finish;
     }
 
-    memset(&mhndl, 0, sizeof(mhndl));
-    memset(&lst, 0, sizeof(lst));
+    memset(p_ctx, 0, sizeof(*p_ctx));
+    p_ctx->eind = -1;
+    p_ctx->fndstat = ELM_NOT_FND;
+    p_ctx->path = path;
+    p_ctx->deftp = deftp;
+    p_ctx->cpath = cpath;
+
+    init_base_hndl(&p_mhndl->b, in, &p_ctx->f_finish, &p_ctx->lsc,
+        &p_ctx->sind, path, deftp, cpath, mod_cb_prop, mod_cb_scope);
 
-    init_base_hndl(&mhndl.b,
-        &f_finish, &lsc, &sind, path, deftp, mod_cb_prop, mod_cb_scope);
+    EXEC_RG(init_base_updt_hndl(&p_ctx->bu, in, out, p_parsc, flags, p_rec));
+    p_mhndl->p_bu = &p_ctx->bu;
 
-    EXEC_RG(init_base_updt_hndl(&bu, in, out, p_parsc, flags));
-    mhndl.p_bu = &bu;
+    p_mhndl->e.is_scp = is_scp;
+    if (!is_scp) {
+        init_prop_dsc(&p_mhndl->e.prop, name, ind);
 
-    mhndl.e.is_scp = 0;
-    mhndl.e.prop.name = name;
-    mhndl.e.prop.ind = ind;
+        p_mhndl->mod.prop.flags = mod_flags;
+        p_mhndl->mod.prop.name = new_name;
+        p_mhndl->mod.prop.val = new_val;
+    } else {
+        init_scope_dsc(&p_mhndl->e.scp, type, name, ind);
+
+        p_mhndl->mod.scp.flags = mod_flags;
+        p_mhndl->mod.scp.type = new_type;
+        p_mhndl->mod.scp.name = new_name;
+    }
+
+    p_mhndl->p_eind = &p_ctx->eind;
+    p_mhndl->p_fndstat = &p_ctx->fndstat;
+    p_mhndl->p_lst = &p_ctx->lst;
 
-    mhndl.mod.prop.flags = mod_flags;
-    mhndl.mod.prop.name = new_name;
-    mhndl.mod.prop.val = new_val;
+finish:
+    return ret;
+}
 
-    mhndl.p_eind = &eind;
-    mhndl.p_fndstat = &fndstat;
-    mhndl.p_lst = &lst;
+/* Finish property modification after the input has been parsed.
+ */
+static sp_errc_t mod_prop_fin(mod_ctx_t *p_ctx)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_updt_hndl_t *p_bu = &p_ctx->bu;
 
-    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &mhndl.b, &mhndl));
+    const mod_lst_t *p_lst = &p_ctx->lst;
+    int ind = p_ctx->mhndl.e.prop.ind, eind = p_ctx->eind;
+    unsigned mod_flags = p_ctx->mhndl.mod.prop.flags;
+    const char *name = p_ctx->mhndl.e.prop.name;
+    const char *new_name = p_ctx->mhndl.mod.prop.name;
+    const char *new_val = p_ctx->mhndl.mod.prop.val;
 
-    if (fndstat==ELM_NOT_FND)
+    if (p_ctx->fndstat==ELM_NOT_FND)
     {
         /* destination scope was not found */
         ret=SPEC_NOTFOUND;
         goto finish;
     }
 
-    if (fndstat==ELM_DEST_FND || (ind>=0 && eind!=ind))
+    if (p_ctx->fndstat==ELM_DEST_FND || (ind>=0 && eind!=ind))
     {
-        if ((flags & SP_F_NOADD) ||
+        if ((p_bu->flags & SP_F_NOADD) ||
             !(mod_flags & MOD_F_PROP_VAL) ||
             (ind>=0 && (eind+1)!=ind))
         {
             /* not found or not allowed/possible to add */
             ret=SPEC_NOTFOUND;
         } else {
-            EXEC_RG(sp_add_prop(in, out, p_parsc,
-                ((mod_flags & MOD_F_PROP_NAME) ? new_name : name),
-                new_val, SP_ELM_LAST, path, deftp, flags));
+            EXEC_RG(add_elem(p_bu->in, p_bu->out, p_bu->p_parsc,
+                ((mod_flags & MOD_F_PROP_NAME) ? new_name : name), new_val,
+                NULL, NULL, SP_ELM_LAST, p_ctx->path, p_ctx->deftp,
+                p_ctx->cpath, p_bu->flags, p_bu->p_rec));
         }
         goto finish;
     }
 
     /* process the last element if required */
-    if (lst.prop.ldef.first_column) {
-        EXEC_RG(cpy_mod_prop(&bu, &lst.prop.lname,
-            (lst.prop.lval.first_column ? &lst.prop.lval : NULL),
-            &lst.prop.ldef, new_name, new_val, mod_flags));
+    if (p_lst->prop.ldef.first_column) {
+        EXEC_RG(cpy_mod_prop(p_bu, &p_lst->prop.lname,
+            (p_lst->prop.lval.first_column ? &p_lst->prop.lval : NULL),
+            &p_lst->prop.ldef, new_name, new_val, mod_flags));
     }
 
     /* copy untouched last part of the input */
-    EXEC_RG(__cpy_to_out(&bu, (p_parsc ? p_parsc->end+1 : EOF)));
+    EXEC_RG(__cpy_to_out(p_bu, (p_bu->p_parsc ? p_bu->p_parsc->end+1 : EOF)));
+    EXEC_RG(rec_flush(p_bu));
 
 finish:
     return ret;
 }
 
-/* exported; see header for details */
-sp_errc_t sp_set_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
-    const char *name, const char *val, int ind, const char *path,
-    const char *deftp, unsigned long flags)
+/* Finish scope modification after the input has been parsed.
+ */
+static sp_errc_t mod_scope_fin(mod_ctx_t *p_ctx)
 {
-    return mod_prop(in, out, p_parsc, name, NULL, val,
-        ind, path, deftp, MOD_F_PROP_VAL, flags);
+    sp_errc_t ret=SPEC_SUCCESS;
+    base_updt_hndl_t *p_bu = &p_ctx->bu;
+    const mod_lst_t *p_lst = &p_ctx->lst;
+
+    if (p_ctx->fndstat!=ELM_FND) {
+        /* scope not found */
+        ret=SPEC_NOTFOUND;
+        goto finish;
+    }
+
+    /* process the last element if required */
+    if (p_lst->scp.lbdyenc.first_column) {
+        EXEC_RG(cpy_mod_scope(p_bu,
+            (p_lst->scp.ltype.first_column ? &p_lst->scp.ltype : NULL),
+            &p_lst->scp.lname, &p_lst->scp.lbdyenc, p_ctx->mhndl.mod.scp.type,
+            p_ctx->mhndl.mod.scp.name, p_ctx->mhndl.mod.scp.flags));
+    }
+
+    /* copy untouched last part of the input */
+    EXEC_RG(__cpy_to_out(p_bu, (p_bu->p_parsc ? p_bu->p_parsc->end+1 : EOF)));
+    EXEC_RG(rec_flush(p_bu));
+
+finish:
+    return ret;
 }
 
-/* exported; see header for details */
-sp_errc_t sp_mv_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
-    const char *name, const char *new_name, int ind, const char *path,
-    const char *deftp, unsigned long flags)
+/* Finish element modification after the input has been parsed.
+ */
+static sp_errc_t mod_fin(mod_ctx_t *p_ctx)
 {
-    return mod_prop(in, out, p_parsc, name, new_name, NULL,
-        ind, path, deftp, MOD_F_PROP_NAME, flags);
+    return (!p_ctx->mhndl.e.is_scp ?
+        mod_prop_fin(p_ctx) : mod_scope_fin(p_ctx));
 }
 
-/* exported; see header for details */
-sp_errc_t sp_mv_scope(
-    SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc, const char *type,
-    const char *name, const char *new_type, const char *new_name, int ind,
-    const char *path, const char *deftp, unsigned long flags)
+/* Element modification; support funct. for sp_set_prop(), sp_mv_prop() and
+   sp_mv_scope().
+ */
+static sp_errc_t mod_elem(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    int is_scp, const char *type, const char *name, const char *new_type,
+    const char *new_name, const char *new_val, int ind, const char *path,
+    const char *deftp, const sp_path_t *cpath, unsigned mod_flags,
+    unsigned long flags)
 {
     sp_errc_t ret=SPEC_SUCCESS;
-    mod_hndl_t mhndl;
-    unsigned mod_flags = MOD_F_SCOPE_TYPE|MOD_F_SCOPE_NAME;
+    mod_ctx_t ctx;
 
-    __BASE_DEFS
-    __BASEUPD_DEF
-    __RM_MOD_DEFS
+    EXEC_RG(mod_init(&ctx, in, out, p_parsc, is_scp, type, name, new_type,
+        new_name, new_val, ind, path, deftp, cpath, mod_flags, flags, NULL));
 
-    /* last element spec. */
-    mod_lst_t lst;
+    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ctx.mhndl.b, &ctx.mhndl));
+    ret = mod_fin(&ctx);
 
-    if (!in || !out || !name || !new_name ||
-        (ind<0 && ind!=SP_IND_LAST && ind!=SP_IND_ALL))
-    {
-        ret=SPEC_INV_ARG;
-        goto finish;
-    }
+finish:
+    return ret;
+}
 
-    memset(&mhndl, 0, sizeof(mhndl));
-    memset(&lst, 0, sizeof(lst));
+/* size of the stack buffer for the tokenized value of the in-place update;
+   longer values are tokenized on the heap */
+#define INPL_BUF_SIZE   0x100
 
-    init_base_hndl(&mhndl.b,
-        &f_finish, &lsc, &sind, path, deftp, mod_cb_prop, mod_cb_scope);
+/* in-place update passes */
+#define INPL_CHECK      0   /* check the values locations */
+#define INPL_WRITE      1   /* overwrite the values */
 
-    EXEC_RG(init_base_updt_hndl(&bu, in, out, p_parsc, flags));
-    mhndl.p_bu = &bu;
+/* In-place property update handle
 
-    mhndl.e.is_scp = 1;
-    mhndl.e.scp.type = type;
-    mhndl.e.scp.name = name;
-    mhndl.e.scp.ind = ind;
+   NOTE: This struct is copied during upward-downward process of following
+   the destination scope path.
+ */
+typedef struct _inpl_hndl_t
+{
+    base_hndl_t b;
 
-    mhndl.mod.scp.flags = mod_flags;
-    mhndl.mod.scp.type = new_type;
-    mhndl.mod.scp.name = new_name;
+    /* property desc. (const) */
+    prop_dsc_t prop;
 
-    mhndl.p_eind = &eind;
-    mhndl.p_fndstat = &fndstat;
-    mhndl.p_lst = &lst;
+    /* tokenized value (const) */
+    struct {
+        const char *ptr;
+        size_t len;
+    } tkval;
 
-    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &mhndl.b, &mhndl));
+    /* update pass; INPL_XXX (const) */
+    int pass;
 
-    if (fndstat!=ELM_FND) {
-        /* scope not found */
-        ret=SPEC_NOTFOUND;
-        goto finish;
-    }
+    /* matched elements tracking index (shared) */
+    int *p_eind;
 
-    /* process the last element if required */
-    if (lst.scp.lbdyenc.first_column) {
-        EXEC_RG(cpy_mod_scope(&bu,
-            (lst.scp.ltype.first_column ? &lst.scp.ltype : NULL),
-            &lst.scp.lname, &lst.scp.lbdyenc, new_type, new_name, mod_flags));
-    }
+    /* found status (shared) */
+    fndstat_t *p_fndstat;
 
-    /* copy untouched last part of the input */
-    EXEC_RG(__cpy_to_out(&bu, (p_parsc ? p_parsc->end+1 : EOF)));
+    /* location of the last matched value pending for the overwrite; zeroed
+       if there is nothing to overwrite (shared) */
+    sp_loc_t *p_lval;
+} inpl_hndl_t;
+
+/* Check if the tokenized value of length 'len' fits the location 'p_lval' of
+   the replaced value (NULL for a property w/o a value).
+ */
+static sp_errc_t inpl_chk_fit(const sp_loc_t *p_lval, size_t len)
+{
+    size_t lv_len = (size_t)sp_loc_len(p_lval);
+
+    if (len==lv_len) return SPEC_SUCCESS;
+#if CONFIG_TRIM_VAL_TRAILING_SPACES
+    /* padding trailing spaces are trimmed off the value */
+    if (len < lv_len) return SPEC_SUCCESS;
+#endif
+    return SPEC_SIZE;
+}
+
+/* Overwrite the pending value location (if any) with the tokenized value
+   padded with spaces.
+ */
+static sp_errc_t inpl_write(SP_FILE *in, const inpl_hndl_t *p_ihndl)
+{
+    static const char spcs[] = "                ";
+
+    sp_errc_t ret=SPEC_SUCCESS;
+    const sp_loc_t *p_lval = p_ihndl->p_lval;
+    size_t n, pad;
+
+    if (!p_lval->first_column) goto finish;
+
+    CHK_FSEEK(sp_fseek(in, p_lval->beg, SEEK_SET));
+
+    n = p_ihndl->tkval.len;
+    if (n && sp_fwrite(p_ihndl->tkval.ptr, n, in)!=n) {
+        ret=SPEC_ACCS_ERR;
+        goto finish;
+    }
+
+    for (pad=(size_t)sp_loc_len(p_lval)-n; pad>0; pad-=n) {
+        n = (pad < sizeof(spcs)-1 ? pad : sizeof(spcs)-1);
+        if (sp_fwrite(spcs, n, in)!=n) {
+            ret=SPEC_ACCS_ERR;
+            goto finish;
+        }
+    }
+
+finish:
+    return ret;
+}
+
+/* In-place property update parser callback: property */
+static sp_errc_t inpl_cb_prop(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    inpl_hndl_t *p_ihndl = (inpl_hndl_t*)arg;
+    int ind = p_ihndl->prop.ind;
+
+    /* ignore props until the destination scope */
+    if (p_ihndl->b.path.beg >= p_ihndl->b.path.end)
+    {
+        if (*p_ihndl->p_fndstat==ELM_NOT_FND) *p_ihndl->p_fndstat=ELM_DEST_FND;
+        CMPLOC_NM_RG(in, p_lname, p_ihndl->prop);
+
+        /* matching element found */
+        *p_ihndl->p_fndstat = ELM_FND;
+        *p_ihndl->p_eind += 1;
+
+        if (ind!=*p_ihndl->p_eind && ind!=SP_IND_ALL && ind!=SP_IND_LAST)
+            goto finish;
+
+        if (p_ihndl->pass==INPL_CHECK) {
+            /* the last matched value is checked after the parsing */
+            if (ind==SP_IND_ALL)
+                EXEC_RG(inpl_chk_fit(TKN_LOC(p_lval), p_ihndl->tkval.len));
+        } else {
+            /* The values are overwritten lagged by one matched property,
+               therefore the overwritten location is always located before
+               the current parser position (which is restored by the parser
+               after the callback return). */
+            EXEC_RG(inpl_write(in, p_ihndl));
+        }
+
+        if (p_lval) {
+            *p_ihndl->p_lval = p_lval->loc;
+        } else {
+            /* prop w/o a value */
+            memset(p_ihndl->p_lval, 0, sizeof(sp_loc_t));
+        }
+
+        if (ind==*p_ihndl->p_eind) {
+            /* specific element found; done */
+            ret = SPEC_CB_FINISH;
+            *p_ihndl->b.p_finish = 1;
+        }
+    }
+finish:
+    return ret;
+}
+
+/* In-place property update parser callback: scope */
+static sp_errc_t inpl_cb_scope(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    inpl_hndl_t *p_ihndl = (inpl_hndl_t*)arg;
+
+    if (p_ihndl->b.path.beg < p_ihndl->b.path.end) {
+        inpl_hndl_t ihndl = *p_ihndl;
+        CALL_FOLLOW_SCOPE_PATH(ihndl);
+    }
+    return ret;
+}
+
+/* Set property value in place (SP_F_INPLACE); support funct. for
+   sp_set_prop(), sp_set_prop_p().
+
+   The input is parsed to check all the set values fit their locations before
+   any of them is overwritten. For SP_IND_ALL the input is parsed once again
+   to overwrite the values, otherwise the only value location is known after
+   the check.
+ */
+static sp_errc_t set_prop_inplace(SP_FILE *in, const sp_loc_t *p_parsc,
+    const char *name, const char *val, int ind, const char *path,
+    const char *deftp, const sp_path_t *cpath)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    inpl_hndl_t ihndl;
+    fndstat_t fndstat=ELM_NOT_FND;
+    sp_loc_t lval;
+    char buf[INPL_BUF_SIZE];
+    SP_FILE tkout;
+
+    __BASE_DEFS
+    __EIND_DEF
+
+    /* stack buffer stream need not to be closed */
+    sp_mopen(&tkout, buf, sizeof(buf));
+
+    if (!in || !name || (ind<0 && ind!=SP_IND_LAST && ind!=SP_IND_ALL))
+    {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    /* tokenize the value */
+    if (val && sp_parser_tokenize_str(
+            &tkout, SP_TKN_VAL, val, 0)!=SPEC_SUCCESS)
+    {
+        /* doesn't fit the stack buffer */
+        EXEC_RG(sp_mopen_dyn(&tkout, 2*sizeof(buf), NULL));
+        EXEC_RG(sp_parser_tokenize_str(&tkout, SP_TKN_VAL, val, 0));
+    }
+
+    memset(&ihndl, 0, sizeof(ihndl));
+    memset(&lval, 0, sizeof(lval));
+
+    init_base_hndl(&ihndl.b, in, &f_finish, &lsc, &sind,
+        path, deftp, cpath, inpl_cb_prop, inpl_cb_scope);
+
+    init_prop_dsc(&ihndl.prop, name, ind);
+    ihndl.tkval.ptr = tkout.m.b;
+    ihndl.tkval.len = tkout.m.i;
+    ihndl.pass = INPL_CHECK;
+    ihndl.p_eind = &eind;
+    ihndl.p_fndstat = &fndstat;
+    ihndl.p_lval = &lval;
+
+    EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ihndl.b, &ihndl));
+
+    if (fndstat!=ELM_FND || (ind>=0 && eind!=ind)) {
+        /* destination scope or the property not found */
+        ret=SPEC_NOTFOUND;
+        goto finish;
+    }
+
+    EXEC_RG(inpl_chk_fit(
+        (lval.first_column ? &lval : NULL), ihndl.tkval.len));
+
+    if (ind==SP_IND_ALL && eind>0)
+    {
+        init_base_hndl(&ihndl.b, in, &f_finish, &lsc, &sind,
+            path, deftp, cpath, inpl_cb_prop, inpl_cb_scope);
+
+        eind = -1;
+        memset(&lval, 0, sizeof(lval));
+        ihndl.pass = INPL_WRITE;
+
+        EXEC_RG(parse_with_lsc_handling(in, p_parsc, &ihndl.b, &ihndl));
+    }
+
+    /* overwrite the last matched value */
+    ret = inpl_write(in, &ihndl);
 
 finish:
+    if (tkout.typ==SP_FILE_MEM_DYN) sp_close(&tkout);
     return ret;
 }
 
-#undef __RM_MOD_DEFS
-#undef __BASEUPD_DEF
+/* exported; see header for details */
+sp_errc_t sp_set_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *name, const char *val, int ind, const char *path,
+    const char *deftp, unsigned long flags)
+{
+    if (flags & SP_F_INPLACE)
+        return set_prop_inplace(in, p_parsc, name, val, ind, path, deftp, NULL);
+
+    return mod_elem(in, out, p_parsc, 0, NULL, name, NULL, NULL, val,
+        ind, path, deftp, NULL, MOD_F_PROP_VAL, flags);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_set_prop_p(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *name, const char *val, int ind, const sp_path_t *path,
+    unsigned long flags)
+{
+    if (flags & SP_F_INPLACE)
+        return set_prop_inplace(in, p_parsc, name, val, ind, NULL, NULL, path);
+
+    return mod_elem(in, out, p_parsc, 0, NULL, name, NULL, NULL, val,
+        ind, NULL, NULL, path, MOD_F_PROP_VAL, flags);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_mv_prop(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const char *name, const char *new_name, int ind, const char *path,
+    const char *deftp, unsigned long flags)
+{
+    return mod_elem(in, out, p_parsc, 0, NULL, name, NULL, new_name, NULL,
+        ind, path, deftp, NULL, MOD_F_PROP_NAME, flags);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_mv_scope(
+    SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc, const char *type,
+    const char *name, const char *new_type, const char *new_name, int ind,
+    const char *path, const char *deftp, unsigned long flags)
+{
+    return mod_elem(in, out, p_parsc, 1, type, name, new_type, new_name, NULL,
+        ind, path, deftp, NULL, MOD_F_SCOPE_TYPE|MOD_F_SCOPE_NAME, flags);
+}
+
+/* Initial size of the batch edits table */
+#define BATCH_INIT_EDITS    8
+
+/* Append edit 'p_edit' to the batch.
+ */
+static sp_errc_t batch_push(sp_edit_batch_t *p_batch, const sp_edit_t *p_edit)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (!p_batch) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    if (p_batch->n_edits >= p_batch->n_alloc)
+    {
+        int n_alloc =
+            (!p_batch->n_alloc ? BATCH_INIT_EDITS : 2*p_batch->n_alloc);
+        sp_edit_t *edits = (sp_edit_t*)realloc(
+            p_batch->edits, n_alloc*sizeof(*edits));
+
+        if (!edits) {
+            ret=SPEC_NOMEM;
+            goto finish;
+        }
+        p_batch->edits = edits;
+        p_batch->n_alloc = n_alloc;
+    }
+    p_batch->edits[p_batch->n_edits++] = *p_edit;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void sp_edit_batch_init(sp_edit_batch_t *p_batch)
+{
+    if (p_batch) memset(p_batch, 0, sizeof(*p_batch));
+}
+
+/* exported; see header for details */
+void sp_edit_batch_free(sp_edit_batch_t *p_batch)
+{
+    if (!p_batch) return;
+
+    if (p_batch->edits) free(p_batch->edits);
+    memset(p_batch, 0, sizeof(*p_batch));
+}
+
+/* Edit spec. initializer */
+#define __EDIT_DEF(o, t, n, v, nt, nn, i) \
+    sp_edit_t e; \
+    e.op = (o); \
+    e.type = (t); \
+    e.name = (n); \
+    e.val = (v); \
+    e.new_type = (nt); \
+    e.new_name = (nn); \
+    e.ind = (i); \
+    e.path = path; \
+    e.deftp = deftp; \
+    e.flags = flags;
+
+/* exported; see header for details */
+sp_errc_t sp_edit_add_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *val, int n_elem, const char *path, const char *deftp,
+    unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_ADD_PROP, NULL, name, val, NULL, NULL, n_elem);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_add_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, int n_elem, const char *path, const char *deftp,
+    unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_ADD_SCOPE, type, name, NULL, NULL, NULL, n_elem);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_rm_prop(sp_edit_batch_t *p_batch, const char *name,
+    int ind, const char *path, const char *deftp, unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_RM_PROP, NULL, name, NULL, NULL, NULL, ind);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_rm_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, int ind, const char *path, const char *deftp,
+    unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_RM_SCOPE, type, name, NULL, NULL, NULL, ind);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_set_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *val, int ind, const char *path, const char *deftp,
+    unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_SET_PROP, NULL, name, val, NULL, NULL, ind);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_mv_prop(sp_edit_batch_t *p_batch, const char *name,
+    const char *new_name, int ind, const char *path, const char *deftp,
+    unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_MV_PROP, NULL, name, NULL, NULL, new_name, ind);
+    return batch_push(p_batch, &e);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_mv_scope(sp_edit_batch_t *p_batch, const char *type,
+    const char *name, const char *new_type, const char *new_name, int ind,
+    const char *path, const char *deftp, unsigned long flags)
+{
+    __EDIT_DEF(SP_EDIT_MV_SCOPE, type, name, NULL, new_type, new_name, ind);
+    return batch_push(p_batch, &e);
+}
+
+#undef __EDIT_DEF
+
+/* Batch edit context
+
+   NOTE: The context must not be moved after its initialization.
+ */
+typedef struct _edit_ctx_t
+{
+    /* edit spec. (const) */
+    const sp_edit_t *p_edit;
+
+    /* edit operation context */
+    union {
+        add_ctx_t add;
+        rm_ctx_t rm;
+        mod_ctx_t mod;
+    } c;
+
+    /* base handle and the handle of the edit operation */
+    base_hndl_t *p_b;
+    void *hndl;
+
+    /* replacement texts written by the edit */
+    SP_FILE out;
+    int out_opn;
+
+    /* if !=0: the edit doesn't need further parser callbacks */
+    int done;
+
+    /* path following mode: states of the scopes descended by the edit (see
+       batch_cb_enter()); the edit is dispatched parser callbacks of the
+       currently parsed scope body if the number of the descended scopes is
+       the same as of the batch */
+    struct {
+        sp_parser_lev_t *levs;  /* heap allocated */
+        int n;                  /* number of descended scopes */
+        int sz;                 /* size of 'levs' table */
+    } pth;
+} edit_ctx_t;
+
+/* sp_edit_apply() handle
+ */
+typedef struct _batch_hndl_t
+{
+    edit_ctx_t *ectx;
+    int n_edits;
+
+    /* number of not finished edits */
+    int n_pend;
+
+    /* number of scopes descended by the batch (in the path following mode) */
+    int lev;
+
+    /* index of the failed edit */
+    int err_edit;
+} batch_hndl_t;
+
+/* Finish dispatching parser callbacks to the edit 'p_ectx' basing on the
+   edit's callback return code 'ret'.
+ */
+static sp_errc_t batch_chk_cb_ret(
+    batch_hndl_t *p_bhndl, int edit, edit_ctx_t *p_ectx, sp_errc_t ret)
+{
+    if (ret==SPEC_CB_FINISH || *p_ectx->p_b->p_finish) {
+        p_ectx->done = 1;
+        p_bhndl->n_pend--;
+        ret = (!p_bhndl->n_pend ? SPEC_CB_FINISH : SPEC_SUCCESS);
+    } else
+    if (ret!=SPEC_SUCCESS) {
+        p_bhndl->err_edit = edit;
+    }
+    return ret;
+}
+
+/* sp_edit_apply() parser callback: property */
+static sp_errc_t batch_cb_prop(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    batch_hndl_t *p_bhndl = (batch_hndl_t*)arg;
+    edit_ctx_t *p_ectx;
+    int i;
+
+    for (i=0; i<p_bhndl->n_edits; i++)
+    {
+        p_ectx = &p_bhndl->ectx[i];
+        if (p_ectx->done || p_ectx->pth.n!=p_bhndl->lev) continue;
+
+        ret = p_ectx->p_b->parser_cb.prop(
+            p_ectx->hndl, in, p_lname, p_lval, p_ldef);
+        EXEC_RG(batch_chk_cb_ret(p_bhndl, i, p_ectx, ret));
+    }
+finish:
+    return ret;
+}
+
+/* sp_edit_apply() parser callback: scope */
+static sp_errc_t batch_cb_scope(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    batch_hndl_t *p_bhndl = (batch_hndl_t*)arg;
+    edit_ctx_t *p_ectx;
+    int i;
+
+    for (i=0; i<p_bhndl->n_edits; i++)
+    {
+        p_ectx = &p_bhndl->ectx[i];
+        if (p_ectx->done || p_ectx->pth.n!=p_bhndl->lev) continue;
+
+        ret = p_ectx->p_b->parser_cb.scope(p_ectx->hndl,
+            in, p_ltype, p_lname, p_lbody, p_lbdyenc, p_ldef);
+        EXEC_RG(batch_chk_cb_ret(p_bhndl, i, p_ectx, ret));
+    }
+finish:
+    return ret;
+}
+
+/* sp_edit_apply() path following mode callback: scope body enter.
+
+   The enter callback of each edit reported in the enclosing scope body is
+   called with the edit's own level state. The body is descended if any of
+   the edits descends into it; its elements are dispatched to such edits only.
+ */
+static sp_errc_t batch_cb_enter(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    sp_parser_lev_t *p_lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    batch_hndl_t *p_bhndl = (batch_hndl_t*)arg;
+    edit_ctx_t *p_ectx;
+    sp_parser_lev_t lev;
+    int i;
+
+    for (i=0; i<p_bhndl->n_edits; i++)
+    {
+        p_ectx = &p_bhndl->ectx[i];
+        if (p_ectx->done || p_ectx->pth.n!=p_bhndl->lev) continue;
+
+        memset(&lev, 0, sizeof(lev));
+        ret = follow_cb_enter(p_ectx->hndl, in, p_ltype, p_lname, &lev);
+
+        if (ret==SPEC_SUCCESS && lev.desc &&
+            p_ectx->pth.n >= p_ectx->pth.sz)
+        {
+            int sz = (p_ectx->pth.sz ? 2*p_ectx->pth.sz : 8);
+            sp_parser_lev_t *levs = (sp_parser_lev_t*)realloc(
+                p_ectx->pth.levs, sz*sizeof(sp_parser_lev_t));
+
+            if (levs) {
+                p_ectx->pth.levs = levs;
+                p_ectx->pth.sz = sz;
+            } else
+                ret=SPEC_NOMEM;
+        }
+
+        if (ret!=SPEC_SUCCESS) {
+            p_bhndl->err_edit = i;
+            goto finish;
+        }
+
+        if (lev.desc) {
+            p_ectx->pth.levs[p_ectx->pth.n++] = lev;
+            p_lev->desc = 1;
+        }
+    }
+
+    if (p_lev->desc) p_bhndl->lev++;
+finish:
+    return ret;
+}
+
+/* sp_edit_apply() path following mode callback: scope body leave; see
+   batch_cb_enter().
+ */
+static sp_errc_t batch_cb_leave(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_lev_t *p_lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    batch_hndl_t *p_bhndl = (batch_hndl_t*)arg;
+    edit_ctx_t *p_ectx;
+    int i;
+
+    for (i=0; i<p_bhndl->n_edits; i++)
+    {
+        p_ectx = &p_bhndl->ectx[i];
+        if (p_ectx->done || p_ectx->pth.n!=p_bhndl->lev) continue;
+
+        /* the edit has descended into the left scope body */
+        p_ectx->pth.n--;
+        ret = follow_cb_leave(p_ectx->hndl,
+            in, p_lname, &p_ectx->pth.levs[p_ectx->pth.n]);
+        EXEC_RG(batch_chk_cb_ret(p_bhndl, i, p_ectx, ret));
+    }
+
+    p_bhndl->lev--;
+finish:
+    return ret;
+}
+
+/* Initialize edit context 'p_ectx' for recording the edit 'p_edit'.
+ */
+static sp_errc_t edit_init(edit_ctx_t *p_ectx, const sp_edit_t *p_edit,
+    SP_FILE *in, const sp_loc_t *p_parsc, unsigned long flags,
+    splices_t *p_rec)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const sp_edit_t *e = p_edit;
+
+    p_ectx->p_edit = p_edit;
+
+    EXEC_RG(sp_mopen_dyn(&p_ectx->out, 0, NULL));
+    p_ectx->out_opn++;
+
+    switch (e->op)
+    {
+    case SP_EDIT_ADD_PROP:
+    case SP_EDIT_ADD_SCOPE:
+        EXEC_RG(add_init(&p_ectx->c.add, in, &p_ectx->out, p_parsc,
+            (e->op==SP_EDIT_ADD_PROP ? e->name : NULL), e->val,
+            (e->op==SP_EDIT_ADD_SCOPE ? e->type : NULL),
+            (e->op==SP_EDIT_ADD_SCOPE ? e->name : NULL),
+            e->ind, e->path, e->deftp, NULL, flags, p_rec));
+        p_ectx->p_b = &p_ectx->c.add.ahndl.b;
+        p_ectx->hndl = &p_ectx->c.add.ahndl;
+        break;
+
+    case SP_EDIT_RM_PROP:
+    case SP_EDIT_RM_SCOPE:
+        EXEC_RG(rm_init(&p_ectx->c.rm, in, &p_ectx->out, p_parsc,
+            (e->op==SP_EDIT_RM_PROP ? e->name : NULL),
+            (e->op==SP_EDIT_RM_SCOPE ? e->type : NULL),
+            (e->op==SP_EDIT_RM_SCOPE ? e->name : NULL),
+            e->ind, e->path, e->deftp, flags, p_rec));
+        p_ectx->p_b = &p_ectx->c.rm.rhndl.b;
+        p_ectx->hndl = &p_ectx->c.rm.rhndl;
+        break;
+
+    case SP_EDIT_SET_PROP:
+    case SP_EDIT_MV_PROP:
+        EXEC_RG(mod_init(&p_ectx->c.mod, in, &p_ectx->out, p_parsc, 0, NULL,
+            e->name, NULL, e->new_name, e->val, e->ind, e->path, e->deftp,
+            NULL, (e->op==SP_EDIT_SET_PROP ? MOD_F_PROP_VAL : MOD_F_PROP_NAME),
+            flags, p_rec));
+        p_ectx->p_b = &p_ectx->c.mod.mhndl.b;
+        p_ectx->hndl = &p_ectx->c.mod.mhndl;
+        break;
+
+    case SP_EDIT_MV_SCOPE:
+        EXEC_RG(mod_init(&p_ectx->c.mod, in, &p_ectx->out, p_parsc, 1,
+            e->type, e->name, e->new_type, e->new_name, NULL, e->ind,
+            e->path, e->deftp, NULL, MOD_F_SCOPE_TYPE|MOD_F_SCOPE_NAME,
+            flags, p_rec));
+        p_ectx->p_b = &p_ectx->c.mod.mhndl.b;
+        p_ectx->hndl = &p_ectx->c.mod.mhndl;
+        break;
+
+    default:
+        ret=SPEC_INV_ARG;
+        break;
+    }
+
+finish:
+    return ret;
+}
+
+/* Finish recording of the edit 'p_ectx' after the input has been parsed.
+ */
+static sp_errc_t edit_fin(edit_ctx_t *p_ectx, SP_FILE *in)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    EXEC_RG(parse_lsc(in, p_ectx->p_b, p_ectx->hndl));
+
+    switch (p_ectx->p_edit->op)
+    {
+    case SP_EDIT_ADD_PROP:
+    case SP_EDIT_ADD_SCOPE:
+        ret = add_fin(&p_ectx->c.add);
+        break;
+
+    case SP_EDIT_RM_PROP:
+    case SP_EDIT_RM_SCOPE:
+        ret = rm_fin(&p_ectx->c.rm);
+        break;
+
+    default:
+        ret = mod_fin(&p_ectx->c.mod);
+        break;
+    }
+
+finish:
+    return ret;
+}
+
+/* qsort(3) splices comparison routine; the splices are ordered by the input
+   range they replace, next by the recording order.
+ */
+static int cmp_splices(const void *p1, const void *p2)
+{
+    const splice_t *s1 = (const splice_t*)p1, *s2 = (const splice_t*)p2;
+
+    if (s1->beg!=s2->beg) return (s1->beg < s2->beg ? -1 : 1);
+    if (s1->end!=s2->end) return (s1->end < s2->end ? -1 : 1);
+    if (s1->edit!=s2->edit) return (s1->edit < s2->edit ? -1 : 1);
+    return (s1->seq < s2->seq ? -1 : (s1->seq > s2->seq));
+}
+
+/* Get offset of the input 'in' end (EOF or NUL char) and write it under
+   'p_end'.
+ */
+static sp_errc_t get_in_end(SP_FILE *in, long *p_end)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    char buf[0x200];
+    size_t rd;
+    long end=0;
+
+    CHK_FSEEK(sp_fseek(in, 0, SEEK_SET));
+    do {
+        rd = sp_fread(buf, sizeof(buf), in);
+        end += (long)rd;
+    } while (rd==sizeof(buf));
+
+    *p_end = end;
+finish:
+    return ret;
+}
+
+/* Text position tracker; lines and columns are counted as by the lexer.
+ */
+typedef struct _txt_pos_t
+{
+    int line;
+    int col;
+    int cr;     /* if !=0 the last tracked char is CR */
+} txt_pos_t;
+
+/* Advance text position 'p_pos' by 'n' chars of 'b' */
+static void txt_pos_adv(txt_pos_t *p_pos, const char *b, size_t n)
+{
+    for (; n; n--, b++)
+    {
+        if (*b=='\n' && p_pos->cr) {
+            /* CRLF is a single EOL */
+            p_pos->cr = 0;
+        } else
+        if (*b=='\r' || *b=='\n') {
+            p_pos->line++;
+            p_pos->col = 1;
+            p_pos->cr = (*b=='\r');
+        } else {
+            p_pos->col++;
+            p_pos->cr = 0;
+        }
+    }
+}
+
+/* Advance text position 'p_pos' by the input 'in' chars in range 'beg' up to
+   'end' (exclusive).
+ */
+static sp_errc_t txt_pos_adv_in(txt_pos_t *p_pos, SP_FILE *in, long beg,
+    long end)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const char *b;
+    char buf[0x200];
+    size_t n;
+
+    for (; beg < end; beg += (long)n)
+    {
+        if ((b = sp_fview(in, beg, &n))==NULL)
+        {
+            /* not memory based stream */
+            n = (end-beg > (long)sizeof(buf) ? sizeof(buf) : (size_t)(end-beg));
+
+            if (sp_fseek(in, beg, SEEK_SET) || !(n = sp_fread(buf, n, in))) {
+                ret=SPEC_ACCS_ERR;
+                goto finish;
+            }
+            b = buf;
+        } else
+        if ((long)n > end-beg) {
+            n = (size_t)(end-beg);
+        }
+        txt_pos_adv(p_pos, b, n);
+    }
+finish:
+    return ret;
+}
+
+/* Calculate delta 'p_delta' of an edit with splices 'p_rec' applied to the
+   input 'in' with a parsing scope 'p_parsc'. The splices are sorted and
+   their texts are located in the edits outputs 'p_ectx'.
+ */
+static sp_errc_t calc_delta(SP_FILE *in, const sp_loc_t *p_parsc,
+    const splices_t *p_rec, const edit_ctx_t *p_ectx, sp_edit_delta_t *p_delta)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    txt_pos_t pos;
+    long off, end;
+    int i;
+
+    off = (p_parsc ? p_parsc->beg : 0);
+    pos.line = (p_parsc ? p_parsc->first_line : 1);
+    pos.col = (p_parsc ? p_parsc->first_column : 1);
+    pos.cr = 0;
+
+    memset(p_delta, 0, sizeof(*p_delta));
+
+    if (p_rec->n > 0)
+    {
+        txt_pos_t in_pos;
+
+        /* covering splice of all the edit splices */
+        end = p_rec->tab[p_rec->n-1].end;
+        p_delta->off = p_rec->tab[0].beg;
+        p_delta->rm_len = end-p_delta->off;
+        p_delta->ins_len = p_delta->rm_len;
+
+        EXEC_RG(txt_pos_adv_in(&pos, in, off, p_delta->off));
+        in_pos = pos;
+        EXEC_RG(txt_pos_adv_in(&in_pos, in, p_delta->off, end));
+
+        for (i=0, off=p_delta->off; i<p_rec->n; i++)
+        {
+            const splice_t *p_spl = &p_rec->tab[i];
+
+            EXEC_RG(txt_pos_adv_in(&pos, in, off, p_spl->beg));
+            txt_pos_adv(&pos,
+                &p_ectx[p_spl->edit].out.m.b[p_spl->txt_off],
+                (size_t)p_spl->txt_len);
+
+            p_delta->ins_len += p_spl->txt_len-(p_spl->end-p_spl->beg);
+            off = p_spl->end;
+        }
+
+        p_delta->in_line = in_pos.line;
+        p_delta->in_col = in_pos.col;
+    } else {
+        p_delta->off = off;
+        p_delta->in_line = pos.line;
+        p_delta->in_col = pos.col;
+    }
+    p_delta->out_line = pos.line;
+    p_delta->out_col = pos.col;
+
+finish:
+    return ret;
+}
+
+/* Apply 'n_edits' edits 'p_edits' (see sp_edit_apply()). If 'p_delta' is not
+   NULL it's written with the edits delta.
+ */
+static sp_errc_t edit_apply(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_t *p_edits, int n_edits, int *p_err_edit,
+    sp_edit_delta_t *p_delta)
+{
+    sp_errc_t ret=SPEC_SUCCESS, wrn=SPEC_SUCCESS;
+    batch_hndl_t bhndl;
+    splices_t rec;
+    sp_eol_t eol;
+    long off;
+    int i;
+
+    memset(&bhndl, 0, sizeof(bhndl));
+    memset(&rec, 0, sizeof(rec));
+    bhndl.err_edit = -1;
+
+    if (!in || !out || (!p_edits && n_edits>0) || n_edits<0) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    /* parsing scope with 'end' set to -1 spans up to the input end */
+    if (p_parsc && p_parsc->end!=-1) {
+        rec.in_end = p_parsc->end+1;
+    } else {
+        EXEC_RG(get_in_end(in, &rec.in_end));
+    }
+
+    /* detect EOL once for all the edits */
+    EXEC_RG(sp_util_detect_eol(in, &eol));
+
+    if (n_edits > 0)
+    {
+        bhndl.ectx = (edit_ctx_t*)calloc(n_edits, sizeof(edit_ctx_t));
+        if (!bhndl.ectx) {
+            ret=SPEC_NOMEM;
+            goto finish;
+        }
+    }
+
+    for (i=0; i<n_edits; i++, bhndl.n_edits++)
+    {
+        unsigned long flags = p_edits[i].flags;
+
+        if (SP_F_GET_USEEOL(flags)==(sp_eol_t)-1) flags |= SP_F_USEEOL(eol);
+
+        rec.edit = i;
+        ret = edit_init(&bhndl.ectx[i], &p_edits[i], in, p_parsc,
+            flags, &rec);
+        if (ret!=SPEC_SUCCESS) {
+            bhndl.err_edit = i;
+            bhndl.n_edits++;
+            goto finish;
+        }
+    }
+
+    /* single parsing pass dispatched to all the edits; scopes on the edits
+       paths are followed by the parser */
+    if ((bhndl.n_pend = bhndl.n_edits) > 0) {
+        EXEC_RG(sp_parse_path(in->pctx, in, p_parsc, batch_cb_prop,
+            batch_cb_scope, batch_cb_enter, batch_cb_leave, &bhndl, NULL));
+    }
+
+    for (i=0; i<bhndl.n_edits; i++)
+    {
+        rec.edit = i;
+        ret = edit_fin(&bhndl.ectx[i], in);
+
+        if (ret==SPEC_NOTFOUND && (p_edits[i].op==SP_EDIT_RM_PROP ||
+            p_edits[i].op==SP_EDIT_RM_SCOPE))
+        {
+            /* not found removal is a warning only (as for sp_rm_prop()) */
+            if (wrn==SPEC_SUCCESS) {
+                wrn = ret;
+                bhndl.err_edit = i;
+            }
+            ret = SPEC_SUCCESS;
+        } else
+        if (ret!=SPEC_SUCCESS) {
+            bhndl.err_edit = i;
+            goto finish;
+        }
+    }
+
+    /* check the edits don't overlap */
+    if (rec.n > 1) qsort(rec.tab, rec.n, sizeof(*rec.tab), cmp_splices);
+
+    for (i=1; i<rec.n; i++) {
+        if (rec.tab[i].beg < rec.tab[i-1].end) {
+            bhndl.err_edit = rec.tab[i].edit;
+            ret=SPEC_INV_ARG;
+            goto finish;
+        }
+    }
+
+    /* write the output in one pass */
+    off = (p_parsc ? p_parsc->beg : 0);
+    for (i=0; i<rec.n; i++)
+    {
+        const splice_t *p_spl = &rec.tab[i];
+        const SP_FILE *p_txt = &bhndl.ectx[p_spl->edit].out;
+
+        EXEC_RG(sp_util_cpy_to_out(in, out, off, p_spl->beg, NULL));
+        if (p_spl->txt_len > 0 && sp_fwrite(&p_txt->m.b[p_spl->txt_off],
+            (size_t)p_spl->txt_len, out)!=(size_t)p_spl->txt_len)
+        {
+            ret=SPEC_ACCS_ERR;
+            goto finish;
+        }
+        off = p_spl->end;
+    }
+    EXEC_RG(sp_util_cpy_to_out(in, out, off, rec.in_end, NULL));
+
+    if (p_delta) {
+        EXEC_RG(calc_delta(in, p_parsc, &rec, bhndl.ectx, p_delta));
+    }
+
+    ret = wrn;
+finish:
+    for (i=0; i<bhndl.n_edits; i++) {
+        if (bhndl.ectx[i].out_opn) sp_close(&bhndl.ectx[i].out);
+        if (bhndl.ectx[i].pth.levs) free(bhndl.ectx[i].pth.levs);
+    }
+    if (bhndl.ectx) free(bhndl.ectx);
+    if (rec.tab) free(rec.tab);
+
+    if (p_err_edit) *p_err_edit = (ret!=SPEC_SUCCESS ? bhndl.err_edit : -1);
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit_apply(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_batch_t *p_batch, int *p_err_edit)
+{
+    if (!p_batch) {
+        if (p_err_edit) *p_err_edit = -1;
+        return SPEC_INV_ARG;
+    }
+    return edit_apply(in, out, p_parsc,
+        p_batch->edits, p_batch->n_edits, p_err_edit, NULL);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_edit(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_t *p_edit, sp_edit_delta_t *p_delta)
+{
+    if (!p_edit) return SPEC_INV_ARG;
+    return edit_apply(in, out, p_parsc, p_edit, 1, NULL, p_delta);
+}
+
+/* exported; see header for details */
+sp_errc_t sp_parsc_extind(SP_FILE *in, sp_loc_t *p_parsc)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    int n=p_parsc->first_column-1;
+
+    if (n<=0) goto finish;
+
+    CHK_FSEEK(sp_fseek(in, p_parsc->beg-n, SEEK_SET));
+    for (; n>0 && isspace(sp_fgetc(in)); n--);
+
+    if (!n) {
+        p_parsc->beg -= p_parsc->first_column-1;
+        p_parsc->first_column = 1;
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_rewrite_scope(SP_FILE *in, SP_FILE *out, const sp_loc_t *p_parsc,
+    const sp_edit_batch_t *p_batch, int *p_err_edit)
+{
+    sp_errc_t ret=SPEC_SUCCESS, wrn=SPEC_SUCCESS;
+    sp_loc_t parsc;
+    int err_edit=-1;
+
+    if (!in || !out || !p_parsc || !p_batch) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    /* indentation of the scope is rewritten along with it (as for
+       transactions with a parsing scope) */
+    parsc = *p_parsc;
+    EXEC_RG(sp_parsc_extind(in, &parsc));
+
+    /* input preceding and following the scope is copied by blocks */
+    EXEC_RG(sp_util_cpy_to_out(in, out, 0, parsc.beg, NULL));
+
+    wrn = edit_apply(in, out, &parsc,
+        p_batch->edits, p_batch->n_edits, &err_edit, NULL);
+    if (wrn!=SPEC_SUCCESS && wrn!=SPEC_NOTFOUND) {
+        ret=wrn;
+        goto finish;
+    }
+
+    /* nothing follows the scope spanning up to the input end */
+    if (parsc.end!=-1) {
+        EXEC_RG(sp_util_cpy_to_out(in, out, parsc.end+1, EOF, NULL));
+    }
+    ret = wrn;
+
+finish:
+    if (p_err_edit) *p_err_edit = (ret!=SPEC_SUCCESS ? err_edit : -1);
+    return ret;
+}
+
+/* Rebase text position (offset 'p_off', line 'p_line', column 'p_col')
+   following the splice of the delta 'p_delta'.
+ */
+static void rebase_pos(
+    const sp_edit_delta_t *p_delta, long *p_off, int *p_line, int *p_col)
+{
+    *p_off += p_delta->ins_len-p_delta->rm_len;
+
+    if (*p_line==p_delta->in_line)
+        *p_col += p_delta->out_col-p_delta->in_col;
+    *p_line += p_delta->out_line-p_delta->in_line;
+}
+
+/* Invalidate location 'p_loc' */
+static void loc_inv(sp_loc_t *p_loc)
+{
+    memset(p_loc, 0, sizeof(*p_loc));
+    p_loc->end = -1;
+}
+
+/* Rebase location 'p_loc' (see sp_loc_rebase()). Return 0 if the location
+   has been invalidated.
+ */
+static int loc_rebase(sp_loc_t *p_loc, const sp_edit_delta_t *p_delta)
+{
+    long off = p_delta->off, end = p_delta->off+p_delta->rm_len;
+
+    if (p_loc->beg > p_loc->end)
+    {
+        /* empty location */
+        if (p_loc->beg <= off) return 1;
+        if (p_loc->beg < end) goto invalid;
+
+        rebase_pos(p_delta, &p_loc->beg, &p_loc->first_line,
+            &p_loc->first_column);
+        p_loc->end = p_loc->beg-1;
+        p_loc->last_line = p_loc->first_line;
+        p_loc->last_column = p_loc->first_column;
+        return 1;
+    }
+
+    /* location before the splice */
+    if (p_loc->end < off) return 1;
+
+    if (p_loc->beg >= end) {
+        /* location after the splice */
+        rebase_pos(p_delta, &p_loc->beg, &p_loc->first_line,
+            &p_loc->first_column);
+    } else
+    if (p_loc->beg >= off || p_loc->end < end) {
+        /* location overlapping the removed input range */
+        goto invalid;
+    }
+
+    /* location after or enclosing the splice */
+    rebase_pos(p_delta, &p_loc->end, &p_loc->last_line, &p_loc->last_column);
+    return 1;
+
+invalid:
+    loc_inv(p_loc);
+    return 0;
+}
+
+/* exported; see header for details */
+int sp_loc_rebase(sp_loc_t *p_locs, int n, const sp_edit_delta_t *p_delta)
+{
+    int i, n_inv=0;
+
+    if (!p_locs || !p_delta || (!p_delta->rm_len && !p_delta->ins_len))
+        return 0;
+
+    for (i=0; i<n; i++) {
+        if (!loc_rebase(&p_locs[i], p_delta)) n_inv++;
+    }
+    return n_inv;
+}
+
+/* exported; see header for details */
+int sp_prop_info_rebase(
+    sp_prop_info_ex_t *p_infos, int n, const sp_edit_delta_t *p_delta)
+{
+    int i, n_inv=0;
+
+    if (!p_infos || !p_delta || (!p_delta->rm_len && !p_delta->ins_len))
+        return 0;
+
+    for (i=0; i<n; i++)
+    {
+        sp_prop_info_ex_t *p_info = &p_infos[i];
+        int val = 1;
+
+        if (p_info->val_pres) val = loc_rebase(&p_info->tkval.loc, p_delta);
+
+        if (!(loc_rebase(&p_info->ldef, p_delta) &
+            loc_rebase(&p_info->tkname.loc, p_delta) & val))
+        {
+            n_inv++;
+        }
+    }
+    return n_inv;
+}
+
+/* exported; see header for details */
+int sp_scope_info_rebase(
+    sp_scope_info_ex_t *p_infos, int n, const sp_edit_delta_t *p_delta)
+{
+    int i, n_inv=0;
+
+    if (!p_infos || !p_delta || (!p_delta->rm_len && !p_delta->ins_len))
+        return 0;
+
+    for (i=0; i<n; i++)
+    {
+        sp_scope_info_ex_t *p_info = &p_infos[i];
+        long off = p_delta->off, end = p_delta->off+p_delta->rm_len;
+        int typ = 1, bdy = 1;
+
+        if (p_info->type_pres) typ = loc_rebase(&p_info->tktype.loc, p_delta);
+
+        if (off > p_info->lbdyenc.beg && end <= p_info->lbdyenc.end &&
+            (!p_info->body_pres ||
+            end <= p_info->lbody.beg || off > p_info->lbody.end))
+        {
+            /* the splice is inside the brackets but outside the body,
+               therefore the body bounds may have changed */
+            loc_inv(&p_info->lbody);
+            bdy = 0;
+        } else
+        if (p_info->body_pres) bdy = loc_rebase(&p_info->lbody, p_delta);
+
+        if (!(loc_rebase(&p_info->ldef, p_delta) &
+            loc_rebase(&p_info->lbdyenc, p_delta) &
+            loc_rebase(&p_info->tkname.loc, p_delta) & typ & bdy))
+        {
+            n_inv++;
+        }
+    }
+    return n_inv;
+}
+
 #undef __NEIND_DEF
 #undef __EIND_DEF
 #undef __BASE_DEFS
@@ -0,0 +1,61 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Content of this header is not a part of the library API interface.
+   It rather defines internal use (private) helpers shared by the properties
+   access modules. Public part of this interface is defined in the props.h
+   header.
+ */
+
+#ifndef __SP_PROPS_INT_H__
+#define __SP_PROPS_INT_H__
+
+#include "sprops/props.h"
+
+/* single path segment (scope spec. on a given path level) */
+typedef struct _sp_pathseg_t
+{
+    const char *type;   /* scope type (not NULL terminated; may be NULL) */
+    size_t typ_len;     /* scope type length */
+    int typ_esc;        /* if !=0: scope type may contain escaped chars */
+
+    const char *name;   /* scope name (not NULL terminated) w/o index spec. */
+    size_t nm_len;      /* scope name length */
+    int nm_esc;         /* if !=0: scope name may contain escaped chars */
+
+    int ind;            /* split-scope index spec. (SP_IND_ALL if absent) */
+
+    /* de-escaped scope type and name hashes and lengths as calculated by
+       sp_parser_str_hash(); length <0: not available */
+    unsigned long typ_hash;
+    long typ_hlen;
+    unsigned long nm_hash;
+    long nm_hlen;
+
+    const char *next;   /* beginning of the remaining part of the path */
+} sp_pathseg_t;
+
+/* Parse the first segment of a path starting at 'beg' and ending at 'end'
+   (exclusive; points to the path NULL terminator). 'deftp' is the default
+   scope type. The result is written under 'p_seg'. In case of the segment
+   syntax error SPEC_INV_PATH is returned.
+ */
+sp_errc_t sp_path_seg(
+    const char *beg, const char *end, const char *deftp, sp_pathseg_t *p_seg);
+
+/* Extend a parsing scope 'p_parsc' by indentation white spaces preceding the
+   scope on its first line. The scope is not modified if preceded by other
+   chars on the line.
+ */
+sp_errc_t sp_parsc_extind(SP_FILE *in, sp_loc_t *p_parsc);
+
+#endif  /* __SP_PROPS_INT_H__ */
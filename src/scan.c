@@ -0,0 +1,169 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include "config.h"
+#include "scan.h"
+
+#if CONFIG_LEX_SIMD
+# include <immintrin.h>
+#endif
+
+/* chars classes of the table entries */
+#define _NUL (SP_CC_RSV | SP_CC_STOP_ID | SP_CC_STOP_DQ | SP_CC_STOP_SQ | \
+    SP_CC_STOP_VAL | SP_CC_STOP_CMT)
+#define _EOL (SP_CC_SPACE | SP_CC_STOP_ID | SP_CC_STOP_DQ | SP_CC_STOP_SQ | \
+    SP_CC_STOP_VAL | SP_CC_STOP_CMT)
+#define _SPC (SP_CC_SPACE | SP_CC_STOP_ID)
+#define _RSV (SP_CC_RSV | SP_CC_STOP_ID)
+#if CONFIG_NO_SEMICOL_ENDS_VAL
+# define _SCL (SP_CC_RSV | SP_CC_STOP_ID)
+#else
+# define _SCL (SP_CC_RSV | SP_CC_STOP_ID | SP_CC_STOP_VAL)
+#endif
+#define _ESC (SP_CC_STOP_ID | SP_CC_STOP_DQ | SP_CC_STOP_SQ | SP_CC_STOP_VAL)
+#define _DQT SP_CC_STOP_DQ
+#define _SQT SP_CC_STOP_SQ
+
+const unsigned char sp_cctab[256] =
+{
+    _NUL, 0, 0, 0, 0, 0, 0, 0, 0, _SPC, _EOL, _SPC, _SPC, _EOL, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    _SPC, 0, _DQT, _RSV, 0, 0, 0, _SQT, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, _SCL, 0, _RSV, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, _ESC, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, _RSV, 0, _RSV, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+#undef _SQT
+#undef _DQT
+#undef _ESC
+#undef _SCL
+#undef _RSV
+#undef _SPC
+#undef _EOL
+#undef _NUL
+
+/* SIMD stopping chars sets are supersets of the classes: all control chars
+   (up to CR or space for non quoted ids) stop the run */
+const sp_scan_mode_t sp_scan_id =
+    {SP_CC_STOP_ID, ' ', 6, {'=', '{', '}', ';', '#', '\\'}};
+const sp_scan_mode_t sp_scan_dq = {SP_CC_STOP_DQ, '\r', 2, {'"', '\\'}};
+const sp_scan_mode_t sp_scan_sq = {SP_CC_STOP_SQ, '\r', 2, {'\'', '\\'}};
+#if CONFIG_NO_SEMICOL_ENDS_VAL
+const sp_scan_mode_t sp_scan_val = {SP_CC_STOP_VAL, '\r', 1, {'\\'}};
+#else
+const sp_scan_mode_t sp_scan_val = {SP_CC_STOP_VAL, '\r', 2, {'\\', ';'}};
+#endif
+const sp_scan_mode_t sp_scan_cmt = {SP_CC_STOP_CMT, '\r', 0, {0}};
+
+/* Table driven scanning */
+static size_t scan_tab(
+    const char *buf, size_t num, const sp_scan_mode_t *p_mode)
+{
+    size_t i=0;
+    unsigned cc = p_mode->cc;
+
+    while (i < num && !(sp_cctab[(unsigned char)buf[i]] & cc)) i++;
+    return i;
+}
+
+#if CONFIG_LEX_SIMD
+/* SSE2 scanning (16 chars blocks) */
+static size_t scan_sse2(
+    const char *buf, size_t num, const sp_scan_mode_t *p_mode)
+{
+    size_t i=0;
+    int k, msk;
+    __m128i v, m, lim, chrs[6];
+
+    lim = _mm_set1_epi8((char)p_mode->lim);
+    for (k=0; k < p_mode->n_chrs; k++)
+        chrs[k] = _mm_set1_epi8(p_mode->chrs[k]);
+
+    for (; i+16 <= num; i+=16)
+    {
+        v = _mm_loadu_si128((const __m128i*)&buf[i]);
+
+        /* unsigned v <= lim */
+        m = _mm_cmpeq_epi8(_mm_min_epu8(v, lim), v);
+        for (k=0; k < p_mode->n_chrs; k++)
+            m = _mm_or_si128(m, _mm_cmpeq_epi8(v, chrs[k]));
+
+        if ((msk = _mm_movemask_epi8(m))!=0)
+            return i + (size_t)__builtin_ctz((unsigned)msk);
+    }
+    return i + scan_tab(&buf[i], num-i, p_mode);
+}
+
+/* AVX2 scanning (32 chars blocks) */
+__attribute__((target("avx2")))
+static size_t scan_avx2(
+    const char *buf, size_t num, const sp_scan_mode_t *p_mode)
+{
+    size_t i=0;
+    int k, msk;
+    __m256i v, m, lim, chrs[6];
+
+    lim = _mm256_set1_epi8((char)p_mode->lim);
+    for (k=0; k < p_mode->n_chrs; k++)
+        chrs[k] = _mm256_set1_epi8(p_mode->chrs[k]);
+
+    for (; i+32 <= num; i+=32)
+    {
+        v = _mm256_loadu_si256((const __m256i*)&buf[i]);
+
+        m = _mm256_cmpeq_epi8(_mm256_min_epu8(v, lim), v);
+        for (k=0; k < p_mode->n_chrs; k++)
+            m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, chrs[k]));
+
+        if ((msk = _mm256_movemask_epi8(m))!=0) {
+            _mm256_zeroupper();
+            return i + (size_t)__builtin_ctz((unsigned)msk);
+        }
+    }
+
+    /* avoid AVX-SSE transition penalty (not guaranteed by the compiler
+       for not optimized builds) */
+    _mm256_zeroupper();
+    return i + scan_sse2(&buf[i], num-i, p_mode);
+}
+#endif  /* CONFIG_LEX_SIMD */
+
+/* exported; see header for details */
+size_t sp_scan_run(const char *buf, size_t num, const sp_scan_mode_t *p_mode)
+{
+#if CONFIG_LEX_SIMD
+    size_t i, n = (num < 16 ? num : 16);
+
+    /* most of the runs are short and not worth SIMD setup; check the first
+       chars by the table lookup */
+    if ((i = scan_tab(buf, n, p_mode)) < n || i==num) return i;
+
+    /* the scanning routine is selected basing on the CPU capabilities
+       detected by the compiler's runtime at the program startup; no state
+       is cached to keep the routine re-entrant */
+    return i + (__builtin_cpu_supports("avx2") ?
+        scan_avx2(&buf[i], num-i, p_mode) : scan_sse2(&buf[i], num-i, p_mode));
+#else
+    return scan_tab(buf, num, p_mode);
+#endif
+}
@@ -0,0 +1,75 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Content of this header is not a part of the library API interface.
+   It defines the lexer's chars classification and fast scanning of chars
+   runs not requiring the lexer's state machine attention.
+ */
+
+#ifndef __SP_SCAN_H__
+#define __SP_SCAN_H__
+
+#include <stddef.h>
+
+/* Chars classes (bit mask)
+ */
+/* isspace(3) chars (as for the "C" locale) */
+#define SP_CC_SPACE     0x01U
+/* reserved chars and NULL; not allowed in non quoted SP_TKN_ID */
+#define SP_CC_RSV       0x02U
+
+/* The following classes define chars stopping a run of chars of a given
+   lexer's state. Chars inside the run are treated by the lexer uniformly.
+ */
+/* non quoted SP_TKN_ID */
+#define SP_CC_STOP_ID   0x04U
+/* SP_TKN_ID quoted by '"' */
+#define SP_CC_STOP_DQ   0x08U
+/* SP_TKN_ID quoted by '\'' */
+#define SP_CC_STOP_SQ   0x10U
+/* SP_TKN_VAL */
+#define SP_CC_STOP_VAL  0x20U
+/* comment */
+#define SP_CC_STOP_CMT  0x40U
+
+/* Chars classes table */
+extern const unsigned char sp_cctab[256];
+
+/* Chars run scanning mode */
+typedef struct _sp_scan_mode_t
+{
+    /* stopping chars class (SP_CC_STOP_XXX) */
+    unsigned cc;
+
+    /* SIMD scanning: stopping chars are chars not greater than 'lim' and
+       'n_chrs' chars from 'chrs'. The set may be a superset of the class. */
+    unsigned char lim;
+    int n_chrs;
+    char chrs[6];
+} sp_scan_mode_t;
+
+/* Predefined scanning modes for the lexer's states */
+extern const sp_scan_mode_t sp_scan_id;
+extern const sp_scan_mode_t sp_scan_dq;
+extern const sp_scan_mode_t sp_scan_sq;
+extern const sp_scan_mode_t sp_scan_val;
+extern const sp_scan_mode_t sp_scan_cmt;
+
+/* Scan 'buf' of 'num' chars length in a mode 'p_mode'. Return length of the
+   run of chars preceding the first stopping char (or 'num' if not found).
+
+   NOTE: If SIMD scanning is used the returned run may be shorter than the
+   one defined by the chars class (but never longer).
+ */
+size_t sp_scan_run(const char *buf, size_t num, const sp_scan_mode_t *p_mode);
+
+#endif  /* __SP_SCAN_H__ */
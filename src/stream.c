@@ -0,0 +1,341 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Single-pass streaming reader.
+
+   The source stream is read sequentially into a caller provided window
+   buffer, which is exposed to the parser as a directly accessed custom stream
+   (see sp_fopen_custom()). The parser is run in the path following mode with
+   all scopes descended, therefore the elements are reported while parsed, and
+   their tokens are copied from the window just after they have been
+   recognized by the lexer. Content of the window preceding the last reported
+   element is not needed anymore and is dropped to make room for the next
+   block of the source.
+ */
+
+#include <string.h>
+#include "config.h"
+#include "io.h"
+#include "parser_int.h"
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* window over the source stream */
+typedef struct _win_t
+{
+    SP_FILE *in;    /* source stream */
+
+    char *b;        /* window buffer */
+    size_t sz;      /* window buffer size */
+
+    long off;       /* stream offset of the window content */
+    size_t num;     /* number of chars in the window */
+
+    long pos;       /* stream position */
+    long keep;      /* content starting from this offset is kept */
+
+    int eof;        /* if !=0: the source end has been reached */
+    int ovf;        /* if !=0: the kept content overflowed the window */
+} win_t;
+
+/* Read the next block of the source into the window. If the window is full
+   its content not needed anymore is dropped beforehand. Return number of read
+   chars.
+ */
+static size_t win_fill(win_t *p_win)
+{
+    size_t n, drop;
+
+    if (p_win->eof || p_win->ovf) return 0;
+
+    if (p_win->num >= p_win->sz) {
+        drop = (size_t)(p_win->keep - p_win->off);
+        if (!drop) {
+            p_win->ovf = 1;
+            return 0;
+        }
+        memmove(p_win->b, &p_win->b[drop], p_win->num-drop);
+        p_win->off += (long)drop;
+        p_win->num -= drop;
+    }
+
+    n = sp_fread(&p_win->b[p_win->num], p_win->sz-p_win->num, p_win->in);
+    if (!n) p_win->eof = 1;
+    p_win->num += n;
+
+    return n;
+}
+
+/* window stream operations */
+
+static const char *win_ptr(void *ctx, long off, size_t *p_num)
+{
+    win_t *p_win = (win_t*)ctx;
+
+    /* the content has been already dropped */
+    if (off < p_win->off) return NULL;
+
+    while (off >= p_win->off+(long)p_win->num)
+        if (!win_fill(p_win)) return NULL;
+
+    *p_num = p_win->num - (size_t)(off - p_win->off);
+    return &p_win->b[off - p_win->off];
+}
+
+static long win_read(void *ctx, char *buf, size_t num)
+{
+    win_t *p_win = (win_t*)ctx;
+    const char *w;
+    size_t n;
+
+    if (!(w = win_ptr(ctx, p_win->pos, &n))) return 0;
+
+    if (n > num) n = num;
+    memcpy(buf, w, n);
+    p_win->pos += (long)n;
+
+    return (long)n;
+}
+
+static int win_seek(void *ctx, long off, int origin)
+{
+    win_t *p_win = (win_t*)ctx;
+
+    /* the stream end is not known in advance */
+    if (origin==SEEK_CUR) off += p_win->pos;
+    else if (origin!=SEEK_SET) return -1;
+
+    if (off < 0) return -1;
+    p_win->pos = off;
+
+    return 0;
+}
+
+static long win_tell(void *ctx)
+{
+    return ((win_t*)ctx)->pos;
+}
+
+static const sp_fops_t win_ops =
+{
+    win_read, NULL, win_seek, win_tell, win_ptr, NULL
+};
+
+/* streaming reader handle */
+typedef struct _strm_hndl_t
+{
+    win_t *p_win;
+
+    struct {
+        sp_strm_cb_prop_t prop;
+        sp_strm_cb_enter_t enter;
+        sp_strm_cb_leave_t leave;
+        void *arg;
+    } cb;
+
+    struct {
+        char *ptr;
+        size_t sz;
+    } buf1, buf2;
+
+    /* current scope level */
+    int lev;
+
+    /* if !=0: the scope callback follows the leave callback */
+    int left;
+} strm_hndl_t;
+
+/* Elements cut by the window overflow are not reported */
+#define CHK_OVF_RG() \
+    if (p_shndl->p_win->ovf) { ret=SPEC_SIZE; goto finish; }
+
+/* Copy a token of type 'tkn' at 'p_tloc' (may be NULL) from the window to
+   a buffer 'p_buf' */
+#define CPY_TKN_RG(tkn, p_tloc, p_buf) \
+    EXEC_RG(sp_parser_tkn_cpy_int(in, (tkn), (p_tloc), \
+        (p_buf)->ptr, (p_buf)->sz, NULL));
+
+/* check user callback return code */
+#define __CHK_USER_CB_RET() \
+    if ((int)ret<0 && ret!=SPEC_CB_FINISH) ret=SPEC_CB_RET_ERR;
+
+/* Report entering a scope with type 'p_ltype' and name 'p_lname' */
+static sp_errc_t strm_enter(strm_hndl_t *p_shndl, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    CHK_OVF_RG();
+
+    if (p_shndl->cb.enter)
+    {
+        CPY_TKN_RG(SP_TKN_ID, p_ltype, &p_shndl->buf1);
+        CPY_TKN_RG(SP_TKN_ID, p_lname, &p_shndl->buf2);
+
+        ret = p_shndl->cb.enter(p_shndl->cb.arg,
+            (p_ltype ? p_shndl->buf1.ptr : NULL), p_shndl->buf2.ptr,
+            p_shndl->lev);
+
+        __CHK_USER_CB_RET();
+    }
+finish:
+    return ret;
+}
+
+/* Report leaving a scope */
+static sp_errc_t strm_leave(strm_hndl_t *p_shndl)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    CHK_OVF_RG();
+
+    if (p_shndl->cb.leave) {
+        ret = p_shndl->cb.leave(p_shndl->cb.arg, p_shndl->lev);
+        __CHK_USER_CB_RET();
+    }
+finish:
+    return ret;
+}
+
+/* sp_read_stream() parser callback: property */
+static sp_errc_t strm_cb_prop(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_tkn_loc_t *p_lval,
+    const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    strm_hndl_t *p_shndl = (strm_hndl_t*)arg;
+
+    CHK_OVF_RG();
+    p_shndl->p_win->keep = p_ldef->end+1;
+
+    if (p_shndl->cb.prop)
+    {
+        CPY_TKN_RG(SP_TKN_ID, p_lname, &p_shndl->buf1);
+        CPY_TKN_RG(SP_TKN_VAL, p_lval, &p_shndl->buf2);
+
+        ret = p_shndl->cb.prop(p_shndl->cb.arg, p_shndl->buf1.ptr,
+            (p_lval ? p_shndl->buf2.ptr : NULL), p_shndl->lev);
+
+        __CHK_USER_CB_RET();
+    }
+finish:
+    return ret;
+}
+
+/* sp_read_stream() parser callback: scope
+
+   Scopes with a body have been already reported by the enter/leave callbacks.
+   Scopes w/o a body (alternative definition) are reported here.
+ */
+static sp_errc_t strm_cb_scope(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    const sp_loc_t *p_lbody, const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    strm_hndl_t *p_shndl = (strm_hndl_t*)arg;
+
+    if (p_shndl->left) {
+        p_shndl->left = 0;
+    } else {
+        EXEC_RG(strm_enter(p_shndl, in, p_ltype, p_lname));
+        EXEC_RG(strm_leave(p_shndl));
+    }
+    p_shndl->p_win->keep = p_ldef->end+1;
+
+finish:
+    return ret;
+}
+
+/* sp_read_stream() scope body enter callback; all scopes are descended */
+static sp_errc_t strm_cb_enter(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_ltype, const sp_parser_tkn_loc_t *p_lname,
+    sp_parser_lev_t *p_lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    strm_hndl_t *p_shndl = (strm_hndl_t*)arg;
+
+    EXEC_RG(strm_enter(p_shndl, in, p_ltype, p_lname));
+    p_shndl->p_win->keep = p_lname->loc.end+1;
+
+    p_lev->desc = 1;
+    p_shndl->lev++;
+
+finish:
+    return ret;
+}
+
+/* sp_read_stream() scope body leave callback */
+static sp_errc_t strm_cb_leave(void *arg, SP_FILE *in,
+    const sp_parser_tkn_loc_t *p_lname, const sp_parser_lev_t *p_lev)
+{
+    strm_hndl_t *p_shndl = (strm_hndl_t*)arg;
+
+    p_shndl->lev--;
+    p_shndl->left = 1;
+
+    return strm_leave(p_shndl);
+}
+
+#undef __CHK_USER_CB_RET
+#undef CPY_TKN_RG
+#undef CHK_OVF_RG
+
+/* exported; see header for details */
+sp_errc_t sp_read_stream(SP_FILE *in, char *win, size_t win_len,
+    sp_strm_cb_prop_t cb_prop, sp_strm_cb_enter_t cb_enter,
+    sp_strm_cb_leave_t cb_leave, void *arg, char *buf1, size_t b1len,
+    char *buf2, size_t b2len, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    SP_FILE wf;
+    win_t w;
+    strm_hndl_t shndl;
+    sp_synerr_t synerr;
+
+    if (!in || !win || win_len<2 || !b1len || !b2len) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    memset(&w, 0, sizeof(w));
+    w.in = in;
+    w.b = win;
+    w.sz = win_len;
+
+    memset(&shndl, 0, sizeof(shndl));
+    shndl.p_win = &w;
+    shndl.cb.prop = cb_prop;
+    shndl.cb.enter = cb_enter;
+    shndl.cb.leave = cb_leave;
+    shndl.cb.arg = arg;
+
+    shndl.buf1.ptr = buf1;
+    shndl.buf1.sz = b1len-1;
+    shndl.buf1.ptr[shndl.buf1.sz] = 0;
+    shndl.buf2.ptr = buf2;
+    shndl.buf2.sz = b2len-1;
+    shndl.buf2.ptr[shndl.buf2.sz] = 0;
+
+    EXEC_RG(sp_fopen_custom(&wf, &win_ops, &w));
+
+    ret = sp_parse_path(in->pctx, &wf, NULL, strm_cb_prop, strm_cb_scope,
+        strm_cb_enter, strm_cb_leave, &shndl, &synerr);
+
+    /* the window overflow cuts the input; the syntax error possibly
+       detected at the cut is not reported */
+    if (w.ovf && ret!=SPEC_CB_RET_ERR) ret=SPEC_SIZE;
+    if (ret==SPEC_SYNTAX && p_synerr) *p_synerr = synerr;
+
+    sp_close(&wf);
+finish:
+    return ret;
+}
@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016,2019 Piotr Stolarz
+   Copyright (c) 2016,2019,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -15,6 +15,7 @@
 
 #include "config.h"
 #include "io.h"
+#include "props_int.h"
 #include "sprops/trans.h"
 #include "sprops/utils.h"
 
@@ -41,39 +42,29 @@
 #define PARSC(t) \
     (!(t)->parsc.first_column || IN_ST(t)==FSTATE_TEMP ? NULL : &(t)->parsc)
 
+/* in-memory transaction (see sp_init_mem_tr()) */
+#define IS_MEM_TR(t) ((t)->ths.open==th_mem_open)
+
+/* Prepare output stream. Temporary memory stream of in-memory transaction is
+   reused (its content is truncated) instead of being reopened.
+ */
 #define PREP_OUT(t) \
     if (!(t) || IN_ST(t)==FSTATE_EMPT) { ret=SPEC_INV_ARG; goto finish; } \
-    if (OUT_ST(t)==FSTATE_TEMP) (t)->ths.close((t)->ths.arg, OUT_F(t)); \
-    OUT_ST(t) = FSTATE_EMPT; \
-    EXEC_RG((t)->ths.open((t)->ths.arg, OUT_F(t))); \
-    OUT_ST(t) = FSTATE_TEMP;
+    if (OUT_ST(t)==FSTATE_TEMP && IS_MEM_TR(t)) { \
+        OUT_F(t)->m.num = OUT_F(t)->m.i = 0; \
+    } else { \
+        if (OUT_ST(t)==FSTATE_TEMP) (t)->ths.close((t)->ths.arg, OUT_F(t)); \
+        OUT_ST(t) = FSTATE_EMPT; \
+        EXEC_RG((t)->ths.open((t)->ths.arg, OUT_F(t))); \
+        OUT_ST(t) = FSTATE_TEMP; \
+    }
 
 /* IN <-> OUT */
 #define PART_COMMIT(t) \
     (t)->fs_i^=1; \
     (t)->n_commits++;
 
-#if CONFIG_TRANS_PARSC_MOD==PARSC_EXTIND
-/* Extend a parsing scope by indentation white spaces preceding the scope.
- */
-static sp_errc_t parsc_extind(SP_FILE *in, sp_loc_t *p_parsc)
-{
-    sp_errc_t ret=SPEC_SUCCESS;
-    int n=p_parsc->first_column-1;
-
-    if (n<=0) goto finish;
-
-    CHK_FSEEK(sp_fseek(in, p_parsc->beg-n, SEEK_SET));
-    for (; n>0 && isspace(sp_fgetc(in)); n--);
-
-    if (!n) {
-        p_parsc->beg -= p_parsc->first_column-1;
-        p_parsc->first_column = 1;
-    }
-finish:
-    return ret;
-}
-#elif CONFIG_TRANS_PARSC_MOD==PARSC_AS_INPUT
+#if CONFIG_TRANS_PARSC_MOD==PARSC_AS_INPUT
 /* Copy indented (or partially indented) version of a parsing scope to a
    temporary stream created by the function and written under 'f'. 'p_ind_sz'
    will get number of indentation white spaces written before the parsing scope
@@ -119,12 +110,42 @@ finish:
 /* default handlers */
 static sp_errc_t th_open(void *arg, SP_FILE *f) {
     FILE *cf = tmpfile();
-    return (cf ? sp_fopen2(f, cf) : SPEC_FOPEN_ERR);
+    if (!cf) return SPEC_FOPEN_ERR;
+
+    sp_fopen2(f, cf);
+
+    /* buffering is optional; proceed in case of failure */
+    if (CONFIG_FILE_BUF_SIZE>0) sp_fsetbuf(f, CONFIG_FILE_BUF_SIZE);
+    return SPEC_SUCCESS;
 }
 static void th_close(void *arg, SP_FILE *f) {
     sp_close(f);
 }
 
+/* in-memory transaction handlers; 'arg' is the allocator */
+static sp_errc_t th_mem_open(void *arg, SP_FILE *f) {
+    return sp_mopen_dyn(f, 0, (const sp_alloc_t*)arg);
+}
+#define th_mem_close th_close
+
+/* Copy content of a memory stream 'in' starting from 'beg' to 'out' by a single
+   write. As for sp_util_cpy_to_out() NULL char terminates the content.
+ */
+static sp_errc_t mem_cpy_to_out(SP_FILE *in, SP_FILE *out, long beg)
+{
+    const char *nul;
+    size_t len=0;
+
+    if (beg>=0 && (size_t)beg<in->m.num)
+    {
+        len = in->m.num-(size_t)beg;
+        if ((nul = (const char*)memchr(&in->m.b[beg], 0, len))!=NULL)
+            len = (size_t)(nul-&in->m.b[beg]);
+    }
+    return (!len || sp_fwrite(&in->m.b[beg], len, out)==len ?
+        SPEC_SUCCESS : SPEC_ACCS_ERR);
+}
+
 /* exported; see header for details */
 sp_errc_t sp_init_tr(sp_trans_t *p_trans, SP_FILE *in,
     const sp_loc_t *p_parsc, const sp_trans_ths_t *p_ths)
@@ -154,7 +175,7 @@ sp_errc_t sp_init_tr(sp_trans_t *p_trans, SP_FILE *in,
         EXEC_RG(cpy_ind_parsc(in, p_parsc, &p_trans->ths,
             IN_F(p_trans), &IN_ST(p_trans), &p_trans->skip_in));
 #elif CONFIG_TRANS_PARSC_MOD==PARSC_EXTIND
-        EXEC_RG(parsc_extind(in, &p_trans->parsc));
+        EXEC_RG(sp_parsc_extind(in, &p_trans->parsc));
 #endif
     }
 
@@ -177,6 +198,19 @@ finish:
     return ret;
 }
 
+/* exported; see header for details */
+sp_errc_t sp_init_mem_tr(sp_trans_t *p_trans, SP_FILE *in,
+    const sp_loc_t *p_parsc, const sp_alloc_t *alloc)
+{
+    sp_trans_ths_t ths;
+
+    ths.open = th_mem_open;
+    ths.close = th_mem_close;
+    ths.arg = (void*)alloc;
+
+    return sp_init_tr(p_trans, in, p_parsc, &ths);
+}
+
 /* exported; see header for details */
 sp_errc_t sp_commit_tr(sp_trans_t *p_trans, SP_FILE *out)
 {
@@ -199,8 +233,12 @@ sp_errc_t sp_commit_tr(sp_trans_t *p_trans, SP_FILE *out)
         if (!p_trans->parsc.first_column)
         {
             /* global scope modification */
-            EXEC_RG(sp_util_cpy_to_out(
-                IN_F(p_trans), out, p_trans->skip_in, EOF, NULL));
+            if (IS_MEM_TR(p_trans)) {
+                EXEC_RG(mem_cpy_to_out(IN_F(p_trans), out, p_trans->skip_in));
+            } else {
+                EXEC_RG(sp_util_cpy_to_out(
+                    IN_F(p_trans), out, p_trans->skip_in, EOF, NULL));
+            }
         } else
         if (p_trans->in)
         {
@@ -209,8 +247,12 @@ sp_errc_t sp_commit_tr(sp_trans_t *p_trans, SP_FILE *out)
             EXEC_RG(sp_util_cpy_to_out(
                 p_trans->in, out, 0, p_trans->parsc.beg, NULL));
 
-            EXEC_RG(sp_util_cpy_to_out(
-                IN_F(p_trans), out, p_trans->skip_in, EOF, NULL));
+            if (IS_MEM_TR(p_trans)) {
+                EXEC_RG(mem_cpy_to_out(IN_F(p_trans), out, p_trans->skip_in));
+            } else {
+                EXEC_RG(sp_util_cpy_to_out(
+                    IN_F(p_trans), out, p_trans->skip_in, EOF, NULL));
+            }
 
             EXEC_RG(sp_util_cpy_to_out(
                 p_trans->in, out, p_trans->parsc.end+1, EOF, NULL));
@@ -1,5 +1,5 @@
 /*
-   Copyright (c) 2016 Piotr Stolarz
+   Copyright (c) 2016,2022 Piotr Stolarz
    Scoped properties configuration library
 
    Distributed under the 2-clause BSD License (the License)
@@ -21,6 +21,10 @@
 
 #define CHK_FSEEK(c) if ((c)!=0) { ret=SPEC_ACCS_ERR; goto finish; }
 
+/* sp_util_cpy_to_out() intermediate buffer size (used for the input streams
+   w/o the direct access) */
+#define CPY_BUF_SIZE    0x1000
+
 /* exported; see header for details */
 sp_errc_t
     sp_util_cpy_to_out(SP_FILE *in, SP_FILE *out, long beg, long end, long *p_n)
@@ -37,17 +41,62 @@ sp_errc_t
 
     if (off<end || end==EOF)
     {
-        int c;
         CHK_FSEEK(sp_fseek(in, off, SEEK_SET));
 
-        for (; off<end || end==EOF; off++)
+        if (sp_fdirect(in))
         {
-            c = sp_fgetc(in);
-            if (c==EOF && end==EOF) break;
-            if (c==EOF || sp_fputc(c, out)==EOF) {
+            const char *b, *nul=NULL;
+            size_t n;
+
+            /* copy by blocks of the input content accessed directly
+               (memory streams, read-ahead buffer of ANSI C streams) */
+            for (; off<end || end==EOF; off+=(long)n)
+            {
+                if (!(b = sp_fpeek(in, &n))) break;
+                if (end!=EOF && (long)n > end-off) n = (size_t)(end-off);
+
+                /* NULL char terminates the content */
+                if ((nul = (const char*)memchr(b, 0, n))!=NULL)
+                    n = (size_t)(nul-b);
+
+                if (n && sp_fwrite(b, n, out)!=n) {
+                    ret=SPEC_ACCS_ERR;
+                    goto finish;
+                }
+                sp_fskip(in, n);
+
+                if (nul) {
+                    off+=(long)n;
+                    break;
+                }
+            }
+
+            /* the input finished before the end of the copied range */
+            if (off<end && end!=EOF) {
                 ret=SPEC_ACCS_ERR;
                 goto finish;
             }
+        } else
+        {
+            char buf[CPY_BUF_SIZE];
+            size_t n, rd;
+
+            /* copy by chunks of the intermediate buffer size */
+            for (; off<end || end==EOF; off+=(long)rd)
+            {
+                n = (end==EOF || end-off > (long)sizeof(buf) ?
+                    sizeof(buf) : (size_t)(end-off));
+
+                rd = sp_fread(buf, n, in);
+                if (sp_fwrite(buf, rd, out)!=rd || (rd<n && end!=EOF)) {
+                    ret=SPEC_ACCS_ERR;
+                    goto finish;
+                }
+                if (rd<n) {
+                    off+=(long)rd;
+                    break;
+                }
+            }
         }
     }
 
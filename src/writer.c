@@ -0,0 +1,278 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Streaming writer.
+
+   Each element is written in a separate line finished by EOL. A header of
+   a begun scope is written w/o its body opening bracket, which is put while
+   writing the first element of the body or ending the scope, depending on
+   whether the body is empty or not (SP_F_EMPCPT). Therefore the writer needs
+   to track the state of the current scope only.
+ */
+
+#include "config.h"
+#include "io.h"
+#include "sprops/parser.h"
+#include "sprops/writer.h"
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+#define CHK_FERR(c) if ((c)==EOF) { ret=SPEC_ACCS_ERR; goto finish; }
+
+/* Put EOL on the output.
+ */
+static sp_errc_t put_eol(const sp_writer_t *p_wr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_eol_t eol_typ = (p_wr->eol!=EOL_PLAT ? p_wr->eol :
+#if defined(_WIN32) || defined(_WIN64)
+        EOL_CRLF
+#else
+        EOL_LF
+#endif
+        );
+
+    switch (eol_typ) {
+        default:
+        case EOL_LF:
+            CHK_FERR(sp_fputc('\n', p_wr->out));
+            break;
+        case EOL_CR:
+            CHK_FERR(sp_fputc('\r', p_wr->out));
+            break;
+        case EOL_CRLF:
+            CHK_FERR(sp_fputs("\r\n", p_wr->out));
+            break;
+    }
+finish:
+    return ret;
+}
+
+/* Put indent chars of scope level 'lev' on the output.
+ */
+static sp_errc_t put_ind(const sp_writer_t *p_wr, int lev)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    int c, n;
+
+    for (; lev>0; lev--) {
+        n = (int)p_wr->ind;
+        c = (!n ? (n++, '\t') : ' ');
+        for (; n; n--) { CHK_FERR(sp_fputc(c, p_wr->out)); }
+    }
+finish:
+    return ret;
+}
+
+/* Open body of the pending scope header, which is followed by an element.
+ */
+static sp_errc_t open_body(sp_writer_t *p_wr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (p_wr->pend_flags & SP_F_SPLBRA) {
+        EXEC_RG(put_eol(p_wr));
+        EXEC_RG(put_ind(p_wr, p_wr->lev-1));
+        CHK_FERR(sp_fputc('{', p_wr->out));
+    } else {
+        CHK_FERR(sp_fputs(" {", p_wr->out));
+    }
+    EXEC_RG(put_eol(p_wr));
+
+    p_wr->pend = 0;
+finish:
+    return ret;
+}
+
+/* Start writing an element with 'flags' in the current scope.
+ */
+static sp_errc_t begin_elem(sp_writer_t *p_wr, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (p_wr->pend) {
+        EXEC_RG(open_body(p_wr));
+    } else
+    if (!p_wr->empty && !p_wr->xeol && (flags & SP_F_EOLBFR)) {
+        EXEC_RG(put_eol(p_wr));
+    }
+
+    p_wr->empty = 0;
+    p_wr->xeol = 0;
+
+    ret = put_ind(p_wr, p_wr->lev);
+finish:
+    return ret;
+}
+
+/* Finish writing an element with 'flags'.
+ */
+static sp_errc_t end_elem(sp_writer_t *p_wr, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    EXEC_RG(put_eol(p_wr));
+
+    if (flags & SP_F_EXTEOL) {
+        EXEC_RG(put_eol(p_wr));
+        p_wr->xeol = 1;
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_writer_init(
+    sp_writer_t *p_wr, SP_FILE *out, unsigned long ind_flags, sp_eol_t eol)
+{
+    if (!p_wr || !out) return SPEC_INV_ARG;
+
+    p_wr->out = out;
+    p_wr->lev = 0;
+    p_wr->ind = SP_F_GET_SPIND(ind_flags);
+    p_wr->eol = eol;
+    p_wr->empty = 1;
+    p_wr->pend = 0;
+    p_wr->pend_flags = 0;
+    p_wr->xeol = 0;
+
+    return SPEC_SUCCESS;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_writer_prop(sp_writer_t *p_wr,
+    const char *name, const char *val, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (!p_wr || !name) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    EXEC_RG(begin_elem(p_wr, flags));
+
+    EXEC_RG(sp_parser_tokenize_str(p_wr->out, SP_TKN_ID, name, 0));
+    if (val && *val)
+    {
+#if CONFIG_CUT_VAL_LEADING_SPACES
+        if (!(flags & SP_F_NVSRSP)) {
+            CHK_FERR(sp_fputs(" = ", p_wr->out));
+        } else {
+#endif
+            CHK_FERR(sp_fputc('=', p_wr->out));
+#if CONFIG_CUT_VAL_LEADING_SPACES
+        }
+#endif
+        EXEC_RG(sp_parser_tokenize_str(p_wr->out, SP_TKN_VAL, val, 0));
+#if !CONFIG_NO_SEMICOL_ENDS_VAL
+        /* otherwise the value is finished by EOL */
+        if (!(flags & SP_F_NOSEMC)) {
+            CHK_FERR(sp_fputc(';', p_wr->out));
+        }
+#endif
+    } else {
+        CHK_FERR(sp_fputc(';', p_wr->out));
+    }
+
+    ret = end_elem(p_wr, flags);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_writer_begin_scope(sp_writer_t *p_wr,
+    const char *type, const char *name, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    int typed = (type && *type);
+
+    if (!p_wr || !name) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+#if CONFIG_MAX_SCOPE_LEVEL_DEPTH>=0
+    /* the written scope wouldn't be accepted by the parser */
+    if (p_wr->lev >= CONFIG_MAX_SCOPE_LEVEL_DEPTH) {
+        ret=SPEC_SIZE;
+        goto finish;
+    }
+#endif
+
+    EXEC_RG(begin_elem(p_wr, flags));
+
+    if (typed) {
+        EXEC_RG(sp_parser_tokenize_str(p_wr->out, SP_TKN_ID, type, 0));
+        CHK_FERR(sp_fputc(' ', p_wr->out));
+    }
+    EXEC_RG(sp_parser_tokenize_str(p_wr->out, SP_TKN_ID, name, 0));
+
+    /* the body is opened by the following element */
+    p_wr->lev++;
+    p_wr->empty = 1;
+    p_wr->pend = (typed ? 2 : 1);
+    p_wr->pend_flags = flags;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+sp_errc_t sp_writer_end_scope(sp_writer_t *p_wr, unsigned long flags)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    if (!p_wr || p_wr->lev<=0) {
+        ret=SPEC_INV_ARG;
+        goto finish;
+    }
+
+    if (p_wr->pend)
+    {
+        /* scope with an empty body */
+        if (p_wr->pend_flags & SP_F_SPLBRA) {
+            EXEC_RG(put_eol(p_wr));
+            EXEC_RG(put_ind(p_wr, p_wr->lev-1));
+            CHK_FERR(sp_fputc('{', p_wr->out));
+        } else {
+#if !CONFIG_NO_EMPTY_SCOPE_ALT
+            if (p_wr->pend==2 && (p_wr->pend_flags & SP_F_EMPCPT)) {
+                CHK_FERR(sp_fputc(';', p_wr->out));
+                goto end;
+            } else
+#endif
+            {
+                CHK_FERR(sp_fputs(" {", p_wr->out));
+            }
+        }
+
+        if (!(p_wr->pend_flags & SP_F_EMPCPT)) {
+            EXEC_RG(put_eol(p_wr));
+            EXEC_RG(put_ind(p_wr, p_wr->lev-1));
+        }
+        CHK_FERR(sp_fputc('}', p_wr->out));
+    } else {
+        EXEC_RG(put_ind(p_wr, p_wr->lev-1));
+        CHK_FERR(sp_fputc('}', p_wr->out));
+    }
+
+#if !CONFIG_NO_EMPTY_SCOPE_ALT
+end:
+#endif
+    p_wr->lev--;
+    p_wr->empty = 0;
+    p_wr->pend = 0;
+
+    ret = end_elem(p_wr, flags);
+finish:
+    return ret;
+}
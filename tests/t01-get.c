@@ -164,6 +164,53 @@ static void print_scope(const char *ownscp,
     print_scope_info(p_info);
 }
 
+/* property request spec. */
+typedef struct _mp_req_t
+{
+    const char *name;
+    int ind;
+} mp_req_t;
+
+static const mp_req_t mp_req1[] =
+    {{"g", 0}, {"d", 0}, {"e", 0}, {"f", 0}, {NULL, 0}};
+static const mp_req_t mp_req2[] =
+    {{"a", SP_IND_LAST}, {"a", 1}, {"a", 0}, {"a", 2}, {NULL, 0}};
+static const mp_req_t mp_req3[] =
+    {{"a", SP_IND_LAST}, {"x", 0}, {NULL, 0}};
+
+/* Get properties specified by 'p_reqs' (NULL name terminated) by a single
+   sp_get_props() call and print them.
+ */
+static sp_errc_t get_props(
+    SP_FILE *in, const char *path, const char *deftp, const mp_req_t *p_reqs)
+{
+    sp_errc_t ret;
+    sp_prop_req_t reqs[8];
+    sp_prop_info_ex_t pi[8];
+    char vals[8][8];
+    int i, n;
+
+    for (n=0; p_reqs[n].name; n++) {
+        reqs[n].name = p_reqs[n].name;
+        reqs[n].ind = p_reqs[n].ind;
+        reqs[n].val = vals[n];
+        reqs[n].len = sizeof(vals[n]);
+        reqs[n].p_info = &pi[n];
+    }
+
+    ret = sp_get_props(in, NULL, path, deftp, reqs, n);
+
+    for (i=0; i<n && (ret==SPEC_SUCCESS || ret==SPEC_NOTFOUND); i++) {
+        if (reqs[i].ret==SPEC_SUCCESS) {
+            print_str_prop(path, reqs[i].name, reqs[i].ind, vals[i], &pi[i]);
+        } else {
+            printf("OWN-SCP<%s> PROP<%s> IND<%s>: not found\n",
+                path, reqs[i].name, strind(reqs[i].ind));
+        }
+    }
+    return ret;
+}
+
 int main(void)
 {
     sp_errc_t ret=SPEC_SUCCESS;
@@ -325,6 +372,14 @@ int main(void)
         &in, NULL, "c", 0, NULL, NULL, buf1, sizeof(buf1), &pi));
     print_str_prop("/", "c", 0, buf1, &pi);
 
+    printf("\n--- Multiple properties info\n");
+
+    EXEC_RG(get_props(&in, "/1/2/3", NULL, mp_req1));
+    EXEC_RG(get_props(&in, "/scope:3", NULL, mp_req2));
+
+    ret = get_props(&in, "/scope:3@$", NULL, mp_req3);
+    assert(ret==SPEC_NOTFOUND);
+
 
     printf("\n--- Scopes info\n");
 
@@ -132,7 +132,8 @@ int main(void)
     char buf1[32], buf2[32];
 
     SP_FILE in;
-    int in_opn=0;
+    sp_path_t path;
+    int in_opn=0, path_cmp=0;
 
     EXEC_RG(sp_fopen(&in, "t01-2.conf", SP_MODE_READ));
 #if 0
@@ -254,6 +255,42 @@ int main(void)
     EXEC_RG(sp_iterate(&in, NULL, "/1@$/2@$/3@$", "", cb_prop, cb_scope, NULL,
         buf1, sizeof(buf1), buf2, sizeof(buf2)));
 
+    printf("\n--- Iterating scope /:1@2/:2@$/:3\n");
+    EXEC_RG(sp_iterate(&in, NULL, "/1@2/2@$/3", "", cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+
+    printf("\n--- Iterating scope /:1@0/:2@$/:3@$\n");
+    EXEC_RG(sp_iterate(&in, NULL, "/1@0/2@$/3@$", "", cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+
+
+    printf("\n\n--- Iterating compiled path scope:1/scope:2\n");
+    EXEC_RG(sp_path_compile("/1/2", "scope", &path));
+    path_cmp++;
+    EXEC_RG(sp_iterate_p(&in, NULL, &path, cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+    sp_path_free(&path);
+    path_cmp--;
+
+    printf("\n--- Iterating compiled path /:1@$/:2@$/:3@$\n");
+    EXEC_RG(sp_path_compile("1@$/2@$/3@$/", NULL, &path));
+    path_cmp++;
+    EXEC_RG(sp_iterate_p(&in, NULL, &path, cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+    sp_path_free(&path);
+    path_cmp--;
+
+    printf("\n--- Iterating compiled path /:'\\: \\/ (escaped)\n");
+    EXEC_RG(sp_path_compile("/:'\\: \\/", NULL, &path));
+    path_cmp++;
+    EXEC_RG(sp_iterate_p(&in, NULL, &path, cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+    sp_path_free(&path);
+    path_cmp--;
+
+    printf("\n--- Compiling malformed path /1//2: %d\n",
+        sp_path_compile("/1//2", NULL, &path));
+
 finish:
     if (ret) {
         if (ret==SPEC_SYNTAX) {
@@ -266,6 +303,7 @@ finish:
         }
     }
     if (in_opn) sp_close(&in);
+    if (path_cmp) sp_path_free(&path);
 
     return 0;
 }
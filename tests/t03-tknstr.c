@@ -30,6 +30,46 @@
 
 #define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
 
+/* number of tokens viewed directly in the stream content */
+static int n_views;
+
+/* Check view of a token against its copy */
+static sp_errc_t chk_view(SP_FILE *in, sp_parser_token_t tkn,
+    const sp_loc_t *p_loc, const char *exp)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    char buf[32];
+    const char *view;
+    size_t len;
+    long tklen;
+
+    EXEC_RG(sp_parser_tkn_cpy(in, tkn, p_loc, buf, sizeof(buf), &tklen));
+
+    if ((view=sp_parser_tkn_view(in, tkn, p_loc, &len))!=NULL) {
+        n_views++;
+        printf("VIEW<%.*s> ", (int)len, view);
+        assert(len==(size_t)tklen && !memcmp(view, buf, len));
+    }
+    printf("CPY<%s>\n", buf);
+    assert(!strcmp(buf, exp));
+finish:
+    return ret;
+}
+
+/* sp_parse() property callback */
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    const char **exp = *(const char***)arg;
+
+    EXEC_RG(chk_view(in, SP_TKN_ID, p_lname, exp[0]));
+    EXEC_RG(chk_view(in, SP_TKN_VAL, p_lval, exp[1]));
+    *(const char***)arg += 2;
+finish:
+    return ret;
+}
+
 int main(void)
 {
     sp_errc_t ret=SPEC_SUCCESS;
@@ -111,6 +151,39 @@ int main(void)
         "012345678\\" PLT_EOL "\\n12345\\" PLT_EOL "\\x20",
         SPAR_F_CVLEN(10)|SPAR_F_CVEOL(EOL_PLAT));
 
+
+    printf("\n--- Token views\n");
+    {
+        static const char in_str[] =
+            "a = plain value;\"quoted id\" = 1;'q' = \"x\";"
+            "esc\\ id = 1; b = x\\ty; c;";
+        static const char *exp[] = {
+            "a", "plain value", "quoted id", "1", "q", "\"x\"",
+            "esc id", "1", "b", "x\ty", "c", ""
+        };
+        const char **p_exp = exp;
+        SP_FILE in;
+        FILE *f;
+
+        sp_mopen(&in, (char*)in_str, sizeof(in_str)-1);
+        EXEC_RG(sp_parse(&in, NULL, cb_prop, NULL, &p_exp, NULL));
+        /* empty value of "c" is viewed too */
+        assert(p_exp==&exp[12] && n_views==10);
+
+        /* no views for not memory based streams (except the empty value) */
+        f = tmpfile();
+        assert(f!=NULL);
+        fputs(in_str, f);
+        EXEC_RG(sp_fopen2(&in, f));
+
+        n_views = 0;
+        p_exp = exp;
+        ret = sp_parse(&in, NULL, cb_prop, NULL, &p_exp, NULL);
+        sp_close(&in);
+        if (ret) goto finish;
+        assert(p_exp==&exp[12] && n_views==1);
+    }
+
 finish:
     if (ret) printf("Error: %d\n", ret);
     return 0;
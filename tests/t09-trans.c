@@ -27,6 +27,52 @@
 /* indentation */
 static unsigned long indf = SP_F_SPIND(4);
 
+/* modifications constrained to /scope:3 */
+static sp_errc_t mod_scope3(sp_trans_t *p_trans)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    EXEC_RG(sp_set_prop_tr(p_trans,
+        "1", "VAL",
+        0,
+        NULL, NULL,
+        indf));
+
+    EXEC_RG(sp_set_prop_tr(p_trans,
+        "PROP", "VAL",
+        0,
+        NULL, NULL,
+        indf));
+
+    /* error doesn't change modifications already committed */
+    assert(sp_set_prop_tr(p_trans,
+        "x", NULL,
+        0,
+        "/", NULL,
+        SP_F_NOADD)==SPEC_NOTFOUND);
+
+    EXEC_RG(sp_add_scope_tr(p_trans,
+        "TYPE", "SCOPE",
+        SP_ELM_LAST,
+        NULL, NULL,
+        indf|SP_F_EMPCPT));
+
+    EXEC_RG(sp_add_scope_tr(p_trans,
+        NULL, "SCOPE",
+        SP_ELM_LAST,
+        NULL, NULL,
+        indf));
+
+    EXEC_RG(sp_add_prop_tr(p_trans,
+        "PROP", "VAL",
+        0,
+        "SCOPE", NULL,
+        indf));
+
+finish:
+    return ret;
+}
+
 int main(void)
 {
     sp_errc_t ret=SPEC_SUCCESS;
@@ -96,41 +142,40 @@ int main(void)
     EXEC_RG(sp_init_tr(&trans, &in, &sc3.lbody, NULL));
     tr_init++;
 
-    EXEC_RG(sp_set_prop_tr(&trans,
-        "1", "VAL",
-        0,
-        NULL, NULL,
-        indf));
+    EXEC_RG(mod_scope3(&trans));
 
-    EXEC_RG(sp_set_prop_tr(&trans,
-        "PROP", "VAL",
-        0,
-        NULL, NULL,
-        indf));
+    EXEC_RG(sp_commit_tr(&trans, &out));
+    tr_init=0;
 
-    /* error doesn't change modifications already committed */
-    assert(sp_set_prop_tr(&trans,
-        "x", NULL,
-        0,
-        "/", NULL,
-        SP_F_NOADD)==SPEC_NOTFOUND);
+    printf("\n--- In-memory transaction constrained to /scope:3\n");
+    EXEC_RG(sp_init_mem_tr(&trans, &in, &sc3.lbody, NULL));
+    tr_init++;
 
-    EXEC_RG(sp_add_scope_tr(&trans,
-        "TYPE", "SCOPE",
+    EXEC_RG(mod_scope3(&trans));
+
+    EXEC_RG(sp_commit_tr(&trans, &out));
+    tr_init=0;
+
+    printf("\n--- In-memory transaction from scratch\n");
+    EXEC_RG(sp_init_mem_tr(&trans, NULL, NULL, NULL));
+    tr_init++;
+
+    EXEC_RG(sp_add_prop_tr(&trans,
+        "PROP", "VAL",
         SP_ELM_LAST,
-        NULL, NULL,
-        indf|SP_F_EMPCPT));
+        "/", NULL,
+        0));
 
     EXEC_RG(sp_add_scope_tr(&trans,
         NULL, "SCOPE",
         SP_ELM_LAST,
-        NULL, NULL,
+        "/", NULL,
         indf));
 
     EXEC_RG(sp_add_prop_tr(&trans,
         "PROP", "VAL",
-        0,
-        "SCOPE", NULL,
+        SP_ELM_LAST,
+        "/SCOPE", NULL,
         indf));
 
     EXEC_RG(sp_commit_tr(&trans, &out));
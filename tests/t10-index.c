@@ -0,0 +1,324 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/index.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<4)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+#define LOC_EQU(l1, l2) \
+    ((l1).beg==(l2).beg && (l1).end==(l2).end && \
+    (l1).first_line==(l2).first_line && \
+    (l1).first_column==(l2).first_column && \
+    (l1).last_line==(l2).last_line && (l1).last_column==(l2).last_column)
+
+typedef struct _prop_qry_t
+{
+    const char *name;
+    int ind;
+    const char *path;
+    const char *deftp;
+} prop_qry_t;
+
+typedef struct _scope_qry_t
+{
+    const char *type;
+    const char *name;
+    int ind;
+    const char *path;
+    const char *deftp;
+} scope_qry_t;
+
+static const prop_qry_t prop_qrys[] =
+{
+    {"a", 0, NULL, NULL},
+    {"b", 0, "/", NULL},
+    {"}'\"{", 0, NULL, NULL},
+    {";\"'#", SP_IND_LAST, NULL, NULL},
+    {"a", 0, "/:\\'\\:\\x20\\/", NULL},
+    {"a", 0, "/\\x31", "scope"},
+    {"a", 0, "\\1/\\x73cope:\\2", "scope"},
+    {"b", 0, "/1/2/", "scope"},
+    {"a", 0, "1/2/:xxx/", "scope"},
+    {"a", 0, "1/2/:xxx/d:d", "scope"},
+    {"b", 0, "/2", "scope"},
+    {"a", 0, "/:scope", NULL},
+    {"a", 0, "1/2/3", NULL},
+    {"x", 0, "1@0/2/3", ""},
+    {"b", 0, "/1/:2/3", ""},
+    {"x", 0, "1/2/3@0", ""},
+    {"c", 0, "/1/2/3", NULL},
+    {"d", 0, ":1/:2/:3", NULL},
+    {"g", 0, ":1/:2/:3", "/"},
+    {"a", 0, "1/2/3/scope:xyz", NULL},
+    {"a", 1, "/scope:3", NULL},
+    {"a", 3, "/3", "scope"},
+    {"a", 4, "/3", "scope"},
+    {"a", SP_IND_LAST, "scope:3", ""},
+    {"a", SP_IND_LAST, "scope:3@$/", NULL},
+    {"a", 0, "scope:3@1", NULL},
+    {"c", 0, NULL, NULL},
+    {"a", 0, "1//2", NULL},
+    {"a", 0, "1/@2", NULL},
+    {NULL, 0, NULL, NULL}
+};
+
+static const scope_qry_t scope_qrys[] =
+{
+    {NULL, "': /", SP_IND_LAST, NULL, NULL},
+    {"scope", "1", 0, "/", NULL},
+    {"scope", "2", 0, "/scope:1", NULL},
+    {NULL, "xxx", 0, "1/2", "scope"},
+    {"d", "d", 0, "/1/2/:xxx", "scope"},
+    {"scope", "3", 0, "/scope:2", NULL},
+    {NULL, "1", 2, NULL, NULL},
+    {NULL, "2", 1, "/:1", NULL},
+    {NULL, "3", 2, "1/2", ""},
+    {"scope", "xyz", 0, "1/2/3", ""},
+    {NULL, "3", SP_IND_LAST, "1@2/2@0", ""},
+    {NULL, "4", SP_IND_LAST, "1@0/2", ""},
+    {NULL, "3", 0, "1@2/2@1", NULL},
+    {NULL, "3", 1, "1@$/2@$", NULL},
+    {NULL, "3", 0, "1@$/2@0", NULL},
+    {NULL, NULL, 0, NULL, NULL}
+};
+
+static const char *iter_paths[] =
+{
+    "/", "/1", "/1@0", "/1@1", "/1@2", "/1@$", "/1/2", "/1/2@1", "/1/2@$",
+    "/1/2/3", "/1/2/3@2", "/1/2@$/3@1", "/1/2@3", "/scope:3", NULL
+};
+
+static char iter_out[2][4096];
+static size_t iter_len[2];
+
+/* append formatted location to the iteration output */
+static void iter_put_loc(int i, const char *nm, const sp_loc_t *p_loc)
+{
+    if (p_loc) {
+        iter_len[i] += sprintf(&iter_out[i][iter_len[i]],
+            " %s:%lx|%lx", nm, p_loc->beg, p_loc->end);
+    } else {
+        iter_len[i] += sprintf(&iter_out[i][iter_len[i]], " %s:-", nm);
+    }
+}
+
+static sp_errc_t cb_prop(
+    void *arg, SP_FILE *in, const char *name, const sp_tkn_info_t *p_tkname,
+    const char *val, const sp_tkn_info_t *p_tkval, const sp_loc_t *p_ldef)
+{
+    int i = *(int*)arg;
+
+    iter_len[i] += sprintf(&iter_out[i][iter_len[i]],
+        "  PROP %s [%ld] = \"%s\"", name, p_tkname->len, val);
+    iter_put_loc(i, "VAL", (p_tkval ? &p_tkval->loc : NULL));
+    iter_put_loc(i, "DEF", p_ldef);
+    iter_len[i] += sprintf(&iter_out[i][iter_len[i]], "\n");
+
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope(
+    void *arg, SP_FILE *in, const char *type, const sp_tkn_info_t *p_tktype,
+    const char *name, const sp_tkn_info_t *p_tkname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    int i = *(int*)arg;
+
+    iter_len[i] += sprintf(&iter_out[i][iter_len[i]],
+        "  SCOPE %s:%s", type, name);
+    iter_put_loc(i, "BODY", p_lbody);
+    iter_put_loc(i, "ENC", p_lbdyenc);
+    iter_put_loc(i, "DEF", p_ldef);
+    iter_len[i] += sprintf(&iter_out[i][iter_len[i]], "\n");
+
+    return SPEC_SUCCESS;
+}
+
+static int prop_info_equ(
+    const sp_prop_info_ex_t *p_info1, const sp_prop_info_ex_t *p_info2)
+{
+    return (p_info1->tkname.len==p_info2->tkname.len &&
+        LOC_EQU(p_info1->tkname.loc, p_info2->tkname.loc) &&
+        p_info1->val_pres==p_info2->val_pres &&
+        (!p_info1->val_pres || (p_info1->tkval.len==p_info2->tkval.len &&
+            LOC_EQU(p_info1->tkval.loc, p_info2->tkval.loc))) &&
+        LOC_EQU(p_info1->ldef, p_info2->ldef) &&
+        p_info1->ind==p_info2->ind && p_info1->n_elem==p_info2->n_elem);
+}
+
+static int scope_info_equ(
+    const sp_scope_info_ex_t *p_info1, const sp_scope_info_ex_t *p_info2)
+{
+    return (p_info1->type_pres==p_info2->type_pres &&
+        (!p_info1->type_pres || (p_info1->tktype.len==p_info2->tktype.len &&
+            LOC_EQU(p_info1->tktype.loc, p_info2->tktype.loc))) &&
+        p_info1->tkname.len==p_info2->tkname.len &&
+        LOC_EQU(p_info1->tkname.loc, p_info2->tkname.loc) &&
+        p_info1->body_pres==p_info2->body_pres &&
+        (!p_info1->body_pres || LOC_EQU(p_info1->lbody, p_info2->lbody)) &&
+        LOC_EQU(p_info1->lbdyenc, p_info2->lbdyenc) &&
+        LOC_EQU(p_info1->ldef, p_info2->ldef) &&
+        p_info1->ind==p_info2->ind && p_info1->n_elem==p_info2->n_elem);
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS, ret1, ret2;
+    int i, n_nodes[3];
+    char buf1[8], buf2[8], ibuf1[32], ibuf2[32];
+
+    sp_prop_info_ex_t pi1, pi2;
+    sp_scope_info_ex_t si1, si2;
+    sp_index_t idx;
+    sp_synerr_t synerr;
+    sp_loc_t parsc;
+
+    SP_FILE in;
+    int in_opn=0, idx_bld=0;
+
+    EXEC_RG(sp_fopen(&in, "t01-2.conf", SP_MODE_READ));
+    in_opn++;
+
+    EXEC_RG(sp_index_build(&in, NULL, &idx, NULL));
+    idx_bld++;
+
+    for (i=0; i<3; i++) n_nodes[i]=0;
+    for (i=0; i<idx.n_nodes; i++) n_nodes[idx.nodes[i].kind]++;
+
+    printf("--- Index: %d nodes (root:%d, props:%d, scopes:%d)\n",
+        idx.n_nodes, n_nodes[SP_IDXN_ROOT], n_nodes[SP_IDXN_PROP],
+        n_nodes[SP_IDXN_SCOPE]);
+
+    printf("\n--- Properties info\n");
+    for (i=0; prop_qrys[i].name; i++)
+    {
+        const prop_qry_t *p_q = &prop_qrys[i];
+
+        ret1 = sp_get_prop(&in, NULL, p_q->name, p_q->ind,
+            p_q->path, p_q->deftp, buf1, sizeof(buf1), &pi1);
+        ret2 = sp_get_prop_idx(&in, &idx, p_q->name, p_q->ind,
+            p_q->path, p_q->deftp, buf2, sizeof(buf2), &pi2);
+
+        assert(ret1==ret2);
+        if (ret2==SPEC_SUCCESS) {
+            assert(!strcmp(buf1, buf2) && prop_info_equ(&pi1, &pi2));
+
+            printf("PATH<%s> PROP<%s> IND<%d>: \"%s\" IND:%d ELM:%d "
+                "DEF [0x%02lx|0x%02lx]\n", (p_q->path ? p_q->path : ""),
+                p_q->name, p_q->ind, buf2, pi2.ind, pi2.n_elem,
+                pi2.ldef.beg, pi2.ldef.end);
+        } else {
+            printf("PATH<%s> PROP<%s> IND<%d>: error %d\n",
+                (p_q->path ? p_q->path : ""), p_q->name, p_q->ind, ret2);
+        }
+    }
+
+    printf("\n--- Scopes info\n");
+    for (i=0; scope_qrys[i].name; i++)
+    {
+        const scope_qry_t *p_q = &scope_qrys[i];
+
+        ret1 = sp_get_scope_info(&in, NULL, p_q->type, p_q->name,
+            p_q->ind, p_q->path, p_q->deftp, &si1);
+        ret2 = sp_get_scope_info_idx(&in, &idx, p_q->type, p_q->name,
+            p_q->ind, p_q->path, p_q->deftp, &si2);
+
+        assert(ret1==ret2);
+        if (ret2==SPEC_SUCCESS) {
+            assert(scope_info_equ(&si1, &si2));
+
+            printf("PATH<%s> SCOPE<%s:%s> IND<%d>: IND:%d ELM:%d "
+                "DEF [0x%02lx|0x%02lx]\n", (p_q->path ? p_q->path : ""),
+                (p_q->type ? p_q->type : ""), p_q->name, p_q->ind,
+                si2.ind, si2.n_elem, si2.ldef.beg, si2.ldef.end);
+        } else {
+            printf("PATH<%s> SCOPE<%s:%s> IND<%d>: error %d\n",
+                (p_q->path ? p_q->path : ""), (p_q->type ? p_q->type : ""),
+                p_q->name, p_q->ind, ret2);
+        }
+    }
+
+    printf("\n--- Iteration\n");
+    for (i=0; iter_paths[i]; i++)
+    {
+        int j;
+
+        for (j=0; j<2; j++) {
+            iter_len[j] = 0;
+            iter_out[j][0] = 0;
+        }
+
+        j=0;
+        EXEC_RG(sp_iterate(&in, NULL, iter_paths[i], NULL, cb_prop,
+            cb_scope, &j, ibuf1, sizeof(ibuf1), ibuf2, sizeof(ibuf2)));
+        j=1;
+        EXEC_RG(sp_iterate_idx(&in, &idx, iter_paths[i], NULL, cb_prop,
+            cb_scope, &j, ibuf1, sizeof(ibuf1), ibuf2, sizeof(ibuf2)));
+
+        assert(!strcmp(iter_out[0], iter_out[1]));
+        printf("%s\n%s", iter_paths[i], iter_out[1]);
+    }
+
+    /* index of a parsing scope */
+    EXEC_RG(sp_get_scope_info(&in, NULL, "scope", "1", 0, NULL, NULL, &si1));
+
+    sp_index_free(&idx);
+    idx_bld--;
+
+    parsc = si1.lbody;
+    EXEC_RG(sp_index_build(&in, &parsc, &idx, NULL));
+    idx_bld++;
+
+    printf("\n--- Parsing scope index: %d nodes\n", idx.n_nodes);
+
+    ret1 = sp_get_prop(&in, &parsc, "a", 0, "/2/:xxx/d:d", "scope",
+        buf1, sizeof(buf1), &pi1);
+    ret2 = sp_get_prop_idx(&in, &idx, "a", 0, "/2/:xxx/d:d", "scope",
+        buf2, sizeof(buf2), &pi2);
+    assert(ret1==SPEC_SUCCESS && ret1==ret2);
+    assert(!strcmp(buf1, buf2) && prop_info_equ(&pi1, &pi2));
+    printf("PATH</2/:xxx/d:d> PROP<a>: \"%s\"\n", buf2);
+
+    sp_index_free(&idx);
+    idx_bld--;
+
+    /* syntax error */
+    sp_close(&in);
+    in_opn--;
+
+    {
+        char err_buf[] = "a=1\nscope x {\n  b=2\n";
+        sp_mopen(&in, err_buf, sizeof(err_buf)-1);
+
+        ret = sp_index_build(&in, NULL, &idx, &synerr);
+        assert(ret==SPEC_SYNTAX);
+        printf("\n--- Syntax error: code:%d, line:%d, col:%d\n",
+            synerr.code, synerr.loc.line, synerr.loc.col);
+        ret=SPEC_SUCCESS;
+    }
+
+finish:
+    if (idx_bld) sp_index_free(&idx);
+    if (in_opn) sp_close(&in);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "../io.h"
+#include "sprops/props.h"
+#include "sprops/utils.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<4)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* sp_iterate() property callback */
+static sp_errc_t cb_prop(
+    void *arg, SP_FILE *in, const char *name, const sp_tkn_info_t *p_tkname,
+    const char *val, const sp_tkn_info_t *p_tkval, const sp_loc_t *p_ldef)
+{
+    printf("  PROP %s = \"%s\" [0x%02lx|0x%02lx]\n",
+        name, val, p_ldef->beg, p_ldef->end);
+    return SPEC_SUCCESS;
+}
+
+/* sp_iterate() scope callback */
+static sp_errc_t cb_scope(
+    void *arg, SP_FILE *in, const char *type, const sp_tkn_info_t *p_tktype,
+    const char *name, const sp_tkn_info_t *p_tkname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    printf("  SCOPE %s:%s [0x%02lx|0x%02lx]\n",
+        type, name, p_ldef->beg, p_ldef->end);
+    return SPEC_SUCCESS;
+}
+
+/* Iterate scopes with paths 'paths' of stream 'in' */
+static sp_errc_t iter_paths(SP_FILE *in, const char **paths)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    char buf1[32], buf2[32];
+
+    for (; *paths; paths++) {
+        printf(" %s\n", *paths);
+        EXEC_RG(sp_iterate(in, NULL, *paths, NULL, cb_prop, cb_scope, NULL,
+            buf1, sizeof(buf1), buf2, sizeof(buf2)));
+    }
+finish:
+    return ret;
+}
+
+static const char *paths[] = {"/", "/1/2/3", "/scope:3", NULL};
+
+/* custom stream backend: memory blob */
+typedef struct
+{
+    char b[0x800];  /* blob content */
+    long len;       /* content length */
+    long pos;       /* stream position */
+} blob_t;
+
+static long blob_read(void *ctx, char *buf, size_t num)
+{
+    blob_t *bl = (blob_t*)ctx;
+    long n = bl->len-bl->pos;
+
+    if (n > (long)num) n = (long)num;
+    if (n < 0) n = 0;
+
+    memcpy(buf, &bl->b[bl->pos], n);
+    bl->pos += n;
+    return n;
+}
+
+static long blob_write(void *ctx, const char *buf, size_t num)
+{
+    blob_t *bl = (blob_t*)ctx;
+    long n = (long)sizeof(bl->b)-bl->pos;
+
+    if (n > (long)num) n = (long)num;
+    if (n <= 0) return -1;
+
+    memcpy(&bl->b[bl->pos], buf, n);
+    bl->pos += n;
+    if (bl->pos > bl->len) bl->len = bl->pos;
+    return n;
+}
+
+static int blob_seek(void *ctx, long off, int origin)
+{
+    blob_t *bl = (blob_t*)ctx;
+
+    if (origin==SEEK_CUR) off += bl->pos;
+    else if (origin==SEEK_END) off += bl->len;
+
+    if (off < 0 || off > (long)sizeof(bl->b)) return -1;
+    bl->pos = off;
+    return 0;
+}
+
+static long blob_tell(void *ctx)
+{
+    return ((blob_t*)ctx)->pos;
+}
+
+static const char *blob_ptr(void *ctx, long off, size_t *p_num)
+{
+    blob_t *bl = (blob_t*)ctx;
+
+    if (off < 0 || off >= bl->len) return NULL;
+    *p_num = (size_t)(bl->len-off);
+    return &bl->b[off];
+}
+
+/* read/write blob stream */
+static const sp_fops_t blob_ops =
+    {blob_read, blob_write, blob_seek, blob_tell, NULL, NULL};
+
+/* read-only blob stream with direct access to the content */
+static const sp_fops_t blob_dops =
+    {blob_read, NULL, blob_seek, blob_tell, blob_ptr, NULL};
+
+static blob_t src, dst;
+
+/* counting allocator w/o realloc routine */
+static int n_allocs, n_frees;
+
+static void *cnt_alloc(void *ctx, size_t size)
+{
+    n_allocs++;
+    return malloc(size);
+}
+
+static void cnt_free(void *ctx, void *ptr)
+{
+    n_frees++;
+    free(ptr);
+}
+
+static const sp_alloc_t cnt_allocator = {cnt_alloc, NULL, cnt_free, NULL};
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    char buf[32];
+
+    SP_FILE in, in2, out, out2;
+    int in_opn=0, in2_opn=0, out_opn=0, out2_opn=0;
+    char *dbuf=NULL;
+    size_t dlen;
+    FILE *cf;
+
+    /*
+     * memory mapped file
+     */
+    printf("--- Memory mapped file\n");
+
+#if CONFIG_FILE_MMAP
+    EXEC_RG(sp_fmap(&in, "t01-2.conf"));
+    in_opn++;
+    assert(in.typ==SP_FILE_MMAP);
+
+    EXEC_RG(iter_paths(&in, paths));
+
+    /* handle copies share the mapping with independent stream positions */
+    in2 = in;
+    EXEC_RG(sp_get_prop(&in2, NULL, "a", 0, "/1/2/3", NULL,
+        buf, sizeof(buf), NULL));
+    printf(" /1/2/3/a via handle copy: \"%s\"\n", buf);
+
+    /* the stream is read-only */
+    sp_mopen(&in2, buf, sizeof(buf));
+    assert(sp_util_cpy_to_out(&in2, &in, 0, EOF, NULL)==SPEC_ACCS_ERR);
+    printf(" write: failed as expected\n");
+
+    EXEC_RG(sp_close(&in));
+    in_opn--;
+
+    assert(sp_fmap(&in, "not-existing.conf")==SPEC_FOPEN_ERR);
+#else
+    /* no mapping support; expected output: t11_nommap.out */
+    printf(" skipped: not supported\n");
+#endif
+
+    /*
+     * custom stream
+     */
+    printf("\n--- Custom stream\n");
+
+    cf = fopen("t01-2.conf", "rb");
+    assert(cf!=NULL);
+    src.len = (long)fread(src.b, 1, sizeof(src.b), cf);
+    fclose(cf);
+
+    EXEC_RG(sp_fopen_custom(&in, &blob_ops, &src));
+    in_opn++;
+
+    EXEC_RG(iter_paths(&in, paths));
+
+    /* modify the blob content and write it to other blob */
+    EXEC_RG(sp_fopen_custom(&out, &blob_ops, &dst));
+    out_opn++;
+
+    EXEC_RG(sp_set_prop(&in, &out, NULL, "a", "modified", 0, "/1/2/3",
+        NULL, 0));
+
+    EXEC_RG(sp_close(&out));
+    out_opn--;
+
+    /* read the modified content directly */
+    EXEC_RG(sp_fopen_custom(&out, &blob_dops, &dst));
+    out_opn++;
+
+    EXEC_RG(sp_get_prop(&out, NULL, "a", 0, "/1/2/3", NULL,
+        buf, sizeof(buf), NULL));
+    printf(" /1/2/3/a modified: \"%s\"\n", buf);
+
+    /* the direct access stream is read-only */
+    assert(sp_util_cpy_to_out(&in, &out, 0, EOF, NULL)==SPEC_ACCS_ERR);
+    printf(" write: failed as expected\n");
+
+    EXEC_RG(sp_close(&out));
+    out_opn--;
+
+    /*
+     * growable memory stream
+     */
+    printf("\n--- Growable memory stream\n");
+
+    /* default allocator */
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    EXEC_RG(sp_set_prop(&in, &out, NULL, "a", "modified", 0, "/1/2/3",
+        NULL, 0));
+    printf(" written %lu chars (input %ld chars)\n",
+        (unsigned long)out.m.num, src.len);
+
+    /* user allocator w/o realloc; output of the previous edit as input */
+    EXEC_RG(sp_mopen_dyn(&out2, 0x10, &cnt_allocator));
+    out2_opn++;
+
+    EXEC_RG(sp_rm_prop(&out, &out2, NULL, "b", 0, "/", NULL, 0));
+
+    EXEC_RG(sp_mdetach(&out2, &dbuf, &dlen));
+    out2_opn--;
+    printf(" detached %lu chars, NULL terminated: %d\n",
+        (unsigned long)dlen, !dbuf[dlen]);
+
+    sp_mopen(&out2, dbuf, dlen);
+    EXEC_RG(sp_get_prop(&out2, NULL, "a", 0, "/1/2/3", NULL,
+        buf, sizeof(buf), NULL));
+    printf(" /1/2/3/a: \"%s\"\n", buf);
+    assert(sp_get_prop(&out2, NULL, "b", 0, "/", NULL,
+        buf, sizeof(buf), NULL)==SPEC_NOTFOUND);
+    printf(" /b: removed\n");
+
+    cnt_free(NULL, dbuf);
+    dbuf = NULL;
+    printf(" all allocations freed: %d\n", (n_allocs>0 && n_allocs==n_frees));
+
+    /*
+     * block copy; NULL char terminates the copied content
+     */
+    printf("\n--- Block copy\n");
+
+    {
+        static char nul_cf[] = "a = 1\nb = 2\n\0c = 3\n";
+        long n;
+
+        sp_mopen(&in2, nul_cf, sizeof(nul_cf)-1);
+        EXEC_RG(sp_mopen_dyn(&out2, 0, NULL));
+        out2_opn++;
+
+        EXEC_RG(sp_util_cpy_to_out(&in2, &out2, 2, EOF, &n));
+        printf(" memory stream: copied %ld chars\n", n);
+
+        /* the range exceeds the content */
+        assert(sp_util_cpy_to_out(
+            &in2, &out2, 0, sizeof(nul_cf)-1, NULL)==SPEC_ACCS_ERR);
+        printf(" range beyond NULL char: failed as expected\n");
+
+        EXEC_RG(sp_close(&out2));
+        out2_opn--;
+
+        /* ANSI C stream read by blocks of its read-ahead buffer */
+        assert((cf = tmpfile())!=NULL);
+        EXEC_RG(sp_fopen2(&in2, cf));
+        in2_opn++;
+        fwrite(nul_cf, 1, sizeof(nul_cf)-1, cf);
+        EXEC_RG(sp_fsetbuf(&in2, 4));
+
+        EXEC_RG(sp_mopen_dyn(&out2, 0, NULL));
+        out2_opn++;
+
+        EXEC_RG(sp_util_cpy_to_out(&in2, &out2, 0, 9, NULL));
+        EXEC_RG(sp_util_cpy_to_out(&in2, &out2, 9, EOF, NULL));
+
+        printf(" C stream: copied %lu chars: %d\n", (unsigned long)out2.m.num,
+            !memcmp(out2.m.b, nul_cf, out2.m.num));
+
+        /* reading directly after writing the buffered stream */
+        {
+            char rd[8];
+
+            assert(!sp_fseek(&in2, 0, SEEK_SET));
+            assert(sp_fwrite("a = 9\n", 6, &in2)==6);
+            rd[0] = (char)sp_fgetc(&in2);
+            assert(!sp_fseek(&in2, 0, SEEK_SET));
+            rd[1+sp_fread(&rd[1], 6, &in2)] = 0;
+            printf(" C stream: read after write: '%c', \"%.5s\"\n",
+                rd[0], &rd[1]);
+        }
+    }
+
+finish:
+    if (in_opn) sp_close(&in);
+    if (in2_opn) sp_close(&in2);
+    if (out_opn) sp_close(&out);
+    if (out2_opn) sp_close(&out2);
+    if (dbuf) cnt_free(NULL, dbuf);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
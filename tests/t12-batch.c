@@ -0,0 +1,305 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <string.h>
+#include "../config.h"
+#include "sprops/props.h"
+#include "sprops/utils.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<3)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* indentation */
+static unsigned long indf = SP_F_SPIND(4);
+
+/* Apply edits of 'p_batch' one by one with the regular API and write the
+   result to 'out'. The edits are applied in reverse order, so they don't
+   affect each other, provided the edits are ordered by their input locations.
+ */
+static sp_errc_t apply_seq(SP_FILE *in, SP_FILE *out,
+    const sp_edit_batch_t *p_batch)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    SP_FILE f[2], *p_in=in, *p_out;
+    int i, n_opn=0;
+
+    for (i=p_batch->n_edits-1; i>=0; i--)
+    {
+        const sp_edit_t *e = &p_batch->edits[i];
+
+        p_out = &f[n_opn & 1];
+        if (n_opn>1) sp_close(p_out);
+        EXEC_RG(sp_mopen_dyn(p_out, 0, NULL));
+        n_opn++;
+
+        switch (e->op)
+        {
+        case SP_EDIT_ADD_PROP:
+            ret = sp_add_prop(p_in, p_out, NULL, e->name, e->val, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_ADD_SCOPE:
+            ret = sp_add_scope(p_in, p_out, NULL, e->type, e->name, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_RM_PROP:
+            ret = sp_rm_prop(p_in, p_out, NULL, e->name, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_RM_SCOPE:
+            ret = sp_rm_scope(p_in, p_out, NULL, e->type, e->name, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_SET_PROP:
+            ret = sp_set_prop(p_in, p_out, NULL, e->name, e->val, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_MV_PROP:
+            ret = sp_mv_prop(p_in, p_out, NULL, e->name, e->new_name, e->ind,
+                e->path, e->deftp, e->flags);
+            break;
+        case SP_EDIT_MV_SCOPE:
+            ret = sp_mv_scope(p_in, p_out, NULL, e->type, e->name,
+                e->new_type, e->new_name, e->ind, e->path, e->deftp, e->flags);
+            break;
+        }
+        if (ret!=SPEC_SUCCESS) goto finish;
+
+        p_in = p_out;
+    }
+
+    EXEC_RG(sp_util_cpy_to_out(p_in, out, 0, EOF, NULL));
+
+finish:
+    for (i=0; i<n_opn && i<2; i++) sp_close(&f[i]);
+    return ret;
+}
+
+/* Apply 'p_batch' to 'in', print the output and check it's the same as for
+   the edits applied one by one.
+ */
+static sp_errc_t apply(SP_FILE *in, const sp_edit_batch_t *p_batch)
+{
+    sp_errc_t ret=SPEC_SUCCESS, aret;
+    SP_FILE out, out_seq;
+    int err_edit, out_opn=0, out_seq_opn=0;
+
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    aret = sp_edit_apply(in, &out, NULL, p_batch, &err_edit);
+    printf("Result: %d, failed edit: %d\n", aret, err_edit);
+    if (aret!=SPEC_SUCCESS) goto finish;
+
+    fwrite(out.m.b, 1, out.m.num, stdout);
+
+    EXEC_RG(sp_mopen_dyn(&out_seq, 0, NULL));
+    out_seq_opn++;
+
+    EXEC_RG(apply_seq(in, &out_seq, p_batch));
+    printf("Same as sequential edits: %d\n", (out.m.num==out_seq.m.num &&
+        !memcmp(out.m.b, out_seq.m.b, out.m.num)));
+
+finish:
+    if (out_opn) sp_close(&out);
+    if (out_seq_opn) sp_close(&out_seq);
+    return ret;
+}
+
+/* Rewrite the 1st part of /scope:1 of 'in', print the output and check it's
+   the same as for the edits applied to the entire input.
+ */
+static sp_errc_t rewrite(SP_FILE *in)
+{
+    sp_errc_t ret=SPEC_SUCCESS, rret;
+    sp_edit_batch_t batch, batch_all;
+    sp_scope_info_ex_t sc;
+    SP_FILE out, out_all;
+    int err_edit, out_opn=0, out_all_opn=0;
+
+    sp_edit_batch_init(&batch);
+    sp_edit_batch_init(&batch_all);
+
+    EXEC_RG(sp_get_scope_info(in, NULL, "scope", "1", 0, NULL, NULL, &sc));
+
+    /* the same edits addressed relatively to the scope and the input */
+    EXEC_RG(sp_edit_set_prop(&batch, "x", "ten", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_add_prop(&batch, "v", "5", SP_ELM_LAST, "/scope:2",
+        NULL, indf));
+    EXEC_RG(sp_edit_add_scope(&batch, "type", "3", SP_ELM_LAST, "/", NULL,
+        indf));
+
+    EXEC_RG(sp_edit_set_prop(&batch_all, "x", "ten", 0, "/scope:1@0", NULL,
+        indf));
+    EXEC_RG(sp_edit_add_prop(&batch_all, "v", "5", SP_ELM_LAST,
+        "/scope:1@0/scope:2", NULL, indf));
+    EXEC_RG(sp_edit_add_scope(&batch_all, "type", "3", SP_ELM_LAST,
+        "/scope:1@0", NULL, indf));
+
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    rret = sp_rewrite_scope(in, &out, &sc.lbody, &batch, &err_edit);
+    printf("Result: %d, failed edit: %d\n", rret, err_edit);
+    if (rret!=SPEC_SUCCESS) goto finish;
+
+    fwrite(out.m.b, 1, out.m.num, stdout);
+
+    EXEC_RG(sp_mopen_dyn(&out_all, 0, NULL));
+    out_all_opn++;
+
+    EXEC_RG(sp_edit_apply(in, &out_all, NULL, &batch_all, NULL));
+    printf("Same as edits of the entire input: %d\n",
+        (out.m.num==out_all.m.num &&
+        !memcmp(out.m.b, out_all.m.b, out.m.num)));
+
+finish:
+    if (out_opn) sp_close(&out);
+    if (out_all_opn) sp_close(&out_all);
+    sp_edit_batch_free(&batch);
+    sp_edit_batch_free(&batch_all);
+    return ret;
+}
+
+/* Rewrite a scope spanning up to the input end ('end' set to -1) */
+static sp_errc_t rewrite_to_end(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    static char cf[] = "a = 1\nb = 2\n";
+    sp_loc_t parsc = {6, -1, 2, 1, -1, -1};
+    sp_edit_batch_t batch;
+    SP_FILE in, out;
+    int out_opn=0;
+
+    sp_edit_batch_init(&batch);
+    sp_mopen(&in, cf, sizeof(cf)-1);
+
+    EXEC_RG(sp_edit_set_prop(&batch, "b", "3", 0, "/", NULL, indf));
+
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    EXEC_RG(sp_rewrite_scope(&in, &out, &parsc, &batch, NULL));
+    fwrite(out.m.b, 1, out.m.num, stdout);
+
+finish:
+    if (out_opn) sp_close(&out);
+    sp_edit_batch_free(&batch);
+    return ret;
+}
+
+/* Rewrite a scope body with an element added at its beginning */
+static sp_errc_t rewrite_first(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    static char cf[] = "s {\n    a = 1;\n}\nt {  b = 2;  }\n";
+    sp_edit_batch_t batch;
+    sp_scope_info_ex_t sc;
+    SP_FILE in, out;
+    int out_opn=0;
+
+    sp_edit_batch_init(&batch);
+    sp_mopen(&in, cf, sizeof(cf)-1);
+
+    EXEC_RG(sp_edit_add_prop(&batch, "c", "3", 0, "/", NULL, indf));
+
+    EXEC_RG(sp_get_scope_info(&in, NULL, NULL, "s", 0, NULL, NULL, &sc));
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    EXEC_RG(sp_rewrite_scope(&in, &out, &sc.lbody, &batch, NULL));
+    fwrite(out.m.b, 1, out.m.num, stdout);
+    sp_close(&out);
+    out_opn--;
+
+    EXEC_RG(sp_get_scope_info(&in, NULL, NULL, "t", 0, NULL, NULL, &sc));
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    out_opn++;
+
+    EXEC_RG(sp_rewrite_scope(&in, &out, &sc.lbody, &batch, NULL));
+    fwrite(out.m.b, 1, out.m.num, stdout);
+
+finish:
+    if (out_opn) sp_close(&out);
+    sp_edit_batch_free(&batch);
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_edit_batch_t batch;
+
+    SP_FILE in;
+    int in_opn=0;
+
+    sp_edit_batch_init(&batch);
+
+    EXEC_RG(sp_fopen(&in, "t12.conf", SP_MODE_READ));
+    in_opn++;
+
+    printf("--- Mixed edits\n");
+    EXEC_RG(sp_edit_add_prop(&batch, "first", "0", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_set_prop(&batch, "a", "one", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_rm_prop(&batch, "b", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_mv_prop(&batch, "x", "xx", 0, "/scope:1", NULL, indf));
+    EXEC_RG(sp_edit_mv_scope(&batch, "scope", "2", "type", "two", 0,
+        "/scope:1", NULL, indf));
+    EXEC_RG(sp_edit_set_prop(&batch, "z", "thirty", 0, "/scope:1/scope:2",
+        NULL, indf));
+    EXEC_RG(sp_edit_add_prop(&batch, "w", "40", SP_ELM_LAST, "/scope:1@$",
+        NULL, indf));
+    EXEC_RG(sp_edit_add_scope(&batch, "type", "last", SP_ELM_LAST, "/", NULL,
+        indf));
+    EXEC_RG(apply(&in, &batch));
+
+    printf("\n--- Insertions in the same location\n");
+    sp_edit_batch_free(&batch);
+    EXEC_RG(sp_edit_add_prop(&batch, "p1", "1", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_add_prop(&batch, "p2", "2", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_add_prop(&batch, "p3", "3", 0, "/", NULL, indf));
+    EXEC_RG(apply(&in, &batch));
+
+    printf("\n--- Overlapping edits\n");
+    sp_edit_batch_free(&batch);
+    EXEC_RG(sp_edit_set_prop(&batch, "c", "three", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_set_prop(&batch, "z", "thirty", 0, "/scope:1/scope:2",
+        NULL, indf));
+    EXEC_RG(sp_edit_rm_scope(&batch, "scope", "1", 0, "/", NULL, indf));
+    EXEC_RG(apply(&in, &batch));
+
+    printf("\n--- Not existing destination\n");
+    sp_edit_batch_free(&batch);
+    EXEC_RG(sp_edit_set_prop(&batch, "a", "one", 0, "/", NULL, indf));
+    EXEC_RG(sp_edit_mv_prop(&batch, "a", "b", 0, "/xxx", NULL, indf));
+    EXEC_RG(apply(&in, &batch));
+
+    printf("\n--- Scope rewrite\n");
+    EXEC_RG(rewrite(&in));
+
+    printf("\n--- Scope rewrite up to the input end\n");
+    EXEC_RG(rewrite_to_end());
+
+    printf("\n--- Scope rewrite with addition at the beginning\n");
+    EXEC_RG(rewrite_first());
+
+finish:
+    sp_edit_batch_free(&batch);
+    if (in_opn) sp_close(&in);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/doc.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<4)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+typedef struct _prop_qry_t
+{
+    const char *name;
+    int ind;
+    const char *path;
+    const char *deftp;
+} prop_qry_t;
+
+static const prop_qry_t prop_qrys[] =
+{
+    {"a", 0, NULL, NULL},
+    {"b", 0, "/", NULL},
+    {"}'\"{", 0, NULL, NULL},
+    {";\"'#", SP_IND_LAST, NULL, NULL},
+    {"a", 0, "/:\\'\\:\\x20\\/", NULL},
+    {"a", 0, "/\\x31", "scope"},
+    {"a", 0, "\\1/\\x73cope:\\2", "scope"},
+    {"b", 0, "/1/2/", "scope"},
+    {"a", 0, "1/2/:xxx/", "scope"},
+    {"a", 0, "1/2/:xxx/d:d", "scope"},
+    {"b", 0, "/2", "scope"},
+    {"a", 0, "/:scope", NULL},
+    {"a", 0, "1/2/3", NULL},
+    {"x", 0, "1@0/2/3", ""},
+    {"b", 0, "/1/:2/3", ""},
+    {"x", 0, "1/2/3@0", ""},
+    {"c", 0, "/1/2/3", NULL},
+    {"d", 0, ":1/:2/:3", NULL},
+    {"e", 0, ":1/:2/:3", NULL},
+    {"g", 0, ":1/:2/:3", "/"},
+    {"a", 0, "1/2/3/scope:xyz", NULL},
+    {"a", 1, "/scope:3", NULL},
+    {"a", 3, "/3", "scope"},
+    {"a", 4, "/3", "scope"},
+    {"a", 5, "/3", "scope"},
+    {"a", SP_IND_LAST, "scope:3", ""},
+    {"a", SP_IND_LAST, "scope:3@$/", NULL},
+    {"a", 0, "scope:3@1", NULL},
+    {"c", 0, NULL, NULL},
+    {"a", 0, "1//2", NULL},
+    {"a", 0, "1/@2", NULL},
+    {NULL, 0, NULL, NULL}
+};
+
+static const sp_enumval_t evals[] =
+{
+    {"false", 0},
+    {"true", 1},
+    {NULL, 0}
+};
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS, ret1, ret2;
+    int i, ival1, ival2;
+    long lval1, lval2;
+    double dval1, dval2;
+    char buf[64];
+    const char *val;
+    size_t len;
+
+    sp_doc_t doc;
+    sp_synerr_t synerr;
+
+    SP_FILE in;
+    int in_opn=0, doc_ld=0;
+
+    EXEC_RG(sp_fopen(&in, "t01-2.conf", SP_MODE_READ));
+    in_opn++;
+
+    EXEC_RG(sp_doc_load(&in, NULL, &doc, NULL));
+    doc_ld++;
+
+    printf("--- Document: props:%d, scopes:%d\n", doc.n_props, doc.n_scopes);
+
+    printf("\n--- Properties\n");
+    for (i=0; prop_qrys[i].name; i++)
+    {
+        const prop_qry_t *p_q = &prop_qrys[i];
+
+        ret1 = sp_get_prop(&in, NULL, p_q->name, p_q->ind,
+            p_q->path, p_q->deftp, buf, sizeof(buf), NULL);
+        ret2 = sp_doc_get_str(&doc, p_q->name, p_q->ind,
+            p_q->path, p_q->deftp, &val, &len);
+
+        assert(ret1==ret2);
+        if (ret2==SPEC_SUCCESS) {
+            assert(!strcmp(buf, val) && strlen(val)==len);
+
+            printf("PATH<%s> PROP<%s> IND<%d>: \"%s\" [%lu]\n",
+                (p_q->path ? p_q->path : ""), p_q->name, p_q->ind, val,
+                (unsigned long)len);
+        } else {
+            printf("PATH<%s> PROP<%s> IND<%d>: error %d\n",
+                (p_q->path ? p_q->path : ""), p_q->name, p_q->ind, ret2);
+        }
+    }
+
+    /* the document doesn't refer to the input after loading */
+    sp_close(&in);
+    in_opn=0;
+
+    printf("\n--- Typed properties\n");
+
+    /* values are de-escaped once and cached by the document */
+    EXEC_RG(sp_doc_get_str(
+        &doc, "a", 0, "/:\\'\\:\\x20\\/", NULL, &val, NULL));
+    {
+        const char *val2;
+        EXEC_RG(sp_doc_get_str(
+            &doc, "a", 0, "/:\\'\\:\\x20\\/", NULL, &val2, NULL));
+        assert(val==val2);
+    }
+
+    EXEC_RG(sp_fopen(&in, "t01-2.conf", SP_MODE_READ));
+    in_opn++;
+
+    ret1 = sp_get_prop_int(
+        &in, NULL, "a", 0, "1/2/:xxx/", "scope", &lval1, NULL);
+    ret2 = sp_doc_get_int(&doc, "a", 0, "1/2/:xxx/", "scope", &lval2);
+    assert(ret1==ret2 && ret2==SPEC_SUCCESS && lval1==lval2);
+    printf("PATH</scope:1/scope:2/:xxx> PROP<a>: %ld\n", lval2);
+
+    ret1 = sp_get_prop_float(
+        &in, NULL, "b", 0, "1/2/:xxx", "scope", &dval1, NULL);
+    ret2 = sp_doc_get_float(&doc, "b", 0, "1/2/:xxx", "scope", &dval2);
+    assert(ret1==ret2 && ret2==SPEC_SUCCESS && dval1==dval2);
+    printf("PATH</scope:1/scope:2/:xxx> PROP<b>: %.4f\n", dval2);
+
+    ret1 = sp_get_prop_enum(&in, NULL, "c", 0, "/1/2/3", NULL,
+        evals, 1, buf, sizeof(buf), &ival1, NULL);
+    ret2 = sp_doc_get_enum(&doc, "c", 0, "/1/2/3", NULL, evals, 1, &ival2);
+    assert(ret1==ret2 && ret2==SPEC_SUCCESS && ival1==ival2);
+    printf("PATH</:1/:2/:3> PROP<c>: %d\n", ival2);
+
+    /* value errors */
+    ret1 = sp_get_prop_int(&in, NULL, "a", 0, "/1/2", "scope", &lval1, NULL);
+    ret2 = sp_doc_get_int(&doc, "a", 0, "/1/2", "scope", &lval2);
+    assert(ret1==ret2);
+    printf("PATH</scope:1/scope:2> PROP<a>: error %d\n", ret2);
+
+    ret1 = sp_get_prop_float(&in, NULL, "a", 0, NULL, NULL, &dval1, NULL);
+    ret2 = sp_doc_get_float(&doc, "a", 0, NULL, NULL, &dval2);
+    assert(ret1==ret2);
+    printf("PATH<> PROP<a>: error %d\n", ret2);
+
+    ret1 = sp_get_prop_enum(&in, NULL, "c", 0, "/1/2/3", NULL,
+        evals, 0, buf, sizeof(buf), &ival1, NULL);
+    ret2 = sp_doc_get_enum(&doc, "c", 0, "/1/2/3", NULL, evals, 0, &ival2);
+    assert(ret1==ret2 && ret2==SPEC_SUCCESS && ival1==ival2);
+
+    ret1 = sp_get_prop_enum(&in, NULL, "a", 0, "/1/2/3", NULL,
+        evals, 1, buf, sizeof(buf), &ival1, NULL);
+    ret2 = sp_doc_get_enum(&doc, "a", 0, "/1/2/3", NULL, evals, 1, &ival2);
+    assert(ret1==ret2);
+    printf("PATH</:1/:2/:3> PROP<a>: error %d\n", ret2);
+
+    sp_doc_free(&doc);
+    doc_ld=0;
+
+    /* lone backslash ending a value escapes its trimmed trailing space */
+    printf("\n--- Trailing backslash\n");
+    {
+        static char cf[] = "a = q\\ \nb = q\\";
+        static const char *names[] = {"a", "b"};
+        SP_FILE cin;
+        size_t i;
+
+        sp_mopen(&cin, cf, sizeof(cf)-1);
+        EXEC_RG(sp_doc_load(&cin, NULL, &doc, NULL));
+        doc_ld++;
+
+        for (i=0; i<sizeof(names)/sizeof(names[0]); i++)
+        {
+            ret1 = sp_get_prop(&cin, NULL, names[i], 0, NULL, NULL,
+                buf, sizeof(buf), NULL);
+            ret2 = sp_doc_get_str(&doc, names[i], 0, NULL, NULL, &val, NULL);
+            assert(ret1==ret2 && ret2==SPEC_SUCCESS && !strcmp(buf, val));
+            printf("PROP<%s>: \"%s\"\n", names[i], val);
+        }
+
+        sp_doc_free(&doc);
+        doc_ld=0;
+        sp_close(&cin);
+    }
+
+    /* syntax error */
+    printf("\n--- Syntax error\n");
+    {
+        static char cf[] = "a=1;\nscope s {\n  b=2;\n";
+        SP_FILE cin;
+
+        sp_mopen(&cin, cf, sizeof(cf)-1);
+        ret2 = sp_doc_load(&cin, NULL, &doc, &synerr);
+        assert(ret2==SPEC_SYNTAX && !doc.blks);
+        printf("Error %d, line:%d, col:%d, code:%d\n", ret2,
+            synerr.loc.line, synerr.loc.col, synerr.code);
+        sp_close(&cin);
+    }
+
+finish:
+    if (doc_ld) sp_doc_free(&doc);
+    if (in_opn) sp_close(&in);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/parser.h"
+#include "sprops/trans.h"
+
+/* scopes nesting depth of the tested input */
+#define DEPTH 300
+
+#if (CONFIG_MAX_SCOPE_LEVEL_DEPTH>=0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<DEPTH)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+typedef struct _count_t
+{
+    int n_props;
+    int n_scopes;
+} count_t;
+
+/* sp_parse() property callback */
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    ((count_t*)arg)->n_props++;
+    return SPEC_SUCCESS;
+}
+
+/* sp_parse_ex() scope callback; the scope body is parsed with the same
+   (busy) parser context */
+static sp_errc_t cb_scope_ctx(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef);
+
+/* sp_parse() scope callback */
+static sp_errc_t cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    ((count_t*)arg)->n_scopes++;
+    return SPEC_SUCCESS;
+}
+
+typedef struct _ctx_count_t
+{
+    sp_parser_ctx_t *p_ctx;
+    count_t cnt;
+} ctx_count_t;
+
+static sp_errc_t cb_prop_ctx(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    ((ctx_count_t*)arg)->cnt.n_props++;
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope_ctx(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    ctx_count_t *p_cc = (ctx_count_t*)arg;
+
+    p_cc->cnt.n_scopes++;
+    return (!p_lbody ? SPEC_SUCCESS : sp_parse_ex(p_cc->p_ctx,
+        in, p_lbody, cb_prop_ctx, cb_scope_ctx, arg, NULL));
+}
+
+/* Parse 'in' (all nesting levels are parsed, 0-level elements are counted) */
+static sp_errc_t parse(SP_FILE *in, const sp_alloc_t *alloc)
+{
+    sp_errc_t ret;
+    count_t cnt = {0, 0};
+
+    ret = sp_parse_alloc(in, NULL, cb_prop, cb_scope, &cnt, alloc, NULL);
+    if (ret==SPEC_SUCCESS) {
+        printf("  props:%d, scopes:%d\n", cnt.n_props, cnt.n_scopes);
+    } else {
+        printf("  error %d\n", ret);
+    }
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    static char cf[DEPTH*4+64];
+    static char ncf[] = "a {b {c {x=1;}} d {y=2;}}\nz=3;\n";
+    static char abuf[0x100000];
+    char sbuf[0x400], val[8], path[DEPTH*2+1];
+    size_t i, len;
+    char *b;
+
+    SP_FILE in, nin, out;
+    sp_arena_t arena;
+    sp_trans_t trans;
+    sp_parser_ctx_t ctx;
+    ctx_count_t cc;
+    void *stk;
+
+    /* deeply nested input */
+    for (i=0, len=0; i<DEPTH; i++, len+=2) memcpy(&cf[len], "a{", 2);
+    memcpy(&cf[len], "x=1;", 4);
+    len+=4;
+    for (i=0; i<DEPTH; i++, len++) cf[len] = '}';
+    memcpy(&cf[len], "\ny=2;\n", 7);
+
+    sp_mopen(&in, cf, sizeof(cf));
+
+    printf("--- Parser stacks: alloca\n");
+    EXEC_RG(parse(&in, NULL));
+
+    printf("\n--- Parser stacks: arena\n");
+    EXEC_RG(sp_arena_init(&arena, abuf, sizeof(abuf)));
+    for (i=0; i<2; i++) {
+        EXEC_RG(parse(&in, &arena.alloc));
+        assert(arena.used>0);
+        sp_arena_reset(&arena);
+    }
+
+    printf("\n--- Parser stacks: arena exhausted\n");
+    EXEC_RG(sp_arena_init(&arena, sbuf, sizeof(sbuf)));
+    assert(parse(&in, &arena.alloc)==SPEC_NOMEM);
+
+    printf("\n--- Parser context\n");
+    EXEC_RG(sp_parser_ctx_init(&ctx, NULL));
+    for (i=0; i<2; i++) {
+        count_t cnt = {0, 0};
+
+        EXEC_RG(sp_parse_ex(&ctx, &in, NULL, cb_prop, cb_scope, &cnt, NULL));
+        printf("  props:%d, scopes:%d\n", cnt.n_props, cnt.n_scopes);
+
+        /* the stacks are retained and reused */
+        assert(ctx.stk && !ctx.busy);
+        if (!i) stk = ctx.stk;
+        else assert(ctx.stk==stk);
+    }
+    sp_parser_ctx_free(&ctx);
+    assert(!ctx.stk);
+
+    /* nested parsing with the busy context */
+    sp_mopen(&nin, ncf, sizeof(ncf)-1);
+    EXEC_RG(sp_arena_init(&arena, abuf, sizeof(abuf)));
+    EXEC_RG(sp_parser_ctx_init(&ctx, &arena.alloc));
+    cc.p_ctx = &ctx;
+    cc.cnt.n_props = cc.cnt.n_scopes = 0;
+    EXEC_RG(sp_parse_ex(&ctx, &nin, NULL, cb_prop_ctx, cb_scope_ctx, &cc, NULL));
+    printf("  nested parsing: props:%d, scopes:%d\n",
+        cc.cnt.n_props, cc.cnt.n_scopes);
+    assert(!ctx.busy);
+    sp_parser_ctx_free(&ctx);
+
+    printf("\n--- Library API: parser context of the stream\n");
+    for (i=0, len=0; i<DEPTH; i++, len+=2) memcpy(&path[len], "/a", 2);
+    path[len] = 0;
+
+    EXEC_RG(sp_arena_init(&arena, abuf, sizeof(abuf)));
+    EXEC_RG(sp_parser_ctx_init(&ctx, &arena.alloc));
+    EXEC_RG(sp_fsetpctx(&in, &ctx));
+    EXEC_RG(sp_get_prop(&in, NULL, "y", 0, NULL, NULL,
+        val, sizeof(val), NULL));
+    printf("  /y: %s\n", val);
+    /* the stacks are allocated by the context allocator and retained */
+    assert(ctx.stk && !ctx.busy && arena.used>0);
+    stk = ctx.stk;
+    EXEC_RG(sp_get_prop(&in, NULL, "x", 0, path, NULL,
+        val, sizeof(val), NULL));
+    printf("  /a.../a/x: %s\n", val);
+    assert(ctx.stk==stk);
+    sp_parser_ctx_free(&ctx);
+
+    /* the library API doesn't grow the stacks on the caller's stack */
+    EXEC_RG(sp_arena_init(&arena, sbuf, sizeof(sbuf)));
+    EXEC_RG(sp_parser_ctx_init(&ctx, &arena.alloc));
+    assert(sp_get_prop(&in, NULL, "y", 0, NULL, NULL,
+        val, sizeof(val), NULL)==SPEC_NOMEM);
+    printf("  arena exhausted: failed as expected\n");
+    sp_parser_ctx_free(&ctx);
+    EXEC_RG(sp_fsetpctx(&in, NULL));
+
+    printf("\n--- Growable memory stream: arena\n");
+    EXEC_RG(sp_arena_init(&arena, abuf, sizeof(abuf)));
+    EXEC_RG(sp_mopen_dyn(&out, 0, &arena.alloc));
+    EXEC_RG(sp_set_prop(&in, &out, NULL, "y", "3", 0, NULL, NULL, 0));
+    EXEC_RG(sp_mdetach(&out, &b, &len));
+    assert(!b[len]);
+    printf("  length:%lu\n", (unsigned long)len);
+
+    /* the buffer has been grown in place as the last arena block,
+       therefore the arena is emptied after the buffer is freed */
+    arena.alloc.free(arena.alloc.ctx, b);
+    assert(!arena.used);
+
+    printf("\n--- In-memory transaction: arena\n");
+    for (i=0; i<2; i++) {
+        EXEC_RG(sp_init_mem_tr(&trans, &in, NULL, &arena.alloc));
+        EXEC_RG(sp_add_prop_tr(
+            &trans, "z", "3", SP_ELM_LAST, NULL, NULL, 0));
+        EXEC_RG(sp_mopen_dyn(&out, 0, &arena.alloc));
+        EXEC_RG(sp_commit_tr(&trans, &out));
+        EXEC_RG(parse(&out, &arena.alloc));
+        sp_close(&out);
+        sp_arena_reset(&arena);
+    }
+
+finish:
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
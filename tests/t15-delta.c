@@ -0,0 +1,176 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/props.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<1)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* edit spec. initializer */
+#define __EDIT(op, type, name, val, new_name, ind, path) \
+    {(op), (type), (name), (val), NULL, (new_name), (ind), (path), NULL, \
+        SP_F_SPIND(4)}
+
+static const sp_edit_t edits[] =
+{
+    __EDIT(SP_EDIT_SET_PROP, NULL, "x", "100", NULL, 0, "/scope:1"),
+    __EDIT(SP_EDIT_ADD_PROP, NULL, "z", "30", NULL, SP_ELM_LAST, "/scope:1"),
+    __EDIT(SP_EDIT_ADD_PROP, NULL, "e", "1", NULL, SP_ELM_LAST, "/scope:e"),
+    __EDIT(SP_EDIT_RM_PROP, NULL, "a", NULL, NULL, 0, NULL),
+    __EDIT(SP_EDIT_MV_PROP, NULL, "c", NULL, "cc", 0, NULL),
+    __EDIT(SP_EDIT_RM_SCOPE, "scope", "e", NULL, NULL, 0, NULL),
+    __EDIT(SP_EDIT_SET_PROP, NULL, "y", "2", NULL, 0, "/scope:1")
+};
+
+/* tracked elements */
+static const char *sc_names[] = {"1", "e"};
+static const char *pr_names[] = {"x", "y", "c"};
+static const char *pr_paths[] = {"/scope:1", "/scope:1", NULL};
+
+/* saved elements info */
+static sp_scope_info_ex_t sc_infos[2];
+static sp_prop_info_ex_t pr_infos[3];
+static sp_loc_t locs[2];
+
+static void print_loc(const char *desc, const sp_loc_t *p_loc)
+{
+    printf("  %s [0x%02lx|0x%02lx] %d:%d-%d:%d\n", desc, p_loc->beg,
+        p_loc->end, p_loc->first_line, p_loc->first_column, p_loc->last_line,
+        p_loc->last_column);
+}
+
+/* Save info of the tracked elements of 'in' */
+static sp_errc_t save_infos(SP_FILE *in)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    char val[32];
+    int i;
+
+    for (i=0; i<2; i++) {
+        EXEC_RG(sp_get_scope_info(in, NULL, "scope", sc_names[i], 0, NULL,
+            NULL, &sc_infos[i]));
+    }
+    for (i=0; i<3; i++) {
+        EXEC_RG(sp_get_prop(in, NULL, pr_names[i], 0, pr_paths[i], NULL,
+            val, sizeof(val), &pr_infos[i]));
+    }
+
+    locs[0] = sc_infos[0].lbdyenc;
+    locs[1] = pr_infos[2].ldef;
+finish:
+    return ret;
+}
+
+/* invalidated locations are not compared */
+#define __CMP_LOC(l1, l2) \
+    assert(!(l1).first_line || !memcmp(&(l1), &(l2), sizeof(sp_loc_t)))
+
+/* Check the rebased info of the tracked elements against info read from
+   the edit output 'out' */
+static void check_infos(SP_FILE *out)
+{
+    sp_scope_info_ex_t sci;
+    sp_prop_info_ex_t pri;
+    char val[32];
+    int i;
+
+    for (i=0; i<2; i++)
+    {
+        const sp_scope_info_ex_t *p_sci = &sc_infos[i];
+
+        /* the scope has been removed */
+        if (!p_sci->ldef.first_line) continue;
+
+        assert(sp_get_scope_info(out, NULL, "scope", sc_names[i], 0, NULL,
+            NULL, &sci)==SPEC_SUCCESS);
+        __CMP_LOC(p_sci->ldef, sci.ldef);
+        __CMP_LOC(p_sci->lbdyenc, sci.lbdyenc);
+        __CMP_LOC(p_sci->tkname.loc, sci.tkname.loc);
+        __CMP_LOC(p_sci->tktype.loc, sci.tktype.loc);
+        if (p_sci->body_pres) __CMP_LOC(p_sci->lbody, sci.lbody);
+    }
+
+    for (i=0; i<3; i++)
+    {
+        const sp_prop_info_ex_t *p_pri = &pr_infos[i];
+
+        /* the property has been removed or renamed */
+        if (!p_pri->tkname.loc.first_line) continue;
+
+        assert(sp_get_prop(out, NULL, pr_names[i], 0, pr_paths[i], NULL,
+            val, sizeof(val), &pri)==SPEC_SUCCESS);
+        __CMP_LOC(p_pri->ldef, pri.ldef);
+        __CMP_LOC(p_pri->tkname.loc, pri.tkname.loc);
+        __CMP_LOC(p_pri->tkval.loc, pri.tkval.loc);
+    }
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    static char cf[] =
+        "# edit deltas test\n"
+        "a = 1\n"
+        "scope 1 {\n"
+        "    x = 10\n"
+        "    y = 20\n"
+        "}\n"
+        "scope e {}\n"
+        "c = 3\n";
+    static char bufs[2][0x200];
+    SP_FILE in, out;
+    sp_edit_delta_t delta;
+    int i, n_inv;
+
+    sp_mopen(&in, cf, sizeof(cf)-1);
+    EXEC_RG(save_infos(&in));
+
+    for (i=0; i<(int)(sizeof(edits)/sizeof(*edits)); i++)
+    {
+        char *b = bufs[i & 1];
+
+        memset(b, 0, sizeof(bufs[0]));
+        sp_mopen(&out, b, sizeof(bufs[0])-1);
+
+        EXEC_RG(sp_edit(&in, &out, NULL, &edits[i], &delta));
+        printf("--- Edit %d: delta off:0x%02lx, rm:%ld, ins:%ld, "
+            "in:%d:%d, out:%d:%d\n", i+1, delta.off, delta.rm_len,
+            delta.ins_len, delta.in_line, delta.in_col, delta.out_line,
+            delta.out_col);
+
+        n_inv = sp_scope_info_rebase(sc_infos, 2, &delta);
+        n_inv += sp_prop_info_rebase(pr_infos, 3, &delta);
+        n_inv += sp_loc_rebase(locs, 2, &delta);
+        printf("  invalidated: %d\n", n_inv);
+
+        print_loc("scope 1 {}:", &locs[0]);
+        print_loc("prop c:", &locs[1]);
+
+        /* the output becomes the input of the next edit */
+        sp_mopen(&in, b, strlen(b));
+        check_infos(&in);
+    }
+    printf("\n%s", bufs[(i-1) & 1]);
+
+finish:
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
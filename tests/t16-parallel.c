@@ -0,0 +1,229 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/parser.h"
+#include "sprops/index.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<2)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* number of threads used by the parallel parsing */
+#define N_THREADS 4
+
+/* number of repetitions of the input pattern */
+#define N_PATTERN 40000
+
+/* input pattern; contains elements which may confuse the chunks splitting
+   (reserved chars in quoted ids, values and comments, continued values,
+   values terminated by a semicolon in the next line) */
+static const char pattern[] =
+    "# scope %d { \" '\n"
+    "scope 's}%d' {\n"
+    "    a = 1; b = {x\\\n"
+    "      y}\n"
+    "    \"c;\" = \\;# not a comment\r\n"
+    "    inner {d;}\n"
+    "}\n"
+    "e%d = 2\n"
+    ";\n";
+
+/* recorded 0-level parser events */
+typedef struct _evts_t
+{
+    int n_props;
+    int n_scopes;
+
+    /* sum of the elements definitions beginnings */
+    unsigned long sum_beg;
+
+    /* definition of the last element */
+    sp_loc_t last;
+} evts_t;
+
+static sp_errc_t cb_prop(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    evts_t *p_evts = (evts_t*)arg;
+
+    p_evts->n_props++;
+    p_evts->sum_beg += (unsigned long)p_ldef->beg;
+    p_evts->last = *p_ldef;
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_scope(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    evts_t *p_evts = (evts_t*)arg;
+
+    p_evts->n_scopes++;
+    p_evts->sum_beg += (unsigned long)p_ldef->beg;
+    p_evts->last = *p_ldef;
+    return SPEC_SUCCESS;
+}
+
+/* ordered mode: the elements are reported in the input order */
+static sp_errc_t cb_prop_ord(void *arg, SP_FILE *in,
+    const sp_loc_t *p_lname, const sp_loc_t *p_lval, const sp_loc_t *p_ldef)
+{
+    assert(p_ldef->beg >= ((evts_t*)arg)->last.end);
+    return cb_prop(arg, in, p_lname, p_lval, p_ldef);
+}
+
+static sp_errc_t cb_scope_ord(void *arg, SP_FILE *in,
+    const sp_loc_t *p_ltype, const sp_loc_t *p_lname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    assert(p_ldef->beg >= ((evts_t*)arg)->last.end);
+    return cb_scope(arg, in, p_ltype, p_lname, p_lbody, p_lbdyenc, p_ldef);
+}
+
+static void print_evts(const evts_t *p_evts)
+{
+    printf("  props:%d, scopes:%d, last:%d:%d-%d:%d\n", p_evts->n_props,
+        p_evts->n_scopes, p_evts->last.first_line, p_evts->last.first_column,
+        p_evts->last.last_line, p_evts->last.last_column);
+}
+
+/* compare sequentially and parallel parsed input */
+static sp_errc_t cmp_parse(SP_FILE *in, const sp_loc_t *p_parsc)
+{
+    sp_errc_t ret;
+    evts_t seq, ord, snk[N_THREADS];
+    void *sinks[N_THREADS];
+    int i;
+
+    memset(&seq, 0, sizeof(seq));
+    EXEC_RG(sp_parse(in, p_parsc, cb_prop, cb_scope, &seq, NULL));
+    print_evts(&seq);
+
+    memset(&ord, 0, sizeof(ord));
+    EXEC_RG(sp_parse_parallel(in, p_parsc,
+        cb_prop_ord, cb_scope_ord, &ord, NULL, N_THREADS, NULL));
+    assert(!memcmp(&seq, &ord, sizeof(seq)));
+
+    memset(snk, 0, sizeof(snk));
+    for (i=0; i<N_THREADS; i++) sinks[i] = &snk[i];
+    EXEC_RG(sp_parse_parallel(in, p_parsc,
+        cb_prop, cb_scope, NULL, sinks, N_THREADS, NULL));
+
+    /* sinks mode: the elements are reported to the threads' sinks
+       in an unspecified order */
+    for (i=1; i<N_THREADS; i++) {
+        snk[0].n_props += snk[i].n_props;
+        snk[0].n_scopes += snk[i].n_scopes;
+        snk[0].sum_beg += snk[i].sum_beg;
+    }
+    assert(snk[0].n_props==seq.n_props &&
+        snk[0].n_scopes==seq.n_scopes && snk[0].sum_beg==seq.sum_beg);
+
+finish:
+    return ret;
+}
+
+/* compare sequentially and parallel built indexes */
+static sp_errc_t cmp_index(SP_FILE *in)
+{
+    sp_errc_t ret;
+    sp_index_t idx, pidx;
+
+    EXEC_RG(sp_index_build(in, NULL, &idx, NULL));
+    ret = sp_index_build_parallel(in, NULL, N_THREADS, &pidx, NULL);
+    if (ret==SPEC_SUCCESS)
+    {
+        printf("  index nodes:%d\n", idx.n_nodes);
+        assert(idx.n_nodes==pidx.n_nodes && idx.hsz==pidx.hsz);
+        assert(!memcmp(idx.nodes, pidx.nodes,
+            idx.n_nodes*sizeof(*idx.nodes)));
+        assert(!memcmp(idx.htab, pidx.htab, idx.hsz*sizeof(*idx.htab)));
+        sp_index_free(&pidx);
+    }
+    sp_index_free(&idx);
+
+finish:
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_synerr_t synerr, psynerr;
+    sp_loc_t parsc;
+    evts_t evts, pevts;
+    SP_FILE in;
+    size_t len=0, sz;
+    char *cf;
+    int i;
+
+    sz = N_PATTERN*(sizeof(pattern)+3*8);
+    cf = (char*)malloc(sz);
+    if (!cf) return 1;
+
+    for (i=0; i<N_PATTERN; i++) {
+        len += sprintf(&cf[len], pattern, i, i, i);
+    }
+    sp_mopen(&in, cf, len);
+
+    printf("--- Parallel parsing\n");
+    EXEC_RG(cmp_parse(&in, NULL));
+
+    printf("\n--- Parallel parsing: scope\n");
+    {
+        /* parse the global scope starting from a 0-level element
+           located in the middle of the input */
+        static const char elm[] = "scope 's}";
+        char *p = strstr(&cf[len/2], elm);
+
+        assert(p);
+        parsc.beg = p-cf;
+        parsc.end = len;
+        parsc.first_line = 1;
+        parsc.first_column = 1;
+        parsc.last_line = parsc.last_column = -1;
+        for (p=cf; p<&cf[parsc.beg]; p++) if (*p=='\n') parsc.first_line++;
+    }
+    EXEC_RG(cmp_parse(&in, &parsc));
+
+    printf("\n--- Parallel index build\n");
+    EXEC_RG(cmp_index(&in));
+
+    printf("\n--- Parallel parsing: syntax error\n");
+    /* the error occurs in the last part of the input */
+    memcpy(&cf[len-len/5], "}}", 2);
+    memset(&evts, 0, sizeof(evts));
+    assert(sp_parse(
+        &in, NULL, cb_prop, cb_scope, &evts, &synerr)==SPEC_SYNTAX);
+    print_evts(&evts);
+    printf("  error %d at %d:%d\n",
+        synerr.code, synerr.loc.line, synerr.loc.col);
+
+    /* elements preceding the error are reported as by sp_parse() */
+    memset(&pevts, 0, sizeof(pevts));
+    assert(sp_parse_parallel(&in, NULL, cb_prop_ord, cb_scope_ord, &pevts,
+        NULL, N_THREADS, &psynerr)==SPEC_SYNTAX);
+    assert(!memcmp(&synerr, &psynerr, sizeof(synerr)));
+    assert(!memcmp(&evts, &pevts, sizeof(evts)));
+
+finish:
+    if (ret) printf("Error: %d\n", ret);
+    free(cf);
+    return 0;
+}
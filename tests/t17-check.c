@@ -0,0 +1,123 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/parser.h"
+#include "sprops/props.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_NO_EMPTY_SCOPE_ALT || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>=0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<2)
+# error Bad configuration
+#endif
+
+/* checked inputs */
+static const char *cfs[] =
+{
+    "a = 1\nb;\nscope s {c = 2; d {}}\n",
+    "a = 1\r\n;\r\n# comment {\r\n'{q}' = x\\\r\n  y\r\n",
+    "a = b\\;c; e =",
+    "a = 1\nb = 2 }\n",
+    "scope s {\n  a = 1\n",
+    "scope s {\n  a =",
+    "a b c;\n",
+    "type name;\n",
+    "a = 1\n= 2\n",
+    "a\\\nb;\n",
+    "\n  \"ab\n",
+    "x;\n  \"\"\n",
+    "x;\n  'abc",
+    "x;\n  \"a",
+    "a {b {c {d;}}}\n",
+    "a;\0{"
+};
+
+/* Check syntax of 'in' by the syntax checker and the grammar parser;
+   the results are required to be the same */
+static void check(SP_FILE *in, const sp_loc_t *p_parsc)
+{
+    sp_errc_t ret;
+    sp_synerr_t synerr, psynerr;
+
+    memset(&synerr, 0, sizeof(synerr));
+    memset(&psynerr, 0, sizeof(psynerr));
+
+    ret = sp_check_syntax(in, p_parsc, &synerr);
+    assert(sp_parse(in, p_parsc, NULL, NULL, NULL, &psynerr)==ret);
+    assert(!memcmp(&synerr, &psynerr, sizeof(synerr)));
+
+    if (ret==SPEC_SUCCESS) {
+        printf("  OK\n");
+    } else
+    if (ret==SPEC_SYNTAX) {
+        printf("  syntax error: line:%d, col:%d, code:%d\n",
+            synerr.loc.line, synerr.loc.col, synerr.code);
+    } else {
+        printf("  error %d\n", ret);
+    }
+}
+
+int main(void)
+{
+    sp_loc_t parsc;
+    SP_FILE in;
+    FILE *cf;
+    int i;
+
+    printf("--- Memory stream\n");
+    for (i=0; i<(int)(sizeof(cfs)/sizeof(*cfs)); i++) {
+        sp_mopen(&in, (char*)cfs[i], strlen(cfs[i])+(i==15 ? 2 : 0));
+        check(&in, NULL);
+    }
+
+    printf("\n--- Parsing scope\n");
+    /* the body of scope s */
+    sp_mopen(&in, (char*)cfs[0], strlen(cfs[0]));
+    parsc.beg = 18;
+    parsc.end = 28;
+    parsc.first_line = 3;
+    parsc.first_column = 10;
+    parsc.last_line = parsc.last_column = -1;
+    check(&in, &parsc);
+
+    /* the body w/o its closing bracket */
+    parsc.beg = 9;
+    parsc.first_column = 1;
+    check(&in, &parsc);
+
+    printf("\n--- C stream, small buffer\n");
+    if ((cf = tmpfile())!=NULL)
+    {
+        if (sp_fopen2(&in, cf)==SPEC_SUCCESS)
+        {
+            /* CR/LF EOLs split between the buffered blocks */
+            fputs(cfs[1], cf);
+            fflush(cf);
+            sp_fsetbuf(&in, 3);
+            check(&in, NULL);
+
+            /* syntax error in the appended content */
+            fseek(cf, 0, SEEK_END);
+            fputs(cfs[4], cf);
+            fflush(cf);
+            check(&in, NULL);
+
+            sp_close(&in);
+        } else {
+            fclose(cf);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/props.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES
+# error Bad configuration
+#endif
+
+#define INPL(n, v, i, p) \
+    sp_set_prop(&in, NULL, NULL, (n), (v), (i), (p), NULL, SP_F_INPLACE)
+
+static const char cf[] =
+    "a = 12345\n"
+    "b = xyz;\n"
+    "scope s {\n"
+    "  a = 1\\\n"
+    "    2\n"
+    "  c;\n"
+    "  a = abcdef  # comment\n"
+    "}\n";
+
+/* Set in-place 'val' of property 'name' with index 'ind' in scope 'path' of
+   the configuration 'buf'; print the result and the modified configuration */
+static void set(char *buf, const char *name, const char *val, int ind,
+    const char *path)
+{
+    SP_FILE in;
+    char v[32];
+
+    sp_mopen(&in, buf, strlen(buf));
+
+    printf("%s@%d in %s <- \"%s\": %d\n", name, ind, path,
+        (val ? val : "(null)"), INPL(name, val, ind, path));
+    fputs(buf, stdout);
+
+    if (ind>=0 && sp_get_prop(&in, NULL, name, ind, path, NULL,
+        v, sizeof(v), NULL)==SPEC_SUCCESS)
+    {
+        printf("-> \"%s\"\n", v);
+    }
+    printf("\n");
+}
+
+int main(void)
+{
+    char buf[sizeof(cf)];
+    SP_FILE in;
+    FILE *f;
+    const char *tmpf = "t18.tmp";
+
+    printf("--- Memory stream\n");
+    memcpy(buf, cf, sizeof(cf));
+
+    /* the same length */
+    set(buf, "a", "54321", 0, "/");
+    /* padded value */
+    set(buf, "b", "x;", 0, "/");
+    /* value exceeding its location */
+    set(buf, "b", "abcd", 0, "/");
+    /* value cut by the line continuation */
+    set(buf, "a", "1 2 3", 0, "/scope:s");
+    /* last property; the others are not checked */
+    set(buf, "a", "abcdef1", SP_IND_LAST, "/scope:s");
+    set(buf, "a", "ab", SP_IND_LAST, "/scope:s");
+    /* all properties have to fit */
+    set(buf, "a", "123456", SP_IND_ALL, "/scope:s");
+    set(buf, "a", "12", SP_IND_ALL, "/scope:s");
+    /* remove the value */
+    set(buf, "a", NULL, 1, "/scope:s");
+    /* prop w/o a value */
+    set(buf, "c", "1", 0, "/scope:s");
+    set(buf, "c", NULL, 0, "/scope:s");
+    /* absent properties are not added */
+    set(buf, "d", "1", 0, "/scope:s");
+    set(buf, "a", "1", 2, "/scope:s");
+    set(buf, "a", "1", 0, "/x");
+
+    printf("--- Read/write C stream\n");
+    if ((f = fopen(tmpf, "wb+"))!=NULL)
+    {
+        fputs(cf, f);
+        fclose(f);
+
+        if (sp_fopen(&in, tmpf, "rb+")==SPEC_SUCCESS)
+        {
+            sp_fsetbuf(&in, 8);
+            printf("a@* in /scope:s <- \"xy\": %d\n",
+                INPL("a", "xy", SP_IND_ALL, "/scope:s"));
+            printf("b@0 in / <- \"a;\": %d\n", INPL("b", "a;", 0, "/"));
+            sp_close(&in);
+        }
+
+#if CONFIG_FILE_MMAP
+        /* read-only mapping */
+        if (sp_fmap(&in, tmpf)==SPEC_SUCCESS) {
+            printf("mmap: %d\n", INPL("a", "0", 0, "/"));
+            sp_close(&in);
+        }
+
+        if (sp_fmap_rw(&in, tmpf)==SPEC_SUCCESS) {
+            printf("mmap rw: %d\n", INPL("a", "0", 0, "/"));
+            sp_close(&in);
+        }
+#else
+        /* no mapping support; expected output: t18_nommap.out */
+        printf("mmap: skipped: not supported\n");
+#endif
+
+        if ((f = fopen(tmpf, "rb"))!=NULL) {
+            while (fgets(buf, sizeof(buf), f)) fputs(buf, stdout);
+            fclose(f);
+        }
+        remove(tmpf);
+    }
+    return 0;
+}
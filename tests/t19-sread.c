@@ -0,0 +1,203 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/props.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    !CONFIG_NO_EMPTY_SCOPE_ALT || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<4)
+# error Bad configuration
+#endif
+
+/* read elements log */
+static char rlog[0x1000];
+static size_t rlog_len;
+
+/* number of properties to read (<0: all) */
+static int n_props = -1;
+
+static void log_add(int lev, const char *fmt, const char *s1, const char *s2)
+{
+    int n;
+
+    for (; lev>0 && rlog_len+2 < sizeof(rlog); lev--) {
+        rlog[rlog_len++] = ' ';
+        rlog[rlog_len++] = ' ';
+    }
+    n = snprintf(&rlog[rlog_len], sizeof(rlog)-rlog_len, fmt, s1, s2);
+    if (n > 0) rlog_len += (size_t)n;
+    assert(rlog_len < sizeof(rlog));
+}
+
+static sp_errc_t cb_prop(void *arg, const char *name, const char *val, int lev)
+{
+    if (!n_props) return SPEC_CB_FINISH;
+    if (n_props > 0) n_props--;
+
+    if (val) log_add(lev, "PROP %s = \"%s\"\n", name, val);
+    else log_add(lev, "PROP %s%s\n", name, "");
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_enter(
+    void *arg, const char *type, const char *name, int lev)
+{
+    log_add(lev, "SCOPE %s:%s {\n", (type ? type : ""), name);
+    return SPEC_SUCCESS;
+}
+
+static sp_errc_t cb_leave(void *arg, int lev)
+{
+    log_add(lev, "}%s%s\n", "", "");
+    return SPEC_SUCCESS;
+}
+
+/* custom stream backend: pipe-like, non-seekable source providing its
+   content by small blocks (e.g. as a decompressor) */
+typedef struct
+{
+    const char *b;  /* source content */
+    long len;       /* content length */
+    long pos;       /* stream position */
+} pipe_t;
+
+static long pipe_read(void *ctx, char *buf, size_t num)
+{
+    pipe_t *pp = (pipe_t*)ctx;
+    long n = pp->len-pp->pos;
+
+    if (n > 5) n = 5;
+    if (n > (long)num) n = (long)num;
+
+    memcpy(buf, &pp->b[pp->pos], n);
+    pp->pos += n;
+    return n;
+}
+
+static int pipe_seek(void *ctx, long off, int origin)
+{
+    pipe_t *pp = (pipe_t*)ctx;
+
+    /* seeking to the current position only */
+    if (origin==SEEK_CUR) off += pp->pos;
+    else if (origin!=SEEK_SET) return -1;
+    return (off==pp->pos ? 0 : -1);
+}
+
+static long pipe_tell(void *ctx)
+{
+    return ((pipe_t*)ctx)->pos;
+}
+
+static const sp_fops_t pipe_ops =
+    {pipe_read, NULL, pipe_seek, pipe_tell, NULL, NULL};
+
+/* Read the source 'src' of 'len' via the pipe-like stream with a window of
+   'win_len' size; the read elements are logged */
+static sp_errc_t read_pipe(
+    const char *src, long len, size_t win_len, sp_synerr_t *p_synerr)
+{
+    sp_errc_t ret;
+    SP_FILE in;
+    pipe_t pp;
+    char win[0x1000], buf1[32], buf2[32];
+
+    assert(win_len <= sizeof(win));
+
+    pp.b = src;
+    pp.len = len;
+    pp.pos = 0;
+    rlog_len = 0;
+    rlog[0] = 0;
+
+    if ((ret=sp_fopen_custom(&in, &pipe_ops, &pp))==SPEC_SUCCESS) {
+        ret = sp_read_stream(&in, win, win_len, cb_prop, cb_enter, cb_leave,
+            NULL, buf1, sizeof(buf1), buf2, sizeof(buf2), p_synerr);
+        sp_close(&in);
+    }
+    return ret;
+}
+
+int main(void)
+{
+    static char src[0x800], ref[sizeof(rlog)];
+    char win[0x80], buf1[32], buf2[32];
+    const char *cf;
+    long len;
+    sp_errc_t ret;
+    sp_synerr_t synerr;
+    SP_FILE in;
+    FILE *f;
+
+    f = fopen("t01-2.conf", "rb");
+    assert(f!=NULL);
+    len = (long)fread(src, 1, sizeof(src), f);
+    fclose(f);
+
+    printf("--- Pipe-like custom stream\n");
+    assert(read_pipe(src, len, 0x1000, NULL)==SPEC_SUCCESS);
+    fputs(rlog, stdout);
+    memcpy(ref, rlog, rlog_len+1);
+
+    /* the window content is dropped many times while reading */
+    ret = read_pipe(src, len, sizeof(win), NULL);
+    printf("Small window: %d, same: %d\n", ret, !strcmp(rlog, ref));
+
+    /* the window too small for the longest token */
+    printf("Too small window: %d\n", read_pipe(src, len, 8, NULL));
+
+    /* the input cut by the window is not reported as a syntax error */
+    cf = "a;\nlong_property_name_exceeding_the_window = 1;\n";
+    memset(&synerr, 0, sizeof(synerr));
+    ret = read_pipe(cf, (long)strlen(cf), 0x10, &synerr);
+    printf("Input cut by the window: %d, syntax error code: %d\n",
+        ret, synerr.code);
+
+    /* reading stopped by the callback */
+    n_props = 3;
+    ret = read_pipe(src, len, sizeof(win), NULL);
+    n_props = -1;
+    printf("Finished by the callback: %d\n", ret);
+    fputs(rlog, stdout);
+
+    cf = "scope s {\n  a = 1\n  b {c}\n";
+    memset(&synerr, 0, sizeof(synerr));
+    ret = read_pipe(cf, (long)strlen(cf), sizeof(win), &synerr);
+    printf("Syntax error: %d, line:%d, col:%d, code:%d\n",
+        ret, synerr.loc.line, synerr.loc.col, synerr.code);
+    fputs(rlog, stdout);
+
+    printf("\n--- Not buffered C stream\n");
+    if ((f = tmpfile())!=NULL)
+    {
+        fwrite(src, 1, len, f);
+        rewind(f);
+
+        if (sp_fopen2(&in, f)==SPEC_SUCCESS)
+        {
+            rlog_len = 0;
+            ret = sp_read_stream(&in, win, sizeof(win), cb_prop, cb_enter,
+                cb_leave, NULL, buf1, sizeof(buf1), buf2, sizeof(buf2), NULL);
+            printf("%d, same: %d\n", ret, !strcmp(rlog, ref));
+            sp_close(&in);
+        } else {
+            fclose(f);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/writer.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    !CONFIG_NO_EMPTY_SCOPE_ALT || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>=0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<3)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+/* number of generated scopes */
+#define N_SCOPES 10000
+
+/* indentation */
+static unsigned long indf = SP_F_SPIND(4);
+
+/* Write the configuration generated by t08-scratch */
+static sp_errc_t write_scratch(sp_writer_t *p_wr)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+
+    EXEC_RG(sp_writer_prop(p_wr, "PROP1", "VAL", indf));
+    EXEC_RG(sp_writer_prop(p_wr, "PROP2", "VAL", indf|SP_F_EXTEOL));
+
+    EXEC_RG(sp_writer_begin_scope(p_wr, "TYPE", "SCOPE1", indf));
+    EXEC_RG(sp_writer_prop(p_wr, "PROP1", "VAL", indf));
+    EXEC_RG(sp_writer_prop(p_wr, "PROP2", "VAL", indf));
+    EXEC_RG(sp_writer_end_scope(p_wr, SP_F_EXTEOL));
+
+    EXEC_RG(sp_writer_begin_scope(p_wr, "TYPE", "SCOPE2", indf|SP_F_EOLBFR));
+    EXEC_RG(sp_writer_begin_scope(p_wr, "TYPE", "SCOPE1", indf|SP_F_EMPCPT));
+    EXEC_RG(sp_writer_end_scope(p_wr, 0));
+    EXEC_RG(sp_writer_begin_scope(p_wr, "TYPE", "SCOPE2", indf|SP_F_SPLBRA));
+    EXEC_RG(sp_writer_prop(p_wr, "PROP1", "VAL", indf));
+    EXEC_RG(sp_writer_end_scope(p_wr, 0));
+    EXEC_RG(sp_writer_end_scope(p_wr, 0));
+
+    EXEC_RG(sp_writer_begin_scope(p_wr, "TYPE", "SCOPE3",
+        indf|SP_F_EOLBFR|SP_F_EMPCPT));
+    EXEC_RG(sp_writer_end_scope(p_wr, 0));
+
+finish:
+    return ret;
+}
+
+/* Write elements requiring escaping; read them back */
+static sp_errc_t write_escaped(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_writer_t wr;
+    SP_FILE out;
+    char *buf=NULL, val[32];
+    size_t i, len;
+
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_writer_init(&wr, &out, SP_F_TBIND, EOL_CRLF));
+
+    EXEC_RG(sp_writer_prop(&wr, "a b", " x;#y ", SP_F_NVSRSP));
+    EXEC_RG(sp_writer_begin_scope(&wr, NULL, "{s}", SP_F_SPLBRA));
+    EXEC_RG(sp_writer_prop(&wr, "c", NULL, 0));
+    EXEC_RG(sp_writer_begin_scope(&wr, "t:", "n", SP_F_EMPCPT));
+    EXEC_RG(sp_writer_prop(&wr, "'d'", "1\\2", SP_F_NOSEMC));
+    EXEC_RG(sp_writer_end_scope(&wr, 0));
+    EXEC_RG(sp_writer_end_scope(&wr, 0));
+
+    /* the global scope can't be ended */
+    assert(sp_writer_end_scope(&wr, 0)==SPEC_INV_ARG);
+
+    EXEC_RG(sp_check_syntax(&out, NULL, NULL));
+
+    EXEC_RG(sp_get_prop(&out, NULL, "a b", 0, NULL, NULL,
+        val, sizeof(val), NULL));
+    printf("/a b: \"%s\"\n", val);
+    EXEC_RG(sp_get_prop(&out, NULL, "c", 0, "/{s}", NULL,
+        val, sizeof(val), NULL));
+    printf("/{s}/c: \"%s\"\n", val);
+    EXEC_RG(sp_get_prop(&out, NULL, "'d'", 0, "/{s}/t\\::n", NULL,
+        val, sizeof(val), NULL));
+    printf("/{s}/t\\::n/'d': \"%s\"\n", val);
+
+    EXEC_RG(sp_mdetach(&out, &buf, &len));
+    for (i=0; i<len; i++) {
+        if (buf[i]=='\r') fputs("\\r", stdout);
+        else putchar(buf[i]);
+    }
+finish:
+    if (buf) free(buf);
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    sp_writer_t wr;
+    SP_FILE out;
+    char *buf=NULL, ref[0x200];
+    size_t len, n;
+    long val;
+    FILE *f;
+    int i;
+
+    printf("--- Scratch configuration\n");
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_writer_init(&wr, &out, indf, EOL_LF));
+    EXEC_RG(write_scratch(&wr));
+    EXEC_RG(sp_mdetach(&out, &buf, &len));
+    fputs(buf, stdout);
+
+    /* the same output as by the element addition API */
+    if ((f = fopen("t08.out", "rb"))!=NULL) {
+        n = fread(ref, 1, sizeof(ref), f);
+        printf("Same as t08-scratch: %d\n", (n==len && !memcmp(buf, ref, n)));
+        fclose(f);
+    }
+    free(buf);
+    buf = NULL;
+
+    printf("\n--- Escaped elements\n");
+    EXEC_RG(write_escaped());
+
+    printf("\n--- Large output\n");
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_writer_init(&wr, &out, SP_F_SPIND(2), EOL_LF));
+    for (i=0; i<N_SCOPES; i++) {
+        char nm[16];
+        sprintf(nm, "%d", i);
+        EXEC_RG(sp_writer_begin_scope(&wr, "scope", nm, 0));
+        EXEC_RG(sp_writer_prop(&wr, "a", nm, 0));
+        EXEC_RG(sp_writer_begin_scope(&wr, NULL, "x", SP_F_EMPCPT));
+        EXEC_RG(sp_writer_end_scope(&wr, 0));
+        EXEC_RG(sp_writer_end_scope(&wr, 0));
+    }
+    EXEC_RG(sp_check_syntax(&out, NULL, NULL));
+    EXEC_RG(sp_get_prop_int(&out, NULL, "a", 0, "/scope:9999", NULL, &val,
+        NULL));
+    printf("/scope:9999/a: %ld\n", val);
+    sp_close(&out);
+
+finish:
+    if (buf) free(buf);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}
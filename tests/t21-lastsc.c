@@ -0,0 +1,199 @@
+/*
+   Copyright (c) 2022 Piotr Stolarz
+   Scoped properties configuration library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "sprops/props.h"
+
+#if CONFIG_NO_SEMICOL_ENDS_VAL || \
+    !CONFIG_CUT_VAL_LEADING_SPACES || \
+    !CONFIG_TRIM_VAL_TRAILING_SPACES || \
+    (CONFIG_MAX_SCOPE_LEVEL_DEPTH>0 && CONFIG_MAX_SCOPE_LEVEL_DEPTH<3)
+# error Bad configuration
+#endif
+
+#define EXEC_RG(c) if ((ret=(c))!=SPEC_SUCCESS) goto finish;
+
+static const char cf[] =
+    "a {\n"
+    "    x = 1;\n"
+    "}\n"
+    "b = 2;\n"
+    "a {\n"
+    "    y = 3;\n"
+    "    # the last part of 'a' scope; the comment is read by the lexer only\n"
+    "    c { z = 4; }\n"
+    "    c {\n"
+    "        z = 5;\n"
+    "        # the last part of 'c' scope\n"
+    "        v = 8;\n"
+    "    }\n"
+    "}\n"
+    "d = 6;\n";
+
+/* custom stream backend counting reads of the content chars */
+typedef struct
+{
+    long pos;               /* stream position */
+    int n_rd[sizeof(cf)];   /* number of reads of each char */
+} cnt_t;
+
+static long cnt_read(void *ctx, char *buf, size_t num)
+{
+    cnt_t *p_cnt = (cnt_t*)ctx;
+    long i, n = (long)sizeof(cf)-1-p_cnt->pos;
+
+    if (n > (long)num) n = (long)num;
+    if (n < 0) n = 0;
+
+    for (i=0; i<n; i++) p_cnt->n_rd[p_cnt->pos+i]++;
+    memcpy(buf, &cf[p_cnt->pos], n);
+    p_cnt->pos += n;
+    return n;
+}
+
+static int cnt_seek(void *ctx, long off, int origin)
+{
+    cnt_t *p_cnt = (cnt_t*)ctx;
+
+    if (origin==SEEK_CUR) off += p_cnt->pos;
+    else if (origin==SEEK_END) off += (long)sizeof(cf)-1;
+
+    if (off < 0 || off > (long)sizeof(cf)-1) return -1;
+    p_cnt->pos = off;
+    return 0;
+}
+
+static long cnt_tell(void *ctx)
+{
+    return ((cnt_t*)ctx)->pos;
+}
+
+static const sp_fops_t cnt_ops =
+    {cnt_read, NULL, cnt_seek, cnt_tell, NULL, NULL};
+
+static cnt_t cnt;
+
+/* Number of parsing passes over the comment starting with 'cmt'; the
+   comment is placed between elements of a scope body to be a part of the
+   body location */
+static int passes(const char *cmt)
+{
+    const char *p = strstr(cf, cmt);
+
+    assert(p!=NULL);
+    /* middle of the comment is not a part of any token */
+    return cnt.n_rd[(p-cf) + strlen(cmt)/2];
+}
+
+/* sp_iterate() callback: property */
+static sp_errc_t cb_prop(
+    void *arg, SP_FILE *in, const char *name, const sp_tkn_info_t *p_tkname,
+    const char *val, const sp_tkn_info_t *p_tkval, const sp_loc_t *p_ldef)
+{
+    printf("  PROP %s = \"%s\"\n", name, val);
+    return SPEC_SUCCESS;
+}
+
+/* sp_iterate() callback: scope */
+static sp_errc_t cb_scope(
+    void *arg, SP_FILE *in, const char *type, const sp_tkn_info_t *p_tktype,
+    const char *name, const sp_tkn_info_t *p_tkname, const sp_loc_t *p_lbody,
+    const sp_loc_t *p_lbdyenc, const sp_loc_t *p_ldef)
+{
+    printf("  SCOPE %s:%s\n", type, name);
+    return SPEC_SUCCESS;
+}
+
+/* Iterate 'path' of the input 'in' counting the parsing passes */
+static sp_errc_t iter_path(SP_FILE *in, const char *path)
+{
+    sp_errc_t ret;
+    char buf1[32], buf2[32];
+
+    memset(&cnt, 0, sizeof(cnt));
+
+    printf("%s\n", path);
+    EXEC_RG(sp_iterate(in, NULL, path, NULL, cb_prop, cb_scope, NULL,
+        buf1, sizeof(buf1), buf2, sizeof(buf2)));
+    printf("  passes: 'a': %d, 'c': %d\n",
+        passes("# the last part of 'a'"), passes("# the last part of 'c'"));
+finish:
+    return ret;
+}
+
+int main(void)
+{
+    sp_errc_t ret=SPEC_SUCCESS;
+    SP_FILE in, out;
+    sp_edit_batch_t batch, empty;
+    char buf[32], *obuf=NULL;
+    size_t olen;
+    int n_a, n_c;
+
+    sp_edit_batch_init(&batch);
+    sp_edit_batch_init(&empty);
+
+    EXEC_RG(sp_fopen_custom(&in, &cnt_ops, &cnt));
+    /* each char is read separately; no re-reads served by the buffer */
+    EXEC_RG(sp_fsetbuf(&in, 1));
+
+    EXEC_RG(iter_path(&in, "/a@$"));
+    EXEC_RG(iter_path(&in, "/a@$/c@$"));
+    EXEC_RG(iter_path(&in, "/a@1/c@$"));
+    EXEC_RG(iter_path(&in, "/a@$/c@0"));
+    EXEC_RG(iter_path(&in, "/a@0"));
+
+    /* update */
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_set_prop(&in, &out, NULL, "z", "7", 0, "/a@$/c@$", NULL, 0));
+    EXEC_RG(sp_get_prop(&out, NULL, "z", 0, "/a@1/c@1", NULL,
+        buf, sizeof(buf), NULL));
+    printf("set /a@$/c@$/z; /a@1/c@1/z: %s\n", buf);
+    EXEC_RG(sp_mdetach(&out, &obuf, &olen));
+    free(obuf);
+    obuf = NULL;
+
+    /* batch edit; single parsing pass for all the edits, the last scope bodies
+       are re-parsed afterwards */
+    EXEC_RG(sp_edit_set_prop(&batch, "z", "8", 0, "/a@$/c@$", NULL, 0));
+    EXEC_RG(sp_edit_add_prop(&batch, "w", "9", SP_ELM_LAST, "/a@1/c@0",
+        NULL, 0));
+    EXEC_RG(sp_edit_rm_prop(&batch, "y", 0, "/a", NULL, 0));
+
+    /* the input is read for writing the output; not counted */
+    memset(&cnt, 0, sizeof(cnt));
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_edit_apply(&in, &out, NULL, &empty, NULL));
+    sp_close(&out);
+    n_a = passes("# the last part of 'a'");
+    n_c = passes("# the last part of 'c'");
+
+    memset(&cnt, 0, sizeof(cnt));
+    EXEC_RG(sp_mopen_dyn(&out, 0, NULL));
+    EXEC_RG(sp_edit_apply(&in, &out, NULL, &batch, NULL));
+    printf("batch passes: 'a': %d, 'c': %d\n",
+        passes("# the last part of 'a'")-n_a,
+        passes("# the last part of 'c'")-n_c);
+    EXEC_RG(sp_mdetach(&out, &obuf, &olen));
+    fwrite(obuf, 1, olen, stdout);
+
+    sp_close(&in);
+finish:
+    sp_edit_batch_free(&batch);
+    if (obuf) free(obuf);
+    if (ret) printf("Error: %d\n", ret);
+    return 0;
+}